@@ -189,12 +189,35 @@ bool DataStore::saveMainIdentity(const mesh::LocalIdentity &identity) {
   return identity_store.save("_main", identity);
 }
 
+bool DataStore::loadPrefsBinary(NodePrefs& prefs) {
+  File file = openRead(_fs, "/prefs.bin");
+  if (!file) return false;
+
+  bool success = false;
+  int len = file.size();
+  if (len > 0 && len <= CONFIG_BINARY_HDR_SIZE + CONFIG_BINARY_MAX_SIZE) {
+    uint8_t* buf = new uint8_t[len];
+    if (file.read(buf, len) == len) {   // whole file in one read
+      success = prefs.loadBinary(buf, len);
+    }
+    delete[] buf;
+  }
+  file.close();
+  return success;
+}
+
 void DataStore::loadPrefs(NodePrefs& prefs) {
+  if (_fs->exists("/prefs.bin")) {
+    if (loadPrefsBinary(prefs)) return;   // compact binary prefs
+    MESH_DEBUG_PRINTLN("loadPrefs: /prefs.bin is corrupt, trying /prefs.json");
+  }
+
   if (_fs->exists("/prefs.json")) {
     File file = openRead(_fs, "/prefs.json");
     if (file) {
-      prefs.loadSerial(file);   // new Serial prefs
+      bool success = prefs.loadSerial(file);   // Serial (json) prefs
       file.close();
+      if (success) savePrefs(prefs);   // migrate to binary prefs
     }
   } else if (_fs->exists("/new_prefs")) {
     loadPrefsInt("/new_prefs", prefs);
@@ -246,16 +269,36 @@ void DataStore::loadPrefsInt(const char *filename, NodePrefs& _prefs) {
   }
 }
 
-bool DataStore::savePrefs(NodePrefs& _prefs) {
+bool DataStore::savePrefsSerial(NodePrefs& _prefs) {
   File file = openWrite(_fs, "/prefs.json");
   if (file) {
     bool success = _prefs.saveSerial(file);
     file.close();
-    return success;
+    if (success) return true;
   }
+  _fs->remove("/prefs.json");   // don't leave a stale or partial copy to fall back to
   return false;
 }
 
+bool DataStore::savePrefs(NodePrefs& _prefs) {
+  // JSON copy first: it is what older firmware loads (so a downgrade keeps its settings), and the fallback if prefs.bin is corrupt
+  savePrefsSerial(_prefs);
+
+  int len = _prefs.saveBinary(NULL, 0);
+  if (len <= 0) return false;
+  uint8_t* buf = new uint8_t[len];
+  _prefs.saveBinary(buf, len);
+
+  bool success = false;
+  File file = openWrite(_fs, "/prefs.bin");
+  if (file) {
+    success = file.write(buf, len) == len;   // whole file in one write
+    file.close();
+  }
+  delete[] buf;
+  return success;
+}
+
 void DataStore::loadContacts(DataStoreHost* host) {
 File file = openRead(_getContactsChannelsFS(), "/contacts3");
     if (file) {
@@ -20,6 +20,8 @@ class DataStore {
   IdentityStore identity_store;
 
   void loadPrefsInt(const char *filename, NodePrefs& prefs);
+  bool loadPrefsBinary(NodePrefs& prefs);
+  bool savePrefsSerial(NodePrefs& prefs);
 #if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
   void checkAdvBlobFile();
 #endif
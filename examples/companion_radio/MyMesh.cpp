@@ -67,6 +67,8 @@
 #define STATS_TYPE_CORE               0
 #define STATS_TYPE_RADIO              1
 #define STATS_TYPE_PACKETS             2
+#define STATS_TYPE_CHANNEL            3
+#define STATS_TYPE_METRICS            4   // third byte is start index
 
 #define RESP_CODE_OK                  0
 #define RESP_CODE_ERR                 1
@@ -258,6 +260,12 @@ float MyMesh::getAirtimeBudgetFactor() const {
   return _prefs.airtime_factor;
 }
 
+#ifdef DUTY_CYCLE_EU868
+uint8_t MyMesh::getDutyCycleBand() const {
+  return mesh::DutyCycleTracker::findEU868Band(_prefs.freq);
+}
+#endif
+
 int MyMesh::getInterferenceThreshold() const {
   return 0; // disabled for now, until currentRSSI() problem is resolved
 }
@@ -625,7 +633,7 @@ void MyMesh::onChannelDataRecv(const mesh::GroupChannel &channel, mesh::Packet *
 }
 
 uint8_t MyMesh::onContactRequest(const ContactInfo &contact, uint32_t sender_timestamp, const uint8_t *data,
-                                 uint8_t len, uint8_t *reply) {
+                                 size_t len, uint8_t *reply) {
   if (data[0] == REQ_TYPE_GET_TELEMETRY_DATA) {
     uint8_t permissions = 0;
     uint8_t cp = contact.flags >> 1; // LSB used as 'favourite' bit (so only use upper bits)
@@ -673,10 +681,15 @@ uint8_t MyMesh::onContactRequest(const ContactInfo &contact, uint32_t sender_tim
   return 0; // unknown
 }
 
-void MyMesh::onContactResponse(const ContactInfo &contact, const uint8_t *data, uint8_t len) {
+void MyMesh::onContactResponse(const ContactInfo &contact, const uint8_t *data, size_t len) {
   uint32_t tag;
   memcpy(&tag, data, 4);
 
+  if (len > MULTIPART_SINGLE_MAX_DATA && !(tag == pending_req && pending_req)) {
+    MESH_DEBUG_PRINTLN("onContactResponse: unexpected multipart response, len=%d", (int)len);
+    return;   // only binary responses can be split over several frames
+  }
+
   if (pending_login && memcmp(&pending_login, contact.id.pub_key, 4) == 0) { // check for login response
     // yes, is response to pending sendLogin()
     pending_login = 0;
@@ -733,17 +746,25 @@ void MyMesh::onContactResponse(const ContactInfo &contact, const uint8_t *data,
     memcpy(&out_frame[i], &data[4], len - 4);
     i += (len - 4);
     _serial->writeFrame(out_frame, i);
-  } else if (len > 4 && tag == pending_req) {  // check for matching response tag
-    pending_req = 0;
+  } else if (len > 4 && (tag == pending_req || isTelemSubscription(tag))) {  // check for matching response tag
+    if (tag == pending_req) pending_req = 0;   // NOTE: telemetry pushes keep coming with subscription's tag
 
-    int i = 0;
-    out_frame[i++] = PUSH_CODE_BINARY_RESPONSE;
-    out_frame[i++] = 0; // reserved
-    memcpy(&out_frame[i], &tag, 4);   // app needs to match this to RESP_CODE_SENT.tag
-    i += 4;
-    memcpy(&out_frame[i], &data[4], len - 4);
-    i += (len - 4);
-    _serial->writeFrame(out_frame, i);
+    // a multipart response can be longer than a frame, so is pushed in parts
+    size_t ofs = 4;
+    for (uint8_t part = 0; ofs < len; part++) {
+      size_t n = len - ofs;
+      if (n > MAX_FRAME_SIZE - 6) n = MAX_FRAME_SIZE - 6;
+
+      int i = 0;
+      out_frame[i++] = PUSH_CODE_BINARY_RESPONSE;
+      out_frame[i++] = (ofs + n < len) ? (0x80 | part) : part;   // was reserved (zero). part number, top bit set if more parts follow
+      memcpy(&out_frame[i], &tag, 4);   // app needs to match this to RESP_CODE_SENT.tag
+      i += 4;
+      memcpy(&out_frame[i], &data[ofs], n);
+      i += n;
+      ofs += n;
+      _serial->writeFrame(out_frame, i);
+    }
   }
 }
 
@@ -820,6 +841,8 @@ void MyMesh::onRawDataRecv(mesh::Packet *packet) {
 
 void MyMesh::onTraceRecv(mesh::Packet *packet, uint32_t tag, uint32_t auth_code, uint8_t flags,
                          const uint8_t *path_snrs, const uint8_t *path_hashes, uint8_t path_len) {
+  BaseChatMesh::onTraceRecv(packet, tag, auth_code, flags, path_snrs, path_hashes, path_len);  // update link quality
+
   uint8_t path_sz = flags & 0x03;  // NEW v1.11+
   if (12 + path_len + (path_len >> path_sz) + 1 > sizeof(out_frame)) {
     MESH_DEBUG_PRINTLN("onTraceRecv(), path_len is too long: %d", (uint32_t)path_len);
@@ -868,9 +891,12 @@ MyMesh::MyMesh(mesh::Radio &radio, mesh::RNG &rng, mesh::RTCClock &rtc, SimpleMe
   offline_queue_len = 0;
   app_target_ver = 0;
   clearPendingReqs();
+  memset(telem_sub_tags, 0, sizeof(telem_sub_tags));
+  next_telem_sub = 0;
   next_ack_idx = 0;
   sign_data = NULL;
   dirty_contacts_expiry = 0;
+  setMultipartBuffers(&mp_recv, NULL);
   memset(advert_paths, 0, sizeof(advert_paths));
   memset(send_scope.key, 0, sizeof(send_scope.key));
   send_unscoped = false;
@@ -900,6 +926,7 @@ MyMesh::MyMesh(mesh::Radio &radio, mesh::RNG &rng, mesh::RTCClock &rtc, SimpleMe
 
 void MyMesh::begin(bool has_display) {
   BaseChatMesh::begin();
+  getMetrics().addGauge(METRIC_ID_BATT_MV, "batt_mv", [](const void*) -> int32_t { return board.getBattMilliVolts(); }, NULL);
 
   if (!_store->loadMainIdentity(self_id)) {
     self_id = radio_new_identity(); // create new random identity
@@ -1271,10 +1298,13 @@ void MyMesh::handleCmdFrame(size_t len) {
     uint8_t *pub_key = &cmd_frame[1];
     ContactInfo *recipient = lookupContactByPubKey(pub_key, PUB_KEY_SIZE);
     if (recipient) {
-      recipient->out_path_len = OUT_PATH_UNKNOWN;
+      resetPathTo(*recipient);
       // recipient->lastmod = ??   shouldn't be needed, app already has this version of contact
       dirty_contacts_expiry = futureMillis(LAZY_CONTACTS_WRITE_DELAY);
       writeOKFrame();
+      if (recipient->out_path_len != OUT_PATH_UNKNOWN) {
+        onContactPathUpdated(*recipient);   // switched to another known path, rather than flood
+      }
     } else {
       writeErrFrame(ERR_CODE_NOT_FOUND); // unknown contact
     }
@@ -1680,6 +1710,10 @@ void MyMesh::handleCmdFrame(size_t len) {
       } else {
         clearPendingReqs();
         pending_req = tag; // match this in onContactResponse()
+        if (req_data[0] == REQ_TYPE_SUBSCRIBE_TELEMETRY) {   // pushes will come with this same tag
+          telem_sub_tags[next_telem_sub] = tag;
+          next_telem_sub = (next_telem_sub + 1) % MAX_TELEM_SUBSCRIPTIONS;
+        }
         out_frame[0] = RESP_CODE_SENT;
         out_frame[1] = (result == MSG_SEND_SENT_FLOOD) ? 1 : 0;
         memcpy(&out_frame[2], &tag, 4);
@@ -1910,6 +1944,34 @@ void MyMesh::handleCmdFrame(size_t len) {
       memcpy(&out_frame[i], &n_recv_direct, 4); i += 4;
       memcpy(&out_frame[i], &n_recv_errors, 4); i += 4;
       _serial->writeFrame(out_frame, i);
+    } else if (stats_type == STATS_TYPE_METRICS) {
+      int i = 0;
+      out_frame[i++] = RESP_CODE_STATS;
+      out_frame[i++] = STATS_TYPE_METRICS;
+      i += getMetrics().exportBinary(&out_frame[i], MAX_FRAME_SIZE - i, len >= 3 ? cmd_frame[2] : 0);
+      _serial->writeFrame(out_frame, i);
+    } else if (stats_type == STATS_TYPE_CHANNEL) {
+      const ChannelMonitor& ch = radio_driver.getChannelMonitor();
+      int i = 0;
+      out_frame[i++] = RESP_CODE_STATS;
+      out_frame[i++] = STATS_TYPE_CHANNEL;
+      out_frame[i++] = CHANNEL_NUM_WINDOWS;
+      out_frame[i++] = (int8_t) CHANNEL_NOISE_BASE;
+      out_frame[i++] = CHANNEL_NOISE_STEP;
+      out_frame[i++] = CHANNEL_NOISE_BINS;
+      for (int w = 0; w < CHANNEL_NUM_WINDOWS; w++) {   // minute, hour, day
+        uint16_t busy = ch.getBusyPermille(w);
+        uint16_t rx = ch.getRecvPermille(w);
+        uint16_t tx = ch.getSentPermille(w);
+        memcpy(&out_frame[i], &busy, 2); i += 2;
+        memcpy(&out_frame[i], &rx, 2); i += 2;
+        memcpy(&out_frame[i], &tx, 2); i += 2;
+        out_frame[i++] = (int8_t) ch.getNoisePercentile(w, 50);
+        for (int b = 0; b < CHANNEL_NOISE_BINS; b++) {
+          out_frame[i++] = ch.getNoiseBinPercent(w, b);
+        }
+      }
+      _serial->writeFrame(out_frame, i);
     } else {
       writeErrFrame(ERR_CODE_ILLEGAL_ARG); // invalid stats sub-type
     }
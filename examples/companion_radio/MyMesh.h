@@ -75,6 +75,11 @@
 #define REQ_TYPE_GET_STATUS             0x01 // same as _GET_STATS
 #define REQ_TYPE_KEEP_ALIVE             0x02
 #define REQ_TYPE_GET_TELEMETRY_DATA     0x03
+#define REQ_TYPE_SUBSCRIBE_TELEMETRY    0x08 // sensor nodes, FIRMWARE_VER_LEVEL >= 3
+
+#ifndef MAX_TELEM_SUBSCRIPTIONS
+  #define MAX_TELEM_SUBSCRIPTIONS   8
+#endif
 
 struct AdvertPath {
   uint8_t pubkey_prefix[7];
@@ -104,6 +109,9 @@ public:
 
 protected:
   float getAirtimeBudgetFactor() const override;
+#ifdef DUTY_CYCLE_EU868
+  uint8_t getDutyCycleBand() const override;
+#endif
   int getInterferenceThreshold() const override;
   bool getCADEnabled() const override;
   int calcRxDelay(float score, uint32_t air_time) const override;
@@ -143,8 +151,8 @@ protected:
                          const uint8_t *data, size_t data_len) override;
 
   uint8_t onContactRequest(const ContactInfo &contact, uint32_t sender_timestamp, const uint8_t *data,
-                           uint8_t len, uint8_t *reply) override;
-  void onContactResponse(const ContactInfo &contact, const uint8_t *data, uint8_t len) override;
+                           size_t len, uint8_t *reply) override;
+  void onContactResponse(const ContactInfo &contact, const uint8_t *data, size_t len) override;
   void onControlDataRecv(mesh::Packet *packet) override;
   void onRawDataRecv(mesh::Packet *packet) override;
   void onTraceRecv(mesh::Packet *packet, uint32_t tag, uint32_t auth_code, uint8_t flags,
@@ -163,6 +171,12 @@ protected:
   void clearPendingReqs() {
     pending_login = pending_status = pending_telemetry = pending_discovery = pending_req = 0;
   }
+  bool isTelemSubscription(uint32_t tag) const {
+    for (int i = 0; i < MAX_TELEM_SUBSCRIPTIONS; i++) {
+      if (tag && telem_sub_tags[i] == tag) return true;
+    }
+    return false;
+  }
 
 public:
   void savePrefs() {
@@ -214,6 +228,8 @@ private:
   uint32_t pending_status;
   uint32_t pending_telemetry, pending_discovery;   // pending _TELEMETRY_REQ
   uint32_t pending_req;   // pending _BINARY_REQ
+  uint32_t telem_sub_tags[MAX_TELEM_SUBSCRIPTIONS];   // tags of telemetry subscriptions, pushes are sent with these
+  uint8_t next_telem_sub;
   BaseSerialInterface *_serial;
   AbstractUITask* _ui;
 
@@ -234,6 +250,7 @@ private:
 
   uint8_t cmd_frame[MAX_FRAME_SIZE + 1];
   uint8_t out_frame[MAX_FRAME_SIZE + 1];
+  mesh::MultipartRecvBuffer mp_recv;   // only receives multipart (responses), never sends
   CayenneLPP telemetry;
 
   struct Frame {
@@ -1,5 +1,4 @@
 #include "MyMesh.h"
-#include <algorithm>
 
 /* ------------------------------ Config -------------------------------- */
 
@@ -41,7 +40,7 @@
   #define TXT_ACK_DELAY 200
 #endif
 
-#define FIRMWARE_VER_LEVEL       2
+#define FIRMWARE_VER_LEVEL       3
 
 #define REQ_TYPE_GET_STATUS         0x01 // same as _GET_STATS
 #define REQ_TYPE_KEEP_ALIVE         0x02
@@ -50,6 +49,10 @@
 #define REQ_TYPE_GET_NEIGHBOURS     0x06
 #define REQ_TYPE_GET_OWNER_INFO     0x07     // FIRMWARE_VER_LEVEL >= 2
 
+#define STATUS_FORMAT_METRICS       1        // GET_STATUS payload[1], payload[2] is start index
+
+#define REQ_FLAG_MULTIPART          0x01     // FIRMWARE_VER_LEVEL >= 3, requester accepts a multipart response
+
 #define RESP_SERVER_LOGIN_OK        0 // response to ANON_REQ
 
 #define ANON_REQ_TYPE_REGIONS      0x01
@@ -62,28 +65,7 @@
 
 void MyMesh::putNeighbour(const mesh::Identity &id, uint32_t timestamp, float snr) {
 #if MAX_NEIGHBOURS // check if neighbours enabled
-  // find existing neighbour, else use least recently updated
-  uint32_t oldest_timestamp = 0xFFFFFFFF;
-  NeighbourInfo *neighbour = &neighbours[0];
-  for (int i = 0; i < MAX_NEIGHBOURS; i++) {
-    // if neighbour already known, we should update it
-    if (id.matches(neighbours[i].id)) {
-      neighbour = &neighbours[i];
-      break;
-    }
-
-    // otherwise we should update the least recently updated neighbour
-    if (neighbours[i].heard_timestamp < oldest_timestamp) {
-      neighbour = &neighbours[i];
-      oldest_timestamp = neighbour->heard_timestamp;
-    }
-  }
-
-  // update neighbour info
-  neighbour->id = id;
-  neighbour->advert_timestamp = timestamp;
-  neighbour->heard_timestamp = getRTCClock()->getCurrentTime();
-  neighbour->snr = (int8_t)(snr * 4);
+  neighbours.put(id.pub_key, timestamp, getRTCClock()->getCurrentTime(), (int8_t)(snr * 4));
 #endif
 }
 
@@ -157,7 +139,7 @@ uint8_t MyMesh::handleAnonRegionsReq(const mesh::Identity& sender, uint32_t send
     uint32_t now = getRTCClock()->getCurrentTime();
     memcpy(&reply_data[4], &now, 4);     // include our clock (for easy clock sync, and packet hash uniqueness)
 
-    return 8 + region_map.exportNamesTo((char *) &reply_data[8], sizeof(reply_data) - 12, REGION_DENY_FLOOD);   // reply length
+    return 8 + region_map.exportNamesTo((char *) &reply_data[8], MAX_PACKET_PAYLOAD - 12, REGION_DENY_FLOOD);   // reply length
   }
   return 0;
 }
@@ -214,6 +196,9 @@ int MyMesh::handleRequest(ClientInfo *sender, uint32_t sender_timestamp, uint8_t
   memcpy(reply_data, &sender_timestamp, 4); // reflect sender_timestamp back in response packet (kind of like a 'tag')
 
   if (payload[0] == REQ_TYPE_GET_STATUS) {  // guests can also access this now
+    if (payload[1] == STATUS_FORMAT_METRICS) {   // reserved byte was zero, for older clients
+      return 4 + getMetrics().exportBinary(&reply_data[4], 128, payload[2]);   // small enough to also fit in a path return
+    }
     RepeaterStats stats;
     stats.batt_milli_volts = board.getBattMilliVolts();
     stats.curr_tx_queue_len = _mgr->getOutboundTotal();
@@ -260,11 +245,12 @@ int MyMesh::handleRequest(ClientInfo *sender, uint32_t sender_timestamp, uint8_t
     return 4 + tlen; // reply_len
   }
   if (payload[0] == REQ_TYPE_GET_ACCESS_LIST && sender->isAdmin()) {
-    uint8_t res1 = payload[1];   // reserved for future  (extra query params)
-    uint8_t res2 = payload[2];
-    if (res1 == 0 && res2 == 0) {
-      uint8_t ofs = 4;
-      for (int i = 0; i < acl.getNumClients() && ofs + 7 <= sizeof(reply_data) - 4; i++) {
+    uint8_t flags = payload[1];   // was reserved (zero), now REQ_FLAG_*
+    uint8_t res2 = payload[2];    // reserved for future  (extra query params)
+    if ((flags & ~REQ_FLAG_MULTIPART) == 0 && res2 == 0) {
+      int max_len = (flags & REQ_FLAG_MULTIPART) ? sizeof(reply_data) : MAX_PACKET_PAYLOAD;
+      int ofs = 4;
+      for (int i = 0; i < acl.getNumClients() && ofs + 7 <= max_len - 4; i++) {
         auto c = acl.getClientByIdx(i);
         if (c->permissions == 0) continue;  // skip deleted entries
         memcpy(&reply_data[ofs], c->id.pub_key, 6); ofs += 6;  // just 6-byte pub_key prefix
@@ -274,8 +260,8 @@ int MyMesh::handleRequest(ClientInfo *sender, uint32_t sender_timestamp, uint8_t
     }
   }
   if (payload[0] == REQ_TYPE_GET_NEIGHBOURS) {
-    uint8_t request_version = payload[1];
-    if (request_version == 0) {
+    uint8_t request_version = payload[1];   // v1: same as v0, but requester accepts a multipart response
+    if (request_version == 0 || request_version == 1) {
 
       // reply data offset (after response sender_timestamp/tag)
       int reply_offset = 4;
@@ -296,64 +282,38 @@ int MyMesh::handleRequest(ClientInfo *sender, uint32_t sender_timestamp, uint8_t
         MESH_DEBUG_PRINTLN("REQ_TYPE_GET_NEIGHBOURS invalid pubkey_prefix_length=%d clamping to %d", pubkey_prefix_length, PUB_KEY_SIZE);
       }
 
-      // create copy of neighbours list, skipping empty entries so we can sort it separately from main list
       int16_t neighbours_count = 0;
 #if MAX_NEIGHBOURS
-      NeighbourInfo* sorted_neighbours[MAX_NEIGHBOURS];
-      for (int i = 0; i < MAX_NEIGHBOURS; i++) {
-        auto neighbour = &neighbours[i];
-        if (neighbour->heard_timestamp > 0) {
-          sorted_neighbours[neighbours_count] = neighbour;
-          neighbours_count++;
-        }
-      }
-
-      // sort neighbours based on order
-      if (order_by == 0) {
-        // sort by newest to oldest
-        MESH_DEBUG_PRINTLN("REQ_TYPE_GET_NEIGHBOURS sorting newest to oldest");
-        std::sort(sorted_neighbours, sorted_neighbours + neighbours_count, [](const NeighbourInfo* a, const NeighbourInfo* b) {
-          return a->heard_timestamp > b->heard_timestamp; // desc
-        });
-      } else if (order_by == 1) {
-        // sort by oldest to newest
-        MESH_DEBUG_PRINTLN("REQ_TYPE_GET_NEIGHBOURS sorting oldest to newest");
-        std::sort(sorted_neighbours, sorted_neighbours + neighbours_count, [](const NeighbourInfo* a, const NeighbourInfo* b) {
-          return a->heard_timestamp < b->heard_timestamp; // asc
-        });
-      } else if (order_by == 2) {
-        // sort by strongest to weakest
-        MESH_DEBUG_PRINTLN("REQ_TYPE_GET_NEIGHBOURS sorting strongest to weakest");
-        std::sort(sorted_neighbours, sorted_neighbours + neighbours_count, [](const NeighbourInfo* a, const NeighbourInfo* b) {
-          return a->snr > b->snr; // desc
-        });
-      } else if (order_by == 3) {
-        // sort by weakest to strongest
-        MESH_DEBUG_PRINTLN("REQ_TYPE_GET_NEIGHBOURS sorting weakest to strongest");
-        std::sort(sorted_neighbours, sorted_neighbours + neighbours_count, [](const NeighbourInfo* a, const NeighbourInfo* b) {
-          return a->snr < b->snr; // asc
-        });
-      }
+      // table is kept in order, so just fetch the page wanted, a few at a time
+      neighbours_count = neighbours.getCount();
+      const NeighbourInfo* page[8];
+      int page_count = 0;
 #endif
 
       // build results buffer
       int results_count = 0;
       int results_offset = 0;
-      uint8_t results_buffer[130];
+      uint8_t results_buffer[sizeof(reply_data) - 8];
+      int results_max = request_version == 1 ? sizeof(results_buffer) : 130;
       for(int index = 0; index < count && index + offset < neighbours_count; index++){
         
         // stop if we can't fit another entry in results
         int entry_size = pubkey_prefix_length + 4 + 1;
-        if(results_offset + entry_size > sizeof(results_buffer)){
+        if(results_offset + entry_size > results_max){
           MESH_DEBUG_PRINTLN("REQ_TYPE_GET_NEIGHBOURS no more entries can fit in results buffer");
           break;
         }
 
 #if MAX_NEIGHBOURS
         // add next neighbour to results
-        auto neighbour = sorted_neighbours[index + offset];
+        int i = index % (sizeof(page) / sizeof(page[0]));
+        if (i == 0) {
+          page_count = neighbours.getOrdered(order_by, offset + index, page, sizeof(page) / sizeof(page[0]));
+        }
+        if (i >= page_count) break;   // unknown order_by
+        auto neighbour = page[i];
         uint32_t heard_seconds_ago = getRTCClock()->getCurrentTime() - neighbour->heard_timestamp;
-        memcpy(&results_buffer[results_offset], neighbour->id.pub_key, pubkey_prefix_length); results_offset += pubkey_prefix_length;
+        memcpy(&results_buffer[results_offset], neighbour->pub_key, pubkey_prefix_length); results_offset += pubkey_prefix_length;
         memcpy(&results_buffer[results_offset], &heard_seconds_ago, 4); results_offset += 4;
         memcpy(&results_buffer[results_offset], &neighbour->snr, 1); results_offset += 1;
         results_count++;
@@ -383,16 +343,6 @@ mesh::Packet *MyMesh::createSelfAdvert() {
   return createAdvert(self_id, app_data, app_data_len);
 }
 
-File MyMesh::openAppend(const char *fname) {
-#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
-  return _fs->open(fname, FILE_O_WRITE);
-#elif defined(RP2040_PLATFORM)
-  return _fs->open(fname, "a");
-#else
-  return _fs->open(fname, "a", true);
-#endif
-}
-
 static uint8_t max_loop_minimal[] =  { 0, /* 1-byte */  4, /* 2-byte */  2, /* 3-byte */  1 };
 static uint8_t max_loop_moderate[] = { 0, /* 1-byte */  2, /* 2-byte */  1, /* 3-byte */  1 };
 static uint8_t max_loop_strict[] =   { 0, /* 1-byte */  1, /* 2-byte */  1, /* 3-byte */  1 };
@@ -458,15 +408,18 @@ bool MyMesh::allowPacketForward(const mesh::Packet *packet) {
   return true;
 }
 
-const char *MyMesh::getLogDateTime() {
+static const char *formatLogTime(uint32_t timestamp) {
   static char tmp[32];
-  uint32_t now = getRTCClock()->getCurrentTime();
-  DateTime dt = DateTime(now);
+  DateTime dt = DateTime(timestamp);
   sprintf(tmp, "%02d:%02d:%02d - %d/%d/%d U", dt.hour(), dt.minute(), dt.second(), dt.day(), dt.month(),
           dt.year());
   return tmp;
 }
 
+const char *MyMesh::getLogDateTime() {
+  return formatLogTime(getRTCClock()->getCurrentTime());
+}
+
 void MyMesh::logRxRaw(float snr, float rssi, const uint8_t raw[], int len) {
 #if MESH_PACKET_LOGGING
   Serial.print(getLogDateTime());
@@ -484,21 +437,8 @@ void MyMesh::logRx(mesh::Packet *pkt, int len, float score) {
 #endif
 
   if (_logging) {
-    File f = openAppend(PACKET_LOG_FILE);
-    if (f) {
-      f.print(getLogDateTime());
-      f.printf(": RX, len=%d (type=%d, route=%s, payload_len=%d) SNR=%d RSSI=%d score=%d", len,
-               pkt->getPayloadType(), pkt->isRouteDirect() ? "D" : "F", pkt->payload_len,
-               (int)_radio->getLastSNR(), (int)_radio->getLastRSSI(), (int)(score * 1000));
-
-      if (pkt->getPayloadType() == PAYLOAD_TYPE_PATH || pkt->getPayloadType() == PAYLOAD_TYPE_REQ ||
-          pkt->getPayloadType() == PAYLOAD_TYPE_RESPONSE || pkt->getPayloadType() == PAYLOAD_TYPE_TXT_MSG) {
-        f.printf(" [%02X -> %02X]\n", (uint32_t)pkt->payload[1], (uint32_t)pkt->payload[0]);
-      } else {
-        f.printf("\n");
-      }
-      f.close();
-    }
+    packet_log.append(PacketLogRecord::fromPacket(getRTCClock()->getCurrentTime(), PACKET_LOG_RX, pkt, len,
+                                                  _radio->getLastSNR(), _radio->getLastRSSI(), score));
   }
 }
 
@@ -510,32 +450,13 @@ void MyMesh::logTx(mesh::Packet *pkt, int len) {
 #endif
 
   if (_logging) {
-    File f = openAppend(PACKET_LOG_FILE);
-    if (f) {
-      f.print(getLogDateTime());
-      f.printf(": TX, len=%d (type=%d, route=%s, payload_len=%d)", len, pkt->getPayloadType(),
-               pkt->isRouteDirect() ? "D" : "F", pkt->payload_len);
-
-      if (pkt->getPayloadType() == PAYLOAD_TYPE_PATH || pkt->getPayloadType() == PAYLOAD_TYPE_REQ ||
-          pkt->getPayloadType() == PAYLOAD_TYPE_RESPONSE || pkt->getPayloadType() == PAYLOAD_TYPE_TXT_MSG) {
-        f.printf(" [%02X -> %02X]\n", (uint32_t)pkt->payload[1], (uint32_t)pkt->payload[0]);
-      } else {
-        f.printf("\n");
-      }
-      f.close();
-    }
+    packet_log.append(PacketLogRecord::fromPacket(getRTCClock()->getCurrentTime(), PACKET_LOG_TX, pkt, len));
   }
 }
 
 void MyMesh::logTxFail(mesh::Packet *pkt, int len) {
   if (_logging) {
-    File f = openAppend(PACKET_LOG_FILE);
-    if (f) {
-      f.print(getLogDateTime());
-      f.printf(": TX FAIL!, len=%d (type=%d, route=%s, payload_len=%d)\n", len, pkt->getPayloadType(),
-               pkt->isRouteDirect() ? "D" : "F", pkt->payload_len);
-      f.close();
-    }
+    packet_log.append(PacketLogRecord::fromPacket(getRTCClock()->getCurrentTime(), PACKET_LOG_TX_FAIL, pkt, len));
   }
 }
 
@@ -544,10 +465,48 @@ int MyMesh::calcRxDelay(float score, uint32_t air_time) const {
   return (int)((pow(_prefs.rx_delay_base, 0.85f - score) - 1.0) * air_time);
 }
 
+int MyMesh::countActiveNeighbours() {
+  int n = 0;
+#if MAX_NEIGHBOURS
+  uint32_t now = getRTCClock()->getCurrentTime();
+  n = neighbours.countHeardSince(now > ACTIVE_NEIGHBOUR_SECS ? now - ACTIVE_NEIGHBOUR_SECS + 1 : 1);
+#endif
+  return n;
+}
+
 uint32_t MyMesh::getRetransmitDelay(const mesh::Packet *packet) {
   uint32_t t = (_radio->getEstAirtimeFor(packet->getPathByteLen() + packet->payload_len + 2) * _prefs.tx_delay_factor);
+  if (_prefs.flood_adaptive && packet->isRouteFlood()) {
+    flood_contention.setNeighbourCount(countActiveNeighbours());
+    flood_contention.updateDupRate(getNumRecvFlood(), ((SimpleMeshTables *)getTables())->getNumFloodDups());
+    flood_contention.setSuppressThreshold(_prefs.flood_suppress);
+    flood_contention.onQueued(packet);
+    return flood_contention.calcDelay(t, packet->getSNR(), getRNG()->nextInt(0, 0x7FFFFFFF));
+  }
   return getRNG()->nextInt(0, 5*t + 1);
 }
+
+void MyMesh::checkFloodSuppress(const mesh::Packet* pkt) {
+  const mesh::Packet* queued = flood_contention.onHeard(pkt);
+  if (queued == NULL) return;
+
+  // enough neighbours have already rebroadcast this, so drop our own retransmit (if not sent yet)
+  uint8_t hash[MAX_HASH_SIZE], q_hash[MAX_HASH_SIZE];
+  pkt->calculatePacketHash(hash);
+  int total = _mgr->getOutboundTotal();
+  for (int i = 0; i < total; i++) {
+    mesh::Packet* q = _mgr->getOutboundByIdx(i);
+    if (q != queued) continue;
+
+    // NOTE: 'queued' may have been sent, and recycled for some other packet, so check contents too
+    q->calculatePacketHash(q_hash);
+    if (memcmp(hash, q_hash, MAX_HASH_SIZE) == 0) {
+      _mgr->free(_mgr->removeOutboundByIdx(i));
+      n_flood_suppressed++;
+    }
+    break;
+  }
+}
 uint32_t MyMesh::getDirectRetransmitDelay(const mesh::Packet *packet) {
   uint32_t t = (_radio->getEstAirtimeFor(packet->getPathByteLen() + packet->payload_len + 2) * _prefs.direct_tx_delay_factor);
   return getRNG()->nextInt(0, 5*t + 1);
@@ -565,6 +524,9 @@ mesh::DispatcherAction MyMesh::onRecvPacket(mesh::Packet* pkt) {
   } else {
     recv_pkt_region = NULL;
   }
+  if (_prefs.flood_adaptive && pkt->isRouteFlood()) {
+    checkFloodSuppress(pkt);
+  }
   return Mesh::onRecvPacket(pkt);
 }
 
@@ -680,7 +642,18 @@ void MyMesh::onPeerDataRecv(mesh::Packet *packet, uint8_t type, int sender_idx,
       client->last_timestamp = timestamp;
       client->last_activity = getRTCClock()->getCurrentTime();
 
-      if (packet->isRouteFlood()) {
+      if (reply_len > MULTIPART_SINGLE_MAX_DATA) {   // too long for one packet (requester said it can take multipart)
+        if (packet->isRouteFlood()) {
+          // let this sender know path TO here, so fragment ACKs can be sent Direct (NOTE: response is in the fragments)
+          mesh::Packet *path = createPathReturn(client->id, secret, packet->path, packet->path_len, 0, NULL, 0);
+          if (path) sendFloodReply(path, SERVER_RESPONSE_DELAY, packet->getPathHashSize());
+        }
+        if (client->out_path_len != OUT_PATH_UNKNOWN) {
+          sendMultipart(PAYLOAD_TYPE_RESPONSE, client->id, secret, reply_data, reply_len, client->out_path, client->out_path_len, SERVER_RESPONSE_DELAY);
+        } else {
+          sendMultipart(PAYLOAD_TYPE_RESPONSE, client->id, secret, reply_data, reply_len, NULL, 0, SERVER_RESPONSE_DELAY, packet->getPathHashSize());
+        }
+      } else if (packet->isRouteFlood()) {
         // let this sender know path TO here, so they can use sendDirect(), and ALSO encode the response
         mesh::Packet *path = createPathReturn(client->id, secret, packet->path, packet->path_len,
                                               PAYLOAD_TYPE_RESPONSE, reply_data, reply_len);
@@ -860,14 +833,17 @@ void MyMesh::sendNodeDiscoverReq() {
 
 MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondClock &ms, mesh::RNG &rng,
                mesh::RTCClock &rtc, mesh::MeshTables &tables)
-    : mesh::Mesh(radio, ms, rng, rtc, *new StaticPoolPacketManager(32), tables),
+    : mesh::Mesh(radio, ms, rng, rtc, *new StaticPoolPacketManager(32), tables), packet_log(PACKET_LOG_FILE),
       region_map(key_store), temp_map(key_store),
       _cli(board, rtc, sensors, region_map, acl, &_prefs, this),
       telemetry(MAX_PACKET_PAYLOAD - 4),
       discover_limiter(4, 120),  // max 4 every 2 minutes
       anon_limiter(4, 180)   // max 4 every 3 minutes
+#if MAX_NEIGHBOURS
+      , neighbours(MAX_NEIGHBOURS)
+#endif
 #if defined(WITH_RS232_BRIDGE)
-      , bridge(&_prefs, WITH_RS232_BRIDGE, _mgr, &rtc)
+      , bridge(&_prefs, WITH_RS232_BRIDGE, _mgr, &rtc, &rng)
 #endif
 #if defined(WITH_ESPNOW_BRIDGE)
       , bridge(&_prefs, _mgr, &rtc)
@@ -881,10 +857,7 @@ MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondCloc
   _logging = false;
   region_load_active = false;
   recv_pkt_region = NULL;
-
-#if MAX_NEIGHBOURS
-  memset(neighbours, 0, sizeof(neighbours));
-#endif
+  setMultipartBuffers(NULL, &mp_send);
 
   // defaults
   _prefs.airtime_factor = 1.0;
@@ -905,6 +878,7 @@ MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondCloc
   _prefs.flood_max = 64;
   _prefs.flood_max_unscoped = 64;
   _prefs.flood_max_advert = 8;
+  _prefs.flood_suppress = 3;
   _prefs.interference_threshold = 0; // disabled
   _prefs.cad_enabled = 0;            // hardware CAD before TX (off by default; 'set cad on')
 
@@ -935,6 +909,7 @@ MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondCloc
   _prefs.radio_fem_txgain = 0;
 
   pending_discover_tag = 0;
+  n_flood_suppressed = 0;
   pending_discover_until = 0;
 
   memset(default_scope.key, 0, sizeof(default_scope.key));
@@ -942,7 +917,10 @@ MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondCloc
 
 void MyMesh::begin(FILESYSTEM *fs) {
   mesh::Mesh::begin();
+  getMetrics().addGauge(METRIC_ID_BATT_MV, "batt_mv", [](const void*) -> int32_t { return board.getBattMilliVolts(); }, NULL);
+  getMetrics().addCounter(METRIC_ID_FLOOD_SUPPRESSED, "fwd_sup", &n_flood_suppressed);
   _fs = fs;
+  packet_log.begin(_fs);
   // load persisted prefs
   _cli.loadPrefs(_fs);
   acl.load(_fs, self_id);
@@ -1058,19 +1036,7 @@ void MyMesh::updateFloodAdvertTimer() {
 }
 
 void MyMesh::dumpLogFile() {
-#if defined(RP2040_PLATFORM)
-  File f = _fs->open(PACKET_LOG_FILE, "r");
-#else
-  File f = _fs->open(PACKET_LOG_FILE);
-#endif
-  if (f) {
-    while (f.available()) {
-      int c = f.read();
-      if (c < 0) break;
-      Serial.print((char)c);
-    }
-    f.close();
-  }
+  packet_log.dump(Serial, formatLogTime);
 }
 
 void MyMesh::setTxPower(int8_t power_dbm) {
@@ -1091,31 +1057,18 @@ void MyMesh::formatNeighborsReply(char *reply) {
   char *dp = reply;
 
 #if MAX_NEIGHBOURS
-  // create copy of neighbours list, skipping empty entries so we can sort it separately from main list
-  int16_t neighbours_count = 0;
-  NeighbourInfo* sorted_neighbours[MAX_NEIGHBOURS];
-  for (int i = 0; i < MAX_NEIGHBOURS; i++) {
-    auto neighbour = &neighbours[i];
-    if (neighbour->heard_timestamp > 0) {
-      sorted_neighbours[neighbours_count] = neighbour;
-      neighbours_count++;
-    }
-  }
-
-  // sort neighbours newest to oldest
-  std::sort(sorted_neighbours, sorted_neighbours + neighbours_count, [](const NeighbourInfo* a, const NeighbourInfo* b) {
-    return a->heard_timestamp > b->heard_timestamp; // desc
-  });
+  const NeighbourInfo* sorted_neighbours[16];   // more than can fit in reply
+  int neighbours_count = neighbours.getOrdered(NEIGHBOUR_ORDER_NEWEST, 0, sorted_neighbours, 16);
 
   for (int i = 0; i < neighbours_count && dp - reply < 134; i++) {
-    NeighbourInfo *neighbour = sorted_neighbours[i];
+    const NeighbourInfo *neighbour = sorted_neighbours[i];
 
     // add new line if not first item
     if (i > 0) *dp++ = '\n';
 
     char hex[10];
     // get 4 bytes of neighbour id as hex
-    mesh::Utils::toHex(hex, neighbour->id.pub_key, 4);
+    mesh::Utils::toHex(hex, neighbour->pub_key, 4);
 
     // add next neighbour
     uint32_t secs_ago = getRTCClock()->getCurrentTime() - neighbour->heard_timestamp;
@@ -1133,12 +1086,7 @@ void MyMesh::formatNeighborsReply(char *reply) {
 
 void MyMesh::removeNeighbor(const uint8_t *pubkey, int key_len) {
 #if MAX_NEIGHBOURS
-  for (int i = 0; i < MAX_NEIGHBOURS; i++) {
-    NeighbourInfo *neighbour = &neighbours[i];
-    if (memcmp(neighbour->id.pub_key, pubkey, key_len) == 0) {
-      neighbours[i] = NeighbourInfo(); // clear neighbour entry
-    }
-  }
+  neighbours.remove(pubkey, key_len);
 #endif
 }
 
@@ -1169,6 +1117,18 @@ void MyMesh::formatRadioStatsReply(char *reply) {
   StatsFormatHelper::formatRadioStats(reply, _radio, radio_driver, getTotalAirTime(), getReceiveAirTime());
 }
 
+void MyMesh::formatChannelStatsReply(char *reply) {
+  StatsFormatHelper::formatChannelStats(reply, radio_driver);
+}
+
+void MyMesh::formatDutyCycleStatsReply(char *reply) {
+  StatsFormatHelper::formatDutyCycleStats(reply, *this);
+}
+
+void MyMesh::formatMetricsReply(char *reply, int start) {
+  StatsFormatHelper::formatMetrics(reply, getMetrics(), start);
+}
+
 void MyMesh::formatPacketStatsReply(char *reply) {
   StatsFormatHelper::formatPacketStats(reply, radio_driver, getNumSentFlood(), getNumSentDirect(), 
                                        getNumRecvFlood(), getNumRecvDirect());
@@ -1191,6 +1151,7 @@ void MyMesh::clearStats() {
   radio_driver.resetStats();
   resetStats();
   ((SimpleMeshTables *)getTables())->resetStats();
+  n_flood_suppressed = 0;
 }
 
 void MyMesh::handleCommand(uint32_t sender_timestamp, char *command, char *reply) {
@@ -1285,6 +1246,8 @@ void MyMesh::handleCommand(uint32_t sender_timestamp, char *command, char *reply
 }
 
 void MyMesh::loop() {
+  packet_log.loop();
+
 #ifdef WITH_BRIDGE
   bridge.loop();
 #endif
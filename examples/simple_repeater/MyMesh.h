@@ -28,7 +28,10 @@
 #include <helpers/ArduinoHelpers.h>
 #include <helpers/ClientACL.h>
 #include <helpers/CommonCLI.h>
+#include <helpers/FloodContention.h>
 #include <helpers/IdentityStore.h>
+#include <helpers/NeighbourTable.h>
+#include <helpers/PacketLog.h>
 #include <helpers/SimpleMeshTables.h>
 #include <helpers/StaticPoolPacketManager.h>
 #include <helpers/StatsFormatHelper.h>
@@ -63,12 +66,9 @@ struct RepeaterStats {
   #define MAX_CLIENTS           32
 #endif
 
-struct NeighbourInfo {
-  mesh::Identity id;
-  uint32_t advert_timestamp;
-  uint32_t heard_timestamp;
-  int8_t snr; // multiplied by 4, user should divide to get float value
-};
+#ifndef ACTIVE_NEIGHBOUR_SECS
+  #define ACTIVE_NEIGHBOUR_SECS   (6*60*60)   // neighbours heard within this long count towards flood.adaptive density
+#endif
 
 #ifndef FIRMWARE_BUILD_DATE
   #define FIRMWARE_BUILD_DATE   "14 Aug 2026"
@@ -80,7 +80,8 @@ struct NeighbourInfo {
 
 #define FIRMWARE_ROLE "repeater"
 
-#define PACKET_LOG_FILE  "/packet_log"
+#define PACKET_LOG_FILE         "/packet_log.bin"
+#define LEGACY_PACKET_LOG_FILE  "/packet_log"   // old text format
 
 class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   FILESYSTEM* _fs;
@@ -88,10 +89,12 @@ class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   uint64_t uptime_millis;
   unsigned long next_local_advert, next_flood_advert;
   bool _logging;
+  PacketLog packet_log;
   NodePrefs _prefs;
   ClientACL  acl;
   CommonCLI _cli;
-  uint8_t reply_data[MAX_PACKET_PAYLOAD];
+  uint8_t reply_data[MULTIPART_MAX_DATA];   // longer than MAX_PACKET_PAYLOAD, for multipart responses
+  mesh::MultipartSendBuffer mp_send;   // only sends multipart, never receives
   uint8_t reply_path[MAX_PATH_SIZE];
   uint8_t reply_path_len;
   TransportKeyStore key_store;
@@ -105,8 +108,10 @@ class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   bool region_load_active;
   unsigned long dirty_contacts_expiry;
 #if MAX_NEIGHBOURS
-  NeighbourInfo neighbours[MAX_NEIGHBOURS];
+  NeighbourTable neighbours;
 #endif
+  FloodContention flood_contention;
+  uint32_t n_flood_suppressed;
   CayenneLPP telemetry;
   unsigned long set_radio_at, revert_radio_at;
   float pending_freq;
@@ -128,13 +133,19 @@ class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   int handleRequest(ClientInfo* sender, uint32_t sender_timestamp, uint8_t* payload, size_t payload_len);
   mesh::Packet* createSelfAdvert();
 
-  File openAppend(const char* fname);
   bool isLooped(const mesh::Packet* packet, const uint8_t max_counters[]);
+  int countActiveNeighbours();
+  void checkFloodSuppress(const mesh::Packet* pkt);
 
 protected:
   float getAirtimeBudgetFactor() const override {
     return _prefs.airtime_factor;
   }
+#ifdef DUTY_CYCLE_EU868
+  uint8_t getDutyCycleBand() const override {
+    return mesh::DutyCycleTracker::findEU868Band(_prefs.freq);
+  }
+#endif
 
   bool allowPacketForward(const mesh::Packet* packet) override;
   const char* getLogDateTime() override;
@@ -151,6 +162,9 @@ protected:
   int getInterferenceThreshold() const override {
     return _prefs.interference_threshold;
   }
+  bool isAdvertVerifyAfterForward() const override {
+    return _prefs.advert_fwd_first;
+  }
   bool getCADEnabled() const override {
     return _prefs.cad_enabled;
   }
@@ -205,10 +219,14 @@ public:
   void updateAdvertTimer() override;
   void updateFloodAdvertTimer() override;
 
-  void setLoggingOn(bool enable) override { _logging = enable; }
+  void setLoggingOn(bool enable) override {
+    _logging = enable;
+    if (!enable) packet_log.flush();
+  }
 
   void eraseLogFile() override {
-    _fs->remove(PACKET_LOG_FILE);
+    packet_log.erase();
+    _fs->remove(LEGACY_PACKET_LOG_FILE);
   }
 
   void dumpLogFile() override;
@@ -217,7 +235,13 @@ public:
   void removeNeighbor(const uint8_t* pubkey, int key_len) override;
   void formatStatsReply(char *reply) override;
   void formatRadioStatsReply(char *reply) override;
+  void formatChannelStatsReply(char *reply) override;
+  void formatDutyCycleStatsReply(char *reply) override;
+  void formatMetricsReply(char *reply, int start) override;
   void formatPacketStatsReply(char *reply) override;
+#if defined(WITH_RS232_BRIDGE)
+  void formatBridgeStatsReply(char *reply) override { bridge.formatStats(reply); }
+#endif
   void startRegionsLoad() override;
   bool saveRegions() override;
   void onDefaultRegionChanged(const RegionEntry* r) override;
@@ -17,6 +17,8 @@
 #define REQ_TYPE_GET_TELEMETRY_DATA 0x03
 #define REQ_TYPE_GET_ACCESS_LIST    0x05
 
+#define STATUS_FORMAT_METRICS       1        // GET_STATUS payload[1], payload[2] is start index
+
 #define RESP_SERVER_LOGIN_OK        0 // response to ANON_REQ
 
 #define LAZY_CONTACTS_WRITE_DELAY    5000
@@ -138,16 +140,6 @@ mesh::Packet *MyMesh::createSelfAdvert() {
   return createAdvert(self_id, app_data, app_data_len);
 }
 
-File MyMesh::openAppend(const char *fname) {
-#if defined(NRF52_PLATFORM)
-  return _fs->open(fname, FILE_O_WRITE);
-#elif defined(RP2040_PLATFORM)
-  return _fs->open(fname, "a");
-#else
-  return _fs->open(fname, "a", true);
-#endif
-}
-
 int MyMesh::handleRequest(ClientInfo *sender, uint32_t sender_timestamp, uint8_t *payload,
                           size_t payload_len) {
   // uint32_t now = getRTCClock()->getCurrentTimeUnique();
@@ -155,6 +147,9 @@ int MyMesh::handleRequest(ClientInfo *sender, uint32_t sender_timestamp, uint8_t
   memcpy(reply_data, &sender_timestamp, 4); // reflect sender_timestamp back in response packet (kind of like a 'tag')
 
   if (payload[0] == REQ_TYPE_GET_STATUS) {
+    if (payload[1] == STATUS_FORMAT_METRICS) {   // reserved byte was zero, for older clients
+      return 4 + getMetrics().exportBinary(&reply_data[4], 128, payload[2]);   // small enough to also fit in a path return
+    }
     ServerStats stats;
     stats.batt_milli_volts = board.getBattMilliVolts();
     stats.curr_tx_queue_len = _mgr->getOutboundTotal();
@@ -227,50 +222,18 @@ void MyMesh::logRxRaw(float snr, float rssi, const uint8_t raw[], int len) {
 
 void MyMesh::logRx(mesh::Packet *pkt, int len, float score) {
   if (_logging) {
-    File f = openAppend(PACKET_LOG_FILE);
-    if (f) {
-      f.print(getLogDateTime());
-      f.printf(": RX, len=%d (type=%d, route=%s, payload_len=%d) SNR=%d RSSI=%d score=%d", len,
-               pkt->getPayloadType(), pkt->isRouteDirect() ? "D" : "F", pkt->payload_len,
-               (int)_radio->getLastSNR(), (int)_radio->getLastRSSI(), (int)(score * 1000));
-
-      if (pkt->getPayloadType() == PAYLOAD_TYPE_PATH || pkt->getPayloadType() == PAYLOAD_TYPE_REQ ||
-          pkt->getPayloadType() == PAYLOAD_TYPE_RESPONSE || pkt->getPayloadType() == PAYLOAD_TYPE_TXT_MSG) {
-        f.printf(" [%02X -> %02X]\n", (uint32_t)pkt->payload[1], (uint32_t)pkt->payload[0]);
-      } else {
-        f.printf("\n");
-      }
-      f.close();
-    }
+    packet_log.append(PacketLogRecord::fromPacket(getRTCClock()->getCurrentTime(), PACKET_LOG_RX, pkt, len,
+                                                  _radio->getLastSNR(), _radio->getLastRSSI(), score));
   }
 }
 void MyMesh::logTx(mesh::Packet *pkt, int len) {
   if (_logging) {
-    File f = openAppend(PACKET_LOG_FILE);
-    if (f) {
-      f.print(getLogDateTime());
-      f.printf(": TX, len=%d (type=%d, route=%s, payload_len=%d)", len, pkt->getPayloadType(),
-               pkt->isRouteDirect() ? "D" : "F", pkt->payload_len);
-
-      if (pkt->getPayloadType() == PAYLOAD_TYPE_PATH || pkt->getPayloadType() == PAYLOAD_TYPE_REQ ||
-          pkt->getPayloadType() == PAYLOAD_TYPE_RESPONSE || pkt->getPayloadType() == PAYLOAD_TYPE_TXT_MSG) {
-        f.printf(" [%02X -> %02X]\n", (uint32_t)pkt->payload[1], (uint32_t)pkt->payload[0]);
-      } else {
-        f.printf("\n");
-      }
-      f.close();
-    }
+    packet_log.append(PacketLogRecord::fromPacket(getRTCClock()->getCurrentTime(), PACKET_LOG_TX, pkt, len));
   }
 }
 void MyMesh::logTxFail(mesh::Packet *pkt, int len) {
   if (_logging) {
-    File f = openAppend(PACKET_LOG_FILE);
-    if (f) {
-      f.print(getLogDateTime());
-      f.printf(": TX FAIL!, len=%d (type=%d, route=%s, payload_len=%d)\n", len, pkt->getPayloadType(),
-               pkt->isRouteDirect() ? "D" : "F", pkt->payload_len);
-      f.close();
-    }
+    packet_log.append(PacketLogRecord::fromPacket(getRTCClock()->getCurrentTime(), PACKET_LOG_TX_FAIL, pkt, len));
   }
 }
 
@@ -279,15 +242,18 @@ int MyMesh::calcRxDelay(float score, uint32_t air_time) const {
   return (int)((pow(_prefs.rx_delay_base, 0.85f - score) - 1.0) * air_time);
 }
 
-const char *MyMesh::getLogDateTime() {
+static const char *formatLogTime(uint32_t timestamp) {
   static char tmp[32];
-  uint32_t now = getRTCClock()->getCurrentTime();
-  DateTime dt = DateTime(now);
+  DateTime dt = DateTime(timestamp);
   sprintf(tmp, "%02d:%02d:%02d - %d/%d/%d U", dt.hour(), dt.minute(), dt.second(), dt.day(), dt.month(),
           dt.year());
   return tmp;
 }
 
+const char *MyMesh::getLogDateTime() {
+  return formatLogTime(getRTCClock()->getCurrentTime());
+}
+
 uint32_t MyMesh::getRetransmitDelay(const mesh::Packet *packet) {
   uint32_t t = (_radio->getEstAirtimeFor(packet->getPathByteLen() + packet->payload_len + 2) * _prefs.tx_delay_factor);
   return getRNG()->nextInt(0, 5*t + 1);
@@ -629,7 +595,7 @@ void MyMesh::onAckRecv(mesh::Packet *packet, uint32_t ack_crc) {
 
 MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondClock &ms, mesh::RNG &rng,
                mesh::RTCClock &rtc, mesh::MeshTables &tables)
-    : mesh::Mesh(radio, ms, rng, rtc, *new StaticPoolPacketManager(32), tables),
+    : mesh::Mesh(radio, ms, rng, rtc, *new StaticPoolPacketManager(32), tables), packet_log(PACKET_LOG_FILE),
       region_map(key_store), temp_map(key_store),
       _cli(board, rtc, sensors, region_map, acl, &_prefs, this),
       telemetry(MAX_PACKET_PAYLOAD - 4)
@@ -695,7 +661,9 @@ MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondCloc
 
 void MyMesh::begin(FILESYSTEM *fs) {
   mesh::Mesh::begin();
+  getMetrics().addGauge(METRIC_ID_BATT_MV, "batt_mv", [](const void*) -> int32_t { return board.getBattMilliVolts(); }, NULL);
   _fs = fs;
+  packet_log.begin(_fs);
   // load persisted prefs
   _cli.loadPrefs(_fs);
 
@@ -822,19 +790,7 @@ void MyMesh::updateFloodAdvertTimer() {
 }
 
 void MyMesh::dumpLogFile() {
-#if defined(RP2040_PLATFORM)
-  File f = _fs->open(PACKET_LOG_FILE, "r");
-#else
-  File f = _fs->open(PACKET_LOG_FILE);
-#endif
-  if (f) {
-    while (f.available()) {
-      int c = f.read();
-      if (c < 0) break;
-      Serial.print((char)c);
-    }
-    f.close();
-  }
+  packet_log.dump(Serial, formatLogTime);
 }
 
 void MyMesh::setTxPower(int8_t power_dbm) {
@@ -891,6 +847,18 @@ void MyMesh::formatRadioStatsReply(char *reply) {
   StatsFormatHelper::formatRadioStats(reply, _radio, radio_driver, getTotalAirTime(), getReceiveAirTime());
 }
 
+void MyMesh::formatChannelStatsReply(char *reply) {
+  StatsFormatHelper::formatChannelStats(reply, radio_driver);
+}
+
+void MyMesh::formatDutyCycleStatsReply(char *reply) {
+  StatsFormatHelper::formatDutyCycleStats(reply, *this);
+}
+
+void MyMesh::formatMetricsReply(char *reply, int start) {
+  StatsFormatHelper::formatMetrics(reply, getMetrics(), start);
+}
+
 void MyMesh::formatPacketStatsReply(char *reply) {
   StatsFormatHelper::formatPacketStats(reply, radio_driver, getNumSentFlood(), getNumSentDirect(), 
                                        getNumRecvFlood(), getNumRecvDirect());
@@ -993,6 +961,8 @@ bool MyMesh::saveFilter(ClientInfo* client) {
 }
 
 void MyMesh::loop() {
+  packet_log.loop();
+
   mesh::Mesh::loop();
 
   if (millisHasNowPassed(next_push) && acl.getNumClients() > 0) {
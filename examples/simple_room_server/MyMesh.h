@@ -15,6 +15,7 @@
 #include <helpers/StaticPoolPacketManager.h>
 #include <helpers/SimpleMeshTables.h>
 #include <helpers/IdentityStore.h>
+#include <helpers/PacketLog.h>
 #include <helpers/AdvertDataHelpers.h>
 #include <helpers/TxtDataHelpers.h>
 #include <helpers/CommonCLI.h>
@@ -79,7 +80,8 @@
 
 #define FIRMWARE_ROLE "room_server"
 
-#define PACKET_LOG_FILE  "/packet_log"
+#define PACKET_LOG_FILE         "/packet_log.bin"
+#define LEGACY_PACKET_LOG_FILE  "/packet_log"   // old text format
 
 #define MAX_POST_TEXT_LEN    (160-9)
 
@@ -95,6 +97,7 @@ class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   uint64_t uptime_millis;
   unsigned long next_local_advert, next_flood_advert;
   bool _logging;
+  PacketLog packet_log;
   bool region_load_active;
   NodePrefs _prefs;
   TransportKeyStore key_store;
@@ -125,13 +128,17 @@ class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   uint8_t getUnsyncedCount(ClientInfo* client);
   bool processAck(const uint8_t *data);
   mesh::Packet* createSelfAdvert();
-  File openAppend(const char* fname);
   int handleRequest(ClientInfo* sender, uint32_t sender_timestamp, uint8_t* payload, size_t payload_len);
 
 protected:
   float getAirtimeBudgetFactor() const override {
     return _prefs.airtime_factor;
   }
+#ifdef DUTY_CYCLE_EU868
+  uint8_t getDutyCycleBand() const override {
+    return mesh::DutyCycleTracker::findEU868Band(_prefs.freq);
+  }
+#endif
 
   void logRxRaw(float snr, float rssi, const uint8_t raw[], int len) override;
   void logRx(mesh::Packet* pkt, int len, float score) override;
@@ -201,10 +208,14 @@ public:
   void updateAdvertTimer() override;
   void updateFloodAdvertTimer() override;
 
-  void setLoggingOn(bool enable) override { _logging = enable; }
+  void setLoggingOn(bool enable) override {
+    _logging = enable;
+    if (!enable) packet_log.flush();
+  }
 
   void eraseLogFile() override {
-    _fs->remove(PACKET_LOG_FILE);
+    packet_log.erase();
+    _fs->remove(LEGACY_PACKET_LOG_FILE);
   }
 
   void dumpLogFile() override;
@@ -216,6 +227,9 @@ public:
   }
   void formatStatsReply(char *reply) override;
   void formatRadioStatsReply(char *reply) override;
+  void formatChannelStatsReply(char *reply) override;
+  void formatDutyCycleStatsReply(char *reply) override;
+  void formatMetricsReply(char *reply, int start) override;
   void formatPacketStatsReply(char *reply) override;
   void startRegionsLoad() override;
   bool saveRegions() override;
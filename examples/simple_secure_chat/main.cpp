@@ -254,11 +254,11 @@ protected:
     Serial.printf("   %s\n", text);
   }
 
-  uint8_t onContactRequest(const ContactInfo& contact, uint32_t sender_timestamp, const uint8_t* data, uint8_t len, uint8_t* reply) override {
+  uint8_t onContactRequest(const ContactInfo& contact, uint32_t sender_timestamp, const uint8_t* data, size_t len, uint8_t* reply) override {
     return 0;  // unknown
   }
 
-  void onContactResponse(const ContactInfo& contact, const uint8_t* data, uint8_t len) override {
+  void onContactResponse(const ContactInfo& contact, const uint8_t* data, size_t len) override {
     // not supported
   }
 
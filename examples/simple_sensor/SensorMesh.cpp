@@ -46,7 +46,7 @@
 
 /* ------------------------------ Code -------------------------------- */
 
-#define FIRMWARE_VER_LEVEL       1
+#define FIRMWARE_VER_LEVEL       3
 
 #define REQ_TYPE_LOGIN               0x00
 #define REQ_TYPE_GET_STATUS          0x01
@@ -54,9 +54,20 @@
 #define REQ_TYPE_GET_TELEMETRY_DATA  0x03
 #define REQ_TYPE_GET_AVG_MIN_MAX     0x04
 #define REQ_TYPE_GET_ACCESS_LIST     0x05
+#define REQ_TYPE_GET_SERIES_HISTORY  0x06     // FIRMWARE_VER_LEVEL >= 2
+#define REQ_TYPE_SUBSCRIBE_TELEMETRY 0x08     // FIRMWARE_VER_LEVEL >= 3  (0x07 is repeater's GET_OWNER_INFO)
+
+#define REQ_FLAG_MULTIPART           0x01     // requester accepts a multipart response
 
 #define RESP_SERVER_LOGIN_OK      0   // response to ANON_REQ
 
+#define TELEM_SUB_OK              0   // response to REQ_TYPE_SUBSCRIBE_TELEMETRY
+#define TELEM_SUB_ENDED           1
+#define TELEM_SUB_FULL            2
+
+#define TELEM_SUB_MIN_PERIOD_SECS  60
+#define TELEM_SUB_FULL_EVERY       12   // periods between full refreshes (also a heartbeat, when nothing changes)
+
 #define CLI_REPLY_DELAY_MILLIS  1000
 
 #define LAZY_CONTACTS_WRITE_DELAY       5000
@@ -170,7 +181,7 @@ static uint8_t putFloat(uint8_t * dest, float value, uint8_t size, uint32_t mult
   return size;
 }
 
-uint8_t SensorMesh::handleRequest(uint8_t perms, uint32_t sender_timestamp, uint8_t req_type, uint8_t* payload, size_t payload_len) {
+int SensorMesh::handleRequest(uint8_t perms, uint32_t sender_timestamp, uint8_t req_type, uint8_t* payload, size_t payload_len) {
   memcpy(reply_data, &sender_timestamp, 4);   // reflect sender_timestamp back in response packet (kind of like a 'tag')
 
   if (req_type == REQ_TYPE_GET_TELEMETRY_DATA) {  // allow all
@@ -220,12 +231,26 @@ uint8_t SensorMesh::handleRequest(uint8_t perms, uint32_t sender_timestamp, uint
     }
     return ofs;
   }
+  if (req_type == REQ_TYPE_GET_SERIES_HISTORY && (perms & PERM_ACL_ROLE_MASK) >= PERM_ACL_READ_ONLY) {
+    uint32_t since;
+    memcpy(&since, &payload[0], 4);
+    uint8_t flags = payload[4];
+    uint8_t res = payload[5];    // reserved for future  (extra query params)
+    if ((flags & ~REQ_FLAG_MULTIPART) == 0 && res == 0) {
+      int max_len = (flags & REQ_FLAG_MULTIPART) ? sizeof(reply_data) : MULTIPART_SINGLE_MAX_DATA;
+      int ofs = 4;
+      uint32_t now = getRTCClock()->getCurrentTime();
+      memcpy(&reply_data[ofs], &now, 4); ofs += 4;
+      ofs += querySeriesHistory(since, &reply_data[ofs], max_len - ofs);
+      return ofs;
+    }
+  }
   if (req_type == REQ_TYPE_GET_ACCESS_LIST && (perms & PERM_ACL_ROLE_MASK) == PERM_ACL_ADMIN) {
     uint8_t res1 = payload[0];   // reserved for future  (extra query params)
     uint8_t res2 = payload[1];
     if (res1 == 0 && res2 == 0) {
       uint8_t ofs = 4;
-      for (int i = 0; i < acl.getNumClients() && ofs + 7 <= sizeof(reply_data) - 4; i++) {
+      for (int i = 0; i < acl.getNumClients() && ofs + 7 <= MAX_PACKET_PAYLOAD - 4; i++) {
         auto c = acl.getClientByIdx(i);
         if (c->permissions == 0) continue;  // skip deleted entries
         memcpy(&reply_data[ofs], c->id.pub_key, 6); ofs += 6;  // just 6-byte pub_key prefix
@@ -237,6 +262,122 @@ uint8_t SensorMesh::handleRequest(uint8_t perms, uint32_t sender_timestamp, uint
   return 0;  // unknown command
 }
 
+int SensorMesh::encodeTelemPush(ClientInfo* client, uint8_t* dest, int max_len, bool full) {
+  auto s = &client->extra.telem;
+
+  telemetry.reset();
+  telemetry.addVoltage(TELEM_CHANNEL_SELF, (float)board.getBattMilliVolts() / 1000.0f);
+  sensors.querySensors(0xFF & s->perm_mask, telemetry);
+
+  dest[0] = s->seq;   // so subscriber can tell if it missed a push
+  int len = telem_deltas[s->slot].encode(telemetry.getBuffer(), telemetry.getSize(), &dest[1], max_len - 1, s->min_delta, full, getDataSize);
+  if (len == 0) return 0;   // nothing has changed
+
+  s->seq++;
+  return 1 + len;
+}
+
+int SensorMesh::handleSubscribe(ClientInfo* client, uint32_t sender_timestamp, const uint8_t* payload, size_t payload_len) {
+  uint8_t perms = client->isAdmin() ? 0xFF : client->permissions;
+  if ((perms & PERM_ACL_ROLE_MASK) < PERM_ACL_READ_ONLY || payload_len < 6) return 0;
+
+  uint16_t period_secs, min_delta;
+  memcpy(&period_secs, &payload[0], 2);
+  memcpy(&min_delta, &payload[2], 2);
+  uint8_t lease_hours = payload[4];
+  uint8_t perm_mask = ~(payload[5]);   // inverse mask, as per REQ_TYPE_GET_TELEMETRY_DATA
+
+  memcpy(reply_data, &sender_timestamp, 4);   // reflect sender_timestamp back in response packet (kind of like a 'tag')
+
+  auto s = &client->extra.telem;
+  if (lease_hours == 0) {   // unsubscribe
+    s->tag = 0;
+    reply_data[4] = TELEM_SUB_ENDED;
+    return 5;
+  }
+  if (s->tag == 0) {   // new subscription, find a free slot
+    uint32_t used = 0;
+    for (int i = 0; i < acl.getNumClients(); i++) {
+      auto c = acl.getClientByIdx(i);
+      if (c != client && c->extra.telem.tag) used |= (1UL << c->extra.telem.slot);
+    }
+    int slot = 0;
+    while (slot < MAX_TELEM_SUBSCRIBERS && (used & (1UL << slot))) slot++;
+    if (slot >= MAX_TELEM_SUBSCRIBERS) {
+      reply_data[4] = TELEM_SUB_FULL;
+      return 5;
+    }
+    s->slot = slot;
+  }
+
+  if (period_secs < TELEM_SUB_MIN_PERIOD_SECS) period_secs = TELEM_SUB_MIN_PERIOD_SECS;
+
+  uint32_t now = getRTCClock()->getCurrentTime();
+  s->tag = sender_timestamp;   // pushes are sent with this tag
+  s->expires = now + lease_hours * 3600UL;
+  s->next_push = now + period_secs;
+  s->period_secs = period_secs;
+  s->min_delta = min_delta;
+  s->perm_mask = perm_mask;
+  s->seq = 0;
+  s->num_pushes = 0;
+
+  int ofs = 4;
+  reply_data[ofs++] = TELEM_SUB_OK;
+  memcpy(&reply_data[ofs], &period_secs, 2); ofs += 2;
+  // current values, in full. NOTE: a subscriber which sees a gap in seq re-subscribes, to get this straight away
+  ofs += encodeTelemPush(client, &reply_data[ofs], MULTIPART_SINGLE_MAX_DATA - ofs, true);
+  return ofs;
+}
+
+void SensorMesh::checkTelemSubscriptions() {
+  uint32_t now = getRTCClock()->getCurrentTime();
+  for (int i = 0; i < acl.getNumClients(); i++) {
+    auto c = acl.getClientByIdx(i);
+    auto s = &c->extra.telem;
+    if (s->tag == 0 || now < s->next_push) continue;
+
+    uint8_t perms = c->isAdmin() ? 0xFF : c->permissions;
+    if (now >= s->expires || (perms & PERM_ACL_ROLE_MASK) < PERM_ACL_READ_ONLY) {
+      s->tag = 0;   // lease has expired (or permissions revoked)
+      continue;
+    }
+    s->next_push = now + s->period_secs;
+
+    bool full = ++s->num_pushes >= TELEM_SUB_FULL_EVERY;
+    if (full) s->num_pushes = 0;
+
+    memcpy(reply_data, &s->tag, 4);
+    int len = encodeTelemPush(c, &reply_data[4], MULTIPART_SINGLE_MAX_DATA - 4, full);
+    if (len == 0) continue;   // nothing changed enough, no push needed
+
+    auto pkt = createDatagram(PAYLOAD_TYPE_RESPONSE, c->id, c->shared_secret, reply_data, 4 + len);
+    if (pkt) {
+      if (c->out_path_len != OUT_PATH_UNKNOWN) {  // we have an out_path, so send DIRECT
+        sendDirect(pkt, c->out_path, c->out_path_len);
+      } else {
+        sendFlood(pkt, 0, _prefs.path_hash_mode + 1);
+      }
+    }
+    break;   // at most one push per loop()
+  }
+}
+
+void SensorMesh::recordHistory(CompressedSeries& series, uint8_t lpp_type, float value) {
+  int32_t q = (int32_t) lroundf(value * getMultiplier(lpp_type));   // quantise to resolution of LPP type
+  series.add(getRTCClock()->getCurrentTime(), q);
+}
+
+int SensorMesh::addSeriesHistory(const CompressedSeries& series, uint8_t channel, uint8_t lpp_type, uint32_t since, uint8_t* dest, int max_len) const {
+  if (max_len < 4) return 0;
+
+  dest[0] = channel;
+  dest[1] = lpp_type;
+  uint16_t len = series.exportSince(since, &dest[4], max_len - 4);
+  memcpy(&dest[2], &len, 2);
+  return 4 + len;
+}
+
 mesh::Packet* SensorMesh::createSelfAdvert() {
   uint8_t app_data[MAX_ADVERT_DATA_SIZE];
   uint8_t app_data_len = _cli.buildAdvertData(ADV_TYPE_SENSOR, app_data);
@@ -244,7 +385,7 @@ mesh::Packet* SensorMesh::createSelfAdvert() {
   return createAdvert(self_id, app_data, app_data_len);
 }
 
-void SensorMesh::sendAlert(const ClientInfo* c, Trigger* t) {
+void SensorMesh::sendAlert(const ClientInfo* c, AlertSend* t) {
   int text_len = strlen(t->text);
 
   uint8_t data[MAX_PACKET_PAYLOAD];
@@ -268,31 +409,58 @@ void SensorMesh::sendAlert(const ClientInfo* c, Trigger* t) {
   t->send_expiry = futureMillis(ALERT_ACK_EXPIRY_MILLIS);
 }
 
-void SensorMesh::alertIf(bool condition, Trigger& t, AlertPriority pri, const char* text) {
-  if (condition) {
-    if (!t.isTriggered() && num_alert_tasks < MAX_CONCURRENT_ALERTS) {
-      StrHelper::strncpy(t.text, text, sizeof(t.text));
-      t.pri = pri;
-      t.send_expiry = 0;  // signal that initial send is needed
-      t.attempt = 4;
-      t.curr_contact_idx = -1;  // start iterating thru contacts[]
+void SensorMesh::alertIf(bool condition, Trigger& t, AlertPriority pri, const char* text, uint32_t min_repeat_secs) {
+  alerts.check(t, condition, pri, text, getRTCClock()->getCurrentTime(), min_repeat_secs);
+}
 
-      alert_tasks[num_alert_tasks++] = &t;  // add to queue
-    }
-  } else {
-    if (t.isTriggered()) {
-      t.text[0] = 0;
-      // remove 't' from alert queue
-      int i = 0;
-      while (i < num_alert_tasks && alert_tasks[i] != &t) i++;
-
-      if (i < num_alert_tasks) {  // found,  now delete from array
-        num_alert_tasks--;
-        while (i < num_alert_tasks) {
-          alert_tasks[i] = alert_tasks[i + 1];
-          i++;
+void SensorMesh::alertAbove(float value, float threshold, float hysteresis, Trigger& t, AlertPriority pri, const char* text) {
+  alerts.checkAbove(t, value, threshold, hysteresis, pri, text, getRTCClock()->getCurrentTime());
+}
+
+void SensorMesh::alertBelow(float value, float threshold, float hysteresis, Trigger& t, AlertPriority pri, const char* text) {
+  alerts.checkBelow(t, value, threshold, hysteresis, pri, text, getRTCClock()->getCurrentTime());
+}
+
+void SensorMesh::checkAlertQueue() {
+  auto t = &alert_send;
+  if (alerts.getBatchSize() == 0) {
+    if (alerts.getNumPending() == 0) return;   // nothing to send
+
+    // coalesce all queued alerts (that fit) into one message per contact
+    alerts.beginBatch(getRTCClock()->getCurrentTime());
+    t->send_expiry = 0;  // signal that initial send is needed
+    t->attempt = 4;
+    t->curr_contact_idx = -1;  // start iterating thru contacts[]
+  }
+
+  if (millisHasNowPassed(t->send_expiry)) {  // next send needed?
+    if (t->attempt >= 4) {  // max attempts reached, try next contact
+      t->curr_contact_idx++;
+      if (t->curr_contact_idx >= acl.getNumClients()) {  // no more contacts to try?
+        alerts.endBatch();
+      } else {
+        auto c = acl.getClientByIdx(t->curr_contact_idx);
+        uint8_t pri_mask = 0;
+        if (c->permissions & PERM_RECV_ALERTS_HI) pri_mask |= (1 << ALERT_PRI_HIGH);
+        if (c->permissions & PERM_RECV_ALERTS_LO) pri_mask |= (1 << ALERT_PRI_LOW);
+
+        int pri = alerts.formatBatch(t->text, sizeof(t->text), pri_mask);
+        if (pri >= 0) {   // contact wants (some of) these alerts
+          // reset attempts
+          t->attempt = (pri == LOW_PRI_ALERT) ? 3 : 0;   // Low pri alerts only, start at attempt #3 (ie. only make ONE attempt)
+          t->timestamp = getRTCClock()->getCurrentTimeUnique();   // need unique timestamp per contact
+
+          sendAlert(c, t);  // NOTE: modifies attempt, expected_acks[] and send_expiry
+        } else {
+          // next contact tested in next ::loop()
         }
       }
+    } else if (t->curr_contact_idx < acl.getNumClients()) {
+      auto c = acl.getClientByIdx(t->curr_contact_idx);   // send next attempt
+      sendAlert(c, t);  // NOTE: modifies attempt, expected_acks[] and send_expiry
+    } else {
+      // contact list has likely been modified while waiting for alert ACK, cancel this contact
+      t->attempt = 4;   // next ::loop() will move to next contact (or end batch)
     }
   }
 }
@@ -301,6 +469,12 @@ float SensorMesh::getAirtimeBudgetFactor() const {
   return _prefs.airtime_factor;
 }
 
+#ifdef DUTY_CYCLE_EU868
+uint8_t SensorMesh::getDutyCycleBand() const {
+  return mesh::DutyCycleTracker::findEU868Band(_prefs.freq);
+}
+#endif
+
 bool SensorMesh::allowPacketForward(const mesh::Packet* packet) {
   if (_prefs.disable_fwd) return false;
   if (packet->isRouteFlood() && packet->getPathHashCount() >= _prefs.flood_max) return false;
@@ -531,13 +705,29 @@ void SensorMesh::onPeerDataRecv(mesh::Packet* packet, uint8_t type, int sender_i
     memcpy(&timestamp, data, 4);
 
     if (timestamp > from->last_timestamp) {  // prevent replay attacks
-      uint8_t reply_len = handleRequest(from->isAdmin() ? 0xFF : from->permissions, timestamp, data[4], &data[5], len - 5);
+      int reply_len;
+      if (data[4] == REQ_TYPE_SUBSCRIBE_TELEMETRY) {
+        reply_len = handleSubscribe(from, timestamp, &data[5], len - 5);
+      } else {
+        reply_len = handleRequest(from->isAdmin() ? 0xFF : from->permissions, timestamp, data[4], &data[5], len - 5);
+      }
       if (reply_len == 0) return;  // invalid command
 
       from->last_timestamp = timestamp;
       from->last_activity = getRTCClock()->getCurrentTime();
 
-      if (packet->isRouteFlood()) {
+      if (reply_len > MULTIPART_SINGLE_MAX_DATA) {   // too long for one packet (requester said it can take multipart)
+        if (packet->isRouteFlood()) {
+          // let this sender know path TO here, so fragment ACKs can be sent Direct (NOTE: response is in the fragments)
+          mesh::Packet* path = createPathReturn(from->id, secret, packet->path, packet->path_len, 0, NULL, 0);
+          if (path) sendFlood(path, SERVER_RESPONSE_DELAY, packet->getPathHashSize());
+        }
+        if (from->out_path_len != OUT_PATH_UNKNOWN) {
+          sendMultipart(PAYLOAD_TYPE_RESPONSE, from->id, secret, reply_data, reply_len, from->out_path, from->out_path_len, SERVER_RESPONSE_DELAY);
+        } else {
+          sendMultipart(PAYLOAD_TYPE_RESPONSE, from->id, secret, reply_data, reply_len, NULL, 0, SERVER_RESPONSE_DELAY, packet->getPathHashSize());
+        }
+      } else if (packet->isRouteFlood()) {
         // let this sender know path TO here, so they can use sendDirect(), and ALSO encode the response
         mesh::Packet* path = createPathReturn(from->id, secret, packet->path, packet->path_len,
                                               PAYLOAD_TYPE_RESPONSE, reply_data, reply_len);
@@ -684,8 +874,8 @@ bool SensorMesh::onPeerPathRecv(mesh::Packet* packet, int sender_idx, const uint
 }
 
 void SensorMesh::onAckRecv(mesh::Packet* packet, uint32_t ack_crc) {
-  if (num_alert_tasks > 0) {
-    auto t = alert_tasks[0];   // check current alert task
+  if (alerts.getBatchSize() > 0) {
+    auto t = &alert_send;   // check current alert batch
     for (int i = 0; i < t->attempt; i++) {
       if (ack_crc == t->expected_acks[i]) {   // matching ACK!
         t->attempt = 4;  // signal to move to next contact
@@ -706,8 +896,9 @@ SensorMesh::SensorMesh(mesh::MainBoard& board, mesh::Radio& radio, mesh::Millise
   next_local_advert = next_flood_advert = 0;
   dirty_contacts_expiry = 0;
   last_read_time = 0;
-  num_alert_tasks = 0;
+  alert_send.send_expiry = 0;
   set_radio_at = revert_radio_at = 0;
+  setMultipartBuffers(NULL, &mp_send);
 
   // defaults
   _prefs.airtime_factor = 1.0;
@@ -742,6 +933,7 @@ SensorMesh::SensorMesh(mesh::MainBoard& board, mesh::Radio& radio, mesh::Millise
 
 void SensorMesh::begin(FILESYSTEM* fs) {
   mesh::Mesh::begin();
+  getMetrics().addGauge(METRIC_ID_BATT_MV, "batt_mv", [](const void*) -> int32_t { return board.getBattMilliVolts(); }, NULL);
   _fs = fs;
   // load persisted prefs
   _cli.loadPrefs(_fs);
@@ -860,6 +1052,18 @@ void SensorMesh::formatRadioStatsReply(char *reply) {
   StatsFormatHelper::formatRadioStats(reply, _radio, radio_driver, getTotalAirTime(), getReceiveAirTime());
 }
 
+void SensorMesh::formatChannelStatsReply(char *reply) {
+  StatsFormatHelper::formatChannelStats(reply, radio_driver);
+}
+
+void SensorMesh::formatDutyCycleStatsReply(char *reply) {
+  StatsFormatHelper::formatDutyCycleStats(reply, *this);
+}
+
+void SensorMesh::formatMetricsReply(char *reply, int start) {
+  StatsFormatHelper::formatMetrics(reply, getMetrics(), start);
+}
+
 void SensorMesh::formatPacketStatsReply(char *reply) {
   StatsFormatHelper::formatPacketStats(reply, radio_driver, getNumSentFlood(), getNumSentDirect(), 
                                        getNumRecvFlood(), getNumRecvDirect());
@@ -937,41 +1141,8 @@ void SensorMesh::loop() {
     last_read_time = curr;
   }
 
-  // check the alert send queue
-  if (num_alert_tasks > 0) {
-    auto t = alert_tasks[0];   // process head of queue
-
-    if (millisHasNowPassed(t->send_expiry)) {  // next send needed?
-      if (t->attempt >= 4) {  // max attempts reached, try next contact
-        t->curr_contact_idx++;
-        if (t->curr_contact_idx >= acl.getNumClients()) {  // no more contacts to try?
-          num_alert_tasks--;   // remove t from queue
-          for (int i = 0; i < num_alert_tasks; i++) {
-            alert_tasks[i] = alert_tasks[i + 1];
-          }
-        } else {
-          auto c = acl.getClientByIdx(t->curr_contact_idx);
-          uint16_t pri_mask = (t->pri == HIGH_PRI_ALERT) ? PERM_RECV_ALERTS_HI : PERM_RECV_ALERTS_LO;
-
-          if (c->permissions & pri_mask) {   // contact wants alert
-            // reset attempts
-            t->attempt = (t->pri == LOW_PRI_ALERT) ? 3 : 0;   // Low pri alerts, start at attempt #3 (ie. only make ONE attempt)
-            t->timestamp = getRTCClock()->getCurrentTimeUnique();   // need unique timestamp per contact
-
-            sendAlert(c, t);  // NOTE: modifies attempt, expected_acks[] and send_expiry
-          } else {
-            // next contact tested in next ::loop()
-          }
-        }
-      } else if (t->curr_contact_idx < acl.getNumClients()) {
-        auto c = acl.getClientByIdx(t->curr_contact_idx);   // send next attempt
-        sendAlert(c, t);  // NOTE: modifies attempt, expected_acks[] and send_expiry
-      } else {
-        // contact list has likely been modified while waiting for alert ACK, cancel this task
-        t->attempt = 4;   // next ::loop() will remove t from queue
-      }
-    }
-  }
+  checkAlertQueue();
+  checkTelemSubscriptions();
 
   // is there are pending dirty contacts write needed?
   if (dirty_contacts_expiry && millisHasNowPassed(dirty_contacts_expiry)) {
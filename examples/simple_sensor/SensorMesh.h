@@ -23,6 +23,9 @@
 #include <helpers/StatsFormatHelper.h>
 #include <helpers/ClientACL.h>
 #include <helpers/RegionMap.h>
+#include <helpers/SeriesCodec.h>
+#include <helpers/AlertEngine.h>
+#include <helpers/TelemetryDelta.h>
 #include <RTClib.h>
 #include <target.h>
 
@@ -44,7 +47,10 @@
 #define FIRMWARE_ROLE "sensor"
 
 #define MAX_SEARCH_RESULTS      8
-#define MAX_CONCURRENT_ALERTS   4
+
+#ifndef MAX_TELEM_SUBSCRIBERS
+  #define MAX_TELEM_SUBSCRIBERS   4
+#endif
 
 class SensorMesh : public mesh::Mesh, public CommonCLICallbacks {
 public:
@@ -73,6 +79,9 @@ public:
   }
   void formatStatsReply(char *reply) override;
   void formatRadioStatsReply(char *reply) override;
+  void formatChannelStatsReply(char *reply) override;
+  void formatDutyCycleStatsReply(char *reply) override;
+  void formatMetricsReply(char *reply, int start) override;
   void formatPacketStatsReply(char *reply) override;
   mesh::LocalIdentity& getSelfId() override { return self_id; }
   void saveIdentity(const mesh::LocalIdentity& new_id) override;
@@ -93,28 +102,34 @@ protected:
   bool  getGPS(uint8_t channel, float& lat, float& lon, float& alt);
 
   // alerts
-  enum AlertPriority { LOW_PRI_ALERT, HIGH_PRI_ALERT };
-
-  struct Trigger {
-    uint32_t timestamp;
-    AlertPriority pri;
-    uint32_t expected_acks[4];
-    int8_t   curr_contact_idx;
-    uint8_t  attempt;
-    unsigned long send_expiry;
-    char text[MAX_PACKET_PAYLOAD];
-
-    Trigger() { text[0] = 0; }
-    bool isTriggered() const { return text[0] != 0; }
-  };
-  void alertIf(bool condition, Trigger& t, AlertPriority pri, const char* text);
+  enum AlertPriority { LOW_PRI_ALERT = ALERT_PRI_LOW, HIGH_PRI_ALERT = ALERT_PRI_HIGH };
+  typedef AlertTrigger Trigger;
+
+  /**
+   * \brief  alert on 'condition' becoming true, at most once per 'min_repeat_secs' (zero for default)
+   */
+  void alertIf(bool condition, Trigger& t, AlertPriority pri, const char* text, uint32_t min_repeat_secs=0);
+  /**
+   * \brief  alert on value rising above threshold, reset once below (threshold - hysteresis)
+   */
+  void alertAbove(float value, float threshold, float hysteresis, Trigger& t, AlertPriority pri, const char* text);
+  /**
+   * \brief  alert on value falling below threshold, reset once above (threshold + hysteresis)
+   */
+  void alertBelow(float value, float threshold, float hysteresis, Trigger& t, AlertPriority pri, const char* text);
 
   virtual void onSensorDataRead() = 0;   // for app to implement
   virtual int querySeriesData(uint32_t start_secs_ago, uint32_t end_secs_ago, MinMaxAvg dest[], int max_num) = 0;  // for app to implement
+  virtual int querySeriesHistory(uint32_t since, uint8_t* dest, int max_len) { return 0; }   // for app to implement, see addSeriesHistory()
+  void recordHistory(CompressedSeries& series, uint8_t lpp_type, float value);
+  int addSeriesHistory(const CompressedSeries& series, uint8_t channel, uint8_t lpp_type, uint32_t since, uint8_t* dest, int max_len) const;
   virtual bool handleCustomCommand(uint32_t sender_timestamp, char* command, char* reply) { return false; }
 
   // Mesh overrides
   float getAirtimeBudgetFactor() const override;
+#ifdef DUTY_CYCLE_EU868
+  uint8_t getDutyCycleBand() const override;
+#endif
   bool allowPacketForward(const mesh::Packet* packet) override;
   int calcRxDelay(float score, uint32_t air_time) const override;
   uint32_t getRetransmitDelay(const mesh::Packet* packet) override;
@@ -137,7 +152,8 @@ private:
   NodePrefs _prefs;
   ClientACL  acl;
   CommonCLI _cli;
-  uint8_t reply_data[MAX_PACKET_PAYLOAD];
+  uint8_t reply_data[MULTIPART_MAX_DATA];
+  mesh::MultipartSendBuffer mp_send;   // only sends multipart, never receives
   unsigned long dirty_contacts_expiry;
   CayenneLPP telemetry;
   TransportKeyStore key_store;
@@ -145,8 +161,16 @@ private:
   TransportKey default_scope;
   uint32_t last_read_time;
   int matching_peer_indexes[MAX_SEARCH_RESULTS];
-  int num_alert_tasks;
-  Trigger* alert_tasks[MAX_CONCURRENT_ALERTS];
+  AlertEngine alerts;
+  struct AlertSend {      // current alert batch, being sent to each contact in turn
+    uint32_t timestamp;
+    uint32_t expected_acks[4];
+    int      curr_contact_idx;
+    uint8_t  attempt;
+    unsigned long send_expiry;
+    char text[ALERT_BATCH_TEXT+1];
+  } alert_send;
+  TelemetryDelta telem_deltas[MAX_TELEM_SUBSCRIBERS];   // last values pushed, per subscription slot
   unsigned long set_radio_at, revert_radio_at;
   float pending_freq;
   float pending_bw;
@@ -154,10 +178,14 @@ private:
   uint8_t pending_cr;
 
   uint8_t handleLoginReq(const mesh::Identity& sender, const uint8_t* secret, uint32_t sender_timestamp, const uint8_t* data, bool is_flood);
-  uint8_t handleRequest(uint8_t perms, uint32_t sender_timestamp, uint8_t req_type, uint8_t* payload, size_t payload_len);
+  int handleRequest(uint8_t perms, uint32_t sender_timestamp, uint8_t req_type, uint8_t* payload, size_t payload_len);
+  int handleSubscribe(ClientInfo* client, uint32_t sender_timestamp, const uint8_t* payload, size_t payload_len);
+  int encodeTelemPush(ClientInfo* client, uint8_t* dest, int max_len, bool full);
+  void checkTelemSubscriptions();
   mesh::Packet* createSelfAdvert();
 
-  void sendAlert(const ClientInfo* c, Trigger* t);
+  void sendAlert(const ClientInfo* c, AlertSend* t);
+  void checkAlertQueue();
 
   #if ENV_INCLUDE_GPS == 1
   void applyGpsPrefs() {
@@ -1,40 +1,123 @@
 #include "TimeSeriesData.h"
 
+#define SERIES_FILE_VERSION  1
+
+static File openWrite(FILESYSTEM* _fs, const char* filename) {
+  #if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+    _fs->remove(filename);
+    return _fs->open(filename, FILE_O_WRITE);
+  #elif defined(RP2040_PLATFORM)
+    return _fs->open(filename, "w");
+  #else
+    return _fs->open(filename, "w", true);
+  #endif
+}
+
+bool TimeSeriesData::addTier(uint32_t secs, int num) {
+  if (num_tiers >= TIME_SERIES_MAX_TIERS || secs == 0 || num <= 0) return false;
+
+  Tier& t = tiers[num_tiers++];
+  t.secs = secs;
+  t.num_slots = num;
+  t.head = 0;
+  t.head_period = 0;
+  t.buckets = new SeriesBucket[num];
+  memset(t.buckets, 0, sizeof(SeriesBucket)*num);
+  return true;
+}
+
+void TimeSeriesData::advance(Tier& t, uint32_t period) {
+  if (period == t.head_period) return;
+
+  uint32_t steps;
+  if (period < t.head_period) {   // clock has gone backwards
+    if (t.head_period - period < (uint32_t) t.num_slots) return;   // only a little, just keep adding to head
+    steps = t.num_slots;
+  } else {
+    steps = period - t.head_period;
+  }
+  if (steps >= (uint32_t) t.num_slots) {    // all buckets are stale
+    memset(t.buckets, 0, sizeof(SeriesBucket)*t.num_slots);
+    t.head = 0;
+  } else {
+    while (steps > 0) {
+      t.head = (t.head + 1) % t.num_slots;
+      memset(&t.buckets[t.head], 0, sizeof(SeriesBucket));
+      steps--;
+    }
+  }
+  t.head_period = period;
+}
+
 void TimeSeriesData::recordData(mesh::RTCClock* clock, float value) {
   uint32_t now = clock->getCurrentTime();
-  if (now >= last_timestamp + interval_secs) {
-    last_timestamp = now;
 
-    data[next] = value;   // append to cycle table
-    next = (next + 1) % num_slots;
+  for (int i = 0; i < num_tiers; i++) {
+    Tier& t = tiers[i];
+    advance(t, now / t.secs);
+
+    SeriesBucket* b = &t.buckets[t.head];
+    if (b->_count == 0) {
+      b->_min = b->_max = b->_sum = value;
+    } else {
+      if (value < b->_min) b->_min = value;
+      if (value > b->_max) b->_max = value;
+      b->_sum += value;
+    }
+    b->_count++;
+  }
+
+  if (_fs) {
+    if (last_saved == 0) {
+      last_saved = now;
+    } else if (now - last_saved >= save_interval_secs) {
+      save();
+      last_saved = now;
+    }
   }
 }
 
 void TimeSeriesData::calcMinMaxAvg(mesh::RTCClock* clock, uint32_t start_secs_ago, uint32_t end_secs_ago, MinMaxAvg* dest, uint8_t channel, uint8_t lpp_type) const {
-  int i = next, n = num_slots;
-  uint32_t ago = clock->getCurrentTime() - last_timestamp;
-  int num_values = 0;
-  float total = 0.0f;
+  uint32_t now = clock->getCurrentTime();
+  uint32_t from = start_secs_ago < now ? now - start_secs_ago : 0;
+  uint32_t to = end_secs_ago < now ? now - end_secs_ago : 0;
 
   dest->_channel = channel;
   dest->_lpp_type = lpp_type;
 
-  // start at most recet recording, back-track through to oldest
-  while (n > 0) {
-    n--;
-    i = (i + num_slots - 1) % num_slots;  // go back by one
-    if (ago >= end_secs_ago && ago < start_secs_ago) {   // filter by the desired time range
-      float v = data[i];
-      num_values++;
-      total += v;
-      if (num_values == 1) {
-        dest->_max = dest->_min = v;
-      } else {
-        if (v < dest->_min) dest->_min = v;
-        if (v > dest->_max) dest->_max = v;
-      }
-    }
-    ago += interval_secs;
+  // use finest tier which still has buckets back to the start of range (or the coarsest)
+  int ti = num_tiers - 1;
+  for (int i = 0; i < num_tiers - 1; i++) {
+    const Tier& t = tiers[i];
+    uint32_t oldest = t.head_period >= (uint32_t)(t.num_slots - 1) ? t.head_period - (t.num_slots - 1) : 0;
+    if (oldest * t.secs <= from) {
+      ti = i;
+      break;
+    }
+  }
+  const Tier& t = tiers[ti];
+
+  uint32_t num_values = 0;
+  float total = 0.0f;
+
+  // start at most recent bucket, back-track until before start of range
+  for (int k = 0; k < t.num_slots && k <= (int) t.head_period; k++) {
+    uint32_t bucket_start = (t.head_period - k) * t.secs;
+    if (bucket_start + t.secs <= from) break;
+    if (bucket_start > to) continue;     // (range includes the end time, eg. a reading made just now)
+
+    const SeriesBucket* b = &t.buckets[(t.head + t.num_slots - k) % t.num_slots];
+    if (b->_count == 0) continue;   // nothing recorded
+
+    if (num_values == 0) {
+      dest->_min = b->_min;
+      dest->_max = b->_max;
+    } else {
+      if (b->_min < dest->_min) dest->_min = b->_min;
+      if (b->_max > dest->_max) dest->_max = b->_max;
+    }
+    num_values += b->_count;
+    total += b->_sum;
   }
   // calc average
   if (num_values > 0) {
@@ -43,3 +126,71 @@ void TimeSeriesData::calcMinMaxAvg(mesh::RTCClock* clock, uint32_t start_secs_ag
     dest->_max = dest->_min = dest->_avg = NAN;
   }
 }
+
+void TimeSeriesData::begin(FILESYSTEM* fs, const char* filename, uint32_t interval_secs) {
+  _fs = fs;
+  _filename = filename;
+  save_interval_secs = interval_secs;
+  last_saved = 0;
+  if (!load()) {
+    for (int i = 0; i < num_tiers; i++) {   // discard anything partially loaded
+      tiers[i].head = 0;
+      tiers[i].head_period = 0;
+      memset(tiers[i].buckets, 0, sizeof(SeriesBucket)*tiers[i].num_slots);
+    }
+  }
+}
+
+bool TimeSeriesData::load() {
+  if (!_fs->exists(_filename)) return false;
+
+#if defined(RP2040_PLATFORM)
+  File file = _fs->open(_filename, "r");
+#else
+  File file = _fs->open(_filename);
+#endif
+  if (!file) return false;
+
+  uint8_t hdr[2];
+  bool success = (file.read(hdr, 2) == 2) && hdr[0] == SERIES_FILE_VERSION && hdr[1] == num_tiers;
+  for (int i = 0; success && i < num_tiers; i++) {
+    Tier& t = tiers[i];
+    uint32_t secs;
+    uint16_t num, head;
+    success = (file.read((uint8_t *) &secs, 4) == 4);
+    success = success && (file.read((uint8_t *) &num, 2) == 2);
+    success = success && secs == t.secs && num == t.num_slots;   // must be same config
+    success = success && (file.read((uint8_t *) &head, 2) == 2) && head < num;
+    success = success && (file.read((uint8_t *) &t.head_period, 4) == 4);
+    if (success) {
+      t.head = head;
+      int len = sizeof(SeriesBucket)*t.num_slots;
+      success = (file.read((uint8_t *) t.buckets, len) == len);
+    }
+  }
+  file.close();
+  return success;
+}
+
+void TimeSeriesData::save() {
+  if (_fs == NULL) return;
+
+  File file = openWrite(_fs, _filename);
+  if (file) {
+    uint8_t hdr[2];
+    hdr[0] = SERIES_FILE_VERSION;
+    hdr[1] = num_tiers;
+    bool success = (file.write(hdr, 2) == 2);
+    for (int i = 0; success && i < num_tiers; i++) {
+      Tier& t = tiers[i];
+      uint16_t num = t.num_slots, head = t.head;
+      int len = sizeof(SeriesBucket)*t.num_slots;
+      success = (file.write((uint8_t *) &t.secs, 4) == 4);
+      success = success && (file.write((uint8_t *) &num, 2) == 2);
+      success = success && (file.write((uint8_t *) &head, 2) == 2);
+      success = success && (file.write((uint8_t *) &t.head_period, 4) == 4);
+      success = success && (file.write((uint8_t *) t.buckets, len) == len);
+    }
+    file.close();
+  }
+}
@@ -2,28 +2,74 @@
 
 #include <Arduino.h>
 #include <Mesh.h>
+#include <helpers/IdentityStore.h>
+
+#ifndef TIME_SERIES_MAX_TIERS
+  #define TIME_SERIES_MAX_TIERS  4
+#endif
 
 struct MinMaxAvg {
   float _min, _max, _avg;
   uint8_t _lpp_type, _channel;
 };
 
+struct SeriesBucket {
+  float _min, _max, _sum;
+  uint32_t _count;     // zero if no data recorded in bucket
+};
+
+/**
+ * \brief  Round-robin store of a value over time, in tiers of min/max/sum/count buckets (eg. 5 min, 15 min, hourly, daily).
+ *      Each recorded value is added to the current bucket of every tier, and a range query reads only the buckets of
+ *      the finest tier that still covers the start of the range. Buckets are aligned to multiples of their length
+ *      in epoch time.
+ */
 class TimeSeriesData {
-  float* data;
-  int num_slots, next;
-  uint32_t last_timestamp;
-  uint32_t interval_secs;
+  struct Tier {
+    uint32_t secs;          // bucket length
+    int num_slots;
+    int head;               // bucket being filled
+    uint32_t head_period;   // (epoch secs / secs) of head bucket
+    SeriesBucket* buckets;
+  };
+
+  Tier tiers[TIME_SERIES_MAX_TIERS];
+  int num_tiers;
+  FILESYSTEM* _fs;
+  const char* _filename;
+  uint32_t save_interval_secs, last_saved;
+
+  static void advance(Tier& t, uint32_t period);
+  bool addTier(uint32_t secs, int num);
+  bool load();
 
 public:
-  TimeSeriesData(float* array, int num, uint32_t secs) : num_slots(num), data(array), last_timestamp(0), next(0), interval_secs(secs) { 
-    memset(data, 0, sizeof(float)*num);
-  }
-  TimeSeriesData(int num, uint32_t secs) : num_slots(num), last_timestamp(0), next(0), interval_secs(secs) {
-    data = new float[num];
-    memset(data, 0, sizeof(float)*num);
+  /**
+   * \param  num   number of raw buckets kept
+   * \param  secs  length of each raw bucket
+   */
+  TimeSeriesData(int num, uint32_t secs) : num_tiers(0), _fs(NULL), _filename(NULL), save_interval_secs(0), last_saved(0) {
+    addTier(secs, num);
   }
+  /**
+   * \deprecated  buckets hold min/max/sum/count so can no longer live in a float array. 'array' is not used,
+   *      this only keeps older callers building.
+   */
+  TimeSeriesData(float* array, int num, uint32_t secs) : TimeSeriesData(num, secs) { }
+
+  /**
+   * \brief  adds a coarser tier which rolls up the same values into 'num' buckets of 'secs' each.
+   *      (secs should be a multiple of the previous tier's)
+   * \returns  false if already at TIME_SERIES_MAX_TIERS, or params invalid
+   */
+  bool addRollupTier(uint32_t secs, int num) { return addTier(secs, num); }
+
+  /**
+   * \brief  loads any saved history, then saves to 'filename' (at most) every 'interval_secs' as data is recorded
+   */
+  void begin(FILESYSTEM* fs, const char* filename, uint32_t interval_secs);
+  void save();
 
   void recordData(mesh::RTCClock* clock, float value);
   void calcMinMaxAvg(mesh::RTCClock* clock, uint32_t start_secs_ago, uint32_t end_secs_ago, MinMaxAvg* dest, uint8_t channel, uint8_t lpp_type) const;
 };
-
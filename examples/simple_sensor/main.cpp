@@ -9,21 +9,36 @@ class MyMesh : public SensorMesh {
 public:
   MyMesh(mesh::MainBoard& board, mesh::Radio& radio, mesh::MillisecondClock& ms, mesh::RNG& rng, mesh::RTCClock& rtc, mesh::MeshTables& tables)
      : SensorMesh(board, radio, ms, rng, rtc, tables), 
-       battery_data(12*24, 5*60)    // 24 hours worth of battery data, every 5 minutes
+       battery_data(12, 5*60),    // last hour in 5 minute buckets
+       battery_history(16)        // 1KB of compressed readings, about a week at 15 minute intervals
   {
+    battery_data.addRollupTier(15*60, 16);      // 4 hours in 15 minute buckets
+    battery_data.addRollupTier(60*60, 24);      // 24 hours in hourly buckets
+    battery_data.addRollupTier(24*60*60, 14);   // 2 weeks in daily buckets
+  }
+
+  void beginSeriesData(FILESYSTEM* fs) {
+    battery_data.begin(fs, "/batt_series", 60*60);   // save history every hour
   }
 
 protected:
   /* ========================== custom logic here ========================== */
   Trigger low_batt, critical_batt;
   TimeSeriesData  battery_data;
+  CompressedSeries battery_history;
+  uint32_t last_history_time = 0;
 
   void onSensorDataRead() override {
     float batt_voltage = getVoltage(TELEM_CHANNEL_SELF);
 
     battery_data.recordData(getRTCClock(), batt_voltage);   // record battery
-    alertIf(batt_voltage < 3.4f, critical_batt, HIGH_PRI_ALERT, "Battery is critical!");
-    alertIf(batt_voltage < 3.6f, low_batt, LOW_PRI_ALERT, "Battery is low");
+    uint32_t now = getRTCClock()->getCurrentTime();
+    if (now >= last_history_time + 15*60) {
+      last_history_time = now;
+      recordHistory(battery_history, LPP_VOLTAGE, batt_voltage);
+    }
+    alertBelow(batt_voltage, 3.4f, 0.1f, critical_batt, HIGH_PRI_ALERT, "Battery is critical!");
+    alertBelow(batt_voltage, 3.6f, 0.1f, low_batt, LOW_PRI_ALERT, "Battery is low");
   }
 
   int querySeriesData(uint32_t start_secs_ago, uint32_t end_secs_ago, MinMaxAvg dest[], int max_num) override {
@@ -31,6 +46,10 @@ protected:
     return 1;
   }
 
+  int querySeriesHistory(uint32_t since, uint8_t* dest, int max_len) override {
+    return addSeriesHistory(battery_history, TELEM_CHANNEL_SELF, LPP_VOLTAGE, since, dest, max_len);
+  }
+
   bool handleCustomCommand(uint32_t sender_timestamp, char* command, char* reply) override {
     if (strcmp(command, "magic") == 0) {    // example 'custom' command handling
       strcpy(reply, "**Magic now done**");
@@ -109,6 +128,7 @@ void setup() {
   sensors.begin();
 
   the_mesh.begin(fs);
+  the_mesh.beginSeriesData(fs);
 
 #ifdef DISPLAY_CLASS
   ui_task.begin(the_mesh.getNodePrefs(), FIRMWARE_BUILD_DATE, FIRMWARE_VERSION);
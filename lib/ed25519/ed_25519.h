@@ -30,9 +30,26 @@ void ED25519_DECLSPEC ed25519_create_keypair(unsigned char *public_key, unsigned
 void ED25519_DECLSPEC ed25519_derive_pub(unsigned char *public_key, const unsigned char *private_key);
 void ED25519_DECLSPEC ed25519_sign(unsigned char *signature, const unsigned char *message, size_t message_len, const unsigned char *public_key, const unsigned char *private_key);
 int ED25519_DECLSPEC ed25519_verify(const unsigned char *signature, const unsigned char *message, size_t message_len, const unsigned char *public_key);
+
+/* public key decompression (a field square root) split out of ed25519_verify(), so the point can be cached */
+#define ED25519_POINT_SIZE  160
+int ED25519_DECLSPEC ed25519_decompress_key(unsigned char *point, const unsigned char *public_key);
+int ED25519_DECLSPEC ed25519_verify_decompressed(const unsigned char *signature, const unsigned char *message, size_t message_len, const unsigned char *public_key, const unsigned char *point);
 void ED25519_DECLSPEC ed25519_add_scalar(unsigned char *public_key, unsigned char *private_key, const unsigned char *scalar);
 void ED25519_DECLSPEC ed25519_key_exchange(unsigned char *shared_secret, const unsigned char *public_key, const unsigned char *private_key);
 
+/* converts an Ed25519 public key to its X25519 (Montgomery u) form, so it can be cached and re-used */
+void ED25519_DECLSPEC ed25519_key_to_montgomery(unsigned char *montgomery_u, const unsigned char *public_key);
+void ED25519_DECLSPEC ed25519_key_exchange_montgomery(unsigned char *shared_secret, const unsigned char *montgomery_u, const unsigned char *private_key);
+
+/* verifies 'count' signatures together, 'random' is 16 bytes per signature (must be unpredictable to signers).
+   returns 1 if ALL are valid. If 'valid' is non-NULL, a failed batch falls back to individual checks to fill it in.
+   NOTE: the check is cofactored, so it agrees with ed25519_verify_cofactored(), not ed25519_verify() */
+int ED25519_DECLSPEC ed25519_verify_batch(const unsigned char * const *signatures, const unsigned char * const *messages, const size_t *message_lens,
+                                          const unsigned char * const *public_keys, size_t count, const unsigned char *random, int *valid);
+/* checks 8*(S*B - R - h*A) == 0, ie. also accepts R and A with small order components (unlike ed25519_verify) */
+int ED25519_DECLSPEC ed25519_verify_cofactored(const unsigned char *signature, const unsigned char *message, size_t message_len, const unsigned char *public_key);
+
 
 #ifdef __cplusplus
 }
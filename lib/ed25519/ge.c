@@ -1,4 +1,19 @@
 #include "ge.h"
+
+/*
+Size of the fixed-base table used by ge_scalarmult_base() (signing, key generation):
+  1 = 30KB table, 4 doublings      (ref10 default)
+  2 = 15KB table, 12 doublings
+  4 = 7.5KB table, 28 doublings
+*/
+#ifndef ED25519_BASE_STRIDE
+  #if defined(NRF52_PLATFORM)
+    #define ED25519_BASE_STRIDE 2
+  #else
+    #define ED25519_BASE_STRIDE 1
+  #endif
+#endif
+
 #include "precomp_data.h"
 
 
@@ -389,7 +404,8 @@ void ge_scalarmult_base(ge_p3 *h, const unsigned char *a) {
     ge_p1p1 r;
     ge_p2 s;
     ge_precomp t;
-    int i;
+    const int span = 2 * ED25519_BASE_STRIDE;
+    int i, j;
 
     for (i = 0; i < 32; ++i) {
         e[2 * i + 0] = (a[i] >> 0) & 15;
@@ -411,25 +427,24 @@ void ge_scalarmult_base(ge_p3 *h, const unsigned char *a) {
     /* each e[i] is between -8 and 8 */
     ge_p3_0(h);
 
-    for (i = 1; i < 64; i += 2) {
-        select(&t, i / 2, e[i]);
-        ge_madd(&r, h, &t);
-        ge_p1p1_to_p3(h, &r);
-    }
+    /* table row m covers digits e[m*span .. m*span + span-1], so do one pass per digit offset, highest first */
+    for (j = span - 1; j >= 0; --j) {
+        if (j != span - 1) {    /* h = 16*h */
+            ge_p3_dbl(&r, h);
+            ge_p1p1_to_p2(&s, &r);
+            ge_p2_dbl(&r, &s);
+            ge_p1p1_to_p2(&s, &r);
+            ge_p2_dbl(&r, &s);
+            ge_p1p1_to_p2(&s, &r);
+            ge_p2_dbl(&r, &s);
+            ge_p1p1_to_p3(h, &r);
+        }
 
-    ge_p3_dbl(&r, h);
-    ge_p1p1_to_p2(&s, &r);
-    ge_p2_dbl(&r, &s);
-    ge_p1p1_to_p2(&s, &r);
-    ge_p2_dbl(&r, &s);
-    ge_p1p1_to_p2(&s, &r);
-    ge_p2_dbl(&r, &s);
-    ge_p1p1_to_p3(h, &r);
-
-    for (i = 0; i < 64; i += 2) {
-        select(&t, i / 2, e[i]);
-        ge_madd(&r, h, &t);
-        ge_p1p1_to_p3(h, &r);
+        for (i = j; i < 64; i += span) {
+            select(&t, i / span, e[i]);
+            ge_madd(&r, h, &t);
+            ge_p1p1_to_p3(h, &r);
+        }
     }
 }
 
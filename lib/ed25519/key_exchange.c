@@ -1,7 +1,30 @@
 #include "ed_25519.h"
 #include "fe.h"
 
+void ed25519_key_to_montgomery(unsigned char *montgomery_u, const unsigned char *public_key) {
+    fe x1;
+    fe tmp0;
+    fe tmp1;
+
+    /* unpack the public key and convert edwards to montgomery */
+    /* due to CodesInChaos: montgomeryX = (edwardsY + 1)*inverse(1 - edwardsY) mod p */
+    fe_frombytes(x1, public_key);
+    fe_1(tmp1);
+    fe_add(tmp0, x1, tmp1);
+    fe_sub(tmp1, tmp1, x1);
+    fe_invert(tmp1, tmp1);
+    fe_mul(x1, tmp0, tmp1);
+    fe_tobytes(montgomery_u, x1);
+}
+
 void ed25519_key_exchange(unsigned char *shared_secret, const unsigned char *public_key, const unsigned char *private_key) {
+    unsigned char u[32];
+
+    ed25519_key_to_montgomery(u, public_key);
+    ed25519_key_exchange_montgomery(shared_secret, u, private_key);
+}
+
+void ed25519_key_exchange_montgomery(unsigned char *shared_secret, const unsigned char *montgomery_u, const unsigned char *private_key) {
     unsigned char e[32];
     unsigned int i;
     
@@ -26,14 +49,7 @@ void ed25519_key_exchange(unsigned char *shared_secret, const unsigned char *pub
     e[31] &= 63;
     e[31] |= 64;
 
-    /* unpack the public key and convert edwards to montgomery */
-    /* due to CodesInChaos: montgomeryX = (edwardsY + 1)*inverse(1 - edwardsY) mod p */
-    fe_frombytes(x1, public_key);
-    fe_1(tmp1);
-    fe_add(tmp0, x1, tmp1);
-    fe_sub(tmp1, tmp1, x1);
-    fe_invert(tmp1, tmp1);
-    fe_mul(x1, tmp0, tmp1);
+    fe_frombytes(x1, montgomery_u);
 
     fe_1(x2);
     fe_0(z2);
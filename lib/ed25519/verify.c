@@ -1,8 +1,11 @@
+#include <string.h>
 #include "ed_25519.h"
 #include "sha512.h"
 #include "ge.h"
 #include "sc.h"
 
+typedef char point_size_check[(sizeof(ge_p3) == ED25519_POINT_SIZE) ? 1 : -1];
+
 static int consttime_equal(const unsigned char *x, const unsigned char *y) {
     unsigned char r = 0;
 
@@ -44,7 +47,17 @@ static int consttime_equal(const unsigned char *x, const unsigned char *y) {
     return !r;
 }
 
-int ed25519_verify(const unsigned char *signature, const unsigned char *message, size_t message_len, const unsigned char *public_key) {
+int ed25519_decompress_key(unsigned char *point, const unsigned char *public_key) {
+    ge_p3 A;
+
+    if (ge_frombytes_negate_vartime(&A, public_key) != 0) {
+        return 0;
+    }
+    memcpy(point, &A, sizeof(A));
+    return 1;
+}
+
+int ed25519_verify_decompressed(const unsigned char *signature, const unsigned char *message, size_t message_len, const unsigned char *public_key, const unsigned char *point) {
     unsigned char h[64];
     unsigned char checker[32];
     sha512_context hash;
@@ -55,9 +68,7 @@ int ed25519_verify(const unsigned char *signature, const unsigned char *message,
         return 0;
     }
 
-    if (ge_frombytes_negate_vartime(&A, public_key) != 0) {
-        return 0;
-    }
+    memcpy(&A, point, sizeof(A));   /* 'point' may not be aligned */
 
     sha512_init(&hash);
     sha512_update(&hash, signature, 32);
@@ -75,3 +86,12 @@ int ed25519_verify(const unsigned char *signature, const unsigned char *message,
 
     return 1;
 }
+
+int ed25519_verify(const unsigned char *signature, const unsigned char *message, size_t message_len, const unsigned char *public_key) {
+    unsigned char point[ED25519_POINT_SIZE];
+
+    if (!ed25519_decompress_key(point, public_key)) {
+        return 0;
+    }
+    return ed25519_verify_decompressed(signature, message, message_len, public_key, point);
+}
@@ -0,0 +1,235 @@
+#include <string.h>
+#include "ed_25519.h"
+#include "sha512.h"
+#include "ge.h"
+#include "sc.h"
+
+/*
+Batch verification: for random 128-bit z_i, checks
+    8 * (sum(z_i * S_i) * B - sum(z_i * R_i) - sum(z_i * h_i * A_i)) == 0
+with a single interleaved (Straus) multi-scalar multiplication, so the 256
+point doublings are shared by every signature in the batch.
+
+The check is cofactored (the final * 8). Without it, small order (torsion)
+components in R or A can cancel out between signatures, so a batch could
+pass where one of its signatures checked alone would not. A cofactored
+batch passes exactly when every signature passes the cofactored check on
+its own, ed25519_verify_cofactored(). NOTE: that differs from the
+cofactorless ed25519_verify() only for signatures with torsion components,
+which only the key's owner can make.
+
+The working tables are static (not re-entrant), sized by ED25519_BATCH_MAX.
+Each signature needs 2 points x 4 cached multiples, plus the signed digits.
+*/
+
+#ifndef ED25519_BATCH_MAX
+#define ED25519_BATCH_MAX 4
+#endif
+
+#define BATCH_POINTS  (2 * ED25519_BATCH_MAX + 1)
+
+static ge_cached batch_tables[BATCH_POINTS][4];   /* P,3P,5P,7P */
+static signed char batch_slides[BATCH_POINTS][256];
+
+/* width-4 NAF style recoding, digits are odd and in [-7, 7] */
+static void slide4(signed char *r, const unsigned char *a) {
+    int i;
+    int b;
+    int k;
+
+    for (i = 0; i < 256; ++i) {
+        r[i] = 1 & (a[i >> 3] >> (i & 7));
+    }
+
+    for (i = 0; i < 256; ++i)
+        if (r[i]) {
+            for (b = 1; b <= 3 && i + b < 256; ++b) {
+                if (r[i + b]) {
+                    if (r[i] + (r[i + b] << b) <= 7) {
+                        r[i] += r[i + b] << b;
+                        r[i + b] = 0;
+                    } else if (r[i] - (r[i + b] << b) >= -7) {
+                        r[i] -= r[i + b] << b;
+
+                        for (k = i + b; k < 256; ++k) {
+                            if (!r[k]) {
+                                r[k] = 1;
+                                break;
+                            }
+
+                            r[k] = 0;
+                        }
+                    } else {
+                        break;
+                    }
+                }
+            }
+        }
+}
+
+static void fill_table(ge_cached *table, const ge_p3 *P) {
+    ge_p1p1 t;
+    ge_p3 u;
+    ge_p3 P2;
+    int i;
+
+    ge_p3_to_cached(&table[0], P);
+    ge_p3_dbl(&t, P);
+    ge_p1p1_to_p3(&P2, &t);
+
+    for (i = 1; i < 4; i++) {
+        ge_add(&t, &P2, &table[i - 1]);
+        ge_p1p1_to_p3(&u, &t);
+        ge_p3_to_cached(&table[i], &u);
+    }
+}
+
+static int is_identity(const ge_p2 *P) {
+    unsigned char enc[32];
+    unsigned char r = 0;
+    int i;
+
+    ge_tobytes(enc, P);
+    r = enc[0] ^ 1;
+    for (i = 1; i < 32; i++) {
+        r |= enc[i];
+    }
+    return !r;
+}
+
+static int verify_chunk(const unsigned char * const *signatures, const unsigned char * const *messages, const size_t *message_lens,
+                        const unsigned char * const *public_keys, size_t count, const unsigned char *random) {
+    unsigned char h[64];
+    unsigned char z[32];
+    unsigned char scalar[32];
+    unsigned char s_sum[32];
+    const unsigned char zero[32] = {0};
+    sha512_context hash;
+    ge_p3 P;
+    ge_p2 r;
+    ge_p1p1 t;
+    ge_p3 u;
+    size_t n_points = 2 * count + 1;
+    size_t i, j;
+    int bit;
+
+    memset(s_sum, 0, sizeof(s_sum));
+    memset(z, 0, sizeof(z));
+
+    for (i = 0; i < count; i++) {
+        const unsigned char *sig = signatures[i];
+
+        if (sig[63] & 224) {
+            return 0;
+        }
+
+        /* points are decoded negated, so the terms below are -z*R and -z*h*A */
+        if (ge_frombytes_negate_vartime(&P, sig) != 0) {
+            return 0;
+        }
+        fill_table(batch_tables[2 * i], &P);
+
+        if (ge_frombytes_negate_vartime(&P, public_keys[i]) != 0) {
+            return 0;
+        }
+        fill_table(batch_tables[2 * i + 1], &P);
+
+        sha512_init(&hash);
+        sha512_update(&hash, sig, 32);
+        sha512_update(&hash, public_keys[i], 32);
+        sha512_update(&hash, messages[i], message_lens[i]);
+        sha512_final(&hash, h);
+        sc_reduce(h);
+
+        memcpy(z, &random[16 * i], 16);
+        z[0] |= 1;   /* never zero */
+
+        slide4(batch_slides[2 * i], z);
+        sc_muladd(scalar, z, h, zero);
+        slide4(batch_slides[2 * i + 1], scalar);
+        sc_muladd(s_sum, z, sig + 32, s_sum);
+    }
+
+    /* base point term, +sum(z*S)*B */
+    memset(scalar, 0, sizeof(scalar));
+    scalar[0] = 1;
+    ge_scalarmult_base(&P, scalar);
+    fill_table(batch_tables[2 * count], &P);
+    slide4(batch_slides[2 * count], s_sum);
+
+    for (bit = 255; bit >= 0; --bit) {
+        for (j = 0; j < n_points; j++) {
+            if (batch_slides[j][bit]) {
+                break;
+            }
+        }
+        if (j < n_points) {
+            break;
+        }
+    }
+
+    ge_p2_0(&r);
+
+    for (; bit >= 0; --bit) {
+        ge_p2_dbl(&t, &r);
+
+        for (j = 0; j < n_points; j++) {
+            signed char d = batch_slides[j][bit];
+
+            if (d > 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_add(&t, &u, &batch_tables[j][d / 2]);
+            } else if (d < 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_sub(&t, &u, &batch_tables[j][(-d) / 2]);
+            }
+        }
+
+        ge_p1p1_to_p2(&r, &t);
+    }
+
+    for (i = 0; i < 3; i++) {   /* cofactor */
+        ge_p2_dbl(&t, &r);
+        ge_p1p1_to_p2(&r, &t);
+    }
+
+    return is_identity(&r);
+}
+
+int ed25519_verify_cofactored(const unsigned char *signature, const unsigned char *message, size_t message_len, const unsigned char *public_key) {
+    static const unsigned char one[16] = {1};
+
+    return verify_chunk(&signature, &message, &message_len, &public_key, 1, one);
+}
+
+int ed25519_verify_batch(const unsigned char * const *signatures, const unsigned char * const *messages, const size_t *message_lens,
+                         const unsigned char * const *public_keys, size_t count, const unsigned char *random, int *valid) {
+    int all_ok = 1;
+    size_t i, n;
+
+    for (i = 0; i < count; i += n) {
+        n = count - i;
+        if (n > ED25519_BATCH_MAX) {
+            n = ED25519_BATCH_MAX;
+        }
+
+        if (verify_chunk(&signatures[i], &messages[i], &message_lens[i], &public_keys[i], n, &random[16 * i])) {
+            if (valid) {
+                size_t k;
+                for (k = 0; k < n; k++) valid[i + k] = 1;
+            }
+        } else {
+            all_ok = 0;
+            if (valid) {   /* find the bad one(s) */
+                size_t k;
+                for (k = 0; k < n; k++) {
+                    valid[i + k] = ed25519_verify_cofactored(signatures[i + k], messages[i + k], message_lens[i + k], public_keys[i + k]);
+                }
+            } else {
+                break;
+            }
+        }
+    }
+
+    return all_ok;
+}
@@ -10,7 +10,6 @@ namespace mesh {
 
 #define MAX_RX_DELAY_MILLIS        32000  // 32 seconds
 #define MIN_TX_BUDGET_RESERVE_MS   100    // min budget (ms) required before allowing next TX
-#define MIN_TX_BUDGET_AIRTIME_DIV  2      // require at least 1/N of estimated airtime as budget before TX
 
 #ifndef NOISE_FLOOR_CALIB_INTERVAL
   #define NOISE_FLOOR_CALIB_INTERVAL   2000     // 2 seconds
@@ -22,34 +21,90 @@ void Dispatcher::begin() {
   _err_flags = 0;
   radio_nonrx_start = _ms->getMillis();
 
-  duty_cycle_window_ms = getDutyCycleWindowMs();
-  float duty_cycle = 1.0f / (1.0f + getAirtimeBudgetFactor());
-  tx_budget_ms = (unsigned long)(duty_cycle_window_ms * duty_cycle);
-  last_budget_update = _ms->getMillis();
+  _duty.begin(getDutyCycleWindowMs(), _ms->getMillis());
 
   _radio->begin();
   prev_isrecv_mode = _radio->isInRecvMode();
+
+  registerMetrics();
+}
+
+void Dispatcher::registerMetrics() {
+  _metrics.addCounter(METRIC_ID_SENT_FLOOD, "sent_flood", &n_sent_flood);
+  _metrics.addCounter(METRIC_ID_SENT_DIRECT, "sent_direct", &n_sent_direct);
+  _metrics.addCounter(METRIC_ID_RECV_FLOOD, "recv_flood", &n_recv_flood);
+  _metrics.addCounter(METRIC_ID_RECV_DIRECT, "recv_direct", &n_recv_direct);
+  _metrics.addGauge(METRIC_ID_QUEUE_LEN, "queue_len", [](const void* d) -> int32_t {
+    return ((const Dispatcher *) d)->_mgr->getOutboundTotal();
+  }, this);
+  _metrics.addCounter(METRIC_ID_TX_AIR_SECS, "tx_air_secs", [](const void* d) -> int32_t {
+    return ((const Dispatcher *) d)->total_air_time / 1000;
+  }, this);
+  _metrics.addCounter(METRIC_ID_RX_AIR_SECS, "rx_air_secs", [](const void* d) -> int32_t {
+    return ((const Dispatcher *) d)->rx_air_time / 1000;
+  }, this);
+  _metrics.addGauge(METRIC_ID_ERR_FLAGS, "errors", [](const void* d) -> int32_t {
+    return ((const Dispatcher *) d)->_err_flags;
+  }, this);
+  _metrics.addCounter(METRIC_ID_UPTIME_SECS, "uptime_secs", [](const void* d) -> int32_t {
+    return ((const Dispatcher *) d)->_ms->getMillis() / 1000;
+  }, this);
+  _metrics.addGauge(METRIC_ID_NOISE_FLOOR, "noise_floor", [](const void* r) -> int32_t {
+    return ((const Radio *) r)->getNoiseFloor();
+  }, _radio);
+  _metrics.addGauge(METRIC_ID_LAST_RSSI, "last_rssi", [](const void* r) -> int32_t {
+    return (int32_t) ((const Radio *) r)->getLastRSSI();
+  }, _radio);
+  _metrics.addGauge(METRIC_ID_LAST_SNR_X4, "last_snr_x4", [](const void* r) -> int32_t {
+    return (int32_t) (((const Radio *) r)->getLastSNR() * 4);
+  }, _radio);
+  _metrics.addHistogram(METRIC_ID_FWD_DELAY_MS, "fwd_delay_ms", &_fwd_delay);
+  _metrics.addHistogram(METRIC_ID_QUEUE_WAIT_MS, "queue_wait_ms", &_queue_wait);
+
+  _radio->registerMetrics(_metrics);
 }
 
 float Dispatcher::getAirtimeBudgetFactor() const {
   return 1.0;
 }
 
-void Dispatcher::updateTxBudget() {
-  unsigned long now = _ms->getMillis();
-  unsigned long elapsed = now - last_budget_update;
-
+uint32_t Dispatcher::getDutyCycleLimit(uint8_t band) const {
   float duty_cycle = 1.0f / (1.0f + getAirtimeBudgetFactor());
-  unsigned long max_budget = (unsigned long)(getDutyCycleWindowMs() * duty_cycle);
-  unsigned long refill = (unsigned long)(elapsed * duty_cycle);
-  
-  if (refill > 0) {
-    tx_budget_ms += refill;
-    if (tx_budget_ms > max_budget) {
-      tx_budget_ms = max_budget;
+  float band_limit = getBandDutyCycle(band);
+  if (band_limit < duty_cycle) {
+    duty_cycle = band_limit;
+  }
+  return (uint32_t)(_duty.getWindowMillis() * duty_cycle);
+}
+
+unsigned long Dispatcher::getRemainingTxBudget() {
+  uint8_t band = getDutyCycleBand();
+  return _duty.getAvailable(band, getDutyCycleLimit(band), _ms->getMillis());
+}
+
+int Dispatcher::getMaxLenForAirtime(uint32_t airtime_ms) {
+  if (_radio->getEstAirtimeFor(MAX_TRANS_UNIT) <= airtime_ms) return MAX_TRANS_UNIT;
+
+  int lo = 0, hi = MAX_TRANS_UNIT;   // airtime(lo) fits (or lo is zero), airtime(hi) doesn't
+  while (hi - lo > 1) {
+    int mid = (lo + hi) / 2;
+    if (_radio->getEstAirtimeFor(mid) <= airtime_ms) {
+      lo = mid;
+    } else {
+      hi = mid;
     }
-    last_budget_update = now;
   }
+  return lo;
+}
+
+uint32_t Dispatcher::getMinQueuedAirtime() {
+  int min_len = MAX_TRANS_UNIT;
+  int n = _mgr->getOutboundTotal();
+  for (int i = 0; i < n; i++) {
+    int len = _mgr->getOutboundByIdx(i)->getRawLength();
+    if (len < min_len) min_len = len;
+  }
+  return _radio->getEstAirtimeFor(min_len);
 }
 
 int Dispatcher::calcRxDelay(float score, uint32_t air_time) const {
@@ -89,21 +144,13 @@ void Dispatcher::loop() {
       total_air_time += t;
       //Serial.print("  airtime="); Serial.println(t);
 
-      updateTxBudget();
+      uint8_t band = getDutyCycleBand();
+      uint32_t limit = getDutyCycleLimit(band);
+      _duty.recordTx(band, t, _ms->getMillis());
 
-      if (t > tx_budget_ms) {
-        tx_budget_ms = 0;
-      } else {
-        tx_budget_ms -= t;
-      }
-
-      if (tx_budget_ms < MIN_TX_BUDGET_RESERVE_MS) {
-        float duty_cycle = 1.0f / (1.0f + getAirtimeBudgetFactor());
-        unsigned long needed = MIN_TX_BUDGET_RESERVE_MS - tx_budget_ms;
-        next_tx_time = futureMillis((unsigned long)(needed / duty_cycle));
-      } else {
-        next_tx_time = _ms->getMillis();
-      }
+      uint32_t wait = _duty.millisUntilAllowed(band, limit, MIN_TX_BUDGET_RESERVE_MS, _ms->getMillis());
+      if (wait == DUTY_CYCLE_NEVER) wait = 0;   // limit is tiny, leave it to checkSend()
+      next_tx_time = futureMillis(wait);
 
       _radio->onSendFinished();
       logTx(outbound, 2 + outbound->getPathByteLen() + outbound->payload_len);
@@ -204,6 +251,7 @@ void Dispatcher::checkRecv() {
       } else {
         if (tryParsePacket(pkt, raw, len)) {
           pkt->_snr = _radio->getLastSNR() * 4.0f;
+          pkt->_rx_millis = _ms->getMillis();
           score = _radio->packetScore(_radio->getLastSNR(), len);
           air_time = _radio->getEstAirtimeFor(len);
           rx_air_time += air_time;
@@ -268,24 +316,18 @@ void Dispatcher::processRecvPacket(Packet* pkt) {
     uint8_t priority = (action >> 24) - 1;
     uint32_t _delay = action & 0xFFFFFF;
 
-    _mgr->queueOutbound(pkt, priority, futureMillis(_delay));
+    pkt->_due_millis = futureMillis(_delay);
+    _mgr->queueOutbound(pkt, priority, pkt->_due_millis);
   }
 }
 
 void Dispatcher::checkSend() {
   if (_mgr->getOutboundCount(_ms->getMillis()) == 0) return;
-  
-  updateTxBudget();
-  
-  uint32_t est_airtime = _radio->getEstAirtimeFor(MAX_TRANS_UNIT);
-  if (tx_budget_ms < est_airtime / MIN_TX_BUDGET_AIRTIME_DIV) {
-    float duty_cycle = 1.0f / (1.0f + getAirtimeBudgetFactor());
-    unsigned long needed = est_airtime / MIN_TX_BUDGET_AIRTIME_DIV - tx_budget_ms;
-    next_tx_time = futureMillis((unsigned long)(needed / duty_cycle));
-    return;
-  }
-  
   if (!millisHasNowPassed(next_tx_time)) return;
+
+  uint8_t band = getDutyCycleBand();
+  uint32_t limit = getDutyCycleLimit(band);
+  int max_len = getMaxLenForAirtime(_duty.getAvailable(band, limit, _ms->getMillis()));
   if (_radio->isReceiving()) {
     if (cad_busy_start == 0) {
       cad_busy_start = _ms->getMillis();   // record when CAD busy state started
@@ -304,7 +346,7 @@ void Dispatcher::checkSend() {
   }
   cad_busy_start = 0;  // reset busy state
 
-  outbound = _mgr->getNextOutbound(_ms->getMillis());
+  outbound = _mgr->getNextOutbound(_ms->getMillis(), max_len);   // next packet that fits in the remaining airtime
   if (outbound) {
     int len = 0;
     uint8_t raw[MAX_TRANS_UNIT];
@@ -326,6 +368,9 @@ void Dispatcher::checkSend() {
 
       uint32_t max_airtime = _radio->getEstAirtimeFor(len)*3/2;
       outbound_start = _ms->getMillis();
+      int32_t wait = outbound_start - outbound->_due_millis;
+      _queue_wait.add(wait > 0 ? wait : 0);
+      if (outbound->_rx_millis) _fwd_delay.add(outbound_start - outbound->_rx_millis);
       bool success = _radio->startSendRaw(raw, len);
       if (!success) {
         MESH_DEBUG_PRINTLN("%s Dispatcher::loop(): ERROR: send start failed!", getLogDateTime());
@@ -350,6 +395,10 @@ void Dispatcher::checkSend() {
       }
     #endif
     }
+  } else {
+    // nothing due fits, wait until the smallest queued packet would (re-checked then, as queue may have changed)
+    uint32_t wait = _duty.millisUntilAllowed(band, limit, getMinQueuedAirtime(), _ms->getMillis());
+    next_tx_time = futureMillis(wait == DUTY_CYCLE_NEVER ? _duty.getBucketMillis() : wait);
   }
 }
 
@@ -360,6 +409,7 @@ Packet* Dispatcher::obtainNewPacket() {
   } else {
     pkt->payload_len = pkt->path_len = 0;
     pkt->_snr = 0;
+    pkt->_rx_millis = 0;
   }
   return pkt;
 }
@@ -373,7 +423,8 @@ void Dispatcher::sendPacket(Packet* packet, uint8_t priority, uint32_t delay_mil
     MESH_DEBUG_PRINTLN("%s Dispatcher::sendPacket(): ERROR: invalid packet... path_len=%d, payload_len=%d", getLogDateTime(), (uint32_t) packet->path_len, (uint32_t) packet->payload_len);
     _mgr->free(packet);
   } else {
-    _mgr->queueOutbound(packet, priority, futureMillis(delay_millis));
+    packet->_due_millis = futureMillis(delay_millis);
+    _mgr->queueOutbound(packet, priority, packet->_due_millis);
   }
 }
 
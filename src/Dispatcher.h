@@ -4,6 +4,8 @@
 #include <Identity.h>
 #include <Packet.h>
 #include <Utils.h>
+#include <DutyCycle.h>
+#include <Metrics.h>
 #include <string.h>
 
 namespace mesh {
@@ -78,6 +80,11 @@ public:
 
   virtual float getLastRSSI() const { return 0; }
   virtual float getLastSNR() const { return 0; }
+
+  /**
+   * \brief  adds any driver specific metrics (eg. packet counters) to the registry
+   */
+  virtual void registerMetrics(MetricsRegistry& metrics) { }
 };
 
 /**
@@ -91,6 +98,7 @@ public:
 
   virtual void queueOutbound(Packet* packet, uint8_t priority, uint32_t scheduled_for) = 0;
   virtual Packet* getNextOutbound(uint32_t now) = 0;    // by priority
+  virtual Packet* getNextOutbound(uint32_t now, int max_raw_len) = 0;    // by priority, of those that are no longer than max_raw_len
   virtual int getOutboundCount(uint32_t now) const = 0;
   virtual int getOutboundTotal() const = 0;
   virtual int getFreeCount() const = 0;
@@ -98,6 +106,8 @@ public:
   virtual Packet* removeOutboundByIdx(int i) = 0;
   virtual void queueInbound(Packet* packet, uint32_t scheduled_for) = 0;
   virtual Packet* getNextInbound(uint32_t now) = 0;
+  virtual int getInboundTotal() const = 0;
+  virtual Packet* getInboundByIdx(int i) = 0;
 };
 
 typedef uint32_t  DispatcherAction;
@@ -125,12 +135,14 @@ class Dispatcher {
   bool  prev_isrecv_mode;
   uint32_t n_sent_flood, n_sent_direct;
   uint32_t n_recv_flood, n_recv_direct;
-  unsigned long tx_budget_ms;
-  unsigned long last_budget_update;
-  unsigned long duty_cycle_window_ms;
+  DutyCycleTracker _duty;
+  MetricHistogram _fwd_delay, _queue_wait;
+  MetricsRegistry _metrics;
 
+  void registerMetrics();
   void processRecvPacket(Packet* pkt);
-  void updateTxBudget();
+  int getMaxLenForAirtime(uint32_t airtime_ms);
+  uint32_t getMinQueuedAirtime();
 
 protected:
   PacketManager* _mgr;
@@ -149,9 +161,6 @@ protected:
     _err_flags = 0;
     radio_nonrx_start = 0;
     prev_isrecv_mode = true;
-    tx_budget_ms = 0;
-    last_budget_update = 0;
-    duty_cycle_window_ms = 3600000;
   }
 
   virtual DispatcherAction onRecvPacket(Packet* pkt) = 0;
@@ -172,6 +181,13 @@ protected:
   virtual int getAGCResetInterval() const { return 0; }    // disabled by default
   virtual unsigned long getDutyCycleWindowMs() const { return 3600000; }
 
+  /**
+   * \brief  the regulated sub-band the radio is transmitting in. TX airtime is accounted separately per band.
+   * \returns  band ID, eg. DutyCycleTracker::findEU868Band(freq), or DUTY_CYCLE_BAND_NONE (the default)
+   */
+  virtual uint8_t getDutyCycleBand() const { return DUTY_CYCLE_BAND_NONE; }
+  virtual float getBandDutyCycle(uint8_t band) const { return DutyCycleTracker::getEU868DutyCycle(band); }
+
 public:
   void begin();
   void loop();
@@ -182,7 +198,14 @@ public:
 
   unsigned long getTotalAirTime() const { return total_air_time; }
   unsigned long getReceiveAirTime() const {return rx_air_time; }
-  unsigned long getRemainingTxBudget() const { return tx_budget_ms; }
+  unsigned long getRemainingTxBudget();    // in current duty-cycle band
+
+  /**
+   * \returns  max TX airtime (millis) per duty-cycle window in 'band', the lower of the airtime budget factor and band's limit
+   */
+  uint32_t getDutyCycleLimit(uint8_t band) const;
+  uint8_t getCurrentDutyCycleBand() const { return getDutyCycleBand(); }
+  DutyCycleTracker& getDutyCycleTracker() { _duty.update(_ms->getMillis()); return _duty; }
   uint32_t getNumSentFlood() const { return n_sent_flood; }
   uint32_t getNumSentDirect() const { return n_sent_direct; }
   uint32_t getNumRecvFlood() const { return n_recv_flood; }
@@ -190,8 +213,17 @@ public:
   void resetStats() {
     n_sent_flood = n_sent_direct = n_recv_flood = n_recv_direct = 0;
     _err_flags = 0;
+    _fwd_delay.reset();
+    _queue_wait.reset();
   }
 
+  /**
+   * \brief  counters, gauges and histograms of every layer, registered at begin()
+   */
+  MetricsRegistry& getMetrics() { return _metrics; }
+  const MetricHistogram& getForwardDelay() const { return _fwd_delay; }
+  const MetricHistogram& getQueueWait() const { return _queue_wait; }
+
   // helper methods
   bool millisHasNowPassed(unsigned long timestamp) const;
   unsigned long futureMillis(int millis_from_now) const;
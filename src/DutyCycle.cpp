@@ -0,0 +1,127 @@
+#include "DutyCycle.h"
+#include <string.h>
+
+namespace mesh {
+
+struct SubBand {
+  float lo, hi;      // MHz
+  float duty_cycle;
+};
+
+// ERC REC 70-03 annex 1, the gaps between sub-bands held to the strictest limit
+static const SubBand eu868_bands[] = {
+  { 863.0f,  865.0f,  0.001f },
+  { 865.0f,  868.0f,  0.01f },
+  { 868.0f,  868.6f,  0.01f },
+  { 868.6f,  868.7f,  0.001f },
+  { 868.7f,  869.2f,  0.001f },
+  { 869.2f,  869.4f,  0.001f },
+  { 869.4f,  869.65f, 0.1f },
+  { 869.65f, 869.7f,  0.001f },
+  { 869.7f,  870.0f,  0.01f },
+};
+
+#define NUM_EU868_BANDS  ((int)(sizeof(eu868_bands) / sizeof(eu868_bands[0])))
+
+uint8_t DutyCycleTracker::findEU868Band(float freq) {
+  for (int i = 0; i < NUM_EU868_BANDS; i++) {
+    if (freq >= eu868_bands[i].lo && freq < eu868_bands[i].hi) return i + 1;
+  }
+  return DUTY_CYCLE_BAND_NONE;
+}
+
+float DutyCycleTracker::getEU868DutyCycle(uint8_t band) {
+  if (band == DUTY_CYCLE_BAND_NONE || band > NUM_EU868_BANDS) return 1.0f;
+  return eu868_bands[band - 1].duty_cycle;
+}
+
+void DutyCycleTracker::begin(uint32_t window_ms, uint32_t now) {
+  memset(_bands, 0, sizeof(_bands));
+  _window_ms = window_ms;
+  _bucket_ms = (window_ms + DUTY_CYCLE_BUCKETS - 2) / (DUTY_CYCLE_BUCKETS - 1);   // round up
+  if (_bucket_ms == 0) _bucket_ms = 1;
+  _head = 0;
+  _head_start = now;
+}
+
+void DutyCycleTracker::update(uint32_t now) {
+  uint32_t elapsed = now - _head_start;
+  if (elapsed < _bucket_ms) return;
+
+  uint32_t steps = elapsed / _bucket_ms;
+  _head_start += steps * _bucket_ms;
+  if (steps >= DUTY_CYCLE_BUCKETS) {   // idle for more than a window, all of ring has expired
+    for (int b = 0; b < DUTY_CYCLE_MAX_BANDS; b++) {
+      memset(_bands[b].buckets, 0, sizeof(_bands[b].buckets));
+      _bands[b].used = 0;
+    }
+    return;
+  }
+  while (steps > 0) {
+    _head = (_head + 1) % DUTY_CYCLE_BUCKETS;   // oldest bucket becomes the new head
+    for (int b = 0; b < DUTY_CYCLE_MAX_BANDS; b++) {
+      _bands[b].used -= _bands[b].buckets[_head];
+      _bands[b].buckets[_head] = 0;
+    }
+    steps--;
+  }
+}
+
+DutyCycleTracker::Band* DutyCycleTracker::findBand(uint8_t id, bool create) {
+  Band* evict = NULL;
+  for (int b = 0; b < DUTY_CYCLE_MAX_BANDS; b++) {
+    Band* band = &_bands[b];
+    if (band->in_use && band->id == id) return band;
+
+    if (!band->in_use) {
+      if (evict == NULL || evict->in_use) evict = band;
+    } else if (evict == NULL || (evict->in_use && band->used < evict->used)) {
+      evict = band;   // least used, if no free slot
+    }
+  }
+  if (!create) return NULL;
+
+  memset(evict, 0, sizeof(*evict));
+  evict->id = id;
+  evict->in_use = true;
+  return evict;
+}
+
+void DutyCycleTracker::recordTx(uint8_t band, uint32_t airtime_ms, uint32_t now) {
+  update(now);
+  Band* b = findBand(band, true);
+  b->buckets[_head] += airtime_ms;
+  b->used += airtime_ms;
+}
+
+uint32_t DutyCycleTracker::getUsed(uint8_t band, uint32_t now) {
+  update(now);
+  Band* b = findBand(band, false);
+  return b ? b->used : 0;
+}
+
+uint32_t DutyCycleTracker::getAvailable(uint8_t band, uint32_t limit_ms, uint32_t now) {
+  uint32_t used = getUsed(band, now);
+  return used >= limit_ms ? 0 : limit_ms - used;
+}
+
+uint32_t DutyCycleTracker::millisUntilAllowed(uint8_t band, uint32_t limit_ms, uint32_t airtime_ms, uint32_t now) {
+  if (airtime_ms > limit_ms) return DUTY_CYCLE_NEVER;
+
+  update(now);
+  Band* b = findBand(band, false);
+  if (b == NULL || b->used + airtime_ms <= limit_ms) return 0;
+
+  // bucket of age 'a' (head is age 0) is dropped (N - a) buckets after the head started
+  uint32_t excess = b->used + airtime_ms - limit_ms;
+  uint32_t freed = 0;
+  for (int a = DUTY_CYCLE_BUCKETS - 1; a >= 0; a--) {
+    freed += b->buckets[(_head + DUTY_CYCLE_BUCKETS - a) % DUTY_CYCLE_BUCKETS];
+    if (freed >= excess) {
+      return _head_start + (DUTY_CYCLE_BUCKETS - a) * _bucket_ms - now;
+    }
+  }
+  return DUTY_CYCLE_NEVER;  // not reachable, as used >= excess
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifndef DUTY_CYCLE_BUCKETS
+  #define DUTY_CYCLE_BUCKETS     61    // ring size, the window is covered by (DUTY_CYCLE_BUCKETS - 1) buckets
+#endif
+#ifndef DUTY_CYCLE_MAX_BANDS
+  #define DUTY_CYCLE_MAX_BANDS    2    // sub-bands tracked at once (ie. current one, plus previous after a freq change)
+#endif
+
+#define DUTY_CYCLE_BAND_NONE      0    // not in a regulated sub-band
+#define DUTY_CYCLE_NEVER  0xFFFFFFFF
+
+namespace mesh {
+
+/**
+ * \brief  Sliding window record of TX airtime, per sub-band, as a ring of fixed length time buckets.
+ *
+ *   The window is split in (DUTY_CYCLE_BUCKETS - 1) buckets, and a bucket is only dropped once ALL of the
+ *   airtime in it is older than the window, so the used airtime is never under-counted (at most over-counted
+ *   by one bucket length). A running total is kept per band, so the used/available airtime is O(1), and
+ *   working out when some amount of airtime will be allowed is a single pass from the oldest bucket.
+ */
+class DutyCycleTracker {
+  struct Band {
+    uint8_t id;
+    bool in_use;
+    uint32_t used;    // sum of buckets[]
+    uint32_t buckets[DUTY_CYCLE_BUCKETS];
+  };
+
+  Band _bands[DUTY_CYCLE_MAX_BANDS];
+  uint32_t _window_ms, _bucket_ms;
+  uint32_t _head_start;    // millis when the current (head) bucket started
+  uint8_t _head;
+
+  Band* findBand(uint8_t id, bool create);
+
+public:
+  DutyCycleTracker() { begin(3600000, 0); }
+
+  void begin(uint32_t window_ms, uint32_t now);
+
+  /**
+   * \brief  rotates the ring up to the current time. (called by all the methods below)
+   */
+  void update(uint32_t now);
+
+  void recordTx(uint8_t band, uint32_t airtime_ms, uint32_t now);
+
+  /**
+   * \returns  airtime used in band, over the last window
+   */
+  uint32_t getUsed(uint8_t band, uint32_t now);
+
+  /**
+   * \returns  airtime still allowed in band, if at most 'limit_ms' of airtime is allowed per window
+   */
+  uint32_t getAvailable(uint8_t band, uint32_t limit_ms, uint32_t now);
+
+  /**
+   * \returns  millis until 'airtime_ms' more airtime will be within 'limit_ms' (zero if already is),
+   *           or DUTY_CYCLE_NEVER if airtime_ms alone is over the limit
+   */
+  uint32_t millisUntilAllowed(uint8_t band, uint32_t limit_ms, uint32_t airtime_ms, uint32_t now);
+
+  uint32_t getWindowMillis() const { return _window_ms; }
+  uint32_t getBucketMillis() const { return _bucket_ms; }
+
+  // for reporting, slot 'i' is 0..DUTY_CYCLE_MAX_BANDS-1
+  bool isSlotInUse(int i) const { return _bands[i].in_use; }
+  uint8_t getSlotBand(int i) const { return _bands[i].id; }
+  uint32_t getSlotUsed(int i) const { return _bands[i].used; }
+
+  /**
+   * \returns  the EU868 (ETSI EN 300 220 / ERC REC 70-03) sub-band that 'freq' (MHz) is in, 1..9,
+   *           or DUTY_CYCLE_BAND_NONE if outside 863..870 MHz
+   */
+  static uint8_t findEU868Band(float freq);
+
+  /**
+   * \returns  max duty cycle for EU868 sub-band (0..1), or 1.0 for DUTY_CYCLE_BAND_NONE
+   */
+  static float getEU868DutyCycle(uint8_t band);
+};
+
+}
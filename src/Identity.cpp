@@ -11,6 +11,12 @@
 
 namespace mesh {
 
+static_assert(PUB_KEY_POINT_SIZE == ED25519_POINT_SIZE, "PUB_KEY_POINT_SIZE mismatch");
+
+#ifdef USE_PUBKEY_POINT_CACHE
+static PubKeyPointCache point_cache;
+#endif
+
 Identity::Identity() {
   memset(pub_key, 0, sizeof(pub_key));
 }
@@ -31,6 +37,10 @@ bool Identity::verify(const uint8_t* sig, const uint8_t* message, int msg_len) c
                                      (uint8_t*)pub_key, CRYS_ECEDW_MOD_SIZE_IN_BYTES,
                                      (uint8_t*)message, (size_t)msg_len, &cc310_tmp);
   return rc == CRYS_OK;
+#elif defined(USE_PUBKEY_POINT_CACHE)
+  // NOTE: opt-in only. This is the lib/ed25519 verify (see below), with the key decompression cached
+  const uint8_t* point = point_cache.get(pub_key);
+  return point != NULL && ed25519_verify_decompressed(sig, message, msg_len, pub_key, point);
 #elif 0
   // NOTE:  memory corruption bug was found in this function!!
   return ed25519_verify(sig, message, msg_len, pub_key);
@@ -39,6 +49,23 @@ bool Identity::verify(const uint8_t* sig, const uint8_t* message, int msg_len) c
 #endif
 }
 
+#ifdef USE_PUBKEY_POINT_CACHE
+const PubKeyPointCache& Identity::getPointCache() {
+  return point_cache;
+}
+#endif
+
+#if ADVERT_VERIFY_BATCH > 1
+bool Identity::verifyBatch(const uint8_t* const* sigs, const uint8_t* const* pub_keys, const uint8_t* const* messages, const size_t* msg_lens,
+                           int count, const uint8_t* random) {
+  return ed25519_verify_batch(sigs, messages, msg_lens, pub_keys, count, random, NULL) != 0;
+}
+#endif
+
+void Identity::calcMontgomeryKey(uint8_t* mont_u) const {
+  ed25519_key_to_montgomery(mont_u, pub_key);
+}
+
 bool Identity::readFrom(Stream& s) {
   return (s.readBytes(pub_key, PUB_KEY_SIZE) == PUB_KEY_SIZE);
 }
@@ -156,4 +183,57 @@ void LocalIdentity::calcSharedSecret(uint8_t* secret, const uint8_t* other_pub_k
   ed25519_key_exchange(secret, other_pub_key, prv_key);
 }
 
-}
\ No newline at end of file
+void LocalIdentity::calcSharedSecretMontgomery(uint8_t* secret, const uint8_t* other_mont_u) const {
+  ed25519_key_exchange_montgomery(secret, other_mont_u, prv_key);
+}
+
+PeerKeyCache::PeerKeyCache() : _clock(0), _hits(0), _misses(0) {
+  memset(_entries, 0, sizeof(_entries));
+}
+
+const uint8_t* PeerKeyCache::get(const uint8_t* pub_key) {
+  Entry* oldest = &_entries[0];
+  for (int i = 0; i < PEER_KEY_CACHE_SIZE; i++) {
+    Entry* e = &_entries[i];
+    if (e->last_used != 0 && memcmp(e->pub_key, pub_key, PUB_KEY_SIZE) == 0) {
+      e->last_used = ++_clock;
+      _hits++;
+      return e->mont_u;
+    }
+    if (e->last_used < oldest->last_used) oldest = e;
+  }
+
+  _misses++;
+  memcpy(oldest->pub_key, pub_key, PUB_KEY_SIZE);
+  ed25519_key_to_montgomery(oldest->mont_u, pub_key);
+  oldest->last_used = ++_clock;
+  return oldest->mont_u;
+}
+
+PubKeyPointCache::PubKeyPointCache() : _clock(0), _hits(0), _misses(0) {
+  memset(_entries, 0, sizeof(_entries));
+}
+
+const uint8_t* PubKeyPointCache::get(const uint8_t* pub_key) {
+  Entry* oldest = &_entries[0];
+  for (int i = 0; i < PUBKEY_POINT_CACHE_SIZE; i++) {
+    Entry* e = &_entries[i];
+    if (e->last_used != 0 && memcmp(e->pub_key, pub_key, PUB_KEY_SIZE) == 0) {
+      e->last_used = ++_clock;
+      _hits++;
+      return e->point;
+    }
+    if (e->last_used < oldest->last_used) oldest = e;
+  }
+
+  _misses++;
+  uint8_t point[PUB_KEY_POINT_SIZE];
+  if (!ed25519_decompress_key(point, pub_key)) return NULL;   // invalid key, don't evict anything for it
+
+  memcpy(oldest->pub_key, pub_key, PUB_KEY_SIZE);
+  memcpy(oldest->point, point, PUB_KEY_POINT_SIZE);
+  oldest->last_used = ++_clock;
+  return oldest->point;
+}
+
+}
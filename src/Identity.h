@@ -8,6 +8,8 @@ namespace mesh {
 /**
  * \brief  An identity in the mesh, with given Ed25519 public key, ie. a party whose signatures can be VERIFIED.
 */
+class PubKeyPointCache;
+
 class Identity {
 public:
   uint8_t pub_key[PUB_KEY_SIZE];
@@ -40,6 +42,32 @@ public:
   */
   bool verify(const uint8_t* sig, const uint8_t* message, int msg_len) const;
 
+#if ADVERT_VERIFY_BATCH > 1
+  /**
+   * \brief  Verifies several signatures together, sharing most of the curve arithmetic.
+   * \param sigs IN - 'count' signatures, each SIGNATURE_SIZE.
+   * \param pub_keys IN - 'count' public keys, each PUB_KEY_SIZE.
+   * \param random IN - 16 bytes per signature, must not be predictable by the signers.
+   * \returns true, only if ALL signatures are valid (NOTE: doesn't say which one is bad)
+   *     NOTE: cofactored, so unlike verify() also accepts signatures with small order components in R or the key
+  */
+  static bool verifyBatch(const uint8_t* const* sigs, const uint8_t* const* pub_keys, const uint8_t* const* messages, const size_t* msg_lens,
+                          int count, const uint8_t* random);
+#endif
+
+  /**
+   * \brief  Converts pub_key to X25519 (Montgomery u) form, for use with LocalIdentity::calcSharedSecretMontgomery()
+   * \param mont_u OUT - must be PUB_KEY_SIZE buffer.
+  */
+  void calcMontgomeryKey(uint8_t* mont_u) const;
+
+#ifdef USE_PUBKEY_POINT_CACHE
+  /**
+   * \returns  the (shared) cache of decompressed public keys, used by verify()
+  */
+  static const PubKeyPointCache& getPointCache();
+#endif
+
   bool matches(const Identity& other) const { return memcmp(pub_key, other.pub_key, PUB_KEY_SIZE) == 0; }
   bool matches(const uint8_t* other_pubkey) const { return memcmp(pub_key, other_pubkey, PUB_KEY_SIZE) == 0; }
 
@@ -80,6 +108,13 @@ public:
   */
   void calcSharedSecret(uint8_t* secret, const uint8_t* other_pub_key) const;
 
+  /**
+   * \brief  the ECDH key exhange, with other party's key already transposed to Ex25519 (skips a field inversion).
+   * \param  secret OUT - the 'shared secret' (must be PUB_KEY_SIZE bytes)
+   * \param  other_mont_u IN - from Identity::calcMontgomeryKey() (must be PUB_KEY_SIZE bytes)
+  */
+  void calcSharedSecretMontgomery(uint8_t* secret, const uint8_t* other_mont_u) const;
+
   /**
    * \brief  Validates that a given private key can be used for ECDH / shared-secret operations.
    * \param  prv IN - the private key to validate (must be PRV_KEY_SIZE bytes)
@@ -94,5 +129,66 @@ public:
   void readFrom(const uint8_t* src, size_t len);
 };
 
+#ifndef PEER_KEY_CACHE_SIZE
+  #define PEER_KEY_CACHE_SIZE  8
+#endif
+
+/**
+ * \brief  A small LRU of peer public keys already in Ex25519 form, so repeated key exchanges with
+ *      the same peers (eg. ANON_REQ retries, logins) don't redo the conversion.
+*/
+class PeerKeyCache {
+  struct Entry {
+    uint8_t pub_key[PUB_KEY_SIZE];
+    uint8_t mont_u[PUB_KEY_SIZE];
+    uint32_t last_used;   // zero = empty
+  };
+  Entry _entries[PEER_KEY_CACHE_SIZE];
+  uint32_t _clock, _hits, _misses;
+
+public:
+  PeerKeyCache();
+
+  /**
+   * \returns  the Montgomery u form of 'pub_key', converting (and caching) on a miss.
+  */
+  const uint8_t* get(const uint8_t* pub_key);
+
+  uint32_t getHits() const { return _hits; }
+  uint32_t getMisses() const { return _misses; }
+};
+
+#ifndef PUBKEY_POINT_CACHE_SIZE
+  #define PUBKEY_POINT_CACHE_SIZE  16
+#endif
+
+#define PUB_KEY_POINT_SIZE  160
+
+/**
+ * \brief  A small LRU of signers' public keys already decompressed to curve points, so repeated
+ *      verify() calls for the same repeaters/companions skip the field square root.
+*/
+class PubKeyPointCache {
+  struct Entry {
+    uint8_t pub_key[PUB_KEY_SIZE];
+    uint8_t point[PUB_KEY_POINT_SIZE];
+    uint32_t last_used;   // zero = empty
+  };
+  Entry _entries[PUBKEY_POINT_CACHE_SIZE];
+  uint32_t _clock, _hits, _misses;
+
+public:
+  PubKeyPointCache();
+
+  /**
+   * \returns  the decompressed point for 'pub_key', decompressing (and caching) on a miss,
+   *          or NULL if 'pub_key' is not a valid point.
+  */
+  const uint8_t* get(const uint8_t* pub_key);
+
+  uint32_t getHits() const { return _hits; }
+  uint32_t getMisses() const { return _misses; }
+};
+
 }
 
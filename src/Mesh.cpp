@@ -5,12 +5,168 @@ namespace mesh {
 
 void Mesh::begin() {
   Dispatcher::begin();
+  getMetrics().addCounter(METRIC_ID_FWD_FORGED_CXL, "fwd_cxl", &_n_forged_cancelled);
+  getMetrics().addCounter(METRIC_ID_FWD_FORGED_LATE, "fwd_late", &_n_forged_late);
+  _tables->registerMetrics(getMetrics());
+  _mp_next_id = _rng->nextInt(0, 256);   // so msg_id's don't repeat after a reboot
 }
 
 void Mesh::loop() {
+  checkPendingAdverts();   // before Dispatcher gets a chance to send their retransmits
+  checkMultipartTimeouts();
   Dispatcher::loop();
 }
 
+bool Mesh::processAdvert(Packet* pkt) {
+  int i = 0;
+  Identity id;
+  memcpy(id.pub_key, &pkt->payload[i], PUB_KEY_SIZE); i += PUB_KEY_SIZE;
+
+  uint32_t timestamp;
+  memcpy(&timestamp, &pkt->payload[i], 4); i += 4;
+  const uint8_t* signature = &pkt->payload[i]; i += SIGNATURE_SIZE;
+
+  uint8_t* app_data = &pkt->payload[i];
+  int app_data_len = pkt->payload_len - i;
+  if (app_data_len > MAX_ADVERT_DATA_SIZE) { app_data_len = MAX_ADVERT_DATA_SIZE; }
+
+  // check that signature is valid
+  bool is_ok;
+  {
+    uint8_t message[PUB_KEY_SIZE + 4 + MAX_ADVERT_DATA_SIZE];
+    int msg_len = 0;
+    memcpy(&message[msg_len], id.pub_key, PUB_KEY_SIZE); msg_len += PUB_KEY_SIZE;
+    memcpy(&message[msg_len], &timestamp, 4); msg_len += 4;
+    memcpy(&message[msg_len], app_data, app_data_len); msg_len += app_data_len;
+
+    is_ok = verifyAdvert(pkt, id, signature, message, msg_len);
+  }
+  if (is_ok) {
+    MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): valid advertisement received!", getLogDateTime());
+    onAdvertRecv(pkt, id, timestamp, app_data, app_data_len);
+  } else {
+    MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): received advertisement with forged signature! (app_data_len=%d)", getLogDateTime(), app_data_len);
+  }
+  return is_ok;
+}
+
+DispatcherAction Mesh::deferAdvertVerify(Packet* pkt) {
+  Packet* fwd = _num_pending_adverts < ADVERT_PENDING_VERIFY_MAX ? _mgr->allocNew() : NULL;
+  if (fwd == NULL) {   // can't defer, just verify first
+    return processAdvert(pkt) ? routeRecvPacket(pkt) : ACTION_RELEASE;
+  }
+
+  // forwarding is decided just once, on the copy (so 'pkt' keeps the path it was received with, for onAdvertRecv())
+  *fwd = *pkt;
+  DispatcherAction action = routeRecvPacket(fwd);
+  uint32_t d = action & 0xFFFFFF;
+  if (action == ACTION_RELEASE || d == 0) {   // not forwarding, or no delay window to verify in
+    bool is_ok = processAdvert(pkt);
+    if (is_ok && action != ACTION_RELEASE) *pkt = *fwd;   // retransmit with the path as already routed
+    _mgr->free(fwd);
+    return is_ok ? action : ACTION_RELEASE;
+  }
+  fwd->_due_millis = futureMillis(d);
+  _mgr->queueOutbound(fwd, (action >> 24) - 1, fwd->_due_millis);
+
+  _pending_adverts[_num_pending_adverts].pkt = pkt;
+  _pending_adverts[_num_pending_adverts].fwd = fwd;
+  _num_pending_adverts++;
+  return ACTION_MANUAL_HOLD;   // retransmit is already queued, signature gets checked in loop()
+}
+
+void Mesh::checkPendingAdverts() {
+  for (int j = 0; j < _num_pending_adverts; j++) {
+    Packet* pkt = _pending_adverts[j].pkt;
+    Packet* fwd = _pending_adverts[j].fwd;
+
+    if (!processAdvert(pkt)) {
+      // forged, try to pull the retransmit before it goes out
+      bool found = false;
+      int total = _mgr->getOutboundTotal();
+      for (int i = 0; i < total; i++) {
+        Packet* q = _mgr->getOutboundByIdx(i);
+        // NOTE: if already sent, 'fwd' may have been recycled for some other packet, so check contents too
+        if (q == fwd && q->payload_len == pkt->payload_len && memcmp(q->payload, pkt->payload, pkt->payload_len) == 0) {
+          _mgr->free(_mgr->removeOutboundByIdx(i));
+          found = true;
+          break;
+        }
+      }
+      if (found) {
+        _n_forged_cancelled++;
+      } else {
+        _n_forged_late++;
+      }
+    }
+    releasePacket(pkt);
+  }
+  _num_pending_adverts = 0;
+}
+
+#if ADVERT_VERIFY_BATCH > 1
+bool Mesh::takePreverified(const uint8_t* digest) {
+  for (int i = 0; i < ADVERT_VERIFY_BATCH; i++) {
+    if (memcmp(_preverified[i], digest, 32) == 0) {
+      memset(_preverified[i], 0, 32);   // one-shot
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+bool Mesh::verifyAdvert(const Packet* pkt, const Identity& id, const uint8_t* signature, const uint8_t* message, int msg_len) {
+#if ADVERT_VERIFY_BATCH > 1
+  // digest of entire payload, so a pre-verified result can only ever apply to the exact same advert
+  AdvertBatch& b = _batch;
+  Utils::sha256(b.digest[0], 32, pkt->payload, pkt->payload_len);
+  if (takePreverified(b.digest[0])) return true;   // was verified in an earlier batch
+
+  // collect other adverts waiting in the (delayed) inbound queue, and verify them all in one go
+  b.msg_ptrs[0] = message; b.sig_ptrs[0] = signature; b.key_ptrs[0] = id.pub_key; b.msg_lens[0] = msg_len;
+  int n = 1;
+
+  const int hdr_len = PUB_KEY_SIZE + 4 + SIGNATURE_SIZE;
+  int total = _mgr->getInboundTotal();
+  for (int i = 0; i < total && n < ADVERT_VERIFY_BATCH; i++) {
+    const Packet* q = _mgr->getInboundByIdx(i);
+    if (q->getPayloadType() != PAYLOAD_TYPE_ADVERT || q->payload_len < hdr_len || self_id.matches(q->payload)) continue;
+
+    Utils::sha256(b.digest[n], 32, q->payload, q->payload_len);
+    bool dup = false;
+    for (int j = 0; j < n && !dup; j++) dup = memcmp(b.digest[j], b.digest[n], 32) == 0;
+    if (dup) continue;
+
+    int app_data_len = q->payload_len - hdr_len;
+    if (app_data_len > MAX_ADVERT_DATA_SIZE) { app_data_len = MAX_ADVERT_DATA_SIZE; }
+    memcpy(b.messages[n], q->payload, PUB_KEY_SIZE + 4);   // pub_key + timestamp
+    memcpy(&b.messages[n][PUB_KEY_SIZE + 4], &q->payload[hdr_len], app_data_len);
+
+    b.msg_ptrs[n] = b.messages[n]; b.sig_ptrs[n] = &q->payload[PUB_KEY_SIZE + 4]; b.key_ptrs[n] = q->payload;
+    b.msg_lens[n] = PUB_KEY_SIZE + 4 + app_data_len;
+    n++;
+  }
+
+  _rng->random(b.random, n * 16);
+  if (n > 1) {
+    if (Identity::verifyBatch(b.sig_ptrs, b.key_ptrs, b.msg_ptrs, b.msg_lens, n, b.random)) {
+      for (int j = 1; j < n; j++) {
+        memcpy(_preverified[_next_preverified], b.digest[j], 32);
+        _next_preverified = (_next_preverified + 1) % ADVERT_VERIFY_BATCH;
+      }
+      return true;
+    }
+    // at least one is bad, fall back to individual checks (queued adverts get theirs when dequeued)
+    MESH_DEBUG_PRINTLN("%s Mesh::verifyAdvert(): batch of %d failed", getLogDateTime(), n);
+  }
+  // same (cofactored) check as the batch, so whether an advert is accepted never depends on what it was batched with
+  return Identity::verifyBatch(b.sig_ptrs, b.key_ptrs, b.msg_ptrs, b.msg_lens, 1, b.random);
+#else
+  return id.verify(signature, message, msg_len);
+#endif
+}
+
 bool Mesh::allowPacketForward(const mesh::Packet* packet) { 
   return false;  // by default, Transport NOT enabled
 }
@@ -208,7 +364,7 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
           Identity sender(sender_pub_key);
 
           uint8_t secret[PUB_KEY_SIZE];
-          self_id.calcSharedSecret(secret, sender);
+          self_id.calcSharedSecretMontgomery(secret, _peer_keys.get(sender_pub_key));
 
           // decrypt, checking MAC is valid
           uint8_t data[MAX_PACKET_PAYLOAD];
@@ -250,41 +406,16 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
       break;
     }
     case PAYLOAD_TYPE_ADVERT: {
-      int i = 0;
-      Identity id;
-      memcpy(id.pub_key, &pkt->payload[i], PUB_KEY_SIZE); i += PUB_KEY_SIZE;
-
-      uint32_t timestamp;
-      memcpy(&timestamp, &pkt->payload[i], 4); i += 4;
-      const uint8_t* signature = &pkt->payload[i]; i += SIGNATURE_SIZE;
-
-      if (i > pkt->payload_len) {
+      if (pkt->payload_len < PUB_KEY_SIZE + 4 + SIGNATURE_SIZE) {
         MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): incomplete advertisement packet", getLogDateTime());
-      } else if (self_id.matches(id.pub_key)) {
+      } else if (self_id.matches(pkt->payload)) {
         MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): receiving SELF advert packet", getLogDateTime());
       } else if (!_tables->wasSeen(pkt)) {
         _tables->markSeen(pkt);
-        uint8_t* app_data = &pkt->payload[i];
-        int app_data_len = pkt->payload_len - i;
-        if (app_data_len > MAX_ADVERT_DATA_SIZE) { app_data_len = MAX_ADVERT_DATA_SIZE; }
-
-        // check that signature is valid
-        bool is_ok;
-        {
-          uint8_t message[PUB_KEY_SIZE + 4 + MAX_ADVERT_DATA_SIZE];
-          int msg_len = 0;
-          memcpy(&message[msg_len], id.pub_key, PUB_KEY_SIZE); msg_len += PUB_KEY_SIZE;
-          memcpy(&message[msg_len], &timestamp, 4); msg_len += 4;
-          memcpy(&message[msg_len], app_data, app_data_len); msg_len += app_data_len;
-
-          is_ok = id.verify(signature, message, msg_len);
-        }
-        if (is_ok) {
-          MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): valid advertisement received!", getLogDateTime());
-          onAdvertRecv(pkt, id, timestamp, app_data, app_data_len);
+        if (isAdvertVerifyAfterForward()) {
+          action = deferAdvertVerify(pkt);
+        } else if (processAdvert(pkt)) {
           action = routeRecvPacket(pkt);
-        } else {
-          MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): received advertisement with forged signature! (app_data_len=%d)", getLogDateTime(), app_data_len);
         }
       }
       break;
@@ -317,8 +448,20 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
             onAckRecv(&tmp, ack_crc);
             //action = routeRecvPacket(&tmp);  // NOTE: currently not needed, as multipart ACKs not sent Flood
           }
-        } else {
-          // FUTURE: other multipart types??
+        } else if ((type == MULTIPART_TYPE_FRAG_ACK && pkt->payload_len >= MULTIPART_FRAG_ACK_SIZE)
+                  || ((type == PAYLOAD_TYPE_REQ || type == PAYLOAD_TYPE_RESPONSE || type == PAYLOAD_TYPE_TXT_MSG) && pkt->payload_len > MULTIPART_HEADER_SIZE)) {
+          if (!_tables->wasSeen(pkt)) {
+            _tables->markSeen(pkt);
+            if (self_id.isHashMatch(&pkt->payload[1])) {
+              if (type == MULTIPART_TYPE_FRAG_ACK) {
+                if (_mp_send) onMultipartAckRecv(pkt);
+              } else {
+                if (_mp_recv) onMultipartFragRecv(pkt);
+              }
+              pkt->markDoNotRetransmit();
+            }
+            action = routeRecvPacket(pkt);
+          }
         }
       }
       break;
@@ -372,10 +515,138 @@ DispatcherAction Mesh::forwardMultipartDirect(Packet* pkt) {
       removeSelfFromPath(&tmp);
       routeDirectRecvAcks(&tmp, ((uint32_t)remaining + 1) * 300);  // expect multipart ACKs 300ms apart (x2)
     }
+  } else if (type != PAYLOAD_TYPE_ACK && !_tables->wasSeen(pkt)) {   // a fragment (or fragment ACK), forward as normal
+    _tables->markSeen(pkt);
+    removeSelfFromPath(pkt);
+
+    uint32_t d = getDirectRetransmitDelay(pkt);
+    return ACTION_RETRANSMIT_DELAYED(0, d);
   }
   return ACTION_RELEASE;
 }
 
+void Mesh::onMultipartFragRecv(Packet* pkt) {
+  bool completed;
+  int slot = _mp_recv->addFragment(pkt->payload, pkt->payload_len, _ms->getMillis(), completed);
+  if (slot < 0) return;
+
+  if (_mp_recv->getState(slot) == MultipartRecvBuffer::DONE) {   // sender must have missed our ACK
+    uint8_t src_hash = _mp_recv->getSrcHash(slot);
+    if (searchPeersByHash(&src_hash) > 0) replyMultipartAck(slot, 0);
+    return;
+  }
+  if (!completed) return;
+
+  uint8_t src_hash = _mp_recv->getSrcHash(slot);
+  int num = searchPeersByHash(&src_hash);
+  for (int j = 0; j < num; j++) {
+    uint8_t secret[PUB_KEY_SIZE];
+    getPeerSharedSecret(secret, j);
+
+    int len = _mp_recv->decrypt(slot, secret);
+    if (len > 0) {  // success!
+      _mp_recv->markDone(slot);
+      replyMultipartAck(slot, j);
+      onPeerDataRecv(pkt, _mp_recv->getType(slot), j, secret, _mp_recv->getData(), len);
+      return;
+    }
+  }
+  MESH_DEBUG_PRINTLN("%s multipart matches no peers, src_hash=%02X", getLogDateTime(), (uint32_t)src_hash);
+  _mp_recv->free(slot);
+}
+
+void Mesh::replyMultipartAck(int slot, int sender_idx) {
+  Packet* ack = obtainNewPacket();
+  if (ack == NULL) return;
+
+  ack->header = (PAYLOAD_TYPE_MULTIPART << PH_TYPE_SHIFT);  // ROUTE_TYPE_* set later
+  ack->payload[0] = MULTIPART_TYPE_FRAG_ACK;
+  ack->payload[1] = _mp_recv->getSrcHash(slot);
+  self_id.copyHashTo(&ack->payload[2]);
+  ack->payload[3] = _mp_recv->getMsgId(slot);
+  ack->payload[4] = _mp_recv->getReceived(slot);
+  getRNG()->random(&ack->payload[5], 1);
+  ack->payload_len = MULTIPART_FRAG_ACK_SIZE;
+
+  _mp_recv->onAckSent(slot, _ms->getMillis());
+  sendMultipartAck(ack, sender_idx);
+}
+
+void Mesh::onMultipartAckRecv(const Packet* pkt) {
+  int slot = _mp_send->find(pkt->payload[2], pkt->payload[3]);
+  if (slot < 0) return;   // not ours, or too late
+
+  uint8_t received = pkt->payload[4];
+  int n = _mp_send->getCount(slot);
+  if (received == (1 << n) - 1) {   // all received
+    _mp_send->free(slot);
+    return;
+  }
+  for (int idx = 0; idx < n; idx++) {
+    if ((received & (1 << idx)) == 0) {
+      sendFragment(slot, idx, 0);   // resend just the missing ones
+    }
+  }
+}
+
+bool Mesh::sendFragment(int slot, int idx, uint32_t delay_millis) {
+  Packet* pkt = obtainNewPacket();
+  if (pkt == NULL) {
+    MESH_DEBUG_PRINTLN("%s Mesh::sendFragment(): error, packet pool empty", getLogDateTime());
+    return false;
+  }
+  uint8_t self_hash;
+  self_id.copyHashTo(&self_hash);
+
+  pkt->header = (PAYLOAD_TYPE_MULTIPART << PH_TYPE_SHIFT);  // ROUTE_TYPE_* set later
+  pkt->payload_len = _mp_send->writeFragment(slot, idx, self_hash, pkt->payload);
+  if (pkt->payload_len == 0) {   // already sent too many times
+    releasePacket(pkt);
+    return false;
+  }
+
+  if (_mp_send->isFlood(slot)) {
+    sendFlood(pkt, delay_millis, _mp_send->getPathHashSize(slot));
+  } else {
+    sendDirect(pkt, _mp_send->getPath(slot), _mp_send->getPathLen(slot), delay_millis);
+  }
+  return true;
+}
+
+void Mesh::checkMultipartTimeouts() {
+  if (_mp_send) _mp_send->expire(_ms->getMillis());
+  if (_mp_recv == NULL) return;
+
+  int slot = _mp_recv->checkTimeouts(_ms->getMillis());
+  if (slot >= 0) {   // still missing some fragments, let sender know which
+    uint8_t src_hash = _mp_recv->getSrcHash(slot);
+    if (searchPeersByHash(&src_hash) > 0) {
+      replyMultipartAck(slot, 0);   // NOTE: can't know which peer (if hashes collide) until fully decrypted
+    } else {
+      _mp_recv->free(slot);
+    }
+  }
+}
+
+int Mesh::sendMultipart(uint8_t type, const Identity& dest, const uint8_t* secret, const uint8_t* data, size_t data_len,
+                        const uint8_t* path, uint8_t path_len, uint32_t delay_millis, uint8_t path_hash_size) {
+  if (_mp_send == NULL) return 0;  // multipart not enabled
+  if (!(type == PAYLOAD_TYPE_TXT_MSG || type == PAYLOAD_TYPE_REQ || type == PAYLOAD_TYPE_RESPONSE)) return 0;  // invalid type
+  if (data_len > MULTIPART_MAX_DATA) return 0;  // too long
+
+  uint8_t dest_hash;
+  dest.copyHashTo(&dest_hash);
+  int slot = _mp_send->add(type, dest_hash, _mp_next_id++, secret, data, data_len, _ms->getMillis());
+  if (slot < 0) return 0;
+  _mp_send->setRoute(slot, path, path_len, path_hash_size);
+
+  int n = 0;
+  for (int idx = 0; idx < _mp_send->getCount(slot); idx++) {
+    if (sendFragment(slot, idx, delay_millis)) n++;
+  }
+  return n;
+}
+
 void Mesh::routeDirectRecvAcks(Packet* packet, uint32_t delay_millis) {
   if (!packet->isMarkedDoNotRetransmit()) {
     uint8_t extra = getExtraAckTransmitCount();
@@ -1,6 +1,18 @@
 #pragma once
 
 #include <Dispatcher.h>
+#include <Multipart.h>
+
+#ifndef ADVERT_PENDING_VERIFY_MAX
+  #define ADVERT_PENDING_VERIFY_MAX   4     // max adverts forwarded, but not yet verified
+#endif
+
+// Opt-in (eg. -D ADVERT_VERIFY_BATCH=4): max adverts (incl. current) to verify together. Other adverts are only
+// found waiting in the inbound queue when rx delay is on (rx_delay_base > 0, which is off by default), otherwise
+// there is never anything to batch with. Not useful with USE_CC310_HW_CRYPTO, where verify is already cheaper.
+#ifndef ADVERT_VERIFY_BATCH
+  #define ADVERT_VERIFY_BATCH   0
+#endif
 
 namespace mesh {
 
@@ -18,6 +30,7 @@ public:
   virtual bool wasSeen(const Packet* packet) = 0;
   virtual void markSeen(const Packet* packet) = 0;
   virtual void clear(const Packet* packet) = 0;    // remove this packet hash from table
+  virtual void registerMetrics(MetricsRegistry& metrics) { }   // eg. duplicate counters
 };
 
 /**
@@ -28,12 +41,53 @@ class Mesh : public Dispatcher {
   RTCClock* _rtc;
   RNG* _rng;
   MeshTables* _tables;
+  PeerKeyCache _peer_keys;
+#if ADVERT_VERIFY_BATCH > 1
+  uint8_t _preverified[ADVERT_VERIFY_BATCH][32];   // SHA-256 of advert payloads already batch-verified, still in inbound queue
+  int _next_preverified;
+
+  struct AdvertBatch {    // verifyAdvert() working storage, kept off the stack
+    uint8_t digest[ADVERT_VERIFY_BATCH][32];
+    uint8_t messages[ADVERT_VERIFY_BATCH][PUB_KEY_SIZE + 4 + MAX_ADVERT_DATA_SIZE];
+    const uint8_t* msg_ptrs[ADVERT_VERIFY_BATCH];
+    const uint8_t* sig_ptrs[ADVERT_VERIFY_BATCH];
+    const uint8_t* key_ptrs[ADVERT_VERIFY_BATCH];
+    size_t msg_lens[ADVERT_VERIFY_BATCH];
+    uint8_t random[ADVERT_VERIFY_BATCH * 16];
+  };
+  AdvertBatch _batch;
+
+  bool takePreverified(const uint8_t* digest);
+#endif
+
+  struct PendingAdvert {
+    Packet* pkt;   // as received, held until verified
+    Packet* fwd;   // the copy queued for retransmit
+  };
+  PendingAdvert _pending_adverts[ADVERT_PENDING_VERIFY_MAX];
+  int _num_pending_adverts;
+  uint32_t _n_forged_cancelled, _n_forged_late;
+
+  bool processAdvert(Packet* pkt);
+  DispatcherAction deferAdvertVerify(Packet* pkt);
+  void checkPendingAdverts();
 
   void removeSelfFromPath(Packet* packet);
+  bool verifyAdvert(const Packet* pkt, const Identity& id, const uint8_t* signature, const uint8_t* message, int msg_len);
   void routeDirectRecvAcks(Packet* packet, uint32_t delay_millis);
   //void routeRecvAcks(Packet* packet, uint32_t delay_millis);
   DispatcherAction forwardMultipartDirect(Packet* pkt);
 
+  MultipartRecvBuffer* _mp_recv;   // NULL unless setMultipartBuffers() was called
+  MultipartSendBuffer* _mp_send;
+  uint8_t _mp_next_id;
+
+  void onMultipartFragRecv(Packet* pkt);
+  void onMultipartAckRecv(const Packet* pkt);
+  void replyMultipartAck(int slot, int sender_idx);
+  bool sendFragment(int slot, int idx, uint32_t delay_millis);
+  void checkMultipartTimeouts();
+
 protected:
   DispatcherAction onRecvPacket(Packet* pkt) override;
 
@@ -71,6 +125,12 @@ protected:
    */
   virtual uint8_t getExtraAckTransmitCount() const;
 
+  /**
+   * \returns  true, if flood adverts should be queued for retransmit BEFORE their signature is verified.
+   *          Verification then happens during the retransmit delay, and the retransmit is cancelled if forged.
+   */
+  virtual bool isAdvertVerifyAfterForward() const { return false; }
+
   /**
    * \brief  Perform search of local DB of peers/contacts.
    * \returns  Number of peers with matching hash
@@ -160,6 +220,13 @@ protected:
   */
   virtual void onGroupDataRecv(Packet* packet, uint8_t type, const GroupChannel& channel, uint8_t* data, size_t len) { }
 
+  /**
+   * \brief  send a multipart fragment ACK (a bitmap of the fragments received) back to the sender of a multipart message
+   * \param  sender_idx  index of peer, [0..n) where n is what searchPeersByHash() returned
+   *         Default is to send it Flood, as there is no path here. Subclasses that know the peer's path should send Direct.
+   */
+  virtual void sendMultipartAck(Packet* ack, int sender_idx) { sendFlood(ack); }
+
   /**
    * \brief  A simple ACK packet has been received.
    *         NOTE: same ACK can be received multiple times, via different routes
@@ -169,9 +236,26 @@ protected:
   Mesh(Radio& radio, MillisecondClock& ms, RNG& rng, RTCClock& rtc, PacketManager& mgr, MeshTables& tables)
     : Dispatcher(radio, ms, mgr), _rng(&rng), _rtc(&rtc), _tables(&tables)
   {
+    _num_pending_adverts = 0;
+    _n_forged_cancelled = _n_forged_late = 0;
+    _mp_recv = NULL;
+    _mp_send = NULL;
+    _mp_next_id = 0;
+#if ADVERT_VERIFY_BATCH > 1
+    memset(_preverified, 0, sizeof(_preverified));
+    _next_preverified = 0;
+#endif
   }
 
+  /**
+   * \brief  enables multipart messages, by giving the buffers for reassembling received ones (recv), and for
+   *       holding sent ones until their fragment ACK (send). Each is about 1.5KB, so is only given by nodes
+   *       which use multipart. Either can be NULL. Multipart packets are always forwarded, buffers or not.
+   */
+  void setMultipartBuffers(MultipartRecvBuffer* recv, MultipartSendBuffer* send) { _mp_recv = recv; _mp_send = send; }
+
   MeshTables* getTables() const { return _tables; }
+  const PeerKeyCache& getPeerKeyCache() const { return _peer_keys; }
 
 public:
   void begin();
@@ -180,6 +264,8 @@ public:
   LocalIdentity self_id;
 
   RNG* getRNG() const { return _rng; }
+  uint32_t getNumForgedCancelled() const { return _n_forged_cancelled; }   // forged adverts, retransmit cancelled in time
+  uint32_t getNumForgedLate() const { return _n_forged_late; }    // forged adverts, already retransmitted
   RTCClock* getRTCClock() const { return _rtc; }
 
   Packet* createAdvert(const LocalIdentity& id, const uint8_t* app_data=NULL, size_t app_data_len=0);
@@ -196,6 +282,17 @@ public:
   Packet* createTrace(uint32_t tag, uint32_t auth_code, uint8_t flags = 0);
   Packet* createControlData(const uint8_t* data, size_t len);
 
+  /**
+   * \brief  encrypts and sends data that is too long for createDatagram() (up to MULTIPART_MAX_DATA), as
+   *       numbered fragments. The receiver reassembles them, and sends back a fragment ACK, which triggers a
+   *       resend of any fragments that are missing.
+   * \param  type  one of: PAYLOAD_TYPE_TXT_MSG, PAYLOAD_TYPE_REQ, PAYLOAD_TYPE_RESPONSE
+   * \param  path  the out_path, to send Direct, or NULL to send Flood
+   * \returns  number of fragments sent, or zero if too long (or packet pool is empty, or no send buffer given)
+   */
+  int sendMultipart(uint8_t type, const Identity& dest, const uint8_t* secret, const uint8_t* data, size_t data_len,
+                    const uint8_t* path, uint8_t path_len, uint32_t delay_millis=0, uint8_t path_hash_size=1);
+
   /**
    * \brief  send a locally-generated Packet with flood routing
   */
@@ -0,0 +1,126 @@
+#include "Metrics.h"
+#include <string.h>
+
+namespace mesh {
+
+void MetricHistogram::reset() {
+  memset(_buckets, 0, sizeof(_buckets));
+  _count = _sum = _max = 0;
+}
+
+int MetricHistogram::bucketFor(uint32_t value) {
+  int b = 0;
+  while (value > 0 && b < METRIC_HIST_BUCKETS - 1) {
+    value >>= 1;
+    b++;
+  }
+  return b;
+}
+
+uint32_t MetricHistogram::bucketLimit(int i) {
+  return i >= METRIC_HIST_BUCKETS - 1 ? 0xFFFFFFFF : (1UL << i);
+}
+
+void MetricHistogram::add(uint32_t value) {
+  _buckets[bucketFor(value)]++;
+  _count++;
+  _sum += value;
+  if (value > _max) _max = value;
+}
+
+uint32_t MetricHistogram::getPercentile(int pct) const {
+  if (_count == 0) return 0;
+  uint32_t target = ((uint64_t)_count * pct + 99) / 100;   // rank, rounded up
+  uint32_t n = 0;
+  for (int i = 0; i < METRIC_HIST_BUCKETS; i++) {
+    n += _buckets[i];
+    if (n >= target) {
+      uint32_t limit = bucketLimit(i);
+      return limit < _max ? limit : _max;
+    }
+  }
+  return _max;
+}
+
+bool MetricsRegistry::add(uint8_t id, uint8_t type, const char* name, const void* src, MetricReadFunc fn) {
+  int i = findById(id);
+  if (i < 0) {
+    if (_num >= METRICS_MAX) return false;   // full
+    i = _num++;
+  }
+  Entry& e = _entries[i];
+  e.id = id;
+  e.type = type;
+  e.name = name;
+  e.src = src;
+  e.fn = fn;
+  return true;
+}
+
+int MetricsRegistry::findById(uint8_t id) const {
+  for (int i = 0; i < _num; i++) {
+    if (_entries[i].id == id) return i;
+  }
+  return -1;
+}
+
+int32_t MetricsRegistry::getValue(int i) const {
+  const Entry& e = _entries[i];
+  if (e.type == METRIC_TYPE_HISTOGRAM) return 0;
+  return e.fn ? e.fn(e.src) : *(const int32_t *) e.src;
+}
+
+const MetricHistogram* MetricsRegistry::getHistogram(int i) const {
+  return _entries[i].type == METRIC_TYPE_HISTOGRAM ? (const MetricHistogram *) _entries[i].src : NULL;
+}
+
+static int putVarint(uint8_t* dest, uint32_t v) {
+  int n = 0;
+  while (v >= 0x80) {
+    dest[n++] = (v & 0x7F) | 0x80;
+    v >>= 7;
+  }
+  dest[n++] = v;
+  return n;
+}
+
+int MetricsRegistry::exportBinary(uint8_t* dest, int max_len, int start) const {
+  if (max_len < 4) return 0;
+  if (start < 0 || start > _num) start = _num;
+
+  dest[0] = METRICS_EXPORT_VERSION;
+  dest[1] = _num;
+  dest[2] = start;
+  int len = 4, num = 0;
+
+  uint8_t tmp[2 + 5*(4 + METRIC_HIST_BUCKETS)];   // largest record
+  for (int i = start; i < _num; i++) {
+    const Entry& e = _entries[i];
+    int n = 0;
+    tmp[n++] = e.id;
+    tmp[n++] = e.type;
+    if (e.type == METRIC_TYPE_HISTOGRAM) {
+      const MetricHistogram* h = (const MetricHistogram *) e.src;
+      int num_buckets = METRIC_HIST_BUCKETS;
+      while (num_buckets > 0 && h->getBucket(num_buckets - 1) == 0) num_buckets--;
+      n += putVarint(&tmp[n], h->getCount());
+      n += putVarint(&tmp[n], h->getSum());
+      n += putVarint(&tmp[n], h->getMax());
+      tmp[n++] = num_buckets;
+      for (int b = 0; b < num_buckets; b++) n += putVarint(&tmp[n], h->getBucket(b));
+    } else if (e.type == METRIC_TYPE_GAUGE) {
+      int32_t v = getValue(i);
+      n += putVarint(&tmp[n], ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));   // zig-zag
+    } else {
+      n += putVarint(&tmp[n], (uint32_t) getValue(i));
+    }
+    if (len + n > max_len) break;   // rest in next page
+    memcpy(&dest[len], tmp, n);
+    len += n;
+    num++;
+  }
+  dest[3] = num;
+  return len;
+}
+
+}
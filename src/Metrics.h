@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef METRICS_MAX
+  #define METRICS_MAX     24    // registry slots
+#endif
+
+#define METRIC_HIST_BUCKETS   16    // bucket 0 is value 0, bucket i is [2^(i-1), 2^i), last bucket is everything above
+
+#define METRIC_TYPE_COUNTER     1    // only goes up (until reset)
+#define METRIC_TYPE_GAUGE       2    // current value, can be negative
+#define METRIC_TYPE_HISTOGRAM   3
+
+#define METRICS_EXPORT_VERSION  1
+
+// stable IDs, for the binary export. Names are only for the CLI.
+#define METRIC_ID_SENT_FLOOD          1
+#define METRIC_ID_SENT_DIRECT         2
+#define METRIC_ID_RECV_FLOOD          3
+#define METRIC_ID_RECV_DIRECT         4
+#define METRIC_ID_QUEUE_LEN           5
+#define METRIC_ID_TX_AIR_SECS         6
+#define METRIC_ID_RX_AIR_SECS         7
+#define METRIC_ID_ERR_FLAGS           8
+#define METRIC_ID_UPTIME_SECS         9
+#define METRIC_ID_NOISE_FLOOR        10
+#define METRIC_ID_LAST_RSSI          11
+#define METRIC_ID_LAST_SNR_X4        12
+#define METRIC_ID_FWD_DELAY_MS       13    // histogram, received to re-transmit started
+#define METRIC_ID_QUEUE_WAIT_MS      14    // histogram, due to transmit started (ie. held up by CAD, duty-cycle, etc)
+#define METRIC_ID_FWD_FORGED_CXL     15    // forged flood adverts, retransmit cancelled in time
+#define METRIC_ID_FWD_FORGED_LATE    16    // forged flood adverts, already retransmitted
+#define METRIC_ID_RADIO_RECV         20
+#define METRIC_ID_RADIO_SENT         21
+#define METRIC_ID_RADIO_RECV_ERRORS  22
+#define METRIC_ID_DUPS_FLOOD         30
+#define METRIC_ID_DUPS_DIRECT        31
+#define METRIC_ID_BATT_MV            40
+#define METRIC_ID_FLOOD_SUPPRESSED   41    // repeater, flood retransmits cancelled (flood.adaptive)
+
+namespace mesh {
+
+typedef int32_t (*MetricReadFunc)(const void* ctx);
+
+/**
+ * \brief  Fixed size histogram, with power-of-2 buckets (eg. of milliseconds), plus count, sum and max.
+ */
+class MetricHistogram {
+  uint32_t _buckets[METRIC_HIST_BUCKETS];
+  uint32_t _count, _sum, _max;
+
+public:
+  MetricHistogram() { reset(); }
+
+  void reset();
+  void add(uint32_t value);
+
+  static int bucketFor(uint32_t value);
+  /**
+   * \returns  exclusive upper bound of values in bucket 'i', or 0xFFFFFFFF for the last bucket
+   */
+  static uint32_t bucketLimit(int i);
+
+  uint32_t getCount() const { return _count; }
+  uint32_t getSum() const { return _sum; }   // wraps
+  uint32_t getMax() const { return _max; }
+  uint32_t getBucket(int i) const { return _buckets[i]; }
+
+  /**
+   * \returns  upper bound of the bucket holding the 'pct' percentile (or max, if lower), 0 if empty
+   */
+  uint32_t getPercentile(int pct) const;
+};
+
+/**
+ * \brief  Registry of counters, gauges and histograms, which each layer (Dispatcher, radio driver, tables, app)
+ *      registers into at begin(). Values stay owned by the layers, the registry only holds where to read them,
+ *      so it's fixed memory, and costs nothing until exported.
+ */
+class MetricsRegistry {
+  struct Entry {
+    const char* name;
+    const void* src;      // value, histogram, or context for fn
+    MetricReadFunc fn;    // NULL if 'src' is the value
+    uint8_t id;
+    uint8_t type;
+  };
+  Entry _entries[METRICS_MAX];
+  int _num;
+
+  bool add(uint8_t id, uint8_t type, const char* name, const void* src, MetricReadFunc fn);
+
+public:
+  MetricsRegistry() : _num(0) { }
+
+  /**
+   * \brief  registers a metric. Re-registering an ID replaces it.
+   * \returns  false if registry is full
+   */
+  bool addCounter(uint8_t id, const char* name, const uint32_t* value) { return add(id, METRIC_TYPE_COUNTER, name, value, NULL); }
+  bool addCounter(uint8_t id, const char* name, MetricReadFunc fn, const void* ctx) { return add(id, METRIC_TYPE_COUNTER, name, ctx, fn); }
+  bool addGauge(uint8_t id, const char* name, MetricReadFunc fn, const void* ctx) { return add(id, METRIC_TYPE_GAUGE, name, ctx, fn); }
+  bool addHistogram(uint8_t id, const char* name, const MetricHistogram* hist) { return add(id, METRIC_TYPE_HISTOGRAM, name, hist, NULL); }
+
+  int getCount() const { return _num; }
+  int findById(uint8_t id) const;
+  uint8_t getId(int i) const { return _entries[i].id; }
+  uint8_t getType(int i) const { return _entries[i].type; }
+  const char* getName(int i) const { return _entries[i].name; }
+
+  /**
+   * \returns  current value of counter or gauge 'i' (counters as uint32_t)
+   */
+  int32_t getValue(int i) const;
+  const MetricHistogram* getHistogram(int i) const;
+
+  /**
+   * \brief  compact binary export of metrics from index 'start', as many as fit in 'max_len'.
+   *    [version][total][start][num], then for each: [id][type][value], where counters are an unsigned varint,
+   *    gauges a zig-zag varint, and histograms are varints: count, sum, max, number of buckets (trailing empty
+   *    ones trimmed), then each bucket.
+   * \returns  length written. If start + num < total, request again from there.
+   */
+  int exportBinary(uint8_t* dest, int max_len, int start) const;
+};
+
+}
@@ -0,0 +1,157 @@
+#include "Multipart.h"
+#include <Utils.h>
+
+namespace mesh {
+
+int MultipartRecvBuffer::addFragment(const uint8_t* payload, int len, uint32_t now, bool& completed) {
+  completed = false;
+  if (len <= MULTIPART_HEADER_SIZE) return -1;
+
+  uint8_t type = payload[0] & 0x0F;
+  uint8_t src_hash = payload[2];
+  uint8_t msg_id = payload[3];
+  uint8_t count = ((payload[4] >> 3) & 0x07) + 1;
+  uint8_t idx = payload[4] & 0x07;
+  int frag_len = len - MULTIPART_HEADER_SIZE;
+  if (count > MULTIPART_MAX_FRAGMENTS || idx >= count) return -1;
+  if (idx < count - 1 && frag_len != MULTIPART_FRAG_DATA_SIZE) return -1;   // only the last fragment can be short
+
+  int i = -1, oldest = 0;
+  for (int j = 0; j < MULTIPART_RECV_SLOTS; j++) {
+    if (_slots[j].state != FREE && _slots[j].src_hash == src_hash) {
+      i = j;
+      break;
+    }
+    if (_slots[oldest].state != FREE && (_slots[j].state == FREE || (int32_t)(_slots[j].started - _slots[oldest].started) < 0)) {
+      oldest = j;   // prefer free slot, otherwise the oldest
+    }
+  }
+  if (i < 0 || _slots[i].msg_id != msg_id || _slots[i].type != type) {   // start a new message
+    if (i < 0) i = oldest;
+    Slot& s = _slots[i];
+    s.state = PARTIAL;
+    s.src_hash = src_hash;
+    s.msg_id = msg_id;
+    s.type = type;
+    s.count = count;
+    s.received = 0;
+    s.n_acks = 0;
+    s.started = now;
+  }
+
+  Slot& s = _slots[i];
+  if (s.state == DONE) return i;
+  if (s.count != count) return -1;   // inconsistent with earlier fragments
+
+  s.last_heard = now;
+  if ((s.received & (1 << idx)) == 0) {
+    memcpy(&s.blob[idx * MULTIPART_FRAG_DATA_SIZE], &payload[MULTIPART_HEADER_SIZE], frag_len);
+    if (idx == count - 1) s.last_len = frag_len;
+    s.received |= (1 << idx);
+  }
+  completed = s.received == (1 << count) - 1;
+  return i;
+}
+
+int MultipartRecvBuffer::decrypt(int i, const uint8_t* secret) {
+  return Utils::MACThenDecrypt(secret, _data, _slots[i].blob, getBlobLength(i));
+}
+
+int MultipartRecvBuffer::checkTimeouts(uint32_t now) {
+  for (int i = 0; i < MULTIPART_RECV_SLOTS; i++) {
+    Slot& s = _slots[i];
+    if (s.state == FREE) continue;
+
+    if (now - s.started >= MULTIPART_HOLD_MILLIS) {
+      s.state = FREE;
+    } else if (s.state == PARTIAL && now - s.last_heard >= MULTIPART_GAP_MILLIS) {
+      if (s.n_acks >= MULTIPART_MAX_ACKS) {
+        s.state = FREE;   // give up
+      } else {
+        return i;
+      }
+    }
+  }
+  return -1;
+}
+
+MultipartSendBuffer::Slot& MultipartSendBuffer::alloc(uint8_t type, uint8_t dest_hash, uint8_t msg_id, uint32_t now) {
+  int i = 0;
+  for (int j = 0; j < MULTIPART_SEND_SLOTS; j++) {
+    if (!_slots[j].in_use) { i = j; break; }
+    if ((int32_t)(_slots[j].created - _slots[i].created) < 0) i = j;
+  }
+  Slot& s = _slots[i];
+  s.in_use = true;
+  s.type = type;
+  s.dest_hash = dest_hash;
+  s.msg_id = msg_id;
+  memset(s.attempts, 0, sizeof(s.attempts));
+  s.path_len = 0xFF;
+  s.path_hash_size = 1;
+  s.created = now;
+  return s;
+}
+
+int MultipartSendBuffer::add(uint8_t type, uint8_t dest_hash, uint8_t msg_id, const uint8_t* blob, int blob_len, uint32_t now) {
+  if (blob_len <= 0 || blob_len > MULTIPART_MAX_BLOB) return -1;
+
+  Slot& s = alloc(type, dest_hash, msg_id, now);
+  memcpy(s.blob, blob, blob_len);
+  s.blob_len = blob_len;
+  s.count = (blob_len + MULTIPART_FRAG_DATA_SIZE - 1) / MULTIPART_FRAG_DATA_SIZE;
+  return &s - _slots;
+}
+
+int MultipartSendBuffer::add(uint8_t type, uint8_t dest_hash, uint8_t msg_id, const uint8_t* secret, const uint8_t* data, int data_len, uint32_t now) {
+  if (data_len <= 0 || data_len > MULTIPART_MAX_DATA) return -1;
+
+  Slot& s = alloc(type, dest_hash, msg_id, now);
+  s.blob_len = Utils::encryptThenMAC(secret, s.blob, data, data_len);
+  s.count = (s.blob_len + MULTIPART_FRAG_DATA_SIZE - 1) / MULTIPART_FRAG_DATA_SIZE;
+  return &s - _slots;
+}
+
+void MultipartSendBuffer::setRoute(int i, const uint8_t* path, uint8_t path_len, uint8_t path_hash_size) {
+  Slot& s = _slots[i];
+  if (path == NULL) {
+    s.path_len = 0xFF;
+  } else {
+    s.path_len = path_len;
+    memcpy(s.path, path, (path_len & 63) * ((path_len >> 6) + 1));   // hash count x hash size
+  }
+  s.path_hash_size = path_hash_size;
+}
+
+int MultipartSendBuffer::find(uint8_t dest_hash, uint8_t msg_id) const {
+  for (int i = 0; i < MULTIPART_SEND_SLOTS; i++) {
+    if (_slots[i].in_use && _slots[i].dest_hash == dest_hash && _slots[i].msg_id == msg_id) return i;
+  }
+  return -1;
+}
+
+void MultipartSendBuffer::expire(uint32_t now) {
+  for (int i = 0; i < MULTIPART_SEND_SLOTS; i++) {
+    if (_slots[i].in_use && now - _slots[i].created >= MULTIPART_HOLD_MILLIS) _slots[i].in_use = false;
+  }
+}
+
+int MultipartSendBuffer::writeFragment(int i, int idx, uint8_t src_hash, uint8_t* payload) {
+  Slot& s = _slots[i];
+  if (idx >= s.count || s.attempts[idx] >= MULTIPART_MAX_ATTEMPTS) return 0;
+
+  int ofs = idx * MULTIPART_FRAG_DATA_SIZE;
+  int n = s.blob_len - ofs;
+  if (n > MULTIPART_FRAG_DATA_SIZE) n = MULTIPART_FRAG_DATA_SIZE;
+
+  payload[0] = ((s.count - 1 - idx) << 4) | s.type;
+  payload[1] = s.dest_hash;
+  payload[2] = src_hash;
+  payload[3] = s.msg_id;
+  payload[4] = (s.attempts[idx] << 6) | ((s.count - 1) << 3) | idx;
+  s.attempts[idx]++;
+  memcpy(&payload[MULTIPART_HEADER_SIZE], &s.blob[ofs], n);
+  return MULTIPART_HEADER_SIZE + n;
+}
+
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <MeshCore.h>
+#include <string.h>
+
+#ifndef MULTIPART_MAX_FRAGMENTS
+  #define MULTIPART_MAX_FRAGMENTS     4    // per message (max 8)
+#endif
+#ifndef MULTIPART_RECV_SLOTS
+  #define MULTIPART_RECV_SLOTS        2    // messages being reassembled at once (one per peer)
+#endif
+#ifndef MULTIPART_SEND_SLOTS
+  #define MULTIPART_SEND_SLOTS        2    // sent messages held for resending missing fragments
+#endif
+#ifndef MULTIPART_GAP_MILLIS
+  #define MULTIPART_GAP_MILLIS    12000    // no new fragment for this long, so ask for the missing ones
+#endif
+#ifndef MULTIPART_HOLD_MILLIS
+  #define MULTIPART_HOLD_MILLIS   60000    // how long a message (sent or received) is kept
+#endif
+
+#define MULTIPART_MAX_ACKS            3    // partial ACKs sent, before giving up on a message
+#define MULTIPART_MAX_ATTEMPTS        4    // sends of a fragment (first + resends)
+
+/*
+  Fragment payload (PAYLOAD_TYPE_MULTIPART):
+    [0] (remaining << 4) | type     type is PAYLOAD_TYPE_REQ, _RESPONSE or _TXT_MSG, remaining = count - 1 - index
+    [1] dest_hash
+    [2] src_hash
+    [3] msg_id
+    [4] (attempt << 6) | ((count - 1) << 3) | index
+    [5..] next part of the encrypted message (MAC + cipher text). All but the last fragment are full.
+
+  Fragment ACK payload (type is MULTIPART_TYPE_FRAG_ACK), sent by receiver:
+    [0] MULTIPART_TYPE_FRAG_ACK
+    [1] dest_hash  (ie. original sender)
+    [2] src_hash
+    [3] msg_id
+    [4] bitmap of fragments received
+    [5] random (so a repeated ACK isn't dropped as already seen)
+*/
+#define MULTIPART_TYPE_FRAG_ACK    0x0A    // same as PAYLOAD_TYPE_MULTIPART
+#define MULTIPART_HEADER_SIZE         5
+#define MULTIPART_FRAG_ACK_SIZE       6
+#define MULTIPART_FRAG_DATA_SIZE   (MAX_PACKET_PAYLOAD - MULTIPART_HEADER_SIZE)
+#define MULTIPART_MAX_BLOB         (MULTIPART_MAX_FRAGMENTS * MULTIPART_FRAG_DATA_SIZE)
+
+// max data (before encryption) that can be sent as multipart, or in a single datagram
+#define MULTIPART_MAX_DATA         (((MULTIPART_MAX_BLOB - CIPHER_MAC_SIZE) / CIPHER_BLOCK_SIZE) * CIPHER_BLOCK_SIZE)
+#define MULTIPART_SINGLE_MAX_DATA  (MAX_PACKET_PAYLOAD - CIPHER_MAC_SIZE - (CIPHER_BLOCK_SIZE - 1))    // as per Mesh::createDatagram()
+
+namespace mesh {
+
+/**
+ * \brief  Reassembles fragmented messages, in a fixed number of slots. A slot is per sender (src_hash),
+ *       so a new message from the same sender replaces one still in progress.
+ */
+class MultipartRecvBuffer {
+public:
+  enum State { FREE = 0, PARTIAL, DONE };
+
+private:
+  struct Slot {
+    uint8_t state;
+    uint8_t src_hash, msg_id, type, count;
+    uint8_t received;     // bitmap
+    uint8_t n_acks;
+    uint16_t last_len;    // length of last fragment's data
+    uint32_t started, last_heard;
+    uint8_t blob[MULTIPART_MAX_BLOB];
+  };
+  Slot _slots[MULTIPART_RECV_SLOTS];
+  uint8_t _data[MULTIPART_MAX_DATA + 1];   // decrypted message (+1, as handlers may null terminate)
+
+public:
+  MultipartRecvBuffer() { memset(_slots, 0, sizeof(_slots)); }
+
+  /**
+   * \brief  stores the fragment (the whole payload of a PAYLOAD_TYPE_MULTIPART packet)
+   * \param  completed  (OUT) set to true if this was the last missing fragment
+   * \returns  slot index, or -1 if fragment is invalid. NOTE: slot may already be DONE (ie. fragment was resent)
+   */
+  int addFragment(const uint8_t* payload, int len, uint32_t now, bool& completed);
+
+  /**
+   * \returns  the next slot which is waiting (for longer than MULTIPART_GAP_MILLIS) on missing fragments,
+   *        or -1. Slots held for MULTIPART_HOLD_MILLIS, or still missing fragments after MULTIPART_MAX_ACKS
+   *        partial ACKs, are freed.
+   */
+  int checkTimeouts(uint32_t now);
+
+  /**
+   * \brief  records that an ACK was sent for slot (and so restarts its gap timer)
+   */
+  void onAckSent(int i, uint32_t now) { _slots[i].n_acks++; _slots[i].last_heard = now; }
+
+  /**
+   * \brief  checks the MAC of the slot's reassembled message, and decrypts it into getData()
+   * \returns  length of decrypted data, or zero if MAC doesn't match (ie. wrong secret)
+   */
+  int decrypt(int i, const uint8_t* secret);
+  uint8_t* getData() { return _data; }
+
+  void markDone(int i) { _slots[i].state = DONE; }
+  void free(int i) { _slots[i].state = FREE; }
+
+  uint8_t getState(int i) const { return _slots[i].state; }
+  uint8_t getSrcHash(int i) const { return _slots[i].src_hash; }
+  uint8_t getMsgId(int i) const { return _slots[i].msg_id; }
+  uint8_t getType(int i) const { return _slots[i].type; }
+  uint8_t getReceived(int i) const { return _slots[i].received; }
+  const uint8_t* getBlob(int i) const { return _slots[i].blob; }
+  int getBlobLength(int i) const { return (_slots[i].count - 1) * MULTIPART_FRAG_DATA_SIZE + _slots[i].last_len; }
+};
+
+/**
+ * \brief  Holds sent messages (the encrypted blob, and how it was routed), so fragments can be resent.
+ */
+class MultipartSendBuffer {
+  struct Slot {
+    bool in_use;
+    uint8_t dest_hash, msg_id, type, count;
+    uint8_t attempts[MULTIPART_MAX_FRAGMENTS];
+    uint16_t blob_len;
+    uint8_t path_len;     // encoded, or 0xFF for flood
+    uint8_t path_hash_size;
+    uint32_t created;
+    uint8_t path[MAX_PATH_SIZE];
+    uint8_t blob[MULTIPART_MAX_BLOB];
+  };
+  Slot _slots[MULTIPART_SEND_SLOTS];
+
+  Slot& alloc(uint8_t type, uint8_t dest_hash, uint8_t msg_id, uint32_t now);
+
+public:
+  MultipartSendBuffer() { memset(_slots, 0, sizeof(_slots)); }
+
+  /**
+   * \returns  slot index (oldest slot is replaced if all are in use), or -1 if blob is too long
+   */
+  int add(uint8_t type, uint8_t dest_hash, uint8_t msg_id, const uint8_t* blob, int blob_len, uint32_t now);
+
+  /**
+   * \brief  same as above, but encrypts data (up to MULTIPART_MAX_DATA) straight into the slot
+   */
+  int add(uint8_t type, uint8_t dest_hash, uint8_t msg_id, const uint8_t* secret, const uint8_t* data, int data_len, uint32_t now);
+
+  void setRoute(int i, const uint8_t* path, uint8_t path_len, uint8_t path_hash_size);
+  bool isFlood(int i) const { return _slots[i].path_len == 0xFF; }
+  const uint8_t* getPath(int i) const { return _slots[i].path; }
+  uint8_t getPathLen(int i) const { return _slots[i].path_len; }
+  uint8_t getPathHashSize(int i) const { return _slots[i].path_hash_size; }
+
+  int find(uint8_t dest_hash, uint8_t msg_id) const;
+  int getCount(int i) const { return _slots[i].count; }
+  void free(int i) { _slots[i].in_use = false; }
+  void expire(uint32_t now);
+
+  /**
+   * \brief  writes payload for fragment 'idx' (bumping its attempt number)
+   * \returns  payload length, or 0 if fragment has been sent MULTIPART_MAX_ATTEMPTS times already
+   */
+  int writeFragment(int i, int idx, uint8_t src_hash, uint8_t* payload);
+};
+
+}
@@ -49,6 +49,8 @@ public:
   uint8_t path[MAX_PATH_SIZE];
   uint8_t payload[MAX_PACKET_PAYLOAD];
   int8_t _snr;
+  uint32_t _rx_millis;    // when received (0 if originated here), for forwarding delay
+  uint32_t _due_millis;   // when scheduled to transmit, for queue wait
 
   /**
    * \brief calculate the hash of payload + type
@@ -0,0 +1,94 @@
+#include "AlertEngine.h"
+
+void AlertEngine::fire(AlertTrigger& t, uint32_t now) {
+  uint32_t repeat = t.min_repeat_secs ? t.min_repeat_secs : _min_repeat_secs;
+  if (t.last_sent != 0 && now - t.last_sent < repeat) return;   // rate limited, try again on later check
+  if (_num_pending >= ALERT_MAX_PENDING) return;
+
+  t.notified = true;
+  t.pending = true;
+  _pending[_num_pending++] = &t;
+}
+
+void AlertEngine::removePending(AlertTrigger& t) {
+  int i = 0;
+  while (i < _num_pending && _pending[i] != &t) i++;
+  if (i < _num_pending) {   // found, now delete from array
+    _num_pending--;
+    while (i < _num_pending) {
+      _pending[i] = _pending[i + 1];
+      i++;
+    }
+  }
+  t.pending = false;
+}
+
+void AlertEngine::check(AlertTrigger& t, bool condition, uint8_t pri, const char* text, uint32_t now, uint32_t min_repeat_secs) {
+  if (condition) {
+    if (!t.active) {
+      t.active = true;
+      t.notified = false;
+    }
+    if (!t.notified) {
+      strncpy(t.text, text, sizeof(t.text) - 1);
+      t.text[sizeof(t.text) - 1] = 0;
+      t.pri = pri;
+      t.min_repeat_secs = min_repeat_secs;
+      fire(t, now);
+    }
+  } else if (t.active) {
+    t.active = false;
+    if (t.pending) removePending(t);   // no longer relevant
+  }
+}
+
+void AlertEngine::checkAbove(AlertTrigger& t, float value, float threshold, float hysteresis, uint8_t pri, const char* text, uint32_t now) {
+  bool condition = t.active ? value >= threshold - hysteresis : value > threshold;
+  check(t, condition, pri, text, now);
+}
+
+void AlertEngine::checkBelow(AlertTrigger& t, float value, float threshold, float hysteresis, uint8_t pri, const char* text, uint32_t now) {
+  bool condition = t.active ? value <= threshold + hysteresis : value < threshold;
+  check(t, condition, pri, text, now);
+}
+
+int AlertEngine::beginBatch(uint32_t now) {
+  _batch_len = 0;
+  int text_len = 0;
+  for (int pri = ALERT_NUM_PRI - 1; pri >= 0; pri--) {
+    int i = 0;
+    while (i < _num_pending) {
+      AlertTrigger* t = _pending[i];
+      int len = strlen(t->text) + (text_len > 0 ? 1 : 0);    // plus newline
+      if (t->pri != pri || text_len + len > ALERT_BATCH_TEXT) {
+        i++;
+        continue;     // leave for a later batch
+      }
+      Entry& e = _batch[_batch_len++];
+      e.pri = t->pri;
+      memcpy(e.text, t->text, sizeof(e.text));
+      text_len += len;
+      t->last_sent = now;
+      removePending(*t);   // NOTE: _pending[i] is now the next one
+    }
+  }
+  return _batch_len;
+}
+
+int AlertEngine::formatBatch(char* dest, int max_len, uint8_t pri_mask) const {
+  int highest = -1, ofs = 0;
+  dest[0] = 0;
+  for (int i = 0; i < _batch_len; i++) {
+    const Entry& e = _batch[i];
+    if ((pri_mask & (1 << e.pri)) == 0) continue;
+
+    int len = strlen(e.text);
+    if (ofs + (ofs > 0 ? 1 : 0) + len >= max_len) break;
+    if (ofs > 0) dest[ofs++] = '\n';
+    memcpy(&dest[ofs], e.text, len);
+    ofs += len;
+    dest[ofs] = 0;
+    if (e.pri > highest) highest = e.pri;
+  }
+  return highest;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef ALERT_MAX_PENDING
+  #define ALERT_MAX_PENDING         8    // alerts waiting to be sent
+#endif
+#ifndef ALERT_MAX_TEXT
+  #define ALERT_MAX_TEXT           48    // per alert
+#endif
+#ifndef ALERT_BATCH_TEXT
+  #define ALERT_BATCH_TEXT        160    // max text of one (coalesced) message
+#endif
+#ifndef ALERT_MIN_REPEAT_SECS
+  #define ALERT_MIN_REPEAT_SECS  (30*60) // default rate limit, per condition
+#endif
+
+#define ALERT_PRI_LOW     0
+#define ALERT_PRI_HIGH    1
+#define ALERT_NUM_PRI     2
+
+/**
+ * \brief  State of one alert condition (owned by the app, eg. one per threshold)
+ */
+struct AlertTrigger {
+  char text[ALERT_MAX_TEXT];
+  uint8_t pri;
+  bool active;            // condition is in alert state (after hysteresis)
+  bool notified;          // an alert has been queued since condition became active
+  bool pending;           // queued, not yet sent
+  uint32_t last_sent;     // when last included in a batch (RTC secs)
+  uint32_t min_repeat_secs;
+
+  AlertTrigger() { text[0] = 0; pri = ALERT_PRI_LOW; active = notified = pending = false; last_sent = 0; min_repeat_secs = 0; }
+  bool isTriggered() const { return active; }
+};
+
+/**
+ * \brief  Turns alert conditions into coalesced messages.
+ *
+ *   A condition only fires on becoming active (with optional hysteresis for thresholds), and at most once per
+ *   'min_repeat_secs' (so a flapping sensor sends at most one alert per period). Fired alerts are queued, and then
+ *   sent in batches: beginBatch() takes as many of the queued alerts as fit in one message (high priority first),
+ *   and formatBatch() gives the text for a recipient, ie. just the alerts of the priorities they want.
+ */
+class AlertEngine {
+  struct Entry {
+    uint8_t pri;
+    char text[ALERT_MAX_TEXT];
+  };
+
+  AlertTrigger* _pending[ALERT_MAX_PENDING];
+  int _num_pending;
+  Entry _batch[ALERT_MAX_PENDING];
+  int _batch_len;
+  uint32_t _min_repeat_secs;
+
+  void fire(AlertTrigger& t, uint32_t now);
+  void removePending(AlertTrigger& t);
+
+public:
+  AlertEngine() : _num_pending(0), _batch_len(0), _min_repeat_secs(ALERT_MIN_REPEAT_SECS) { }
+
+  void setMinRepeatSecs(uint32_t secs) { _min_repeat_secs = secs; }
+  uint32_t getMinRepeatSecs() const { return _min_repeat_secs; }
+
+  /**
+   * \brief  updates trigger with current state of condition
+   * \param  min_repeat_secs  rate limit for this trigger, or zero for the default
+   */
+  void check(AlertTrigger& t, bool condition, uint8_t pri, const char* text, uint32_t now, uint32_t min_repeat_secs=0);
+
+  /**
+   * \brief  alert when value rises above threshold, and reset only once it falls below (threshold - hysteresis)
+   */
+  void checkAbove(AlertTrigger& t, float value, float threshold, float hysteresis, uint8_t pri, const char* text, uint32_t now);
+
+  /**
+   * \brief  alert when value falls below threshold, and reset only once it rises above (threshold + hysteresis)
+   */
+  void checkBelow(AlertTrigger& t, float value, float threshold, float hysteresis, uint8_t pri, const char* text, uint32_t now);
+
+  int getNumPending() const { return _num_pending; }
+
+  /**
+   * \brief  moves queued alerts (as many as fit in one message, high priority first) into the current batch
+   * \returns  number of alerts in batch
+   */
+  int beginBatch(uint32_t now);
+  int getBatchSize() const { return _batch_len; }
+  void endBatch() { _batch_len = 0; }
+
+  /**
+   * \brief  text of current batch for a recipient, ie. alerts with a priority in 'pri_mask' (bit per ALERT_PRI_*),
+   *      one per line
+   * \returns  highest priority included, or -1 if none for this recipient
+   */
+  int formatBatch(char* dest, int max_len, uint8_t pri_mask) const;
+};
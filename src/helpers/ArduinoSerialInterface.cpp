@@ -8,6 +8,7 @@
 void ArduinoSerialInterface::enable() { 
   _isEnabled = true;
   _state = RECV_STATE_IDLE;
+  in_pos = in_len = 0;
 }
 void ArduinoSerialInterface::disable() {
   _isEnabled = false;
@@ -27,46 +28,63 @@ size_t ArduinoSerialInterface::writeFrame(const uint8_t src[], size_t len) {
     return 0;
   }
 
-  uint8_t hdr[3];
-  hdr[0] = '>';
-  hdr[1] = (len & 0xFF);  // LSB
-  hdr[2] = (len >> 8);    // MSB
+  uint8_t buf[3 + MAX_FRAME_SIZE];   // gather header + frame, so it goes out in a single write()
+  buf[0] = '>';
+  buf[1] = (len & 0xFF);  // LSB
+  buf[2] = (len >> 8);    // MSB
+  memcpy(&buf[3], src, len);
 
-  _serial->write(hdr, 3);
-  return _serial->write(src, len);
+  size_t n = _serial->write(buf, 3 + len);
+  return n > 3 ? n - 3 : 0;
 }
 
 size_t ArduinoSerialInterface::checkRecvFrame(uint8_t dest[]) {
-  while (_serial->available()) {
-    int c = _serial->read();
-    if (c < 0) break;
+  for (;;) {
+    if (in_pos >= in_len) {   // staging buffer consumed, pull in next chunk
+      int avail = _serial->available();
+      if (avail <= 0) break;
+      in_len = _serial->readBytes(in_buf, avail < (int)sizeof(in_buf) ? avail : sizeof(in_buf));
+      in_pos = 0;
+      if (in_len == 0) break;
+    }
 
     switch (_state) {
-      case RECV_STATE_IDLE:
-        if (c == '<') {
+      case RECV_STATE_IDLE: {
+        const uint8_t* hdr = (const uint8_t*) memchr(&in_buf[in_pos], '<', in_len - in_pos);
+        if (hdr) {
+          in_pos = (hdr - in_buf) + 1;
           _state = RECV_STATE_HDR_FOUND;
+        } else {
+          in_pos = in_len;   // no frame start in this chunk
         }
         break;
+      }
       case RECV_STATE_HDR_FOUND:
-        _frame_len = (uint8_t)c;   // LSB
+        _frame_len = in_buf[in_pos++];   // LSB
         _state = RECV_STATE_LEN1_FOUND;
         break;
       case RECV_STATE_LEN1_FOUND:
-        _frame_len |= ((uint16_t)c) << 8;   // MSB
+        _frame_len |= ((uint16_t)in_buf[in_pos++]) << 8;   // MSB
         rx_len = 0;
         _state = _frame_len > 0 ? RECV_STATE_LEN2_FOUND : RECV_STATE_IDLE;
         break;
-      default:
-        if (rx_len < MAX_FRAME_SIZE) {
-          rx_buf[rx_len] = (uint8_t)c;   // rest of frame will be discarded if > MAX
+      default: {
+        uint16_t n = in_len - in_pos;
+        if (n > _frame_len - rx_len) n = _frame_len - rx_len;
+        if (rx_len < MAX_FRAME_SIZE) {   // rest of frame will be discarded if > MAX
+          uint16_t keep = n;
+          if (keep > MAX_FRAME_SIZE - rx_len) keep = MAX_FRAME_SIZE - rx_len;
+          memcpy(&rx_buf[rx_len], &in_buf[in_pos], keep);
         }
-        rx_len++;
+        in_pos += n;
+        rx_len += n;
         if (rx_len >= _frame_len) {  // received a complete frame?
           if (_frame_len > MAX_FRAME_SIZE) _frame_len = MAX_FRAME_SIZE;    // truncate
           memcpy(dest, rx_buf, _frame_len);
           _state = RECV_STATE_IDLE;  // reset state, for next frame
           return _frame_len;
         }
+      }
     }
   }
   return 0;
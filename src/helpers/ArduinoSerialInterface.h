@@ -3,6 +3,10 @@
 #include "BaseSerialInterface.h"
 #include <Arduino.h>
 
+#ifndef SERIAL_RX_CHUNK_SIZE
+  #define SERIAL_RX_CHUNK_SIZE  64    // bytes pulled from Stream per readBytes()
+#endif
+
 class ArduinoSerialInterface : public BaseSerialInterface {
   bool _isEnabled;
   uint8_t _state;
@@ -10,9 +14,11 @@ class ArduinoSerialInterface : public BaseSerialInterface {
   uint16_t rx_len;
   Stream* _serial;
   uint8_t rx_buf[MAX_FRAME_SIZE];
+  uint8_t in_buf[SERIAL_RX_CHUNK_SIZE];   // staging for bulk reads, parsed in place
+  uint16_t in_pos, in_len;
 
 public:
-  ArduinoSerialInterface() { _isEnabled = false; _state = 0; }
+  ArduinoSerialInterface() { _isEnabled = false; _state = 0; in_pos = in_len = 0; }
 
   void begin(Stream& serial) { 
     _serial = &serial; 
@@ -31,4 +37,4 @@ public:
   bool isWriteBusy() const override;
   size_t writeFrame(const uint8_t src[], size_t len) override;
   size_t checkRecvFrame(uint8_t dest[]) override;
-};
\ No newline at end of file
+};
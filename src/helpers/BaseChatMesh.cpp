@@ -313,6 +313,22 @@ void BaseChatMesh::onPeerDataRecv(mesh::Packet* packet, uint8_t type, int sender
   }
 }
 
+void BaseChatMesh::sendMultipartAck(mesh::Packet* ack, int sender_idx) {
+  int i = matching_peer_indexes[sender_idx];
+  if (i < 0 || i >= num_contacts) {
+    MESH_DEBUG_PRINTLN("sendMultipartAck: Invalid sender idx: %d", i);
+    releasePacket(ack);
+    return;
+  }
+
+  ContactInfo& from = contacts[i];
+  if (from.out_path_len != OUT_PATH_UNKNOWN) {  // we have an out_path, so send DIRECT
+    sendDirect(ack, from.out_path, from.out_path_len);
+  } else {
+    sendFloodScoped(from, ack);
+  }
+}
+
 bool BaseChatMesh::onPeerPathRecv(mesh::Packet* packet, int sender_idx, const uint8_t* secret, uint8_t* path, uint8_t path_len, uint8_t extra_type, uint8_t* extra, uint8_t extra_len) {
   int i = matching_peer_indexes[sender_idx];
   if (i < 0 || i >= num_contacts) {
@@ -326,10 +342,15 @@ bool BaseChatMesh::onPeerPathRecv(mesh::Packet* packet, int sender_idx, const ui
 }
 
 bool BaseChatMesh::onContactPathRecv(ContactInfo& from, uint8_t* in_path, uint8_t in_path_len, uint8_t* out_path, uint8_t out_path_len, uint8_t extra_type, uint8_t* extra, uint8_t extra_len) {
-  // NOTE: default impl, we just replace the current 'out_path' regardless, whenever sender sends us a new out_path.
-  // FUTURE: could store multiple out_paths per contact, and try to find which is the 'best'(?)
-  from.out_path_len = mesh::Packet::copyPath(from.out_path, out_path, out_path_len);  // store a copy of path, for sendDirect()
-  from.lastmod = getRTCClock()->getCurrentTime();
+  // NOTE: default impl, keep a few out_paths per contact, and use the 'best' (by link quality) for sendDirect().
+  //       A newly received path is used unless another candidate scores better.
+  uint32_t now = getRTCClock()->getCurrentTime();
+  if (from.out_path_len != OUT_PATH_UNKNOWN && !link_quality.hasRoute(from.id.pub_key)) {
+    link_quality.addPath(from.id.pub_key, from.out_path, from.out_path_len, from.lastmod);  // existing path is a candidate too
+  }
+  link_quality.addPath(from.id.pub_key, out_path, out_path_len, now);
+  link_quality.selectPath(from.id.pub_key, from.out_path, from.out_path_len, now, false);
+  from.lastmod = now;
 
   onContactPathUpdated(from);
 
@@ -344,6 +365,27 @@ bool BaseChatMesh::onContactPathRecv(ContactInfo& from, uint8_t* in_path, uint8_
   return true;  // send reciprocal path if necessary
 }
 
+mesh::DispatcherAction BaseChatMesh::onRecvPacket(mesh::Packet* pkt) {
+  link_quality.onPacketRecv(pkt, getRTCClock()->getCurrentTime());
+  return Mesh::onRecvPacket(pkt);
+}
+
+void BaseChatMesh::onTraceRecv(mesh::Packet* packet, uint32_t tag, uint32_t auth_code, uint8_t flags, const uint8_t* path_snrs, const uint8_t* path_hashes, uint8_t path_len) {
+  link_quality.onTraceRecv(flags, path_snrs, path_hashes, path_len, packet->_snr, getRTCClock()->getCurrentTime());
+}
+
+void BaseChatMesh::reselectPaths() {
+  uint32_t now = getRTCClock()->getCurrentTime();
+  for (int i = MAX_ANON_CONTACTS; i < num_contacts; i++) {
+    ContactInfo& c = contacts[i];
+    // NOTE: contacts set to flood (OUT_PATH_UNKNOWN) are left alone
+    if (c.out_path_len != OUT_PATH_UNKNOWN && link_quality.selectPath(c.id.pub_key, c.out_path, c.out_path_len, now, true)) {
+      MESH_DEBUG_PRINTLN("reselectPaths(): new path for %s, path_len=%d", c.name, (uint32_t) c.out_path_len);
+      onContactPathUpdated(c);
+    }
+  }
+}
+
 void BaseChatMesh::onAckRecv(mesh::Packet* packet, uint32_t ack_crc) {
   ContactInfo* from;
   if ((from = processAck((uint8_t *)&ack_crc)) != NULL) {
@@ -801,7 +843,12 @@ void BaseChatMesh::checkConnections() {
 }
 
 void BaseChatMesh::resetPathTo(ContactInfo& recipient) {
+  if (recipient.out_path_len != OUT_PATH_UNKNOWN) {
+    link_quality.removePath(recipient.id.pub_key, recipient.out_path, recipient.out_path_len);
+  }
+  // switch to next best known path, if any, otherwise flood (OUT_PATH_UNKNOWN)
   recipient.out_path_len = OUT_PATH_UNKNOWN;
+  link_quality.selectPath(recipient.id.pub_key, recipient.out_path, recipient.out_path_len, getRTCClock()->getCurrentTime(), false);
 }
 
 static ContactInfo* table;  // pass via global :-(
@@ -966,4 +1013,8 @@ void BaseChatMesh::loop() {
     releasePacket(_pendingLoopback);   // undo the obtainNewPacket()
     _pendingLoopback = NULL;
   }
+
+  if (link_quality.checkDirty()) {
+    reselectPaths();   // link SNRs have changed
+  }
 }
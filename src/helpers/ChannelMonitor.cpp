@@ -0,0 +1,119 @@
+#include "ChannelMonitor.h"
+#include <string.h>
+
+#define NOISE_SAMPLE_WEIGHT   256    // so histogram counts decay smoothly, even with few readings
+#define MAX_CATCHUP_STEPS      64    // (15/16)^64 is under 2%, so just clear the window
+
+static const uint32_t window_millis[CHANNEL_NUM_WINDOWS] = { 60UL*1000, 60UL*60*1000, 24UL*60*60*1000 };
+
+uint32_t ChannelMonitor::getWindowMillis(int w) {
+  return window_millis[w];
+}
+
+void ChannelMonitor::reset() {
+  memset(_windows, 0, sizeof(_windows));
+  for (int w = 0; w < CHANNEL_NUM_WINDOWS; w++) {
+    _windows[w].next_decay = window_millis[w] / CHANNEL_DECAY_STEPS;
+  }
+  _last_update = _total_ms = 0;
+  _started = false;
+}
+
+void ChannelMonitor::decay(Window& w) {
+  w.elapsed_ms -= w.elapsed_ms >> 4;
+  w.busy_ms -= w.busy_ms >> 4;
+  w.rx_ms -= w.rx_ms >> 4;
+  w.tx_ms -= w.tx_ms >> 4;
+  for (int i = 0; i < CHANNEL_NOISE_BINS; i++) {
+    w.noise_hist[i] -= w.noise_hist[i] >> 4;
+  }
+}
+
+void ChannelMonitor::update(uint32_t now_ms) {
+  if (!_started) {
+    _last_update = now_ms;
+    _started = true;
+    return;
+  }
+  uint32_t dt = now_ms - _last_update;
+  _last_update = now_ms;
+  _total_ms += dt;
+
+  for (int i = 0; i < CHANNEL_NUM_WINDOWS; i++) {
+    Window& w = _windows[i];
+    w.elapsed_ms += dt;
+
+    uint32_t step = window_millis[i] / CHANNEL_DECAY_STEPS;
+    int n = 0;
+    while ((int32_t)(_total_ms - w.next_decay) >= 0) {   // NOTE: wrap safe
+      if (++n > MAX_CATCHUP_STEPS) {   // long gap (eg. deep sleep), all old data has gone
+        memset(&w, 0, sizeof(w));
+        w.next_decay = _total_ms + step;
+        break;
+      }
+      decay(w);
+      w.next_decay += step;
+    }
+  }
+}
+
+void ChannelMonitor::addBusy(uint32_t millis) {
+  for (int i = 0; i < CHANNEL_NUM_WINDOWS; i++) _windows[i].busy_ms += millis;
+}
+
+void ChannelMonitor::addRecv(uint32_t airtime_ms) {
+  for (int i = 0; i < CHANNEL_NUM_WINDOWS; i++) _windows[i].rx_ms += airtime_ms;
+}
+
+void ChannelMonitor::addSent(uint32_t airtime_ms) {
+  for (int i = 0; i < CHANNEL_NUM_WINDOWS; i++) _windows[i].tx_ms += airtime_ms;
+}
+
+void ChannelMonitor::addNoiseFloor(int noise_floor) {
+  int b = 0;
+  if (noise_floor >= CHANNEL_NOISE_BASE) {
+    b = (noise_floor - CHANNEL_NOISE_BASE) / CHANNEL_NOISE_STEP;
+    if (b >= CHANNEL_NOISE_BINS) b = CHANNEL_NOISE_BINS - 1;
+  }
+  for (int i = 0; i < CHANNEL_NUM_WINDOWS; i++) _windows[i].noise_hist[b] += NOISE_SAMPLE_WEIGHT;
+}
+
+static uint16_t permille(uint32_t part, uint32_t total) {
+  if (total == 0) return 0;
+  uint32_t p = (uint32_t)(((uint64_t)part * 1000) / total);
+  return p > 1000 ? 1000 : p;
+}
+
+uint16_t ChannelMonitor::getBusyPermille(int w) const {
+  return permille(_windows[w].busy_ms, _windows[w].elapsed_ms);
+}
+uint16_t ChannelMonitor::getRecvPermille(int w) const {
+  return permille(_windows[w].rx_ms, _windows[w].elapsed_ms);
+}
+uint16_t ChannelMonitor::getSentPermille(int w) const {
+  return permille(_windows[w].tx_ms, _windows[w].elapsed_ms);
+}
+
+int ChannelMonitor::getNoisePercentile(int w, int pct) const {
+  const uint32_t* hist = _windows[w].noise_hist;
+  uint64_t total = 0;
+  for (int i = 0; i < CHANNEL_NOISE_BINS; i++) total += hist[i];
+  if (total == 0) return 0;
+
+  uint64_t target = (total * pct + 99) / 100;
+  uint64_t sum = 0;
+  int i = 0;
+  for ( ; i < CHANNEL_NOISE_BINS - 1; i++) {
+    sum += hist[i];
+    if (sum >= target) break;
+  }
+  return CHANNEL_NOISE_BASE + (i + 1) * CHANNEL_NOISE_STEP;   // upper edge of bin
+}
+
+uint8_t ChannelMonitor::getNoiseBinPercent(int w, int i) const {
+  const uint32_t* hist = _windows[w].noise_hist;
+  uint64_t total = 0;
+  for (int j = 0; j < CHANNEL_NOISE_BINS; j++) total += hist[j];
+  if (total == 0) return 0;
+  return (uint8_t)((hist[i] * 100ULL + total / 2) / total);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+
+#define CHANNEL_WINDOW_MINUTE   0
+#define CHANNEL_WINDOW_HOUR     1
+#define CHANNEL_WINDOW_DAY      2
+#define CHANNEL_NUM_WINDOWS     3
+
+#define CHANNEL_NOISE_BINS      8
+#define CHANNEL_NOISE_BASE   -125    // lower edge of first bin (dBm), everything below goes in first bin
+#define CHANNEL_NOISE_STEP      5    // dB per bin, everything above the last edge goes in the last bin
+
+#define CHANNEL_DECAY_STEPS    16    // each window decays by 1/16, 16 times per window length
+
+/**
+ * \brief  Channel utilisation and noise floor, over 1 minute, 1 hour and 1 day, in fixed memory.
+ *
+ *   Each window keeps exponentially decaying totals of elapsed, busy, RX and TX time, plus a histogram of
+ *   noise floor readings. Every (window / CHANNEL_DECAY_STEPS) all of that window's totals are scaled
+ *   by 15/16, so the busy/RX/TX fractions are (roughly) averages over the window length.
+ */
+class ChannelMonitor {
+public:
+  struct Window {
+    uint32_t elapsed_ms, busy_ms, rx_ms, tx_ms;
+    uint32_t noise_hist[CHANNEL_NOISE_BINS];
+    uint32_t next_decay;    // elapsed millis (since begin) when next decay step is due
+  };
+
+private:
+  Window _windows[CHANNEL_NUM_WINDOWS];
+  uint32_t _last_update, _total_ms;
+  bool _started;
+
+  void decay(Window& w);
+
+public:
+  ChannelMonitor() { reset(); }
+
+  void reset();
+
+  /**
+   * \brief  advances the clock (all windows accumulate elapsed time). Call at least every few seconds.
+   */
+  void update(uint32_t now_ms);
+
+  void addBusy(uint32_t millis);
+  void addRecv(uint32_t airtime_ms);
+  void addSent(uint32_t airtime_ms);
+  void addNoiseFloor(int noise_floor);
+
+  static uint32_t getWindowMillis(int w);
+  const Window& getWindow(int w) const { return _windows[w]; }
+
+  // fractions of elapsed time, in per-mille (0..1000)
+  uint16_t getBusyPermille(int w) const;
+  uint16_t getRecvPermille(int w) const;
+  uint16_t getSentPermille(int w) const;
+
+  /**
+   * \returns  the noise floor (dBm, to bin resolution) that 'pct' percent of readings were at or below,
+   *           or zero if no readings yet
+   */
+  int getNoisePercentile(int w, int pct) const;
+
+  /**
+   * \returns  share of noise floor readings in bin 'i', in percent
+   */
+  uint8_t getNoiseBinPercent(int w, int i) const;
+};
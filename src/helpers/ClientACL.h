@@ -28,6 +28,17 @@ struct ClientInfo {
       unsigned long ack_timeout;
       uint8_t  push_failures;
     } room;
+    struct {
+      uint32_t expires;     // by OUR clock (NOTE: first, as room.sync_since is persisted)
+      uint32_t tag;         // of subscribe request, echoed in each push (zero if not subscribed)
+      uint32_t next_push;   // by OUR clock
+      uint16_t period_secs;
+      uint16_t min_delta;   // in steps of the LPP type's resolution
+      uint8_t  perm_mask;
+      uint8_t  slot;        // index of app's per-subscriber state
+      uint8_t  seq;
+      uint8_t  num_pushes;  // since last full refresh
+    } telem;                // telemetry subscription (sensors)
   } extra;
   
   bool isAdmin() const { return (permissions & PERM_ACL_ROLE_MASK) == PERM_ACL_ADMIN; }
@@ -0,0 +1,80 @@
+#include "CommandTable.h"
+
+static bool isPrefix(const char* prefix, const char* text) {
+  return strncmp(prefix, text, strlen(prefix)) == 0;
+}
+
+CommandTable::CommandTable(const CommandDef* defs, int num) {
+  _defs = defs;
+  _num = num < NONE ? num : NONE - 1;
+  _sorted = new uint8_t[_num];
+  _parent = new uint8_t[_num];
+
+  // insertion sort, just once
+  for (int i = 0; i < _num; i++) {
+    int p = i;
+    while (p > 0 && strcmp(_defs[_sorted[p - 1]].name, _defs[i].name) > 0) {
+      _sorted[p] = _sorted[p - 1];
+      p--;
+    }
+    _sorted[p] = i;
+  }
+
+  // any name which is a prefix of entry 'i' sorts before it, and is either entry i-1, or one of its parents
+  for (int i = 0; i < _num; i++) {
+    int p = i - 1;
+    while (p >= 0 && !isPrefix(at(p)->name, at(i)->name)) {
+      p = _parent[p] == NONE ? -1 : _parent[p];
+    }
+    _parent[i] = p < 0 ? NONE : p;
+  }
+}
+
+int CommandTable::lowerBound(const char* text) const {
+  int lo = 0, hi = _num;   // first position with name >= text
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (strcmp(at(mid)->name, text) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+const CommandDef* CommandTable::lookup(const char* text, bool from_serial, const char** args) const {
+  // last name <= text. Any name which is a prefix of text must also be a prefix of this one (or be this one)
+  int pos = lowerBound(text);
+  if (pos >= _num || strcmp(at(pos)->name, text) != 0) pos--;
+
+  while (pos >= 0) {
+    const CommandDef* def = at(pos);
+    int len = strlen(def->name);
+    bool match = strncmp(def->name, text, len) == 0;
+    if (match && (def->flags & CMD_FLAG_SERIAL_ONLY) && !from_serial) match = false;
+    if (match && (def->flags & CMD_FLAG_EXACT) && text[len] != 0) match = false;
+    if (match && (def->flags & CMD_FLAG_WHOLE_WORD) && text[len] != 0 && text[len] != ' ') match = false;
+    if (match) {
+      if (args) {
+        const char* sp = &text[len];
+        while (*sp == ' ') sp++;
+        *args = sp;
+      }
+      return def;
+    }
+    pos = _parent[pos] == NONE ? -1 : _parent[pos];   // try next shorter name
+  }
+  return NULL;
+}
+
+int CommandTable::complete(const char* partial, bool from_serial, const CommandDef* dest[], int max_num) const {
+  int n = 0;
+  for (int pos = lowerBound(partial); pos < _num && isPrefix(partial, at(pos)->name); pos++) {
+    const CommandDef* def = at(pos);
+    if ((def->flags & CMD_FLAG_SERIAL_ONLY) && !from_serial) continue;
+    if (n < max_num) dest[n] = def;
+    n++;
+  }
+  return n;
+}
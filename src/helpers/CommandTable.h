@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#define CMD_FLAG_SERIAL_ONLY   0x01   // only from local serial console, not from remote admins
+#define CMD_FLAG_WHOLE_WORD    0x02   // name must be followed by end of text, or a space
+#define CMD_FLAG_EXACT         0x04   // name must be whole of text
+
+struct CommandDef {
+  const char* name;
+  uint8_t id;
+  uint8_t flags;   // CMD_FLAG_*
+};
+
+/**
+ * \brief  Maps command text to a CommandDef, by the longest name which is a prefix of the text (same as a chain of
+ *      memcmp()'s with longer names first). Names are sorted once, at construction, so a lookup is a binary search
+ *      plus a short walk up the names which are prefixes of others, rather than a compare against every command.
+ *      The sorted order also gives listing, and completion of partial names.
+ */
+class CommandTable {
+  static const uint8_t NONE = 0xFF;
+
+  const CommandDef* _defs;
+  uint8_t* _sorted;   // indexes into _defs, in name order
+  uint8_t* _parent;   // for each sorted entry, position of longest other name which is a prefix of it, or NONE
+  int _num;
+
+  const CommandDef* at(int pos) const { return &_defs[_sorted[pos]]; }
+  int lowerBound(const char* text) const;
+
+public:
+  /**
+   * \param  defs  must outlive this table. At most 254 entries, and no duplicate names.
+   */
+  CommandTable(const CommandDef* defs, int num);
+
+  int getCount() const { return _num; }
+
+  /**
+   * \returns  the i'th command, in name order
+   */
+  const CommandDef* getSorted(int i) const { return at(i); }
+
+  /**
+   * \param  from_serial  false if from a remote admin (CMD_FLAG_SERIAL_ONLY commands are skipped)
+   * \param  args  (optional) receives pointer to text after the command name, with leading spaces skipped
+   * \returns  NULL if no match
+   */
+  const CommandDef* lookup(const char* text, bool from_serial, const char** args = NULL) const;
+
+  /**
+   * \brief  finds commands whose names start with 'partial', in name order (eg. for listing, or auto-complete)
+   * \returns  total number of matches, of which first 'max_num' are put in 'dest'
+   */
+  int complete(const char* partial, bool from_serial, const CommandDef* dest[], int max_num) const;
+};
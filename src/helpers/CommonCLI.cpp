@@ -27,7 +27,33 @@ static bool isValidName(const char *n) {
   return true;
 }
 
+bool CommonCLI::loadPrefsBinary(FILESYSTEM* fs) {
+#if defined(RP2040_PLATFORM)
+  File file = fs->open("/prefs.bin", "r");
+#else
+  File file = fs->open("/prefs.bin");
+#endif
+  if (!file) return false;
+
+  bool success = false;
+  int len = file.size();
+  if (len > 0 && len <= CONFIG_BINARY_HDR_SIZE + CONFIG_BINARY_MAX_SIZE) {
+    uint8_t* buf = new uint8_t[len];
+    if (file.read(buf, len) == len) {   // whole file in one read
+      success = _prefs->loadBinary(buf, len);
+    }
+    delete[] buf;
+  }
+  file.close();
+  return success;
+}
+
 void CommonCLI::loadPrefs(FILESYSTEM* fs) {
+  if (fs->exists("/prefs.bin")) {
+    if (loadPrefsBinary(fs)) return;   // compact binary prefs
+    MESH_DEBUG_PRINTLN("loadPrefs: /prefs.bin is corrupt, trying /prefs.json");
+  }
+
   if (fs->exists("/prefs.json")) {
 #if defined(RP2040_PLATFORM)
     File file = fs->open("/prefs.json", "r");
@@ -35,12 +61,13 @@ void CommonCLI::loadPrefs(FILESYSTEM* fs) {
     File file = fs->open("/prefs.json");
 #endif
     if (file) {
-      _prefs->loadSerial(file);   // new Serial prefs
+      bool success = _prefs->loadSerial(file);   // Serial (json) prefs
       file.close();
+      if (success) savePrefs(fs);   // migrate to binary prefs
     }
   } else if (fs->exists("/com_prefs")) {
     loadPrefsInt(fs, "/com_prefs");
-    if (savePrefs(fs)) {  // save to new Serial prefs
+    if (savePrefs(fs)) {  // save to new binary prefs
   //    fs->remove("/com_prefs");  // remove old
     }
   }
@@ -140,7 +167,7 @@ void CommonCLI::loadPrefsInt(FILESYSTEM* fs, const char* filename) {  // Legacy
   }
 }
 
-bool CommonCLI::savePrefs(FILESYSTEM* fs) {
+bool CommonCLI::savePrefsSerial(FILESYSTEM* fs) {
 #if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
   fs->remove("/prefs.json");
   File file = fs->open("/prefs.json", FILE_O_WRITE);
@@ -152,11 +179,38 @@ bool CommonCLI::savePrefs(FILESYSTEM* fs) {
   if (file) {
     bool success = _prefs->saveSerial(file);
     file.close();
-    return success;
+    if (success) return true;
   }
+  fs->remove("/prefs.json");   // don't leave a stale or partial copy to fall back to
   return false;
 }
 
+bool CommonCLI::savePrefs(FILESYSTEM* fs) {
+  // JSON copy first: it is what older firmware loads (so a downgrade keeps its settings), and the fallback if prefs.bin is corrupt
+  savePrefsSerial(fs);
+
+  int len = _prefs->saveBinary(NULL, 0);
+  if (len <= 0) return false;
+  uint8_t* buf = new uint8_t[len];
+  _prefs->saveBinary(buf, len);
+
+#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+  fs->remove("/prefs.bin");
+  File file = fs->open("/prefs.bin", FILE_O_WRITE);
+#elif defined(RP2040_PLATFORM)
+  File file = fs->open("/prefs.bin", "w");
+#else
+  File file = fs->open("/prefs.bin", "w", true);
+#endif
+  bool success = false;
+  if (file) {
+    success = file.write(buf, len) == len;   // whole file in one write
+    file.close();
+  }
+  delete[] buf;
+  return success;
+}
+
 #define MIN_LOCAL_ADVERT_INTERVAL   60
 
 void CommonCLI::savePrefs() {
@@ -180,23 +234,30 @@ uint8_t CommonCLI::buildAdvertData(uint8_t node_type, uint8_t* app_data) {
 }
 
 void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* reply) {
-    if (memcmp(command, "poweroff", 8) == 0 || memcmp(command, "shutdown", 8) == 0) {
+  const CommandDef* def = _commands.lookup(command, sender_timestamp == 0);
+  switch (def ? def->id : CLI_UNKNOWN) {
+    case CLI_CMD_POWEROFF:
       _board->powerOff();  // doesn't return
-    } else if (memcmp(command, "reboot", 6) == 0) {
+      break;
+    case CLI_CMD_REBOOT:
       _board->reboot();  // doesn't return
-    } else if (memcmp(command, "clkreboot", 9) == 0) {
+      break;
+    case CLI_CMD_CLKREBOOT:
       // Reset clock
       getRTCClock()->setCurrentTime(1715770351);  // 15 May 2024, 8:50pm
       _board->reboot();  // doesn't return
-     } else if (memcmp(command, "advert.zerohop", 14) == 0 && (command[14] == 0 || command[14] == ' ')) {
+      break;
+    case CLI_CMD_ADVERT_ZEROHOP:
       // send zerohop advert
       _callbacks->sendSelfAdvertisement(1500, false);  // longer delay, give CLI response time to be sent first
       strcpy(reply, "OK - zerohop advert sent");
-    } else if (memcmp(command, "advert", 6) == 0) {
+      break;
+    case CLI_CMD_ADVERT:
       // send flood advert
       _callbacks->sendSelfAdvertisement(1500, true);  // longer delay, give CLI response time to be sent first
       strcpy(reply, "OK - Advert sent");
-    } else if (memcmp(command, "clock sync", 10) == 0) {
+      break;
+    case CLI_CMD_CLOCK_SYNC: {
       uint32_t curr = getRTCClock()->getCurrentTime();
       if (sender_timestamp > curr) {
         getRTCClock()->setCurrentTime(sender_timestamp + 1);
@@ -206,15 +267,20 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "ERR: clock cannot go backwards");
       }
-    } else if (memcmp(command, "start ota", 9) == 0) {
+      break;
+    }
+    case CLI_CMD_START_OTA:
       if (!_board->startOTAUpdate(_prefs->node_name, reply)) {
         strcpy(reply, "Error");
       }
-    } else if (memcmp(command, "clock", 5) == 0) {
+      break;
+    case CLI_CMD_CLOCK: {
       uint32_t now = getRTCClock()->getCurrentTime();
       DateTime dt = DateTime(now);
       sprintf(reply, "%02d:%02d - %d/%d/%d UTC", dt.hour(), dt.minute(), dt.day(), dt.month(), dt.year());
-    } else if (memcmp(command, "time ", 5) == 0) {  // set time (to epoch seconds)
+      break;
+    }
+    case CLI_CMD_TIME: {  // set time (to epoch seconds)
       uint32_t secs = _atoi(&command[5]);
       uint32_t curr = getRTCClock()->getCurrentTime();
       if (secs > curr) {
@@ -225,9 +291,12 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "(ERR: clock cannot go backwards)");
       }
-    } else if (memcmp(command, "neighbors", 9) == 0) {
+      break;
+    }
+    case CLI_CMD_NEIGHBORS:
       _callbacks->formatNeighborsReply(reply);
-    } else if (memcmp(command, "neighbor.remove ", 16) == 0) {
+      break;
+    case CLI_CMD_NEIGHBOR_REMOVE: {
       const char* hex = &command[16];
       uint8_t pubkey[PUB_KEY_SIZE];
       int hex_len = min((int)strlen(hex), PUB_KEY_SIZE*2);
@@ -238,8 +307,10 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "ERR: bad pubkey");
       }
-    } else if (memcmp(command, "tempradio ", 10) == 0) {
-      strcpy(tmp, &command[10]);
+      break;
+    }
+    case CLI_CMD_TEMPRADIO: {
+      StrHelper::strncpy(tmp, &command[10], sizeof(tmp));
       const char *parts[5];
       int num = mesh::Utils::parseTextParts(tmp, parts, 5);
       float freq  = num > 0 ? strtof(parts[0], nullptr) : 0.0f;
@@ -253,27 +324,37 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "Error, invalid params");
       }
-    } else if (memcmp(command, "password ", 9) == 0) {
+      break;
+    }
+    case CLI_CMD_PASSWORD:
       // change admin password
       StrHelper::strncpy(_prefs->password, &command[9], sizeof(_prefs->password));
       savePrefs();
       sprintf(reply, "password now: ");
       StrHelper::strncpy(&reply[14], _prefs->password, 160-15);   // echo back just to let admin know for sure!!
-    } else if (memcmp(command, "clear stats", 11) == 0) {
+      break;
+    case CLI_CMD_CLEAR_STATS:
       _callbacks->clearStats();
       strcpy(reply, "(OK - stats reset)");
-    } else if (memcmp(command, "get ", 4) == 0) {
+      break;
+    case CLI_CMD_GET:
       handleGetCmd(sender_timestamp, command, reply);
-    } else if (memcmp(command, "set ", 4) == 0) {
+      break;
+    case CLI_CMD_SET:
       handleSetCmd(sender_timestamp, command, reply);
-    } else if (sender_timestamp == 0 && strcmp(command, "erase") == 0) {
+      break;
+    case CLI_CMD_ERASE: {
       bool s = _callbacks->formatFileSystem();
       sprintf(reply, "File system erase: %s", s ? "OK" : "Err");
-    } else if (memcmp(command, "ver", 3) == 0) {
+      break;
+    }
+    case CLI_CMD_VER:
       sprintf(reply, "%s (Build: %s)", _callbacks->getFirmwareVer(), _callbacks->getBuildDate());
-    } else if (memcmp(command, "board", 5) == 0) {
+      break;
+    case CLI_CMD_BOARD:
       sprintf(reply, "%s", _board->getManufacturerName());
-    } else if (memcmp(command, "sensor get ", 11) == 0) {
+      break;
+    case CLI_CMD_SENSOR_GET: {
       const char* key = command + 11;
       const char* val = _sensors->getSettingByKey(key);
       if (val != NULL) {
@@ -281,8 +362,10 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "null");
       }
-    } else if (memcmp(command, "sensor set ", 11) == 0) {
-      strcpy(tmp, &command[11]);
+      break;
+    }
+    case CLI_CMD_SENSOR_SET: {
+      StrHelper::strncpy(tmp, &command[11], sizeof(tmp));
       const char *parts[2];
       int num = mesh::Utils::parseTextParts(tmp, parts, 2, ' ');
       const char *key = (num > 0) ? parts[0] : "";
@@ -292,7 +375,9 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "can't find custom var");
       }
-    } else if (memcmp(command, "sensor list", 11) == 0) {
+      break;
+    }
+    case CLI_CMD_SENSOR_LIST: {
       char* dp = reply;
       int start = 0;
       int end = _sensors->getNumSettings();
@@ -317,10 +402,13 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
           *(dp-1) = 0; // remove last CR
         }
       }
-    } else if (memcmp(command, "region", 6) == 0) {
+      break;
+    }
+    case CLI_CMD_REGION:
       handleRegionCmd(command, reply);
+      break;
 #if ENV_INCLUDE_GPS == 1
-    } else if (memcmp(command, "gps on", 6) == 0) {
+    case CLI_CMD_GPS_ON:
       if (_sensors->setSettingValue("gps", "1")) {
         _prefs->gps_enabled = 1;
         savePrefs();
@@ -328,7 +416,8 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "gps toggle not found");
       }
-    } else if (memcmp(command, "gps off", 7) == 0) {
+      break;
+    case CLI_CMD_GPS_OFF:
       if (_sensors->setSettingValue("gps", "0")) {
         _prefs->gps_enabled = 0;
         savePrefs();
@@ -336,7 +425,8 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "gps toggle not found");
       }
-    } else if (memcmp(command, "gps sync", 8) == 0) {
+      break;
+    case CLI_CMD_GPS_SYNC: {
       LocationProvider * l = _sensors->getLocationProvider();
       if (l != NULL) {
         l->syncTime();
@@ -344,12 +434,15 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "gps provider not found");
       }
-    } else if (memcmp(command, "gps setloc", 10) == 0) {
+      break;
+    }
+    case CLI_CMD_GPS_SETLOC:
       _prefs->node_lat = _sensors->node_lat;
       _prefs->node_lon = _sensors->node_lon;
       savePrefs();
       strcpy(reply, "ok");
-    } else if (memcmp(command, "gps advert", 10) == 0) {
+      break;
+    case CLI_CMD_GPS_ADVERT:
       if (strlen(command) == 10) {
         switch (_prefs->advert_loc_policy) {
           case ADVERT_LOC_NONE:
@@ -379,7 +472,8 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "error");
       }
-    } else if (memcmp(command, "gps", 3) == 0) {
+      break;
+    case CLI_CMD_GPS: {
       LocationProvider * l = _sensors->getLocationProvider();
       if (l != NULL) {
         bool enabled = l->isEnabled(); // is EN pin on ?
@@ -397,8 +491,10 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
       } else {
         strcpy(reply, "Can't find GPS");
       }
+      break;
+    }
 #endif
-    } else if (memcmp(command, "powersaving on", 14) == 0) {
+    case CLI_CMD_POWERSAVING_ON:
 #if defined(NRF52_PLATFORM)
       _prefs->powersaving_enabled = 1;
       savePrefs();
@@ -412,577 +508,777 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, char* command, char* re
 #else
       strcpy(reply, "Board not supported");
 #endif
-    } else if (memcmp(command, "powersaving off", 15) == 0) {
+      break;
+    case CLI_CMD_POWERSAVING_OFF:
       _prefs->powersaving_enabled = 0;
       savePrefs();
       strcpy(reply, "off");
-    } else if (memcmp(command, "powersaving", 11) == 0) {
+      break;
+    case CLI_CMD_POWERSAVING:
       if (_prefs->powersaving_enabled) {
         strcpy(reply, "on");
       } else {
         strcpy(reply, "off");
       }
-    } else if (memcmp(command, "log start", 9) == 0) {
+      break;
+    case CLI_CMD_LOG_START:
       _callbacks->setLoggingOn(true);
       strcpy(reply, "   logging on");
-    } else if (memcmp(command, "log stop", 8) == 0) {
+      break;
+    case CLI_CMD_LOG_STOP:
       _callbacks->setLoggingOn(false);
       strcpy(reply, "   logging off");
-    } else if (memcmp(command, "log erase", 9) == 0) {
+      break;
+    case CLI_CMD_LOG_ERASE:
       _callbacks->eraseLogFile();
       strcpy(reply, "   log erased");
-    } else if (sender_timestamp == 0 && memcmp(command, "log", 3) == 0) {
+      break;
+    case CLI_CMD_LOG:
       _callbacks->dumpLogFile();
       strcpy(reply, "   EOF");
-    } else if (sender_timestamp == 0 && memcmp(command, "stats-packets", 13) == 0 && (command[13] == 0 || command[13] == ' ')) {
+      break;
+    case CLI_CMD_STATS_PACKETS:
       _callbacks->formatPacketStatsReply(reply);
-    } else if (sender_timestamp == 0 && memcmp(command, "stats-radio", 11) == 0 && (command[11] == 0 || command[11] == ' ')) {
+      break;
+    case CLI_CMD_STATS_RADIO:
       _callbacks->formatRadioStatsReply(reply);
-    } else if (sender_timestamp == 0 && memcmp(command, "stats-core", 10) == 0 && (command[10] == 0 || command[10] == ' ')) {
+      break;
+    case CLI_CMD_STATS_CORE:
       _callbacks->formatStatsReply(reply);
-    } else {
+      break;
+    case CLI_CMD_STATS_CHANNEL:
+      _callbacks->formatChannelStatsReply(reply);
+      break;
+    case CLI_CMD_STATS_DUTYCYCLE:
+      _callbacks->formatDutyCycleStatsReply(reply);
+      break;
+    case CLI_CMD_STATS_BRIDGE:
+      _callbacks->formatBridgeStatsReply(reply);
+      break;
+    case CLI_CMD_STATS_METRICS:
+      _callbacks->formatMetricsReply(reply, command[13] == ' ' ? _atoi(&command[14]) : 0);
+      break;
+    case CLI_CMD_HELP:
+      formatHelpReply(sender_timestamp == 0, command[4] == ' ' ? &command[5] : "", reply);
+      break;
+    default:
       strcpy(reply, "Unknown command");
-    }
+  }
+}
+
+#define HELP_MAX_MATCHES  32
+
+void CommonCLI::formatHelpReply(bool from_serial, const char* partial, char* reply) {
+  const CommandTable* table = &_commands;
+  if (memcmp(partial, "get ", 4) == 0) {   // list config keys
+    table = &_get_keys;
+    partial += 4;
+  } else if (memcmp(partial, "set ", 4) == 0) {
+    table = &_set_keys;
+    partial += 4;
+  }
+
+  const CommandDef* matches[HELP_MAX_MATCHES];
+  int total = table->complete(partial, from_serial, matches, HELP_MAX_MATCHES);
+  if (total == 0) {
+    strcpy(reply, "no match");
+    return;
+  }
+  char* dp = reply;
+  int i;
+  for (i = 0; i < total && i < HELP_MAX_MATCHES; i++) {
+    int len = strlen(matches[i]->name);
+    if (matches[i]->name[len - 1] == ' ') len--;   // trailing space, before args
+    if (dp - reply + len + 1 > 140) break;   // leave room for "+N more"
+    if (dp > reply) *dp++ = ' ';
+    memcpy(dp, matches[i]->name, len);
+    dp += len;
+  }
+  *dp = 0;
+  if (i < total) sprintf(dp, " +%d more", total - i);
 }
 
 void CommonCLI::handleSetCmd(uint32_t sender_timestamp, char* command, char* reply) {
   const char* config = &command[4];
-  if (memcmp(config, "dutycycle ", 10) == 0) {
-    float dc = atof(&config[10]);
-    if (dc < 1 || dc > 100) {
-      strcpy(reply, "ERROR: dutycycle must be 1-100");
-    } else {
-      _prefs->airtime_factor = (100.0f / dc) - 1.0f;
-      savePrefs();
-      float actual = 100.0f / (_prefs->airtime_factor + 1.0f);
-      int a_int = (int)actual;
-      int a_frac = (int)((actual - a_int) * 10.0f + 0.5f);
-      sprintf(reply, "OK - %d.%d%%", a_int, a_frac);
+  const CommandDef* def = _set_keys.lookup(config, sender_timestamp == 0);
+  switch (def ? def->id : CLI_UNKNOWN) {
+    case CLI_SET_DUTYCYCLE: {
+      float dc = atof(&config[10]);
+      if (dc < 1 || dc > 100) {
+        strcpy(reply, "ERROR: dutycycle must be 1-100");
+      } else {
+        _prefs->airtime_factor = (100.0f / dc) - 1.0f;
+        savePrefs();
+        float actual = 100.0f / (_prefs->airtime_factor + 1.0f);
+        int a_int = (int)actual;
+        int a_frac = (int)((actual - a_int) * 10.0f + 0.5f);
+        sprintf(reply, "OK - %d.%d%%", a_int, a_frac);
+      }
+      break;
     }
-  } else if (memcmp(config, "af ", 3) == 0) {
-    _prefs->airtime_factor = atof(&config[3]);
-    savePrefs();
-    strcpy(reply, "OK");
-  } else if (memcmp(config, "int.thresh ", 11) == 0) {
-    _prefs->interference_threshold = atoi(&config[11]);
-    savePrefs();
-    strcpy(reply, "OK");
-  } else if (memcmp(config, "cad ", 4) == 0) {
-    _prefs->cad_enabled = memcmp(&config[4], "on", 2) == 0;
-    savePrefs();
-    strcpy(reply, "OK");
-  } else if (memcmp(config, "agc.reset.interval ", 19) == 0) {
-    _prefs->agc_reset_interval = atoi(&config[19]) / 4;
-    savePrefs();
-    sprintf(reply, "OK - interval rounded to %d", ((uint32_t) _prefs->agc_reset_interval) * 4);
-  } else if (memcmp(config, "multi.acks ", 11) == 0) {
-    _prefs->multi_acks = atoi(&config[11]);
-    savePrefs();
-    strcpy(reply, "OK");
-  } else if (memcmp(config, "allow.read.only ", 16) == 0) {
-    _prefs->allow_read_only = memcmp(&config[16], "on", 2) == 0;
-    savePrefs();
-    strcpy(reply, "OK");
-  } else if (memcmp(config, "flood.advert.interval ", 22) == 0) {
-    int hours = _atoi(&config[22]);
-    if ((hours > 0 && hours < 3) || (hours > 168)) {
-      strcpy(reply, "Error: interval range is 3-168 hours");
-    } else {
-      _prefs->flood_advert_interval = (uint8_t)(hours);
-      _callbacks->updateFloodAdvertTimer();
+    case CLI_SET_AF:
+      _prefs->airtime_factor = atof(&config[3]);
       savePrefs();
       strcpy(reply, "OK");
-    }
-  } else if (memcmp(config, "advert.interval ", 16) == 0) {
-    int mins = _atoi(&config[16]);
-    if ((mins > 0 && mins < MIN_LOCAL_ADVERT_INTERVAL) || (mins > 240)) {
-      sprintf(reply, "Error: interval range is %d-240 minutes", MIN_LOCAL_ADVERT_INTERVAL);
-    } else {
-      _prefs->advert_interval = (uint8_t)(mins / 2);
-      _callbacks->updateAdvertTimer();
+      break;
+    case CLI_SET_INT_THRESH:
+      _prefs->interference_threshold = atoi(&config[11]);
       savePrefs();
       strcpy(reply, "OK");
-    }
-  } else if (memcmp(config, "guest.password ", 15) == 0) {
-    StrHelper::strncpy(_prefs->guest_password, &config[15], sizeof(_prefs->guest_password));
-    savePrefs();
-    strcpy(reply, "OK");
-  } else if (memcmp(config, "prv.key ", 8) == 0) {
-    uint8_t prv_key[PRV_KEY_SIZE];
-    bool success = mesh::Utils::fromHex(prv_key, PRV_KEY_SIZE, &config[8]);
-    // only allow rekey if key is valid
-    if (success && mesh::LocalIdentity::validatePrivateKey(prv_key)) {
-      mesh::LocalIdentity new_id;
-      new_id.readFrom(prv_key, PRV_KEY_SIZE);
-      _callbacks->saveIdentity(new_id);
-      strcpy(reply, "OK, reboot to apply! New pubkey: ");
-      mesh::Utils::toHex(&reply[33], new_id.pub_key, PUB_KEY_SIZE);
-    } else {
-      strcpy(reply, "Error, bad key");
-    }
-  } else if (memcmp(config, "name ", 5) == 0) {
-    if (isValidName(&config[5])) {
-      StrHelper::strncpy(_prefs->node_name, &config[5], sizeof(_prefs->node_name));
+      break;
+    case CLI_SET_CAD:
+      _prefs->cad_enabled = memcmp(&config[4], "on", 2) == 0;
       savePrefs();
       strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error, bad chars");
-    }
-  } else if (memcmp(config, "repeat ", 7) == 0) {
-    _prefs->disable_fwd = memcmp(&config[7], "off", 3) == 0;
-    savePrefs();
-    strcpy(reply, _prefs->disable_fwd ? "OK - repeat is now OFF" : "OK - repeat is now ON");
-  } else if (memcmp(config, "radio.rxgain ", 13) == 0) {
-    bool enabled = memcmp(&config[13], "on", 2) == 0;
-    _prefs->rx_boosted_gain = enabled;
-    savePrefs();
-    if (_callbacks->setRxBoostedGain(enabled)) {
+      break;
+    case CLI_SET_AGC_RESET_INTERVAL:
+      _prefs->agc_reset_interval = atoi(&config[19]) / 4;
+      savePrefs();
+      sprintf(reply, "OK - interval rounded to %d", ((uint32_t) _prefs->agc_reset_interval) * 4);
+      break;
+    case CLI_SET_MULTI_ACKS:
+      _prefs->multi_acks = atoi(&config[11]);
+      savePrefs();
       strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error: unsupported");
-    }
-  } else if (memcmp(config, "radio.fem.rxgain ", 17) == 0) {
-    if (!_board->canControlLoRaFemLna()) {
-      strcpy(reply, "Error: unsupported");
-    } else if (memcmp(&config[17], "on", 2) == 0) {
-      if (_board->setLoRaFemLnaEnabled(true)) {
-        _prefs->radio_fem_rxgain = 1;
-        savePrefs();
-        strcpy(reply, "OK - LoRa FEM RX gain on");
+      break;
+    case CLI_SET_ALLOW_READ_ONLY:
+      _prefs->allow_read_only = memcmp(&config[16], "on", 2) == 0;
+      savePrefs();
+      strcpy(reply, "OK");
+      break;
+    case CLI_SET_FLOOD_ADVERT_INTERVAL: {
+      int hours = _atoi(&config[22]);
+      if ((hours > 0 && hours < 3) || (hours > 168)) {
+        strcpy(reply, "Error: interval range is 3-168 hours");
       } else {
-        strcpy(reply, "Error: failed to apply LoRa FEM RX gain");
+        _prefs->flood_advert_interval = (uint8_t)(hours);
+        _callbacks->updateFloodAdvertTimer();
+        savePrefs();
+        strcpy(reply, "OK");
       }
-    } else if (memcmp(&config[17], "off", 3) == 0) {
-      if (_board->setLoRaFemLnaEnabled(false)) {
-        _prefs->radio_fem_rxgain = 0;
+      break;
+    }
+    case CLI_SET_ADVERT_INTERVAL: {
+      int mins = _atoi(&config[16]);
+      if ((mins > 0 && mins < MIN_LOCAL_ADVERT_INTERVAL) || (mins > 240)) {
+        sprintf(reply, "Error: interval range is %d-240 minutes", MIN_LOCAL_ADVERT_INTERVAL);
+      } else {
+        _prefs->advert_interval = (uint8_t)(mins / 2);
+        _callbacks->updateAdvertTimer();
         savePrefs();
-        strcpy(reply, "OK - LoRa FEM RX gain off");
+        strcpy(reply, "OK");
+      }
+      break;
+    }
+    case CLI_SET_GUEST_PASSWORD:
+      StrHelper::strncpy(_prefs->guest_password, &config[15], sizeof(_prefs->guest_password));
+      savePrefs();
+      strcpy(reply, "OK");
+      break;
+    case CLI_SET_PRV_KEY: {
+      uint8_t prv_key[PRV_KEY_SIZE];
+      bool success = mesh::Utils::fromHex(prv_key, PRV_KEY_SIZE, &config[8]);
+      // only allow rekey if key is valid
+      if (success && mesh::LocalIdentity::validatePrivateKey(prv_key)) {
+        mesh::LocalIdentity new_id;
+        new_id.readFrom(prv_key, PRV_KEY_SIZE);
+        _callbacks->saveIdentity(new_id);
+        strcpy(reply, "OK, reboot to apply! New pubkey: ");
+        mesh::Utils::toHex(&reply[33], new_id.pub_key, PUB_KEY_SIZE);
       } else {
-        strcpy(reply, "Error: failed to apply LoRa FEM RX gain");
+        strcpy(reply, "Error, bad key");
       }
-    } else {
-      strcpy(reply, "Error: state must be on or off");
+      break;
     }
-  } else if (memcmp(config, "radio.fem.txgain ", 17) == 0) {
-    if (!_board->canControlLoRaFemPaGain()) {
-      strcpy(reply, "Error: unsupported");
-    } else if (memcmp(&config[17], "on", 2) == 0) {
-      if (_board->setLoRaFemPaGainEnabled(true)) {
-        _prefs->radio_fem_txgain = 1;
+    case CLI_SET_NAME:
+      if (isValidName(&config[5])) {
+        StrHelper::strncpy(_prefs->node_name, &config[5], sizeof(_prefs->node_name));
         savePrefs();
-        strcpy(reply, "OK - LoRa FEM TX gain on");
+        strcpy(reply, "OK");
       } else {
-        strcpy(reply, "Error: failed to apply LoRa FEM TX gain");
+        strcpy(reply, "Error, bad chars");
       }
-    } else if (memcmp(&config[17], "off", 3) == 0) {
-      if (_board->setLoRaFemPaGainEnabled(false)) {
-        _prefs->radio_fem_txgain = 0;
-        savePrefs();
-        strcpy(reply, "OK - LoRa FEM TX gain off");
+      break;
+    case CLI_SET_REPEAT:
+      _prefs->disable_fwd = memcmp(&config[7], "off", 3) == 0;
+      savePrefs();
+      strcpy(reply, _prefs->disable_fwd ? "OK - repeat is now OFF" : "OK - repeat is now ON");
+      break;
+    case CLI_SET_RADIO_RXGAIN: {
+      bool enabled = memcmp(&config[13], "on", 2) == 0;
+      _prefs->rx_boosted_gain = enabled;
+      savePrefs();
+      if (_callbacks->setRxBoostedGain(enabled)) {
+        strcpy(reply, "OK");
       } else {
-        strcpy(reply, "Error: failed to apply LoRa FEM TX gain");
+        strcpy(reply, "Error: unsupported");
       }
-    } else {
-      strcpy(reply, "Error: state must be on or off");
+      break;
     }
-  } else if (memcmp(config, "radio ", 6) == 0) {
-    strcpy(tmp, &config[6]);
-    const char *parts[4];
-    int num = mesh::Utils::parseTextParts(tmp, parts, 4);
-    float freq  = num > 0 ? strtof(parts[0], nullptr) : 0.0f;
-    float bw    = num > 1 ? strtof(parts[1], nullptr) : 0.0f;
-    uint8_t sf  = num > 2 ? atoi(parts[2]) : 0;
-    uint8_t cr  = num > 3 ? atoi(parts[3]) : 0;
-    if (freq >= 150.0f && freq <= 2500.0f && sf >= 5 && sf <= 12 && cr >= 5 && cr <= 8 && bw >= 7.0f && bw <= 500.0f) {
-      _prefs->sf = sf;
-      _prefs->cr = cr;
-      _prefs->freq = freq;
-      _prefs->bw = bw;
-      _callbacks->savePrefs();
-      strcpy(reply, "OK - reboot to apply");
-    } else {
-      strcpy(reply, "Error, invalid radio params");
+    case CLI_SET_RADIO_FEM_RXGAIN:
+      if (!_board->canControlLoRaFemLna()) {
+        strcpy(reply, "Error: unsupported");
+      } else if (memcmp(&config[17], "on", 2) == 0) {
+        if (_board->setLoRaFemLnaEnabled(true)) {
+          _prefs->radio_fem_rxgain = 1;
+          savePrefs();
+          strcpy(reply, "OK - LoRa FEM RX gain on");
+        } else {
+          strcpy(reply, "Error: failed to apply LoRa FEM RX gain");
+        }
+      } else if (memcmp(&config[17], "off", 3) == 0) {
+        if (_board->setLoRaFemLnaEnabled(false)) {
+          _prefs->radio_fem_rxgain = 0;
+          savePrefs();
+          strcpy(reply, "OK - LoRa FEM RX gain off");
+        } else {
+          strcpy(reply, "Error: failed to apply LoRa FEM RX gain");
+        }
+      } else {
+        strcpy(reply, "Error: state must be on or off");
+      }
+      break;
+    case CLI_SET_RADIO_FEM_TXGAIN:
+      if (!_board->canControlLoRaFemPaGain()) {
+        strcpy(reply, "Error: unsupported");
+      } else if (memcmp(&config[17], "on", 2) == 0) {
+        if (_board->setLoRaFemPaGainEnabled(true)) {
+          _prefs->radio_fem_txgain = 1;
+          savePrefs();
+          strcpy(reply, "OK - LoRa FEM TX gain on");
+        } else {
+          strcpy(reply, "Error: failed to apply LoRa FEM TX gain");
+        }
+      } else if (memcmp(&config[17], "off", 3) == 0) {
+        if (_board->setLoRaFemPaGainEnabled(false)) {
+          _prefs->radio_fem_txgain = 0;
+          savePrefs();
+          strcpy(reply, "OK - LoRa FEM TX gain off");
+        } else {
+          strcpy(reply, "Error: failed to apply LoRa FEM TX gain");
+        }
+      } else {
+        strcpy(reply, "Error: state must be on or off");
+      }
+      break;
+    case CLI_SET_RADIO: {
+      StrHelper::strncpy(tmp, &config[6], sizeof(tmp));
+      const char *parts[4];
+      int num = mesh::Utils::parseTextParts(tmp, parts, 4);
+      float freq  = num > 0 ? strtof(parts[0], nullptr) : 0.0f;
+      float bw    = num > 1 ? strtof(parts[1], nullptr) : 0.0f;
+      uint8_t sf  = num > 2 ? atoi(parts[2]) : 0;
+      uint8_t cr  = num > 3 ? atoi(parts[3]) : 0;
+      if (freq >= 150.0f && freq <= 2500.0f && sf >= 5 && sf <= 12 && cr >= 5 && cr <= 8 && bw >= 7.0f && bw <= 500.0f) {
+        _prefs->sf = sf;
+        _prefs->cr = cr;
+        _prefs->freq = freq;
+        _prefs->bw = bw;
+        _callbacks->savePrefs();
+        strcpy(reply, "OK - reboot to apply");
+      } else {
+        strcpy(reply, "Error, invalid radio params");
+      }
+      break;
     }
-  } else if (memcmp(config, "lat ", 4) == 0) {
-    _prefs->node_lat = atof(&config[4]);
-    savePrefs();
-    strcpy(reply, "OK");
-  } else if (memcmp(config, "lon ", 4) == 0) {
-    _prefs->node_lon = atof(&config[4]);
-    savePrefs();
-    strcpy(reply, "OK");
-  } else if (memcmp(config, "rxdelay ", 8) == 0) {
-    float db = atof(&config[8]);
-    if (db >= 0 && db <= 20.0f) {
-      _prefs->rx_delay_base = db;
+    case CLI_SET_LAT:
+      _prefs->node_lat = atof(&config[4]);
       savePrefs();
       strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error, must be 0-20");
-    }
-  } else if (memcmp(config, "txdelay ", 8) == 0) {
-    float f = atof(&config[8]);
-    if (f >= 0 && f <= 2.0f) {
-      _prefs->tx_delay_factor = f;
+      break;
+    case CLI_SET_LON:
+      _prefs->node_lon = atof(&config[4]);
       savePrefs();
       strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error, must be 0-2");
+      break;
+    case CLI_SET_RXDELAY: {
+      float db = atof(&config[8]);
+      if (db >= 0 && db <= 20.0f) {
+        _prefs->rx_delay_base = db;
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        strcpy(reply, "Error, must be 0-20");
+      }
+      break;
     }
-  } else if (memcmp(config, "flood.max.unscoped ", 19) == 0) {
-    uint8_t m = atoi(&config[19]);
-    if (m <= 64) {
-      _prefs->flood_max_unscoped = m;
-      savePrefs();
-      strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error, max 64");
-    } 
-  } else if (memcmp(config, "flood.max.advert ", 17) == 0) {
-    uint8_t m = atoi(&config[17]);
-    if (m <= 64) {
-      _prefs->flood_max_advert = m;
-      savePrefs();
-      strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error, max 64");
+    case CLI_SET_TXDELAY: {
+      float f = atof(&config[8]);
+      if (f >= 0 && f <= 2.0f) {
+        _prefs->tx_delay_factor = f;
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        strcpy(reply, "Error, must be 0-2");
+      }
+      break;
     }
-  } else if (memcmp(config, "flood.max ", 10) == 0) {
-    uint8_t m = atoi(&config[10]);
-    if (m <= 64) {
-      _prefs->flood_max = m;
+    case CLI_SET_FLOOD_ADAPTIVE:
+      _prefs->flood_adaptive = memcmp(&config[15], "on", 2) == 0;
       savePrefs();
       strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error, max 64");
+      break;
+    case CLI_SET_FLOOD_SUPPRESS: {
+      int m = atoi(&config[15]);
+      if (m >= 0 && m <= 16) {
+        _prefs->flood_suppress = m;
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        strcpy(reply, "Error, must be 0-16");
+      }
+      break;
     }
-  } else if (memcmp(config, "direct.txdelay ", 15) == 0) {
-    float f = atof(&config[15]);
-    if (f >= 0 && f <= 2.0f) {
-      _prefs->direct_tx_delay_factor = f;
-      savePrefs();
-      strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error, must be 0-2");
+    case CLI_SET_FLOOD_MAX_UNSCOPED: {
+      uint8_t m = atoi(&config[19]);
+      if (m <= 64) {
+        _prefs->flood_max_unscoped = m;
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        strcpy(reply, "Error, max 64");
+      } 
+      break;
     }
-  } else if (memcmp(config, "owner.info ", 11) == 0) {
-    config += 11;
-    char *dp = _prefs->owner_info;
-    while (*config && dp - _prefs->owner_info < sizeof(_prefs->owner_info)-1) {
-      *dp++ = (*config == '|') ? '\n' : *config;    // translate '|' to newline chars
-      config++;
+    case CLI_SET_FLOOD_MAX_ADVERT: {
+      uint8_t m = atoi(&config[17]);
+      if (m <= 64) {
+        _prefs->flood_max_advert = m;
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        strcpy(reply, "Error, max 64");
+      }
+      break;
     }
-    *dp = 0;
-    savePrefs();
-    strcpy(reply, "OK");
-  } else if (memcmp(config, "path.hash.mode ", 15) == 0) {
-    config += 15;
-    uint8_t mode = atoi(config);
-    if (mode < 3) {
-      _prefs->path_hash_mode = mode;
+    case CLI_SET_FLOOD_MAX: {
+      uint8_t m = atoi(&config[10]);
+      if (m <= 64) {
+        _prefs->flood_max = m;
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        strcpy(reply, "Error, max 64");
+      }
+      break;
+    }
+    case CLI_SET_DIRECT_TXDELAY: {
+      float f = atof(&config[15]);
+      if (f >= 0 && f <= 2.0f) {
+        _prefs->direct_tx_delay_factor = f;
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        strcpy(reply, "Error, must be 0-2");
+      }
+      break;
+    }
+    case CLI_SET_OWNER_INFO: {
+      config += 11;
+      char *dp = _prefs->owner_info;
+      while (*config && dp - _prefs->owner_info < sizeof(_prefs->owner_info)-1) {
+        *dp++ = (*config == '|') ? '\n' : *config;    // translate '|' to newline chars
+        config++;
+      }
+      *dp = 0;
       savePrefs();
       strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error, must be 0,1, or 2");
+      break;
     }
-  } else if (memcmp(config, "loop.detect ", 12) == 0) {
-    config += 12;
-    uint8_t mode;
-    if (memcmp(config, "off", 3) == 0) {
-      mode = LOOP_DETECT_OFF;
-    } else if (memcmp(config, "minimal", 7) == 0) {
-      mode = LOOP_DETECT_MINIMAL;
-    } else if (memcmp(config, "moderate", 8) == 0) {
-      mode = LOOP_DETECT_MODERATE;
-    } else if (memcmp(config, "strict", 6) == 0) {
-      mode = LOOP_DETECT_STRICT;
-    } else {
-      mode = 0xFF;
-      strcpy(reply, "Error, must be: off, minimal, moderate, or strict");
+    case CLI_SET_PATH_HASH_MODE: {
+      config += 15;
+      uint8_t mode = atoi(config);
+      if (mode < 3) {
+        _prefs->path_hash_mode = mode;
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        strcpy(reply, "Error, must be 0,1, or 2");
+      }
+      break;
+    }
+    case CLI_SET_LOOP_DETECT: {
+      config += 12;
+      uint8_t mode;
+      if (memcmp(config, "off", 3) == 0) {
+        mode = LOOP_DETECT_OFF;
+      } else if (memcmp(config, "minimal", 7) == 0) {
+        mode = LOOP_DETECT_MINIMAL;
+      } else if (memcmp(config, "moderate", 8) == 0) {
+        mode = LOOP_DETECT_MODERATE;
+      } else if (memcmp(config, "strict", 6) == 0) {
+        mode = LOOP_DETECT_STRICT;
+      } else {
+        mode = 0xFF;
+        strcpy(reply, "Error, must be: off, minimal, moderate, or strict");
+      }
+      if (mode != 0xFF) {
+        _prefs->loop_detect = mode;
+        savePrefs();
+        strcpy(reply, "OK");
+      }
+      break;
     }
-    if (mode != 0xFF) {
-      _prefs->loop_detect = mode;
+    case CLI_SET_ADVERT_FWD_FIRST:
+      _prefs->advert_fwd_first = memcmp(&config[17], "on", 2) == 0;
       savePrefs();
       strcpy(reply, "OK");
-    }
-  } else if (memcmp(config, "tx ", 3) == 0) {
-    _prefs->tx_power_dbm = atoi(&config[3]);
-    savePrefs();
-    _callbacks->setTxPower(_prefs->tx_power_dbm);
-    strcpy(reply, "OK");
-  } else if (sender_timestamp == 0 && memcmp(config, "freq ", 5) == 0) {
-    _prefs->freq = atof(&config[5]);
-    savePrefs();
-    strcpy(reply, "OK - reboot to apply");
+      break;
+    case CLI_SET_TX:
+      _prefs->tx_power_dbm = atoi(&config[3]);
+      savePrefs();
+      _callbacks->setTxPower(_prefs->tx_power_dbm);
+      strcpy(reply, "OK");
+      break;
+    case CLI_SET_FREQ:
+      _prefs->freq = atof(&config[5]);
+      savePrefs();
+      strcpy(reply, "OK - reboot to apply");
+      break;
 #ifdef WITH_BRIDGE
-  } else if (memcmp(config, "bridge.enabled ", 15) == 0) {
-    _prefs->bridge_enabled = memcmp(&config[15], "on", 2) == 0;
-    _callbacks->setBridgeState(_prefs->bridge_enabled);
-    savePrefs();
-    strcpy(reply, "OK");
-  } else if (memcmp(config, "bridge.delay ", 13) == 0) {
-    int delay = _atoi(&config[13]);
-    if (delay >= 0 && delay <= 10000) {
-      _prefs->bridge_delay = (uint16_t)delay;
+    case CLI_SET_BRIDGE_ENABLED:
+      _prefs->bridge_enabled = memcmp(&config[15], "on", 2) == 0;
+      _callbacks->setBridgeState(_prefs->bridge_enabled);
       savePrefs();
       strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error: delay must be between 0-10000 ms");
+      break;
+    case CLI_SET_BRIDGE_DELAY: {
+      int delay = _atoi(&config[13]);
+      if (delay >= 0 && delay <= 10000) {
+        _prefs->bridge_delay = (uint16_t)delay;
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        strcpy(reply, "Error: delay must be between 0-10000 ms");
+      }
+      break;
     }
-  } else if (memcmp(config, "bridge.source ", 14) == 0) {
-    _prefs->bridge_pkt_src = memcmp(&config[14], "rx", 2) == 0;
-    savePrefs();
-    strcpy(reply, "OK");
-#endif
-#ifdef WITH_RS232_BRIDGE
-  } else if (memcmp(config, "bridge.baud ", 12) == 0) {
-    uint32_t baud = atoi(&config[12]);
-    if (baud >= 9600 && baud <= BRIDGE_MAX_BAUD) {
-      _prefs->bridge_baud = (uint32_t)baud;
-      _callbacks->restartBridge();
+    case CLI_SET_BRIDGE_SOURCE:
+      _prefs->bridge_pkt_src = memcmp(&config[14], "rx", 2) == 0;
       savePrefs();
       strcpy(reply, "OK");
-    } else {
-      sprintf(reply, "Error: baud rate must be between 9600-%d",BRIDGE_MAX_BAUD);
+      break;
+#endif
+#ifdef WITH_RS232_BRIDGE
+    case CLI_SET_BRIDGE_BAUD: {
+      uint32_t baud = atoi(&config[12]);
+      if (baud >= 9600 && baud <= BRIDGE_MAX_BAUD) {
+        _prefs->bridge_baud = (uint32_t)baud;
+        _callbacks->restartBridge();
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        sprintf(reply, "Error: baud rate must be between 9600-%d",BRIDGE_MAX_BAUD);
+      }
+      break;
     }
 #endif
 #ifdef WITH_ESPNOW_BRIDGE
-  } else if (memcmp(config, "bridge.channel ", 15) == 0) {
-    int ch = atoi(&config[15]);
-    if (ch > 0 && ch < 15) {
-      _prefs->bridge_channel = (uint8_t)ch;
+    case CLI_SET_BRIDGE_CHANNEL: {
+      int ch = atoi(&config[15]);
+      if (ch > 0 && ch < 15) {
+        _prefs->bridge_channel = (uint8_t)ch;
+        _callbacks->restartBridge();
+        savePrefs();
+        strcpy(reply, "OK");
+      } else {
+        strcpy(reply, "Error: channel must be between 1-14");
+      }
+      break;
+    }
+    case CLI_SET_BRIDGE_SECRET:
+      StrHelper::strncpy(_prefs->bridge_secret, &config[14], sizeof(_prefs->bridge_secret));
       _callbacks->restartBridge();
       savePrefs();
       strcpy(reply, "OK");
-    } else {
-      strcpy(reply, "Error: channel must be between 1-14");
-    }
-  } else if (memcmp(config, "bridge.secret ", 14) == 0) {
-    StrHelper::strncpy(_prefs->bridge_secret, &config[14], sizeof(_prefs->bridge_secret));
-    _callbacks->restartBridge();
-    savePrefs();
-    strcpy(reply, "OK");
+      break;
 #endif
-  } else if (memcmp(config, "adc.multiplier ", 15) == 0) {
-    _prefs->adc_multiplier = atof(&config[15]);
-    if (_board->setAdcMultiplier(_prefs->adc_multiplier)) {
-      savePrefs();
-      if (_prefs->adc_multiplier == 0.0f) {
-        strcpy(reply, "OK - using default board multiplier");
-      } else {
-        sprintf(reply, "OK - multiplier set to %.3f", _prefs->adc_multiplier);
-      }
-    } else {
-      _prefs->adc_multiplier = 0.0f;
-      strcpy(reply, "Error: unsupported");
-    };
-  #if defined(USE_LR2021)
-  } else if (memcmp(config, "extra.sf ", 9) == 0) {
-    strcpy(tmp, &config[9]);
-    const char *parts[4];
-    uint8_t sideDetSFs[4];
-    int num = mesh::Utils::parseTextParts(tmp, parts, 4);
-    if (num > 3) {
-      sprintf(reply, "Invalid extra SF config");
-    } else {
-      for (int i = 0; i < num; i++) {
-        sideDetSFs[i] = atoi(parts[i]);
-      }
-      sideDetSFs[num] = 0;
-      if (_callbacks->configSideDetectors(sideDetSFs, num, _prefs->bw)) {
-        for (int i = 0; i <= num; i++) _prefs->extra_sf[i] = sideDetSFs[i];
+    case CLI_SET_ADC_MULTIPLIER:
+      _prefs->adc_multiplier = atof(&config[15]);
+      if (_board->setAdcMultiplier(_prefs->adc_multiplier)) {
         savePrefs();
-        sprintf(reply, "OK - extra SFs set");
+        if (_prefs->adc_multiplier == 0.0f) {
+          strcpy(reply, "OK - using default board multiplier");
+        } else {
+          sprintf(reply, "OK - multiplier set to %.3f", _prefs->adc_multiplier);
+        }
       } else {
+        _prefs->adc_multiplier = 0.0f;
+        strcpy(reply, "Error: unsupported");
+      };
+      break;
+#if defined(USE_LR2021)
+    case CLI_SET_EXTRA_SF: {
+      StrHelper::strncpy(tmp, &config[9], sizeof(tmp));
+      const char *parts[4];
+      uint8_t sideDetSFs[4];
+      int num = mesh::Utils::parseTextParts(tmp, parts, 4);
+      if (num > 3) {
         sprintf(reply, "Invalid extra SF config");
+      } else {
+        for (int i = 0; i < num; i++) {
+          sideDetSFs[i] = atoi(parts[i]);
+        }
+        sideDetSFs[num] = 0;
+        if (_callbacks->configSideDetectors(sideDetSFs, num, _prefs->bw)) {
+          for (int i = 0; i <= num; i++) _prefs->extra_sf[i] = sideDetSFs[i];
+          savePrefs();
+          sprintf(reply, "OK - extra SFs set");
+        } else {
+          sprintf(reply, "Invalid extra SF config");
+        }
       }
+      break;
     }
-  #endif
-  } else {
-    strcpy(reply, "unknown config: ");
-    StrHelper::strncpy(&reply[16], config, 160-17);
+#endif
+    default:
+      strcpy(reply, "unknown config: ");
+      StrHelper::strncpy(&reply[16], config, 160-17);
   }
 }
 
 void CommonCLI::handleGetCmd(uint32_t sender_timestamp, char* command, char* reply) {
   const char* config = &command[4];
-  if (memcmp(config, "dutycycle", 9) == 0) {
-    float dc = 100.0f / (_prefs->airtime_factor + 1.0f);
-    int dc_int = (int)dc;
-    int dc_frac = (int)((dc - dc_int) * 10.0f + 0.5f);
-    sprintf(reply, "> %d.%d%%", dc_int, dc_frac);
-  } else if (memcmp(config, "af", 2) == 0) {
-    sprintf(reply, "> %s", StrHelper::ftoa(_prefs->airtime_factor));
-  } else if (memcmp(config, "int.thresh", 10) == 0) {
-    sprintf(reply, "> %d", (uint32_t) _prefs->interference_threshold);
-  } else if (memcmp(config, "cad", 3) == 0) {
-    sprintf(reply, "> %s", _prefs->cad_enabled ? "on" : "off");
-  } else if (memcmp(config, "agc.reset.interval", 18) == 0) {
-    sprintf(reply, "> %d", ((uint32_t) _prefs->agc_reset_interval) * 4);
-  } else if (memcmp(config, "multi.acks", 10) == 0) {
-    sprintf(reply, "> %d", (uint32_t) _prefs->multi_acks);
-  } else if (memcmp(config, "allow.read.only", 15) == 0) {
-    sprintf(reply, "> %s", _prefs->allow_read_only ? "on" : "off");
-  } else if (memcmp(config, "flood.advert.interval", 21) == 0) {
-    sprintf(reply, "> %d", ((uint32_t) _prefs->flood_advert_interval));
-  } else if (memcmp(config, "advert.interval", 15) == 0) {
-    sprintf(reply, "> %d", ((uint32_t) _prefs->advert_interval) * 2);
-  } else if (memcmp(config, "guest.password", 14) == 0) {
-    sprintf(reply, "> %s", _prefs->guest_password);
-  } else if (sender_timestamp == 0 && memcmp(config, "prv.key", 7) == 0) {  // from serial command line only
-    uint8_t prv_key[PRV_KEY_SIZE];
-    int len = _callbacks->getSelfId().writeTo(prv_key, PRV_KEY_SIZE);
-    mesh::Utils::toHex(tmp, prv_key, len);
-    sprintf(reply, "> %s", tmp);
-  } else if (memcmp(config, "name", 4) == 0) {
-    sprintf(reply, "> %s", _prefs->node_name);
-  } else if (memcmp(config, "repeat", 6) == 0) {
-    sprintf(reply, "> %s", _prefs->disable_fwd ? "off" : "on");
-  } else if (memcmp(config, "lat", 3) == 0) {
-    sprintf(reply, "> %s", StrHelper::ftoa(_prefs->node_lat));
-  } else if (memcmp(config, "lon", 3) == 0) {
-    sprintf(reply, "> %s", StrHelper::ftoa(_prefs->node_lon));
-  } else if (memcmp(config, "radio.rxgain", 12) == 0) {
-    sprintf(reply, "> %s", _prefs->rx_boosted_gain ? "on" : "off");
-  } else if (memcmp(config, "radio.fem.rxgain", 16) == 0) {
-    if (!_board->canControlLoRaFemLna()) {
-      strcpy(reply, "Error: unsupported");
-    } else {
-      sprintf(reply, "> %s", _board->isLoRaFemLnaEnabled() ? "on" : "off");
+  const CommandDef* def = _get_keys.lookup(config, sender_timestamp == 0);
+  switch (def ? def->id : CLI_UNKNOWN) {
+    case CLI_GET_DUTYCYCLE: {
+      float dc = 100.0f / (_prefs->airtime_factor + 1.0f);
+      int dc_int = (int)dc;
+      int dc_frac = (int)((dc - dc_int) * 10.0f + 0.5f);
+      sprintf(reply, "> %d.%d%%", dc_int, dc_frac);
+      break;
     }
-  } else if (memcmp(config, "radio.fem.txgain", 16) == 0) {
-    if (!_board->canControlLoRaFemPaGain()) {
-      strcpy(reply, "Error: unsupported");
-    } else {
-      sprintf(reply, "> %s", _board->isLoRaFemPaGainEnabled() ? "on" : "off");
+    case CLI_GET_AF:
+      sprintf(reply, "> %s", StrHelper::ftoa(_prefs->airtime_factor));
+      break;
+    case CLI_GET_INT_THRESH:
+      sprintf(reply, "> %d", (uint32_t) _prefs->interference_threshold);
+      break;
+    case CLI_GET_CAD:
+      sprintf(reply, "> %s", _prefs->cad_enabled ? "on" : "off");
+      break;
+    case CLI_GET_AGC_RESET_INTERVAL:
+      sprintf(reply, "> %d", ((uint32_t) _prefs->agc_reset_interval) * 4);
+      break;
+    case CLI_GET_MULTI_ACKS:
+      sprintf(reply, "> %d", (uint32_t) _prefs->multi_acks);
+      break;
+    case CLI_GET_ALLOW_READ_ONLY:
+      sprintf(reply, "> %s", _prefs->allow_read_only ? "on" : "off");
+      break;
+    case CLI_GET_FLOOD_ADVERT_INTERVAL:
+      sprintf(reply, "> %d", ((uint32_t) _prefs->flood_advert_interval));
+      break;
+    case CLI_GET_ADVERT_INTERVAL:
+      sprintf(reply, "> %d", ((uint32_t) _prefs->advert_interval) * 2);
+      break;
+    case CLI_GET_GUEST_PASSWORD:
+      sprintf(reply, "> %s", _prefs->guest_password);
+      break;
+    case CLI_GET_PRV_KEY: {  // from serial command line only
+      uint8_t prv_key[PRV_KEY_SIZE];
+      int len = _callbacks->getSelfId().writeTo(prv_key, PRV_KEY_SIZE);
+      mesh::Utils::toHex(tmp, prv_key, len);
+      sprintf(reply, "> %s", tmp);
+      break;
     }
-  } else if (memcmp(config, "radio", 5) == 0) {
-    char freq[16], bw[16];
-    strcpy(freq, StrHelper::ftoa(_prefs->freq));
-    strcpy(bw, StrHelper::ftoa3(_prefs->bw));
-    sprintf(reply, "> %s,%s,%d,%d", freq, bw, (uint32_t)_prefs->sf, (uint32_t)_prefs->cr);
-  } else if (memcmp(config, "rxdelay", 7) == 0) {
-    sprintf(reply, "> %s", StrHelper::ftoa(_prefs->rx_delay_base));
-  } else if (memcmp(config, "txdelay", 7) == 0) {
-    sprintf(reply, "> %s", StrHelper::ftoa(_prefs->tx_delay_factor));
-  } else if (memcmp(config, "flood.max.advert", 16) == 0) {
-    sprintf(reply, "> %d", (uint32_t)_prefs->flood_max_advert);
-  } else if (memcmp(config, "flood.max.unscoped", 18) == 0) {
-    sprintf(reply, "> %d", (uint32_t)_prefs->flood_max_unscoped);
-  } else if (memcmp(config, "flood.max", 9) == 0) {
-    sprintf(reply, "> %d", (uint32_t)_prefs->flood_max);
-  } else if (memcmp(config, "direct.txdelay", 14) == 0) {
-    sprintf(reply, "> %s", StrHelper::ftoa(_prefs->direct_tx_delay_factor));
-  } else if (memcmp(config, "owner.info", 10) == 0) {
-    auto start = reply;
-    *reply++ = '>';
-    *reply++ = ' ';
-    const char* sp = _prefs->owner_info;
-    while (*sp && reply - start < 159) {
-      *reply++ = (*sp == '\n') ? '|' : *sp;    // translate newline back to orig '|'
-      sp++;
+    case CLI_GET_NAME:
+      sprintf(reply, "> %s", _prefs->node_name);
+      break;
+    case CLI_GET_REPEAT:
+      sprintf(reply, "> %s", _prefs->disable_fwd ? "off" : "on");
+      break;
+    case CLI_GET_LAT:
+      sprintf(reply, "> %s", StrHelper::ftoa(_prefs->node_lat));
+      break;
+    case CLI_GET_LON:
+      sprintf(reply, "> %s", StrHelper::ftoa(_prefs->node_lon));
+      break;
+    case CLI_GET_RADIO_RXGAIN:
+      sprintf(reply, "> %s", _prefs->rx_boosted_gain ? "on" : "off");
+      break;
+    case CLI_GET_RADIO_FEM_RXGAIN:
+      if (!_board->canControlLoRaFemLna()) {
+        strcpy(reply, "Error: unsupported");
+      } else {
+        sprintf(reply, "> %s", _board->isLoRaFemLnaEnabled() ? "on" : "off");
+      }
+      break;
+    case CLI_GET_RADIO_FEM_TXGAIN:
+      if (!_board->canControlLoRaFemPaGain()) {
+        strcpy(reply, "Error: unsupported");
+      } else {
+        sprintf(reply, "> %s", _board->isLoRaFemPaGainEnabled() ? "on" : "off");
+      }
+      break;
+    case CLI_GET_RADIO: {
+      char freq[16], bw[16];
+      strcpy(freq, StrHelper::ftoa(_prefs->freq));
+      strcpy(bw, StrHelper::ftoa3(_prefs->bw));
+      sprintf(reply, "> %s,%s,%d,%d", freq, bw, (uint32_t)_prefs->sf, (uint32_t)_prefs->cr);
+      break;
     }
-    *reply = 0;  // set null terminator
-  } else if (memcmp(config, "path.hash.mode", 14) == 0) {
-    sprintf(reply, "> %d", (uint32_t)_prefs->path_hash_mode);
-  } else if (memcmp(config, "loop.detect", 11) == 0) {
-    if (_prefs->loop_detect == LOOP_DETECT_OFF) {
-      strcpy(reply, "> off");
-    } else if (_prefs->loop_detect == LOOP_DETECT_MINIMAL) {
-      strcpy(reply, "> minimal");
-    } else if (_prefs->loop_detect == LOOP_DETECT_MODERATE) {
-      strcpy(reply, "> moderate");
-    } else {
-      strcpy(reply, "> strict");
+    case CLI_GET_RXDELAY:
+      sprintf(reply, "> %s", StrHelper::ftoa(_prefs->rx_delay_base));
+      break;
+    case CLI_GET_TXDELAY:
+      sprintf(reply, "> %s", StrHelper::ftoa(_prefs->tx_delay_factor));
+      break;
+    case CLI_GET_FLOOD_ADAPTIVE:
+      sprintf(reply, "> %s", _prefs->flood_adaptive ? "on" : "off");
+      break;
+    case CLI_GET_FLOOD_SUPPRESS:
+      sprintf(reply, "> %d", (uint32_t)_prefs->flood_suppress);
+      break;
+    case CLI_GET_FLOOD_MAX_ADVERT:
+      sprintf(reply, "> %d", (uint32_t)_prefs->flood_max_advert);
+      break;
+    case CLI_GET_FLOOD_MAX_UNSCOPED:
+      sprintf(reply, "> %d", (uint32_t)_prefs->flood_max_unscoped);
+      break;
+    case CLI_GET_FLOOD_MAX:
+      sprintf(reply, "> %d", (uint32_t)_prefs->flood_max);
+      break;
+    case CLI_GET_DIRECT_TXDELAY:
+      sprintf(reply, "> %s", StrHelper::ftoa(_prefs->direct_tx_delay_factor));
+      break;
+    case CLI_GET_OWNER_INFO: {
+      auto start = reply;
+      *reply++ = '>';
+      *reply++ = ' ';
+      const char* sp = _prefs->owner_info;
+      while (*sp && reply - start < 159) {
+        *reply++ = (*sp == '\n') ? '|' : *sp;    // translate newline back to orig '|'
+        sp++;
+      }
+      *reply = 0;  // set null terminator
+      break;
     }
-  } else if (memcmp(config, "tx", 2) == 0 && (config[2] == 0 || config[2] == ' ')) {
-    sprintf(reply, "> %d", (int32_t) _prefs->tx_power_dbm);
-  } else if (memcmp(config, "freq", 4) == 0) {
-    sprintf(reply, "> %s", StrHelper::ftoa(_prefs->freq));
-  } else if (memcmp(config, "public.key", 10) == 0) {
-    strcpy(reply, "> ");
-    mesh::Utils::toHex(&reply[2], _callbacks->getSelfId().pub_key, PUB_KEY_SIZE);
-  } else if (memcmp(config, "role", 4) == 0) {
-    sprintf(reply, "> %s", _callbacks->getRole());
-  } else if (memcmp(config, "bridge.type", 11) == 0) {
-    sprintf(reply, "> %s",
+    case CLI_GET_PATH_HASH_MODE:
+      sprintf(reply, "> %d", (uint32_t)_prefs->path_hash_mode);
+      break;
+    case CLI_GET_LOOP_DETECT:
+      if (_prefs->loop_detect == LOOP_DETECT_OFF) {
+        strcpy(reply, "> off");
+      } else if (_prefs->loop_detect == LOOP_DETECT_MINIMAL) {
+        strcpy(reply, "> minimal");
+      } else if (_prefs->loop_detect == LOOP_DETECT_MODERATE) {
+        strcpy(reply, "> moderate");
+      } else {
+        strcpy(reply, "> strict");
+      }
+      break;
+    case CLI_GET_ADVERT_FWD_FIRST:
+      sprintf(reply, "> %s", _prefs->advert_fwd_first ? "on" : "off");
+      break;
+    case CLI_GET_TX:
+      sprintf(reply, "> %d", (int32_t) _prefs->tx_power_dbm);
+      break;
+    case CLI_GET_FREQ:
+      sprintf(reply, "> %s", StrHelper::ftoa(_prefs->freq));
+      break;
+    case CLI_GET_PUBLIC_KEY:
+      strcpy(reply, "> ");
+      mesh::Utils::toHex(&reply[2], _callbacks->getSelfId().pub_key, PUB_KEY_SIZE);
+      break;
+    case CLI_GET_ROLE:
+      sprintf(reply, "> %s", _callbacks->getRole());
+      break;
+    case CLI_GET_BRIDGE_TYPE:
+      sprintf(reply, "> %s",
 #ifdef WITH_RS232_BRIDGE
-            "rs232"
+              "rs232"
 #elif WITH_ESPNOW_BRIDGE
-            "espnow"
+              "espnow"
 #else
-            "none"
+              "none"
 #endif
-    );
+      );
+      break;
 #ifdef WITH_BRIDGE
-  } else if (memcmp(config, "bridge.enabled", 14) == 0) {
-    sprintf(reply, "> %s", _prefs->bridge_enabled ? "on" : "off");
-  } else if (memcmp(config, "bridge.delay", 12) == 0) {
-    sprintf(reply, "> %d", (uint32_t)_prefs->bridge_delay);
-  } else if (memcmp(config, "bridge.source", 13) == 0) {
-    sprintf(reply, "> %s", _prefs->bridge_pkt_src ? "logRx" : "logTx");
+    case CLI_GET_BRIDGE_ENABLED:
+      sprintf(reply, "> %s", _prefs->bridge_enabled ? "on" : "off");
+      break;
+    case CLI_GET_BRIDGE_DELAY:
+      sprintf(reply, "> %d", (uint32_t)_prefs->bridge_delay);
+      break;
+    case CLI_GET_BRIDGE_SOURCE:
+      sprintf(reply, "> %s", _prefs->bridge_pkt_src ? "logRx" : "logTx");
+      break;
 #endif
 #ifdef WITH_RS232_BRIDGE
-  } else if (memcmp(config, "bridge.baud", 11) == 0) {
-    sprintf(reply, "> %d", (uint32_t)_prefs->bridge_baud);
+    case CLI_GET_BRIDGE_BAUD:
+      sprintf(reply, "> %d", (uint32_t)_prefs->bridge_baud);
+      break;
 #endif
 #ifdef WITH_ESPNOW_BRIDGE
-  } else if (memcmp(config, "bridge.channel", 14) == 0) {
-    sprintf(reply, "> %d", (uint32_t)_prefs->bridge_channel);
-  } else if (memcmp(config, "bridge.secret", 13) == 0) {
-    sprintf(reply, "> %s", _prefs->bridge_secret);
+    case CLI_GET_BRIDGE_CHANNEL:
+      sprintf(reply, "> %d", (uint32_t)_prefs->bridge_channel);
+      break;
+    case CLI_GET_BRIDGE_SECRET:
+      sprintf(reply, "> %s", _prefs->bridge_secret);
+      break;
 #endif
-  } else if (memcmp(config, "bootloader.ver", 14) == 0) {
+    case CLI_GET_BOOTLOADER_VER:
   #ifdef NRF52_PLATFORM
-      char ver[32];
-      if (_board->getBootloaderVersion(ver, sizeof(ver))) {
-          sprintf(reply, "> %s", ver);
+        char ver[32];
+        if (_board->getBootloaderVersion(ver, sizeof(ver))) {
+            sprintf(reply, "> %s", ver);
+        } else {
+            strcpy(reply, "> unknown");
+        }
+  #else
+        strcpy(reply, "Error: unsupported");
+#endif
+      break;
+    case CLI_GET_ADC_MULTIPLIER: {
+      float adc_mult = _board->getAdcMultiplier();
+      if (adc_mult == 0.0f) {
+        strcpy(reply, "Error: unsupported");
       } else {
-          strcpy(reply, "> unknown");
+        sprintf(reply, "> %.3f", adc_mult);
       }
-  #else
-      strcpy(reply, "Error: unsupported");
-  #endif
-  } else if (memcmp(config, "adc.multiplier", 14) == 0) {
-    float adc_mult = _board->getAdcMultiplier();
-    if (adc_mult == 0.0f) {
-      strcpy(reply, "Error: unsupported");
-    } else {
-      sprintf(reply, "> %.3f", adc_mult);
+    // Power management commands
+      break;
     }
-  // Power management commands
-  } else if (memcmp(config, "pwrmgt.support", 14) == 0) {
+    case CLI_GET_PWRMGT_SUPPORT:
 #ifdef NRF52_POWER_MANAGEMENT
-    strcpy(reply, "> supported");
+      strcpy(reply, "> supported");
 #else
-    strcpy(reply, "> unsupported");
+      strcpy(reply, "> unsupported");
 #endif
-  } else if (memcmp(config, "pwrmgt.source", 13) == 0) {
+      break;
+    case CLI_GET_PWRMGT_SOURCE:
 #ifdef NRF52_POWER_MANAGEMENT
-    strcpy(reply, _board->isExternalPowered() ? "> external" : "> battery");
+      strcpy(reply, _board->isExternalPowered() ? "> external" : "> battery");
 #else
-    strcpy(reply, "ERROR: Power management not supported");
+      strcpy(reply, "ERROR: Power management not supported");
 #endif
-  } else if (memcmp(config, "pwrmgt.bootreason", 17) == 0) {
-    sprintf(reply, "> Reset: %s; Shutdown: %s",
-      _board->getResetReasonString(_board->getResetReason()),
-      _board->getShutdownReasonString(_board->getShutdownReason()));
-  } else if (memcmp(config, "pwrmgt.bootmv", 13) == 0) {
+      break;
+    case CLI_GET_PWRMGT_BOOTREASON:
+      sprintf(reply, "> Reset: %s; Shutdown: %s",
+        _board->getResetReasonString(_board->getResetReason()),
+        _board->getShutdownReasonString(_board->getShutdownReason()));
+      break;
+    case CLI_GET_PWRMGT_BOOTMV:
 #ifdef NRF52_POWER_MANAGEMENT
-    sprintf(reply, "> %u mV", _board->getBootVoltage());
+      sprintf(reply, "> %u mV", _board->getBootVoltage());
 #else
-    strcpy(reply, "ERROR: Power management not supported");
+      strcpy(reply, "ERROR: Power management not supported");
 #endif
-  } else if (memcmp(config, "extra.sf", 8) == 0) {
-    char* tmp = reply;
-    for (int i = 0; i < 3 && _prefs->extra_sf[i] != 0; i++) {
-      tmp += sprintf(tmp, "%s%d", (i == 0) ? "" : ",", _prefs->extra_sf[i]);
-    } 
-    if (tmp == reply) {
-      sprintf(reply, "No extra SF configured");
+      break;
+    case CLI_GET_EXTRA_SF: {
+      char* tmp = reply;
+      for (int i = 0; i < 3 && _prefs->extra_sf[i] != 0; i++) {
+        tmp += sprintf(tmp, "%s%d", (i == 0) ? "" : ",", _prefs->extra_sf[i]);
+      } 
+      if (tmp == reply) {
+        sprintf(reply, "No extra SF configured");
+      }
+      break;
     }
-  } else {
-    sprintf(reply, "??: %s", config);
+    default:
+      sprintf(reply, "??: %s", config);
   }
 }
 
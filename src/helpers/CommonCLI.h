@@ -6,6 +6,7 @@
 #include <helpers/ClientACL.h>
 #include <helpers/RegionMap.h>
 #include <helpers/ConfigSerializer.h>
+#include <helpers/CommonCLICommands.h>
 
 #if defined(WITH_RS232_BRIDGE) || defined(WITH_ESPNOW_BRIDGE)
 #define WITH_BRIDGE
@@ -53,7 +54,7 @@ public:
   uint8_t bridge_pkt_src = 0; // 0 = logTx, 1 = logRx (default logTx)
   uint32_t bridge_baud = 0;   // 9600, 19200, 38400, 57600, 115200 (default 115200)
   uint8_t bridge_channel = 0; // 1-14 (ESP-NOW only)
-  char bridge_secret[16]; // for XOR encryption of bridge packets (ESP-NOW only)
+  char bridge_secret[16]; // for encryption of bridge packets (ESP-NOW only)
   // Power setting
   uint8_t powersaving_enabled = 0; // boolean
   // Gps settings
@@ -68,6 +69,9 @@ public:
   uint8_t radio_fem_txgain = 0; // LoRa FEM TX gain setting
   uint8_t path_hash_mode = 0;   // which path mode to use when sending
   uint8_t loop_detect = 0;
+  uint8_t advert_fwd_first = 0; // boolean, forward flood adverts before verifying signature
+  uint8_t flood_adaptive = 0;   // boolean, size flood retransmit window by neighbour density
+  uint8_t flood_suppress = 0;   // with flood_adaptive, cancel retransmit after hearing this many rebroadcasts (0 = never)
   uint8_t cad_enabled = 0;      // hardware Channel Activity Detection before TX (boolean)
   uint8_t extra_sf[4];
 
@@ -108,7 +112,7 @@ private:
       def("src", _parent->bridge_pkt_src); // 0 = logTx, 1 = logRx (default logTx)
       def("baud", _parent->bridge_baud);   // 9600, 19200, 38400, 57600, 115200 (default 115200)
       def("ch", _parent->bridge_channel); // 1-14 (ESP-NOW only)
-      def("secret", _parent->bridge_secret, sizeof(_parent->bridge_secret)); // for XOR encryption of bridge packets (ESP-NOW only)
+      def("secret", _parent->bridge_secret, sizeof(_parent->bridge_secret)); // for encryption of bridge packets (ESP-NOW only)
     }
   public:
     BridgePrefs(NodePrefs* parent) : _parent(parent) { }
@@ -149,6 +153,9 @@ private:
       def("f_max_uns", _parent->flood_max_unscoped);
       def("f_max_adv", _parent->flood_max_advert);
       def("loop", _parent->loop_detect);
+      def("adv_fwd_first", _parent->advert_fwd_first);
+      def("f_adaptive", _parent->flood_adaptive);
+      def("f_suppress", _parent->flood_suppress);
     }
   public:
     RepeatPrefs(NodePrefs* parent) : _parent(parent) { }
@@ -215,6 +222,18 @@ public:
   virtual void formatStatsReply(char *reply) = 0;
   virtual void formatRadioStatsReply(char *reply) = 0;
   virtual void formatPacketStatsReply(char *reply) = 0;
+  virtual void formatChannelStatsReply(char *reply) {
+    strcpy(reply, "Error: no channel stats");   // default, if radio driver doesn't monitor channel
+  }
+  virtual void formatDutyCycleStatsReply(char *reply) {
+    strcpy(reply, "Error: no duty cycle stats");
+  }
+  virtual void formatBridgeStatsReply(char *reply) {
+    strcpy(reply, "Error: no bridge stats");   // default, if bridge doesn't keep link stats
+  }
+  virtual void formatMetricsReply(char *reply, int start) {
+    strcpy(reply, "Error: no metrics");
+  }
   virtual mesh::LocalIdentity& getSelfId() = 0;
   virtual void saveIdentity(const mesh::LocalIdentity& new_id) = 0;
   virtual void clearStats() = 0;
@@ -258,18 +277,23 @@ class CommonCLI {
   RegionMap* _region_map;
   ClientACL* _acl;
   char tmp[PRV_KEY_SIZE*2 + 4];
+  CommandTable _commands, _get_keys, _set_keys;
 
   mesh::RTCClock* getRTCClock() { return _rtc; }
   void savePrefs();
   void loadPrefsInt(FILESYSTEM* _fs, const char* filename);
+  bool loadPrefsBinary(FILESYSTEM* _fs);
+  bool savePrefsSerial(FILESYSTEM* _fs);
 
   void handleRegionCmd(char* command, char* reply);
   void handleGetCmd(uint32_t sender_timestamp, char* command, char* reply);
   void handleSetCmd(uint32_t sender_timestamp, char* command, char* reply);
+  void formatHelpReply(bool from_serial, const char* partial, char* reply);
 
 public:
   CommonCLI(mesh::MainBoard& board, mesh::RTCClock& rtc, SensorManager& sensors, RegionMap& region_map, ClientACL& acl, NodePrefs* prefs, CommonCLICallbacks* callbacks)
-      : _board(&board), _rtc(&rtc), _sensors(&sensors), _region_map(&region_map), _acl(&acl), _prefs(prefs), _callbacks(callbacks) { }
+      : _board(&board), _rtc(&rtc), _sensors(&sensors), _region_map(&region_map), _acl(&acl), _prefs(prefs), _callbacks(callbacks),
+        _commands(cli_commands, num_cli_commands), _get_keys(cli_get_keys, num_cli_get_keys), _set_keys(cli_set_keys, num_cli_set_keys) { }
 
   void loadPrefs(FILESYSTEM* _fs);
   bool savePrefs(FILESYSTEM* _fs);
@@ -0,0 +1,168 @@
+#include "CommonCLICommands.h"
+
+#if defined(WITH_RS232_BRIDGE) || defined(WITH_ESPNOW_BRIDGE)
+#define WITH_BRIDGE
+#endif
+
+const CommandDef cli_commands[] = {
+  { "poweroff", CLI_CMD_POWEROFF, 0 },
+  { "shutdown", CLI_CMD_POWEROFF, 0 },
+  { "reboot", CLI_CMD_REBOOT, 0 },
+  { "clkreboot", CLI_CMD_CLKREBOOT, 0 },
+  { "advert.zerohop", CLI_CMD_ADVERT_ZEROHOP, CMD_FLAG_WHOLE_WORD },
+  { "advert", CLI_CMD_ADVERT, 0 },
+  { "clock sync", CLI_CMD_CLOCK_SYNC, 0 },
+  { "start ota", CLI_CMD_START_OTA, 0 },
+  { "clock", CLI_CMD_CLOCK, 0 },
+  { "time ", CLI_CMD_TIME, 0 },
+  { "neighbors", CLI_CMD_NEIGHBORS, 0 },
+  { "neighbor.remove ", CLI_CMD_NEIGHBOR_REMOVE, 0 },
+  { "tempradio ", CLI_CMD_TEMPRADIO, 0 },
+  { "password ", CLI_CMD_PASSWORD, 0 },
+  { "clear stats", CLI_CMD_CLEAR_STATS, 0 },
+  { "get ", CLI_CMD_GET, 0 },
+  { "set ", CLI_CMD_SET, 0 },
+  { "erase", CLI_CMD_ERASE, CMD_FLAG_SERIAL_ONLY | CMD_FLAG_EXACT },
+  { "ver", CLI_CMD_VER, 0 },
+  { "board", CLI_CMD_BOARD, 0 },
+  { "sensor get ", CLI_CMD_SENSOR_GET, 0 },
+  { "sensor set ", CLI_CMD_SENSOR_SET, 0 },
+  { "sensor list", CLI_CMD_SENSOR_LIST, 0 },
+  { "region", CLI_CMD_REGION, 0 },
+#if ENV_INCLUDE_GPS == 1
+  { "gps on", CLI_CMD_GPS_ON, 0 },
+  { "gps off", CLI_CMD_GPS_OFF, 0 },
+  { "gps sync", CLI_CMD_GPS_SYNC, 0 },
+  { "gps setloc", CLI_CMD_GPS_SETLOC, 0 },
+  { "gps advert", CLI_CMD_GPS_ADVERT, 0 },
+  { "gps", CLI_CMD_GPS, 0 },
+#endif
+  { "powersaving on", CLI_CMD_POWERSAVING_ON, 0 },
+  { "powersaving off", CLI_CMD_POWERSAVING_OFF, 0 },
+  { "powersaving", CLI_CMD_POWERSAVING, 0 },
+  { "log start", CLI_CMD_LOG_START, 0 },
+  { "log stop", CLI_CMD_LOG_STOP, 0 },
+  { "log erase", CLI_CMD_LOG_ERASE, 0 },
+  { "log", CLI_CMD_LOG, CMD_FLAG_SERIAL_ONLY },
+  { "stats-packets", CLI_CMD_STATS_PACKETS, CMD_FLAG_SERIAL_ONLY | CMD_FLAG_WHOLE_WORD },
+  { "stats-radio", CLI_CMD_STATS_RADIO, CMD_FLAG_SERIAL_ONLY | CMD_FLAG_WHOLE_WORD },
+  { "stats-core", CLI_CMD_STATS_CORE, CMD_FLAG_SERIAL_ONLY | CMD_FLAG_WHOLE_WORD },
+  { "stats-channel", CLI_CMD_STATS_CHANNEL, CMD_FLAG_SERIAL_ONLY | CMD_FLAG_WHOLE_WORD },
+  { "stats-dutycycle", CLI_CMD_STATS_DUTYCYCLE, CMD_FLAG_SERIAL_ONLY | CMD_FLAG_WHOLE_WORD },
+  { "stats-bridge", CLI_CMD_STATS_BRIDGE, CMD_FLAG_SERIAL_ONLY | CMD_FLAG_WHOLE_WORD },
+  { "stats-metrics", CLI_CMD_STATS_METRICS, CMD_FLAG_SERIAL_ONLY | CMD_FLAG_WHOLE_WORD },
+  { "help", CLI_CMD_HELP, 0 },
+};
+const int num_cli_commands = sizeof(cli_commands) / sizeof(cli_commands[0]);
+
+const CommandDef cli_get_keys[] = {
+  { "dutycycle", CLI_GET_DUTYCYCLE, 0 },
+  { "af", CLI_GET_AF, 0 },
+  { "int.thresh", CLI_GET_INT_THRESH, 0 },
+  { "cad", CLI_GET_CAD, 0 },
+  { "agc.reset.interval", CLI_GET_AGC_RESET_INTERVAL, 0 },
+  { "multi.acks", CLI_GET_MULTI_ACKS, 0 },
+  { "allow.read.only", CLI_GET_ALLOW_READ_ONLY, 0 },
+  { "flood.advert.interval", CLI_GET_FLOOD_ADVERT_INTERVAL, 0 },
+  { "advert.interval", CLI_GET_ADVERT_INTERVAL, 0 },
+  { "guest.password", CLI_GET_GUEST_PASSWORD, 0 },
+  { "prv.key", CLI_GET_PRV_KEY, CMD_FLAG_SERIAL_ONLY },
+  { "name", CLI_GET_NAME, 0 },
+  { "repeat", CLI_GET_REPEAT, 0 },
+  { "lat", CLI_GET_LAT, 0 },
+  { "lon", CLI_GET_LON, 0 },
+  { "radio.rxgain", CLI_GET_RADIO_RXGAIN, 0 },
+  { "radio.fem.rxgain", CLI_GET_RADIO_FEM_RXGAIN, 0 },
+  { "radio.fem.txgain", CLI_GET_RADIO_FEM_TXGAIN, 0 },
+  { "radio", CLI_GET_RADIO, 0 },
+  { "rxdelay", CLI_GET_RXDELAY, 0 },
+  { "txdelay", CLI_GET_TXDELAY, 0 },
+  { "flood.adaptive", CLI_GET_FLOOD_ADAPTIVE, 0 },
+  { "flood.suppress", CLI_GET_FLOOD_SUPPRESS, 0 },
+  { "flood.max.advert", CLI_GET_FLOOD_MAX_ADVERT, 0 },
+  { "flood.max.unscoped", CLI_GET_FLOOD_MAX_UNSCOPED, 0 },
+  { "flood.max", CLI_GET_FLOOD_MAX, 0 },
+  { "direct.txdelay", CLI_GET_DIRECT_TXDELAY, 0 },
+  { "owner.info", CLI_GET_OWNER_INFO, 0 },
+  { "path.hash.mode", CLI_GET_PATH_HASH_MODE, 0 },
+  { "loop.detect", CLI_GET_LOOP_DETECT, 0 },
+  { "advert.fwd.first", CLI_GET_ADVERT_FWD_FIRST, 0 },
+  { "tx", CLI_GET_TX, CMD_FLAG_WHOLE_WORD },
+  { "freq", CLI_GET_FREQ, 0 },
+  { "public.key", CLI_GET_PUBLIC_KEY, 0 },
+  { "role", CLI_GET_ROLE, 0 },
+  { "bridge.type", CLI_GET_BRIDGE_TYPE, 0 },
+#ifdef WITH_BRIDGE
+  { "bridge.enabled", CLI_GET_BRIDGE_ENABLED, 0 },
+  { "bridge.delay", CLI_GET_BRIDGE_DELAY, 0 },
+  { "bridge.source", CLI_GET_BRIDGE_SOURCE, 0 },
+#endif
+#ifdef WITH_RS232_BRIDGE
+  { "bridge.baud", CLI_GET_BRIDGE_BAUD, 0 },
+#endif
+#ifdef WITH_ESPNOW_BRIDGE
+  { "bridge.channel", CLI_GET_BRIDGE_CHANNEL, 0 },
+  { "bridge.secret", CLI_GET_BRIDGE_SECRET, 0 },
+#endif
+  { "bootloader.ver", CLI_GET_BOOTLOADER_VER, 0 },
+  { "adc.multiplier", CLI_GET_ADC_MULTIPLIER, 0 },
+  { "pwrmgt.support", CLI_GET_PWRMGT_SUPPORT, 0 },
+  { "pwrmgt.source", CLI_GET_PWRMGT_SOURCE, 0 },
+  { "pwrmgt.bootreason", CLI_GET_PWRMGT_BOOTREASON, 0 },
+  { "pwrmgt.bootmv", CLI_GET_PWRMGT_BOOTMV, 0 },
+  { "extra.sf", CLI_GET_EXTRA_SF, 0 },
+};
+const int num_cli_get_keys = sizeof(cli_get_keys) / sizeof(cli_get_keys[0]);
+
+const CommandDef cli_set_keys[] = {
+  { "dutycycle ", CLI_SET_DUTYCYCLE, 0 },
+  { "af ", CLI_SET_AF, 0 },
+  { "int.thresh ", CLI_SET_INT_THRESH, 0 },
+  { "cad ", CLI_SET_CAD, 0 },
+  { "agc.reset.interval ", CLI_SET_AGC_RESET_INTERVAL, 0 },
+  { "multi.acks ", CLI_SET_MULTI_ACKS, 0 },
+  { "allow.read.only ", CLI_SET_ALLOW_READ_ONLY, 0 },
+  { "flood.advert.interval ", CLI_SET_FLOOD_ADVERT_INTERVAL, 0 },
+  { "advert.interval ", CLI_SET_ADVERT_INTERVAL, 0 },
+  { "guest.password ", CLI_SET_GUEST_PASSWORD, 0 },
+  { "prv.key ", CLI_SET_PRV_KEY, 0 },
+  { "name ", CLI_SET_NAME, 0 },
+  { "repeat ", CLI_SET_REPEAT, 0 },
+  { "radio.rxgain ", CLI_SET_RADIO_RXGAIN, 0 },
+  { "radio.fem.rxgain ", CLI_SET_RADIO_FEM_RXGAIN, 0 },
+  { "radio.fem.txgain ", CLI_SET_RADIO_FEM_TXGAIN, 0 },
+  { "radio ", CLI_SET_RADIO, 0 },
+  { "lat ", CLI_SET_LAT, 0 },
+  { "lon ", CLI_SET_LON, 0 },
+  { "rxdelay ", CLI_SET_RXDELAY, 0 },
+  { "txdelay ", CLI_SET_TXDELAY, 0 },
+  { "flood.adaptive ", CLI_SET_FLOOD_ADAPTIVE, 0 },
+  { "flood.suppress ", CLI_SET_FLOOD_SUPPRESS, 0 },
+  { "flood.max.unscoped ", CLI_SET_FLOOD_MAX_UNSCOPED, 0 },
+  { "flood.max.advert ", CLI_SET_FLOOD_MAX_ADVERT, 0 },
+  { "flood.max ", CLI_SET_FLOOD_MAX, 0 },
+  { "direct.txdelay ", CLI_SET_DIRECT_TXDELAY, 0 },
+  { "owner.info ", CLI_SET_OWNER_INFO, 0 },
+  { "path.hash.mode ", CLI_SET_PATH_HASH_MODE, 0 },
+  { "loop.detect ", CLI_SET_LOOP_DETECT, 0 },
+  { "advert.fwd.first ", CLI_SET_ADVERT_FWD_FIRST, 0 },
+  { "tx ", CLI_SET_TX, 0 },
+  { "freq ", CLI_SET_FREQ, CMD_FLAG_SERIAL_ONLY },
+#ifdef WITH_BRIDGE
+  { "bridge.enabled ", CLI_SET_BRIDGE_ENABLED, 0 },
+  { "bridge.delay ", CLI_SET_BRIDGE_DELAY, 0 },
+  { "bridge.source ", CLI_SET_BRIDGE_SOURCE, 0 },
+#endif
+#ifdef WITH_RS232_BRIDGE
+  { "bridge.baud ", CLI_SET_BRIDGE_BAUD, 0 },
+#endif
+#ifdef WITH_ESPNOW_BRIDGE
+  { "bridge.channel ", CLI_SET_BRIDGE_CHANNEL, 0 },
+  { "bridge.secret ", CLI_SET_BRIDGE_SECRET, 0 },
+#endif
+  { "adc.multiplier ", CLI_SET_ADC_MULTIPLIER, 0 },
+#if defined(USE_LR2021)
+  { "extra.sf ", CLI_SET_EXTRA_SF, 0 },
+#endif
+};
+const int num_cli_set_keys = sizeof(cli_set_keys) / sizeof(cli_set_keys[0]);
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "CommandTable.h"
+
+/**
+ *   Command names, and get/set config keys, understood by CommonCLI. Order here doesn't matter, as CommandTable sorts
+ *   them, and where one name is a prefix of another (eg. "advert", "advert.zerohop") the longest match wins.
+ */
+
+#define CLI_UNKNOWN   0
+
+enum {   // commands
+  CLI_CMD_POWEROFF = 1,
+  CLI_CMD_REBOOT,
+  CLI_CMD_CLKREBOOT,
+  CLI_CMD_ADVERT_ZEROHOP,
+  CLI_CMD_ADVERT,
+  CLI_CMD_CLOCK_SYNC,
+  CLI_CMD_START_OTA,
+  CLI_CMD_CLOCK,
+  CLI_CMD_TIME,
+  CLI_CMD_NEIGHBORS,
+  CLI_CMD_NEIGHBOR_REMOVE,
+  CLI_CMD_TEMPRADIO,
+  CLI_CMD_PASSWORD,
+  CLI_CMD_CLEAR_STATS,
+  CLI_CMD_GET,
+  CLI_CMD_SET,
+  CLI_CMD_ERASE,
+  CLI_CMD_VER,
+  CLI_CMD_BOARD,
+  CLI_CMD_SENSOR_GET,
+  CLI_CMD_SENSOR_SET,
+  CLI_CMD_SENSOR_LIST,
+  CLI_CMD_REGION,
+  CLI_CMD_GPS_ON,
+  CLI_CMD_GPS_OFF,
+  CLI_CMD_GPS_SYNC,
+  CLI_CMD_GPS_SETLOC,
+  CLI_CMD_GPS_ADVERT,
+  CLI_CMD_GPS,
+  CLI_CMD_POWERSAVING_ON,
+  CLI_CMD_POWERSAVING_OFF,
+  CLI_CMD_POWERSAVING,
+  CLI_CMD_LOG_START,
+  CLI_CMD_LOG_STOP,
+  CLI_CMD_LOG_ERASE,
+  CLI_CMD_LOG,
+  CLI_CMD_STATS_PACKETS,
+  CLI_CMD_STATS_RADIO,
+  CLI_CMD_STATS_CORE,
+  CLI_CMD_STATS_CHANNEL,
+  CLI_CMD_STATS_DUTYCYCLE,
+  CLI_CMD_STATS_BRIDGE,
+  CLI_CMD_STATS_METRICS,
+  CLI_CMD_HELP,
+};
+
+enum {   // 'get' keys
+  CLI_GET_DUTYCYCLE = 1,
+  CLI_GET_AF,
+  CLI_GET_INT_THRESH,
+  CLI_GET_CAD,
+  CLI_GET_AGC_RESET_INTERVAL,
+  CLI_GET_MULTI_ACKS,
+  CLI_GET_ALLOW_READ_ONLY,
+  CLI_GET_FLOOD_ADVERT_INTERVAL,
+  CLI_GET_ADVERT_INTERVAL,
+  CLI_GET_GUEST_PASSWORD,
+  CLI_GET_PRV_KEY,
+  CLI_GET_NAME,
+  CLI_GET_REPEAT,
+  CLI_GET_LAT,
+  CLI_GET_LON,
+  CLI_GET_RADIO_RXGAIN,
+  CLI_GET_RADIO_FEM_RXGAIN,
+  CLI_GET_RADIO_FEM_TXGAIN,
+  CLI_GET_RADIO,
+  CLI_GET_RXDELAY,
+  CLI_GET_TXDELAY,
+  CLI_GET_FLOOD_ADAPTIVE,
+  CLI_GET_FLOOD_SUPPRESS,
+  CLI_GET_FLOOD_MAX_ADVERT,
+  CLI_GET_FLOOD_MAX_UNSCOPED,
+  CLI_GET_FLOOD_MAX,
+  CLI_GET_DIRECT_TXDELAY,
+  CLI_GET_OWNER_INFO,
+  CLI_GET_PATH_HASH_MODE,
+  CLI_GET_LOOP_DETECT,
+  CLI_GET_ADVERT_FWD_FIRST,
+  CLI_GET_TX,
+  CLI_GET_FREQ,
+  CLI_GET_PUBLIC_KEY,
+  CLI_GET_ROLE,
+  CLI_GET_BRIDGE_TYPE,
+  CLI_GET_BRIDGE_ENABLED,
+  CLI_GET_BRIDGE_DELAY,
+  CLI_GET_BRIDGE_SOURCE,
+  CLI_GET_BRIDGE_BAUD,
+  CLI_GET_BRIDGE_CHANNEL,
+  CLI_GET_BRIDGE_SECRET,
+  CLI_GET_BOOTLOADER_VER,
+  CLI_GET_ADC_MULTIPLIER,
+  CLI_GET_PWRMGT_SUPPORT,
+  CLI_GET_PWRMGT_SOURCE,
+  CLI_GET_PWRMGT_BOOTREASON,
+  CLI_GET_PWRMGT_BOOTMV,
+  CLI_GET_EXTRA_SF,
+};
+
+enum {   // 'set' keys (incl. trailing space)
+  CLI_SET_DUTYCYCLE = 1,
+  CLI_SET_AF,
+  CLI_SET_INT_THRESH,
+  CLI_SET_CAD,
+  CLI_SET_AGC_RESET_INTERVAL,
+  CLI_SET_MULTI_ACKS,
+  CLI_SET_ALLOW_READ_ONLY,
+  CLI_SET_FLOOD_ADVERT_INTERVAL,
+  CLI_SET_ADVERT_INTERVAL,
+  CLI_SET_GUEST_PASSWORD,
+  CLI_SET_PRV_KEY,
+  CLI_SET_NAME,
+  CLI_SET_REPEAT,
+  CLI_SET_RADIO_RXGAIN,
+  CLI_SET_RADIO_FEM_RXGAIN,
+  CLI_SET_RADIO_FEM_TXGAIN,
+  CLI_SET_RADIO,
+  CLI_SET_LAT,
+  CLI_SET_LON,
+  CLI_SET_RXDELAY,
+  CLI_SET_TXDELAY,
+  CLI_SET_FLOOD_ADAPTIVE,
+  CLI_SET_FLOOD_SUPPRESS,
+  CLI_SET_FLOOD_MAX_UNSCOPED,
+  CLI_SET_FLOOD_MAX_ADVERT,
+  CLI_SET_FLOOD_MAX,
+  CLI_SET_DIRECT_TXDELAY,
+  CLI_SET_OWNER_INFO,
+  CLI_SET_PATH_HASH_MODE,
+  CLI_SET_LOOP_DETECT,
+  CLI_SET_ADVERT_FWD_FIRST,
+  CLI_SET_TX,
+  CLI_SET_FREQ,
+  CLI_SET_BRIDGE_ENABLED,
+  CLI_SET_BRIDGE_DELAY,
+  CLI_SET_BRIDGE_SOURCE,
+  CLI_SET_BRIDGE_BAUD,
+  CLI_SET_BRIDGE_CHANNEL,
+  CLI_SET_BRIDGE_SECRET,
+  CLI_SET_ADC_MULTIPLIER,
+  CLI_SET_EXTRA_SF,
+};
+
+extern const CommandDef cli_commands[];
+extern const int num_cli_commands;
+extern const CommandDef cli_get_keys[];
+extern const int num_cli_get_keys;
+extern const CommandDef cli_set_keys[];
+extern const int num_cli_set_keys;
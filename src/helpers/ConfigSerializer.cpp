@@ -144,7 +144,17 @@ void ConfigSerializer::writeComma() {
 
 #include <Utils.h>
 
+static uint16_t calcTag(uint16_t seed, const char* key) {
+  uint32_t h = 2166136261UL;   // FNV-1a, of parent's tag and key
+  h = (h ^ (seed & 0xFF)) * 16777619UL;
+  h = (h ^ (seed >> 8)) * 16777619UL;
+  while (*key) h = (h ^ (uint8_t)*key++) * 16777619UL;
+  return (uint16_t)((h >> 16) ^ h);
+}
+
 void ConfigSerializer::def(const char* key, void* value, size_t len) {
+  if (binField(key, value, len, KIND_BYTES)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -160,6 +170,8 @@ void ConfigSerializer::def(const char* key, void* value, size_t len) {
 }
 
 void ConfigSerializer::def(const char* key, char* value, size_t max_len) {
+  if (binField(key, value, max_len, KIND_STRING)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -188,6 +200,8 @@ void ConfigSerializer::def(const char* key, char* value, size_t max_len) {
 }
 
 void ConfigSerializer::def(const char* key, int32_t& value) {
+  if (binField(key, &value, sizeof(value), KIND_INT)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -201,6 +215,8 @@ void ConfigSerializer::def(const char* key, int32_t& value) {
 }
 
 void ConfigSerializer::def(const char* key, uint32_t& value) {
+  if (binField(key, &value, sizeof(value), KIND_UINT)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -214,6 +230,8 @@ void ConfigSerializer::def(const char* key, uint32_t& value) {
 }
 
 void ConfigSerializer::def(const char* key, int16_t& value) {
+  if (binField(key, &value, sizeof(value), KIND_INT)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -227,6 +245,8 @@ void ConfigSerializer::def(const char* key, int16_t& value) {
 }
 
 void ConfigSerializer::def(const char* key, uint16_t& value) {
+  if (binField(key, &value, sizeof(value), KIND_UINT)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -240,6 +260,8 @@ void ConfigSerializer::def(const char* key, uint16_t& value) {
 }
 
 void ConfigSerializer::def(const char* key, uint8_t& value) {
+  if (binField(key, &value, sizeof(value), KIND_UINT)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -253,6 +275,8 @@ void ConfigSerializer::def(const char* key, uint8_t& value) {
 }
 
 void ConfigSerializer::def(const char* key, int8_t& value) {
+  if (binField(key, &value, sizeof(value), KIND_INT)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -266,6 +290,8 @@ void ConfigSerializer::def(const char* key, int8_t& value) {
 }
 
 void ConfigSerializer::def(const char* key, bool& value) {
+  if (binField(key, &value, sizeof(value), KIND_UINT)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -279,6 +305,8 @@ void ConfigSerializer::def(const char* key, bool& value) {
 }
 
 void ConfigSerializer::def(const char* key, double& value) {
+  if (binField(key, &value, sizeof(value), KIND_FLOAT)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -296,6 +324,8 @@ void ConfigSerializer::def(const char* key, double& value) {
 }
 
 void ConfigSerializer::def(const char* key, float& value) {
+  if (binField(key, &value, sizeof(value), KIND_FLOAT)) return;
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -313,6 +343,14 @@ void ConfigSerializer::def(const char* key, float& value) {
 }
 
 void ConfigSerializer::def(const char* key, ConfigSerializer& sub_obj) {
+  if (_bin) {
+    sub_obj._bin = _bin;   // inherit the BinContext
+    sub_obj._tag_seed = calcTag(_tag_seed, key);   // so keys are unique per sub object
+    sub_obj.structure();
+    sub_obj._bin = NULL;
+    return;
+  }
+
   if (_context->op() == OP::WRITE) {
     writeComma();
     _context->file()->print(key);
@@ -329,3 +367,157 @@ void ConfigSerializer::def(const char* key, ConfigSerializer& sub_obj) {
     }
   }
 }
+
+/* ------------------------------ Binary -------------------------------- */
+
+static uint16_t calcChecksum(const uint8_t* data, int len) {   // Fletcher-16
+  uint16_t a = 0, b = 0;
+  for (int i = 0; i < len; i++) {
+    a = (a + data[i]) % 255;
+    b = (b + a) % 255;
+  }
+  return (b << 8) | a;
+}
+
+int ConfigSerializer::findRecord(uint16_t tag) {
+  // records are usually in same order as structure(), so search from after the last one found
+  for (int pass = 0; pass < 2; pass++) {
+    int i = pass == 0 ? _bin->pos : 0;
+    int end = pass == 0 ? _bin->len : _bin->pos;
+    while (i < end) {
+      int next = i + 3 + _bin->buf[i + 2];
+      if ((_bin->buf[i] | (_bin->buf[i + 1] << 8)) == tag) {
+        _bin->pos = next;
+        return i;
+      }
+      i = next;
+    }
+  }
+  return -1;
+}
+
+// NOTE: values are in native byte order, ie. little-endian on all supported MCUs
+bool ConfigSerializer::binField(const char* key, void* value, size_t size, Kind kind) {
+  if (_bin == NULL) return false;   // not in binary mode
+
+  uint16_t tag = calcTag(_tag_seed, key);
+  if (_bin->op != BIN_READ) {
+    size_t len = kind == KIND_STRING ? strnlen((const char *) value, size) : size;
+    if (len > 255) {
+      _bin->success = false;   // too long for a record
+      return true;
+    }
+    if (_bin->op == BIN_WRITE) {
+      if (_bin->pos + 3 + (int)len > _bin->len) {
+        _bin->success = false;
+        return true;
+      }
+      uint8_t* dest = &_bin->buf[_bin->pos];
+      dest[0] = tag & 0xFF;
+      dest[1] = tag >> 8;
+      dest[2] = len;
+      memcpy(&dest[3], value, len);
+    }
+    _bin->pos += 3 + len;
+    return true;
+  }
+
+  int i = findRecord(tag);
+  if (i < 0) return true;   // not in file, so leave as is
+
+  uint8_t len = _bin->buf[i + 2];
+  const uint8_t* src = &_bin->buf[i + 3];
+  switch (kind) {
+    case KIND_INT:
+    case KIND_UINT:
+      if (len > 0 && len <= 8) {   // width may have changed since saved
+        uint64_t v = 0;
+        memcpy(&v, src, len);
+        if (kind == KIND_INT && len < 8 && (src[len - 1] & 0x80)) v |= ~0ULL << (len * 8);   // sign extend
+        memcpy(value, &v, size);
+      }
+      break;
+    case KIND_FLOAT: {
+      double d;
+      if (len == sizeof(float)) {
+        float f;
+        memcpy(&f, src, len);
+        d = f;
+      } else if (len == sizeof(double)) {
+        memcpy(&d, src, len);
+      } else {
+        break;
+      }
+      if (size == sizeof(float)) {
+        *(float *)value = (float) d;
+      } else {
+        *(double *)value = d;
+      }
+      break;
+    }
+    case KIND_STRING: {
+      size_t n = len < size - 1 ? len : size - 1;
+      memcpy(value, src, n);
+      ((char *)value)[n] = 0;
+      break;
+    }
+    case KIND_BYTES:
+      memset(value, 0, size);
+      memcpy(value, src, len < size ? len : size);
+      break;
+  }
+  return true;
+}
+
+void ConfigSerializer::runBinary(BinContext& bin) {
+  _bin = &bin;
+  _tag_seed = 0;
+  structure();
+  _bin = NULL;
+}
+
+int ConfigSerializer::saveBinary(uint8_t* dest, int max_len) {
+  BinContext bin = { BIN_SIZE, NULL, 0, 0, true };
+  runBinary(bin);   // first pass, to get length
+  int len = bin.pos;
+  if (!bin.success || len > CONFIG_BINARY_MAX_SIZE) return -1;
+  if (dest == NULL) return CONFIG_BINARY_HDR_SIZE + len;
+  if (CONFIG_BINARY_HDR_SIZE + len > max_len) return -1;
+
+  bin.op = BIN_WRITE;
+  bin.buf = &dest[CONFIG_BINARY_HDR_SIZE];
+  bin.len = len;
+  bin.pos = 0;
+  runBinary(bin);
+  if (!bin.success) return -1;
+
+  uint16_t checksum = calcChecksum(bin.buf, len);
+  dest[0] = 'M';
+  dest[1] = 'C';
+  dest[2] = CONFIG_BINARY_VERSION;
+  dest[3] = 0;   // reserved
+  dest[4] = len & 0xFF;
+  dest[5] = len >> 8;
+  dest[6] = checksum & 0xFF;
+  dest[7] = checksum >> 8;
+  return CONFIG_BINARY_HDR_SIZE + len;
+}
+
+bool ConfigSerializer::loadBinary(const uint8_t* src, int len) {
+  if (len < CONFIG_BINARY_HDR_SIZE || src[0] != 'M' || src[1] != 'C') return false;
+  if (src[2] == 0 || src[2] > CONFIG_BINARY_VERSION) return false;   // unknown version
+
+  int data_len = src[4] | (src[5] << 8);
+  const uint8_t* data = &src[CONFIG_BINARY_HDR_SIZE];
+  if (CONFIG_BINARY_HDR_SIZE + data_len > len) return false;   // truncated
+  if (calcChecksum(data, data_len) != (src[6] | (src[7] << 8))) return false;
+
+  // check records are well formed, before modifying any fields
+  for (int i = 0; i < data_len; i += 3 + data[i + 2]) {
+    if (i + 3 > data_len || i + 3 + data[i + 2] > data_len) return false;
+  }
+
+  BinContext bin = { BIN_READ, (uint8_t *) data, data_len, 0, true };
+  runBinary(bin);
+  return bin.success;
+}
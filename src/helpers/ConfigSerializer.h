@@ -14,6 +14,13 @@
   #define CONFIG_MAX_TOKEN_LEN   128
 #endif
 
+#ifndef CONFIG_BINARY_MAX_SIZE
+  #define CONFIG_BINARY_MAX_SIZE   2048
+#endif
+
+#define CONFIG_BINARY_VERSION    1
+#define CONFIG_BINARY_HDR_SIZE   8     // magic(2), version(1), reserved(1), length(2), checksum(2)
+
 class ConfigSerializer {
   bool _first;
   int8_t _depth;
@@ -42,7 +49,28 @@ class ConfigSerializer {
 
   Context* _context = NULL;
 
+  enum BinOP { BIN_SIZE, BIN_WRITE, BIN_READ };
+  enum Kind { KIND_INT, KIND_UINT, KIND_FLOAT, KIND_STRING, KIND_BYTES };
+
+  /**
+   *   Binary encoding: a record per field, [tag (2)][length (1)][value (length)], where tag is a hash of the
+   *   field's key path. Unknown tags are skipped, and missing ones leave the field untouched, so files stay
+   *   compatible as fields are added/removed (or change width).
+   */
+  struct BinContext {
+    BinOP op;
+    uint8_t* buf;
+    int len;
+    int pos;        // write position, or read search cursor
+    bool success;
+  };
+  BinContext* _bin = NULL;
+  uint16_t _tag_seed = 0;
+
   void writeComma();
+  bool binField(const char* key, void* value, size_t size, Kind kind);
+  int findRecord(uint16_t tag);
+  void runBinary(BinContext& bin);
 
 protected:
   ConfigSerializer() { }
@@ -65,4 +93,16 @@ protected:
 public:
   bool loadSerial(Stream& s);
   bool saveSerial(Stream& s);
+
+  /**
+   * \brief  loads from compact binary form (eg. whole file, read in one block)
+   * \returns  false if corrupt, or a newer format version (in which case nothing is modified)
+   */
+  bool loadBinary(const uint8_t* src, int len);
+  /**
+   * \brief  saves in compact binary form (to be written in one block)
+   * \param  dest  if NULL, just calculates length needed
+   * \returns  length, or -1 if 'max_len' too small
+   */
+  int saveBinary(uint8_t* dest, int max_len);
 };
@@ -0,0 +1,76 @@
+#include "FloodContention.h"
+#include <string.h>
+
+#define DUP_RATE_MIN_SAMPLE   8     // flood receptions needed before the dup rate is updated
+
+FloodContention::FloodContention() {
+  memset(_pending, 0, sizeof(_pending));
+  _next_pending = 0;
+  _neighbours = 0;
+  _suppress_threshold = 0;
+  _dup_rate = 0;
+  _last_rx = _last_dups = 0;
+}
+
+void FloodContention::updateDupRate(uint32_t total_flood_rx, uint32_t total_flood_dups) {
+  if (total_flood_rx < _last_rx || total_flood_dups < _last_dups) {   // counters were reset
+    _last_rx = total_flood_rx;
+    _last_dups = total_flood_dups;
+    return;
+  }
+  uint32_t rx = total_flood_rx - _last_rx;
+  if (rx < DUP_RATE_MIN_SAMPLE) return;
+
+  uint32_t dups = total_flood_dups - _last_dups;
+  if (dups > rx) dups = rx;
+  uint16_t sample = (dups * 256) / rx;
+  _dup_rate = (_dup_rate * 3 + sample) / 4;   // smoothed
+  _last_rx = total_flood_rx;
+  _last_dups = total_flood_dups;
+}
+
+int FloodContention::getWindowSlots() const {
+  int slots = _neighbours * 2;   // aim for about two slots per contender
+  slots = (slots * (256 + _dup_rate)) / 256;   // up to double, when most of what we hear is redundant
+  if (slots < FLOOD_MIN_WINDOW_SLOTS) return FLOOD_MIN_WINDOW_SLOTS;
+  if (slots > FLOOD_MAX_WINDOW_SLOTS) return FLOOD_MAX_WINDOW_SLOTS;
+  return slots;
+}
+
+uint32_t FloodContention::calcDelay(uint32_t slot_millis, float snr, uint32_t rand) const {
+  float bias = (snr - FLOOD_SNR_LOW) / (FLOOD_SNR_HIGH - FLOOD_SNR_LOW);
+  if (bias < 0.0f) bias = 0.0f;
+  if (bias > 1.0f) bias = 1.0f;
+
+  uint32_t half = (getWindowSlots() * slot_millis) / 2;
+  return (uint32_t)(bias * half) + rand % (half + 1);
+}
+
+void FloodContention::onQueued(const mesh::Packet* pkt) {
+  if (_suppress_threshold == 0) return;
+
+  Pending* p = &_pending[_next_pending];
+  _next_pending = (_next_pending + 1) % FLOOD_SUPPRESS_MAX_PENDING;
+  p->pkt = pkt;
+  pkt->calculatePacketHash(p->hash);
+  p->heard = 0;
+}
+
+const mesh::Packet* FloodContention::onHeard(const mesh::Packet* pkt) {
+  if (_suppress_threshold == 0) return NULL;
+
+  uint8_t hash[MAX_HASH_SIZE];
+  pkt->calculatePacketHash(hash);
+  for (int i = 0; i < FLOOD_SUPPRESS_MAX_PENDING; i++) {
+    Pending* p = &_pending[i];
+    if (p->pkt && p->pkt != pkt && memcmp(p->hash, hash, MAX_HASH_SIZE) == 0) {
+      if (++p->heard >= _suppress_threshold) {
+        const mesh::Packet* q = p->pkt;
+        p->pkt = NULL;
+        return q;
+      }
+      break;
+    }
+  }
+  return NULL;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Packet.h>
+
+#ifndef FLOOD_MAX_WINDOW_SLOTS
+  #define FLOOD_MAX_WINDOW_SLOTS     40
+#endif
+#ifndef FLOOD_SUPPRESS_MAX_PENDING
+  #define FLOOD_SUPPRESS_MAX_PENDING  8    // max queued flood retransmits being watched for suppression
+#endif
+
+#define FLOOD_MIN_WINDOW_SLOTS   5     // same as the legacy [0, 5*t] window
+#define FLOOD_SNR_LOW           -10.0f
+#define FLOOD_SNR_HIGH           10.0f
+
+/**
+ * \brief  Contention window for flood retransmits, sized by local density and biased by received SNR.
+ *
+ *   - window grows with the number of active neighbours (more nodes contending for the same slots),
+ *     and with the measured rate of duplicate flood receptions.
+ *   - a weak received SNR (we are far from the sender, so add more new coverage) picks from the early
+ *     half of the window, a strong SNR is pushed towards the later half.
+ *   - a queued retransmit is suppressed once 'threshold' other nodes are heard rebroadcasting the same
+ *     packet first (counter-based suppression).
+ */
+class FloodContention {
+  struct Pending {
+    const mesh::Packet* pkt;    // NULL = unused
+    uint8_t hash[MAX_HASH_SIZE];
+    uint8_t heard;
+  };
+  Pending _pending[FLOOD_SUPPRESS_MAX_PENDING];
+  int _next_pending;
+  uint8_t _neighbours, _suppress_threshold;
+  uint16_t _dup_rate;    // fraction of flood receptions that were dups, scaled 0..256 (smoothed)
+  uint32_t _last_rx, _last_dups;
+
+public:
+  FloodContention();
+
+  void setNeighbourCount(int n) { _neighbours = n > 255 ? 255 : n; }
+  void setSuppressThreshold(uint8_t threshold) { _suppress_threshold = threshold; }   // zero = never suppress
+
+  /**
+   * \brief  feeds the running totals of flood packets received, and how many of those were duplicates.
+   */
+  void updateDupRate(uint32_t total_flood_rx, uint32_t total_flood_dups);
+  uint16_t getDupRate() const { return _dup_rate; }
+
+  int getWindowSlots() const;
+
+  /**
+   * \param slot_millis  the length of one slot, ie. airtime of the packet * tx_delay_factor
+   * \param snr  SNR the packet was received with
+   * \param rand  a random number
+   * \returns  the retransmit delay, in millis
+   */
+  uint32_t calcDelay(uint32_t slot_millis, float snr, uint32_t rand) const;
+
+  /**
+   * \brief  watches a packet just scheduled for retransmit, for rebroadcasts by other nodes
+   */
+  void onQueued(const mesh::Packet* pkt);
+
+  /**
+   * \brief  a flood packet was received (possibly a rebroadcast of one we have queued)
+   * \returns  the queued packet to cancel, if suppression threshold now reached, otherwise NULL.
+   *          NOTE: caller must check it is still in the outbound queue (it may have been sent already)
+   */
+  const mesh::Packet* onHeard(const mesh::Packet* pkt);
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Burst-mode envelope for packing several companion frames into one BLE notification/write.
+ * Each frame is prefixed by its length byte:   [len][frame bytes] [len][frame bytes] ...
+ *
+ * Burst mode is opt-in by the app. It writes a (legacy, single frame) hello:  [FRAME_BATCH_HELLO][version]
+ * and the device replies with:  [FRAME_BATCH_HELLO][version][max_payload (uint16 LE)]
+ * after which ALL traffic (both directions) uses the envelope, until disconnect.
+ * A max_payload of zero means declined (MTU too small for a full size frame), and legacy mode continues.
+ */
+#define FRAME_BATCH_HELLO     0xBF   // never a valid CMD_* or RESP_* code
+#define FRAME_BATCH_VERSION   1
+
+class FrameBatch {
+public:
+  static bool isHello(const uint8_t* frame, size_t len) {
+    return len >= 2 && frame[0] == FRAME_BATCH_HELLO && frame[1] >= FRAME_BATCH_VERSION;
+  }
+
+  /**
+   * \returns  true if an envelope of 'max_payload' bytes can hold a frame of 'max_frame_len', ie. no frame is ever
+   *           too big to send. Burst mode must not be enabled otherwise.
+   */
+  static bool canBurst(uint16_t max_payload, size_t max_frame_len) {
+    return max_payload >= 1 + max_frame_len;
+  }
+
+  static size_t writeHelloReply(uint8_t* dest, uint16_t max_payload) {
+    dest[0] = FRAME_BATCH_HELLO;
+    dest[1] = FRAME_BATCH_VERSION;
+    memcpy(&dest[2], &max_payload, 2);
+    return 4;
+  }
+
+  /**
+   * \brief  appends 'frame' to the envelope in 'dest' (currently 'dest_len' bytes), without exceeding 'max_len'.
+   * \returns  the new envelope length, or zero if frame does not fit.
+   */
+  static size_t append(uint8_t* dest, size_t dest_len, size_t max_len, const uint8_t* frame, size_t len) {
+    if (len == 0 || len > 255 || dest_len + 1 + len > max_len) return 0;
+    dest[dest_len++] = len;
+    memcpy(&dest[dest_len], frame, len);
+    return dest_len + len;
+  }
+
+  /**
+   * \brief  reads the next frame from envelope 'src', advancing 'pos'.
+   * \returns  length of frame (pointed to by 'frame'), zero at end of envelope, or -1 if envelope is malformed.
+   */
+  static int next(const uint8_t* src, size_t src_len, size_t& pos, const uint8_t*& frame) {
+    if (pos >= src_len) return 0;
+    uint8_t len = src[pos];
+    if (len == 0 || pos + 1 + len > src_len) return -1;
+    frame = &src[pos + 1];
+    pos += 1 + len;
+    return len;
+  }
+};
+
+/**
+ * \brief  Reassembles envelopes which arrive in pieces (a write can be split over several reads, or coalesced
+ *       with the next). Bytes of a partial frame are kept until the rest arrives, so must be held across reads.
+ */
+template <size_t BUF_SIZE>
+class FrameBatchReader {
+  uint8_t _buf[BUF_SIZE];
+  size_t _len, _pos;
+
+public:
+  FrameBatchReader() { reset(); }
+
+  void reset() { _len = _pos = 0; }
+  size_t getPending() const { return _len - _pos; }
+
+  /**
+   * \brief  where to read more bytes into (up to getRoom() of them). Call added() after.
+   */
+  uint8_t* getTail() { return &_buf[_len]; }
+  size_t getRoom() const { return BUF_SIZE - _len; }
+  void added(size_t n) { _len += n; }
+
+  /**
+   * \brief  reads the next complete frame. 'frame' is valid until the following call.
+   * \returns  length of frame, or zero if none (yet). A malformed envelope is discarded.
+   */
+  int next(const uint8_t*& frame) {
+    int n = FrameBatch::next(_buf, _len, _pos, frame);
+    if (n > 0) return n;
+
+    if (n == 0 || _buf[_pos] == 0) {   // all read, or malformed
+      reset();
+    } else if (_pos > 0) {   // frame split across reads, keep remainder
+      _len -= _pos;
+      memmove(_buf, &_buf[_pos], _len);
+      _pos = 0;
+    } else if (_len == BUF_SIZE) {   // partial frame can never fit
+      reset();
+    }
+    return 0;
+  }
+};
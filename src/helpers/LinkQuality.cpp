@@ -0,0 +1,232 @@
+#include "LinkQuality.h"
+
+#define NO_SCORE   -0x7FFF
+
+LinkQualityTable::LinkQualityTable() {
+  memset(_links, 0, sizeof(_links));
+  memset(_routes, 0, sizeof(_routes));
+  for (int i = 0; i < LINK_QUALITY_MAX_ROUTES; i++) {
+    for (int j = 0; j < LINK_QUALITY_PATHS_PER_ROUTE; j++) _routes[i].paths[j].path_len = LINK_PATH_NONE;
+  }
+  static const uint8_t no_hash[LINK_MAX_HASH_SIZE] = { 0 };
+  _self_hash = no_hash;
+  _dirty = false;
+}
+
+static bool sameLink(const uint8_t* a, const uint8_t* b, const uint8_t* x, const uint8_t* y, uint8_t hash_size) {
+  return (memcmp(a, x, hash_size) == 0 && memcmp(b, y, hash_size) == 0)
+      || (memcmp(a, y, hash_size) == 0 && memcmp(b, x, hash_size) == 0);
+}
+
+LinkQualityTable::Link* LinkQualityTable::findLink(const uint8_t* a, const uint8_t* b, uint8_t hash_size, uint32_t now, bool create) {
+  Link* oldest = NULL;
+  for (int i = 0; i < LINK_QUALITY_MAX_LINKS; i++) {
+    Link* l = &_links[i];
+    if (l->hash_size == hash_size && sameLink(l->a, l->b, a, b, hash_size)) {
+      return l;
+    }
+    if (oldest == NULL || (oldest->hash_size != 0 && (l->hash_size == 0 || l->updated < oldest->updated))) {
+      oldest = l;   // unused, else least recently updated
+    }
+  }
+  if (!create) return NULL;
+
+  memset(oldest, 0, sizeof(*oldest));
+  memcpy(oldest->a, a, hash_size);
+  memcpy(oldest->b, b, hash_size);
+  return oldest;   // NOTE: caller sets hash_size, once it has a sample
+}
+
+void LinkQualityTable::recordLink(const uint8_t* a, const uint8_t* b, uint8_t hash_size, int8_t snr, uint32_t now) {
+  if (hash_size == 0 || hash_size > LINK_MAX_HASH_SIZE || memcmp(a, b, hash_size) == 0) return;
+
+  Link* l = findLink(a, b, hash_size, now, true);
+  bool fresh = l->hash_size == 0 || now - l->updated > LINK_QUALITY_MAX_AGE_SECS;
+  int16_t prev_snr = l->snr;
+  if (fresh) {
+    l->hash_size = hash_size;
+    l->snr = snr;      // first (fresh) sample
+  } else {
+    l->snr = (l->snr * 3 + snr) / 4;   // smoothed
+  }
+  l->updated = now;
+  if ((fresh || l->snr != prev_snr) && isTracked(a, b, hash_size)) {
+    _dirty = true;   // a candidate path's score may have changed
+  }
+}
+
+bool LinkQualityTable::isTracked(const uint8_t* a, const uint8_t* b, uint8_t hash_size) const {
+  for (int i = 0; i < LINK_QUALITY_MAX_ROUTES; i++) {
+    const Route* r = &_routes[i];
+    if (!r->in_use) continue;
+
+    for (int j = 0; j < LINK_QUALITY_PATHS_PER_ROUTE; j++) {
+      const Candidate& c = r->paths[j];
+      if (c.path_len == LINK_PATH_NONE || (c.path_len >> 6) + 1 != hash_size) continue;
+
+      // links: us -> path[0] -> ... -> path[n-1] -> contact
+      int n = c.path_len & 63;
+      const uint8_t* prev = _self_hash;
+      for (int k = 0; k <= n; k++) {
+        const uint8_t* next = k < n ? &c.path[k * hash_size] : r->key;
+        if (sameLink(a, b, prev, next, hash_size)) return true;
+        prev = next;
+      }
+    }
+  }
+  return false;
+}
+
+int LinkQualityTable::getLinkSNR(const uint8_t* a, const uint8_t* b, uint8_t hash_size, uint32_t now) {
+  Link* l = findLink(a, b, hash_size, now, false);
+  if (l == NULL || now - l->updated > LINK_QUALITY_MAX_AGE_SECS) return LINK_UNKNOWN_SNR;
+  return l->snr;
+}
+
+int LinkQualityTable::getNumLinks() const {
+  int n = 0;
+  for (int i = 0; i < LINK_QUALITY_MAX_LINKS; i++) {
+    if (_links[i].hash_size) n++;
+  }
+  return n;
+}
+
+void LinkQualityTable::onPacketRecv(const mesh::Packet* pkt, uint32_t now) {
+  if (!pkt->isRouteFlood() || pkt->getPathHashCount() == 0) return;
+
+  uint8_t sz = pkt->getPathHashSize();
+  recordLink(&pkt->path[(pkt->getPathHashCount() - 1) * sz], _self_hash, sz, pkt->_snr, now);
+}
+
+void LinkQualityTable::onTraceRecv(uint8_t flags, const uint8_t* path_snrs, const uint8_t* path_hashes, uint8_t path_len, int8_t final_snr, uint32_t now) {
+  uint8_t path_sz = flags & 0x03;
+  uint8_t hash_size = 1 << path_sz;
+  if (hash_size > LINK_MAX_HASH_SIZE) return;
+
+  // path_snrs[i] is the SNR that hop 'i' heard the previous one (or us) with
+  const uint8_t* prev = _self_hash;
+  int n = path_len >> path_sz;
+  for (int i = 0; i < n; i++) {
+    const uint8_t* hop = &path_hashes[i * hash_size];
+    recordLink(prev, hop, hash_size, (int8_t) path_snrs[i], now);
+    prev = hop;
+  }
+  recordLink(prev, _self_hash, hash_size, final_snr, now);
+}
+
+LinkQualityTable::Route* LinkQualityTable::findRoute(const uint8_t* pub_key, uint32_t now, bool create) {
+  Route* oldest = NULL;
+  for (int i = 0; i < LINK_QUALITY_MAX_ROUTES; i++) {
+    Route* r = &_routes[i];
+    if (r->in_use && memcmp(r->key, pub_key, LINK_ROUTE_KEY_SIZE) == 0) {
+      return r;
+    }
+    if (oldest == NULL || (oldest->in_use && (!r->in_use || r->last_used < oldest->last_used))) {
+      oldest = r;
+    }
+  }
+  if (!create) return NULL;
+
+  memcpy(oldest->key, pub_key, LINK_ROUTE_KEY_SIZE);
+  oldest->in_use = true;
+  oldest->last_used = now;
+  for (int j = 0; j < LINK_QUALITY_PATHS_PER_ROUTE; j++) oldest->paths[j].path_len = LINK_PATH_NONE;
+  return oldest;
+}
+
+int LinkQualityTable::findCandidate(const Route* r, const uint8_t* path, uint8_t path_len) const {
+  for (int j = 0; j < LINK_QUALITY_PATHS_PER_ROUTE; j++) {
+    const Candidate& c = r->paths[j];
+    if (c.path_len != LINK_PATH_NONE && c.path_len == path_len
+        && memcmp(c.path, path, (path_len & 63) * ((path_len >> 6) + 1)) == 0) {
+      return j;
+    }
+  }
+  return -1;
+}
+
+void LinkQualityTable::addPath(const uint8_t* pub_key, const uint8_t* path, uint8_t path_len, uint32_t now) {
+  if (!mesh::Packet::isValidPathLen(path_len)) return;
+
+  Route* r = findRoute(pub_key, now, true);
+  r->last_used = now;
+  int j = findCandidate(r, path, path_len);
+  if (j < 0) {
+    // use a free slot, else replace the least recently heard
+    j = 0;
+    for (int k = 0; k < LINK_QUALITY_PATHS_PER_ROUTE; k++) {
+      if (r->paths[k].path_len == LINK_PATH_NONE) { j = k; break; }
+      if (r->paths[k].heard < r->paths[j].heard) j = k;
+    }
+    Candidate& c = r->paths[j];
+    c.path_len = mesh::Packet::copyPath(c.path, path, path_len);
+  }
+  r->paths[j].heard = now;
+}
+
+void LinkQualityTable::removePath(const uint8_t* pub_key, const uint8_t* path, uint8_t path_len) {
+  Route* r = findRoute(pub_key, 0, false);
+  if (r == NULL) return;
+
+  int j = findCandidate(r, path, path_len);
+  if (j >= 0) r->paths[j].path_len = LINK_PATH_NONE;
+}
+
+bool LinkQualityTable::hasRoute(const uint8_t* pub_key) {
+  return findRoute(pub_key, 0, false) != NULL;
+}
+
+bool LinkQualityTable::isCandidate(const uint8_t* pub_key, const uint8_t* path, uint8_t path_len) {
+  Route* r = findRoute(pub_key, 0, false);
+  return r && findCandidate(r, path, path_len) >= 0;
+}
+
+int LinkQualityTable::scorePath(const uint8_t* pub_key, const uint8_t* path, uint8_t path_len, uint32_t now) {
+  uint8_t hash_size = (path_len >> 6) + 1;
+  uint8_t n = path_len & 63;
+  if (hash_size > LINK_MAX_HASH_SIZE) return NO_SCORE;
+
+  // links: us -> path[0] -> ... -> path[n-1] -> contact. Unmeasured links (typically the last one) are skipped
+  int weakest = 0x7FFF;
+  const uint8_t* prev = _self_hash;
+  for (int i = 0; i <= n; i++) {
+    const uint8_t* next = i < n ? &path[i * hash_size] : pub_key;
+    Link* l = findLink(prev, next, hash_size, now, false);
+    if (l && now - l->updated <= LINK_QUALITY_MAX_AGE_SECS && l->snr < weakest) weakest = l->snr;
+    prev = next;
+  }
+  if (weakest == 0x7FFF) weakest = LINK_UNKNOWN_SNR;   // nothing measured
+  return weakest - n * LINK_HOP_PENALTY;
+}
+
+bool LinkQualityTable::selectPath(const uint8_t* pub_key, uint8_t* path, uint8_t& path_len, uint32_t now, bool keep_current) {
+  Route* r = findRoute(pub_key, now, false);
+  int cur = (r && path_len != LINK_PATH_NONE) ? findCandidate(r, path, path_len) : -1;
+  if (keep_current && path_len != LINK_PATH_NONE && cur < 0) return false;   // not one of ours, leave it
+
+  int best = -1, best_score = NO_SCORE, cur_score = NO_SCORE;
+  if (r) {
+    for (int j = 0; j < LINK_QUALITY_PATHS_PER_ROUTE; j++) {
+      const Candidate& c = r->paths[j];
+      if (c.path_len == LINK_PATH_NONE) continue;
+
+      int score = scorePath(pub_key, c.path, c.path_len, now);
+      if (j == cur) cur_score = score;
+      if (best < 0 || score > best_score || (score == best_score && c.heard > r->paths[best].heard)) {
+        best = j;
+        best_score = score;
+      }
+    }
+  }
+  if (best < 0) {   // no candidates left
+    bool changed = path_len != LINK_PATH_NONE;
+    path_len = LINK_PATH_NONE;
+    return changed;
+  }
+  if (best == cur) return false;
+  if (keep_current && cur >= 0 && best_score < cur_score + LINK_SWITCH_MARGIN) return false;
+
+  path_len = mesh::Packet::copyPath(path, r->paths[best].path, r->paths[best].path_len);
+  r->last_used = now;
+  return true;
+}
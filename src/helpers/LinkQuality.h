@@ -0,0 +1,128 @@
+#pragma once
+
+#include <Packet.h>
+#include <string.h>
+
+#ifndef LINK_QUALITY_MAX_LINKS
+  #define LINK_QUALITY_MAX_LINKS     48    // hop-to-hop links we keep an SNR for
+#endif
+#ifndef LINK_QUALITY_MAX_ROUTES
+  #define LINK_QUALITY_MAX_ROUTES     8    // contacts we keep alternative out_paths for
+#endif
+#ifndef LINK_QUALITY_PATHS_PER_ROUTE
+  #define LINK_QUALITY_PATHS_PER_ROUTE  3
+#endif
+#ifndef LINK_QUALITY_MAX_AGE_SECS
+  #define LINK_QUALITY_MAX_AGE_SECS  (24*60*60)   // older link samples are treated as unknown
+#endif
+
+#define LINK_MAX_HASH_SIZE     3
+#define LINK_ROUTE_KEY_SIZE    6      // pub_key prefix
+#define LINK_PATH_NONE      0xFF      // same as OUT_PATH_UNKNOWN
+
+// all SNRs are in the units of Packet::_snr, ie. dB x 4
+#define LINK_UNKNOWN_SNR       0      // for a link we have not measured (and the score of a path with none measured)
+#define LINK_HOP_PENALTY       8      // 2 dB per hop, so shorter path wins when links are similar
+#define LINK_SWITCH_MARGIN     4      // 1 dB, hysteresis before replacing a path already in use
+
+/**
+ * \brief  Per-link SNR table, plus a few candidate out_paths per contact scored by the links they use.
+ *
+ *   Link SNRs come from the last hop of received flood packets (link from that repeater to us), and
+ *   from TRACE results (every link along the traced path). Links are undirected, keyed by the node hashes
+ *   at each end, and the hash size is part of the key (paths of different hash sizes are never mixed).
+ *
+ *   A path scores as its weakest measured link, less a penalty per hop. Unmeasured links don't count either way,
+ *   as the last link (to the contact) is rarely heard by us. A path that fails is dropped, and the
+ *   next best candidate (if any) is used instead of falling back to flood.
+ */
+class LinkQualityTable {
+  struct Link {
+    uint8_t a[LINK_MAX_HASH_SIZE], b[LINK_MAX_HASH_SIZE];
+    uint8_t hash_size;   // zero = unused
+    int16_t snr;         // smoothed
+    uint32_t updated;    // by our RTC clock
+  };
+  struct Candidate {
+    uint8_t path_len;    // encoded, as in Packet::path_len (LINK_PATH_NONE = unused)
+    uint32_t heard;
+    uint8_t path[MAX_PATH_SIZE];
+  };
+  struct Route {
+    uint8_t key[LINK_ROUTE_KEY_SIZE];
+    bool in_use;
+    uint32_t last_used;
+    Candidate paths[LINK_QUALITY_PATHS_PER_ROUTE];
+  };
+
+  Link _links[LINK_QUALITY_MAX_LINKS];
+  Route _routes[LINK_QUALITY_MAX_ROUTES];
+  const uint8_t* _self_hash;
+  bool _dirty;
+
+  Link* findLink(const uint8_t* a, const uint8_t* b, uint8_t hash_size, uint32_t now, bool create);
+  Route* findRoute(const uint8_t* pub_key, uint32_t now, bool create);
+  int findCandidate(const Route* r, const uint8_t* path, uint8_t path_len) const;
+  bool isTracked(const uint8_t* a, const uint8_t* b, uint8_t hash_size) const;
+
+public:
+  LinkQualityTable();
+
+  /**
+   * \param  pub_key  this node's public key (must remain valid, ie. LocalIdentity::pub_key)
+   */
+  void setSelf(const uint8_t* pub_key) { _self_hash = pub_key; }
+
+  /**
+   * \brief  records the SNR of the link between nodes 'a' and 'b'
+   */
+  void recordLink(const uint8_t* a, const uint8_t* b, uint8_t hash_size, int8_t snr, uint32_t now);
+  /**
+   * \returns  smoothed SNR of link, or LINK_UNKNOWN_SNR
+   */
+  int getLinkSNR(const uint8_t* a, const uint8_t* b, uint8_t hash_size, uint32_t now);
+  int getNumLinks() const;
+
+  /**
+   * \brief  records the link from the last repeater in a (flood) packet's path, to us
+   */
+  void onPacketRecv(const mesh::Packet* pkt, uint32_t now);
+
+  /**
+   * \brief  records every link of a completed TRACE (which we sent). Args as per Mesh::onTraceRecv()
+   * \param  final_snr  SNR we received the TRACE with (from the last hop)
+   */
+  void onTraceRecv(uint8_t flags, const uint8_t* path_snrs, const uint8_t* path_hashes, uint8_t path_len, int8_t final_snr, uint32_t now);
+
+  /**
+   * \brief  adds (or refreshes) a candidate out_path to the given contact
+   */
+  void addPath(const uint8_t* pub_key, const uint8_t* path, uint8_t path_len, uint32_t now);
+
+  /**
+   * \brief  drops the given path from the candidates (eg. a send on it failed)
+   */
+  void removePath(const uint8_t* pub_key, const uint8_t* path, uint8_t path_len);
+
+  bool hasRoute(const uint8_t* pub_key);
+  bool isCandidate(const uint8_t* pub_key, const uint8_t* path, uint8_t path_len);
+
+  /**
+   * \returns  score of given path to contact, higher is better
+   */
+  int scorePath(const uint8_t* pub_key, const uint8_t* path, uint8_t path_len, uint32_t now);
+
+  /**
+   * \brief  picks the best candidate out_path to contact (ties go to the most recently heard).
+   * \param  path, path_len  (IN/OUT) the path currently in use
+   * \param  keep_current  if true, a current path is only replaced by a candidate scoring better by
+   *          LINK_SWITCH_MARGIN, and is never replaced if it isn't a candidate (eg. was set by the user)
+   * \returns  true if path was changed. NOTE: is set to LINK_PATH_NONE if no candidates remain
+   */
+  bool selectPath(const uint8_t* pub_key, uint8_t* path, uint8_t& path_len, uint32_t now, bool keep_current);
+
+  /**
+   * \returns  true (once) if a link used by any candidate path has changed since last call, ie. time to re-run selectPath()
+   */
+  bool checkDirty() { bool d = _dirty; _dirty = false; return d; }
+};
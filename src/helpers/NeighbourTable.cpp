@@ -0,0 +1,169 @@
+#include "NeighbourTable.h"
+
+NeighbourTable::NeighbourTable(int max_entries) {
+  _max = max_entries;
+  _num_buckets = 1;
+  while (_num_buckets < _max && _num_buckets < 256) _num_buckets <<= 1;   // hashed by first byte, so no more than 256
+
+  _entries = new NeighbourInfo[_max];
+  _prev = new uint16_t[_max];
+  _next = new uint16_t[_max];
+  _hash_next = new uint16_t[_max];
+  _buckets = new uint16_t[_num_buckets];
+  _by_snr = new uint16_t[_max];
+  _snr_pos = new uint16_t[_max];
+  clear();
+}
+
+void NeighbourTable::clear() {
+  _num = 0;
+  _head = _tail = NONE;
+  for (int b = 0; b < _num_buckets; b++) _buckets[b] = NONE;
+  memset(_entries, 0, sizeof(NeighbourInfo) * _max);
+}
+
+void NeighbourTable::unlinkRecent(uint16_t i) {
+  if (_prev[i] != NONE) _next[_prev[i]] = _next[i]; else _head = _next[i];
+  if (_next[i] != NONE) _prev[_next[i]] = _prev[i]; else _tail = _prev[i];
+}
+
+void NeighbourTable::linkRecentHead(uint16_t i) {
+  _prev[i] = NONE;
+  _next[i] = _head;
+  if (_head != NONE) _prev[_head] = i; else _tail = i;
+  _head = i;
+}
+
+void NeighbourTable::unlinkHash(uint16_t i) {
+  uint16_t* p = &_buckets[bucketOf(_entries[i].pub_key)];
+  while (*p != NONE && *p != i) p = &_hash_next[*p];
+  if (*p == i) *p = _hash_next[i];
+}
+
+void NeighbourTable::swapSnr(int a, int b) {
+  uint16_t t = _by_snr[a];
+  _by_snr[a] = _by_snr[b];
+  _by_snr[b] = t;
+  _snr_pos[_by_snr[a]] = a;
+  _snr_pos[_by_snr[b]] = b;
+}
+
+void NeighbourTable::resortSnr(uint16_t i) {
+  // entry's SNR has changed, so move it up or down to its place (other entries are still in order)
+  int p = _snr_pos[i];
+  while (p > 0 && _entries[_by_snr[p - 1]].snr < _entries[i].snr) {
+    swapSnr(p - 1, p);
+    p--;
+  }
+  while (p + 1 < _num && _entries[_by_snr[p + 1]].snr > _entries[i].snr) {
+    swapSnr(p, p + 1);
+    p++;
+  }
+}
+
+void NeighbourTable::removeAt(uint16_t i) {
+  unlinkRecent(i);
+  unlinkHash(i);
+  for (int p = _snr_pos[i]; p + 1 < _num; p++) swapSnr(p, p + 1);   // move to end of SNR order
+
+  // move last entry into slot 'i', so entries stay packed
+  uint16_t last = _num - 1;
+  if (i != last) {
+    unlinkHash(last);
+    _entries[i] = _entries[last];
+    _prev[i] = _prev[last];
+    _next[i] = _next[last];
+    if (_prev[i] != NONE) _next[_prev[i]] = i; else _head = i;
+    if (_next[i] != NONE) _prev[_next[i]] = i; else _tail = i;
+
+    int b = bucketOf(_entries[i].pub_key);
+    _hash_next[i] = _buckets[b];
+    _buckets[b] = i;
+
+    _snr_pos[i] = _snr_pos[last];
+    _by_snr[_snr_pos[i]] = i;
+  }
+  memset(&_entries[last], 0, sizeof(NeighbourInfo));
+  _num--;
+}
+
+NeighbourInfo* NeighbourTable::put(const uint8_t* pub_key, uint32_t advert_timestamp, uint32_t now, int8_t snr_x4) {
+  if (_max == 0) return NULL;
+
+  NeighbourInfo* n = find(pub_key, PUB_KEY_SIZE);
+  uint16_t i;
+  if (n) {
+    i = n - _entries;
+    if (now - n->heard_timestamp < NEIGHBOUR_SNR_MAX_AGE_SECS) {
+      int avg = (3 * n->snr + snr_x4);   // moving average, 1/4 weight to new sample
+      n->snr = (int8_t)(avg >= 0 ? (avg + 2) / 4 : -((-avg + 2) / 4));
+    } else {
+      n->snr = snr_x4;
+    }
+    unlinkRecent(i);
+  } else {
+    if (_num >= _max) removeAt(_tail);   // replace least recently heard
+
+    i = _num++;
+    n = &_entries[i];
+    memcpy(n->pub_key, pub_key, PUB_KEY_SIZE);
+    n->snr = snr_x4;
+
+    int b = bucketOf(pub_key);
+    _hash_next[i] = _buckets[b];
+    _buckets[b] = i;
+
+    _by_snr[i] = i;   // at end, resortSnr() moves to place
+    _snr_pos[i] = i;
+  }
+  n->advert_timestamp = advert_timestamp;
+  n->heard_timestamp = now;
+  linkRecentHead(i);
+  resortSnr(i);
+  return n;
+}
+
+NeighbourInfo* NeighbourTable::find(const uint8_t* prefix, int prefix_len) const {
+  if (prefix_len <= 0 || _max == 0) return NULL;
+  for (uint16_t i = _buckets[bucketOf(prefix)]; i != NONE; i = _hash_next[i]) {
+    if (memcmp(_entries[i].pub_key, prefix, prefix_len) == 0) return &_entries[i];
+  }
+  return NULL;
+}
+
+int NeighbourTable::remove(const uint8_t* prefix, int prefix_len) {
+  int n = 0;
+  NeighbourInfo* e;
+  while ((e = find(prefix, prefix_len)) != NULL) {
+    removeAt(e - _entries);
+    n++;
+  }
+  return n;
+}
+
+int NeighbourTable::countHeardSince(uint32_t since) const {
+  int n = 0;
+  for (uint16_t i = _head; i != NONE && _entries[i].heard_timestamp >= since; i = _next[i]) n++;
+  return n;
+}
+
+int NeighbourTable::getOrdered(uint8_t order_by, int offset, const NeighbourInfo* dest[], int max_num) const {
+  int n = 0;
+  if (order_by == NEIGHBOUR_ORDER_NEWEST || order_by == NEIGHBOUR_ORDER_OLDEST) {
+    bool newest = order_by == NEIGHBOUR_ORDER_NEWEST;
+    uint16_t i = newest ? _head : _tail;
+    while (i != NONE && offset > 0) {
+      i = newest ? _next[i] : _prev[i];
+      offset--;
+    }
+    while (i != NONE && n < max_num) {
+      dest[n++] = &_entries[i];
+      i = newest ? _next[i] : _prev[i];
+    }
+  } else if (order_by == NEIGHBOUR_ORDER_STRONGEST) {
+    for (int p = offset; p < _num && n < max_num; p++) dest[n++] = &_entries[_by_snr[p]];
+  } else if (order_by == NEIGHBOUR_ORDER_WEAKEST) {
+    for (int p = _num - 1 - offset; p >= 0 && n < max_num; p--) dest[n++] = &_entries[_by_snr[p]];
+  }
+  return n;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <MeshCore.h>
+#include <string.h>
+
+#ifndef NEIGHBOUR_SNR_MAX_AGE_SECS
+  #define NEIGHBOUR_SNR_MAX_AGE_SECS   (60*60)   // older SNR than this is replaced, rather than averaged with new
+#endif
+
+#define NEIGHBOUR_ORDER_NEWEST     0
+#define NEIGHBOUR_ORDER_OLDEST     1
+#define NEIGHBOUR_ORDER_STRONGEST  2
+#define NEIGHBOUR_ORDER_WEAKEST    3
+
+struct NeighbourInfo {
+  uint8_t pub_key[PUB_KEY_SIZE];
+  uint32_t advert_timestamp;
+  uint32_t heard_timestamp;
+  int8_t snr; // multiplied by 4, user should divide to get float value
+};
+
+/**
+ * \brief  Table of zero-hop neighbours, which keeps itself ordered both by recency and by SNR as entries are put(),
+ *      so paged queries in either order need no sorting, and lookups by pub_key prefix are via a hash of the first byte.
+ *
+ *   When full, the least recently heard neighbour is replaced. SNR is a moving average over recent adverts, so one
+ *   lucky (or unlucky) packet doesn't re-order the table, but an SNR older than NEIGHBOUR_SNR_MAX_AGE_SECS is dropped.
+ */
+class NeighbourTable {
+  static const uint16_t NONE = 0xFFFF;
+
+  NeighbourInfo* _entries;
+  uint16_t* _prev;        // recency list (doubly-linked), head is most recent
+  uint16_t* _next;
+  uint16_t* _hash_next;   // chain of entries in same hash bucket
+  uint16_t* _buckets;
+  uint16_t* _by_snr;      // entry indexes, strongest first
+  uint16_t* _snr_pos;     // position of each entry in _by_snr
+  int _max, _num, _num_buckets;
+  uint16_t _head, _tail;
+
+  int bucketOf(const uint8_t* pub_key) const { return pub_key[0] & (_num_buckets - 1); }
+  void unlinkRecent(uint16_t i);
+  void linkRecentHead(uint16_t i);
+  void unlinkHash(uint16_t i);
+  void swapSnr(int a, int b);
+  void resortSnr(uint16_t i);
+  void removeAt(uint16_t i);
+
+public:
+  NeighbourTable(int max_entries);
+
+  void clear();
+  int getCount() const { return _num; }
+  int getMax() const { return _max; }
+
+  /**
+   * \brief  adds or updates neighbour, replacing least recently heard if table is full
+   * \param  snr_x4  SNR of advert, multiplied by 4
+   */
+  NeighbourInfo* put(const uint8_t* pub_key, uint32_t advert_timestamp, uint32_t now, int8_t snr_x4);
+
+  /**
+   * \returns  first neighbour whose pub_key starts with 'prefix' (at least 1 byte), or NULL
+   */
+  NeighbourInfo* find(const uint8_t* prefix, int prefix_len) const;
+
+  /**
+   * \brief  removes all neighbours matching 'prefix'
+   * \returns  number removed
+   */
+  int remove(const uint8_t* prefix, int prefix_len);
+
+  /**
+   * \returns  number of neighbours heard at, or after 'since'
+   */
+  int countHeardSince(uint32_t since) const;
+
+  /**
+   * \brief  a page of neighbours, in given order (NEIGHBOUR_ORDER_*)
+   * \returns  number put in 'dest'
+   */
+  int getOrdered(uint8_t order_by, int offset, const NeighbourInfo* dest[], int max_num) const;
+};
@@ -0,0 +1,152 @@
+#include "PacketLog.h"
+
+static File openRead(FILESYSTEM* fs, const char* fname) {
+#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+  return fs->open(fname, FILE_O_READ);
+#elif defined(RP2040_PLATFORM)
+  return fs->open(fname, "r");
+#else
+  return fs->open(fname, "r", false);
+#endif
+}
+
+static File openReadWrite(FILESYSTEM* fs, const char* fname) {
+#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+  return fs->open(fname, FILE_O_WRITE);
+#else
+  if (!fs->exists(fname)) {
+  #if defined(RP2040_PLATFORM)
+    File f = fs->open(fname, "w");
+  #else
+    File f = fs->open(fname, "w", true);
+  #endif
+    f.close();
+  }
+  return fs->open(fname, "r+");
+#endif
+}
+
+void PacketLog::reset() {
+  _page_start = 0;
+  _count = _flushed = 0;
+  _lap = false;
+  _dirty_since = 0;
+}
+
+void PacketLog::begin(FILESYSTEM* fs) {
+  _fs = fs;
+  reset();
+
+  File f = openRead(_fs, _fname);
+  if (!f) return;
+
+  uint32_t num = f.size() / sizeof(PacketLogRecord);
+  if (num > PACKET_LOG_MAX_RECORDS) num = PACKET_LOG_MAX_RECORDS;
+
+  // head is the first record from an older lap than record zero (or end of file)
+  uint32_t head = 0;
+  bool first_lap = false;
+  while (head < num) {
+    int n = f.read((uint8_t *)_page, sizeof(_page)) / sizeof(PacketLogRecord);
+    if (n <= 0) break;
+
+    int i = 0;
+    if (head == 0) first_lap = (_page[0].flags & PACKET_LOG_FLAG_LAP) != 0;
+    while (i < n && ((_page[i].flags & PACKET_LOG_FLAG_LAP) != 0) == first_lap) i++;
+    head += i;
+    if (i < n) break;
+  }
+  if (head > num) head = num;
+
+  _lap = first_lap;
+  if (head >= PACKET_LOG_MAX_RECORDS) {   // ring is full, and head is at the very end
+    head = 0;
+    _lap = !_lap;
+  }
+
+  // reload the partial page we're continuing
+  _page_start = head - (head % PACKET_LOG_PAGE_RECORDS);
+  _count = _flushed = head - _page_start;
+  if (_count > 0) {
+    f.seek(_page_start * sizeof(PacketLogRecord));
+    f.read((uint8_t *)_page, _count * sizeof(PacketLogRecord));
+  }
+  f.close();
+}
+
+void PacketLog::append(const PacketLogRecord& rec) {
+  if (_flushed == _count) _dirty_since = millis();
+
+  PacketLogRecord& r = _page[_count++];
+  r = rec;
+  r.flags &= ~PACKET_LOG_FLAG_LAP;
+  if (_lap) r.flags |= PACKET_LOG_FLAG_LAP;
+
+  if (_count >= PACKET_LOG_PAGE_RECORDS) {
+    flush();
+
+    _page_start += PACKET_LOG_PAGE_RECORDS;
+    if (_page_start >= PACKET_LOG_MAX_RECORDS) {   // wrap around, overwriting oldest
+      _page_start = 0;
+      _lap = !_lap;
+    }
+    _count = _flushed = 0;
+  }
+}
+
+void PacketLog::loop() {
+  if (_flushed < _count && millis() - _dirty_since >= PACKET_LOG_FLUSH_MILLIS) {
+    flush();
+  }
+}
+
+void PacketLog::flush() {
+  if (_fs == NULL || _flushed >= _count) return;
+
+  File f = openReadWrite(_fs, _fname);
+  if (f) {
+    f.seek((_page_start + _flushed) * sizeof(PacketLogRecord));
+    f.write((const uint8_t *)&_page[_flushed], (_count - _flushed) * sizeof(PacketLogRecord));
+    f.close();
+  }
+  _flushed = _count;   // don't retry forever if flash is failing
+}
+
+void PacketLog::erase() {
+  if (_fs) _fs->remove(_fname);
+  reset();
+}
+
+void PacketLog::dump(Print& out, const char* (*formatTime)(uint32_t timestamp)) {
+  flush();
+
+  File f = openRead(_fs, _fname);
+  if (!f) return;
+
+  uint32_t num = f.size() / sizeof(PacketLogRecord);
+  uint32_t head = _page_start + _count;
+  if (head > num) head = num;
+
+  char line[100];
+  PacketLogRecord buf[PACKET_LOG_PAGE_RECORDS];
+  for (int pass = 0; pass < 2; pass++) {   // oldest first: [head, end), then [0, head)
+    uint32_t i = pass == 0 ? head : 0;
+    uint32_t end = pass == 0 ? num : head;
+    f.seek(i * sizeof(PacketLogRecord));
+    while (i < end) {
+      uint32_t want = end - i;
+      if (want > PACKET_LOG_PAGE_RECORDS) want = PACKET_LOG_PAGE_RECORDS;
+      int n = f.read((uint8_t *)buf, want * sizeof(PacketLogRecord)) / sizeof(PacketLogRecord);
+      if (n <= 0) break;
+
+      for (int j = 0; j < n; j++) {
+        out.print(formatTime(buf[j].timestamp));
+        out.print(": ");
+        buf[j].format(line);
+        out.print(line);
+      }
+      i += n;
+    }
+  }
+  f.close();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Arduino.h>   // needed for PlatformIO
+#include <helpers/IdentityStore.h>
+#include <helpers/PacketLogRecord.h>
+
+#ifndef PACKET_LOG_MAX_RECORDS
+  #define PACKET_LOG_MAX_RECORDS   2048    // 32KB on flash, must be multiple of PACKET_LOG_PAGE_RECORDS
+#endif
+#ifndef PACKET_LOG_FLUSH_MILLIS
+  #define PACKET_LOG_FLUSH_MILLIS  60000   // max time a partial page stays in RAM
+#endif
+
+#define PACKET_LOG_PAGE_RECORDS    16      // 256 bytes, written in one go
+
+/**
+ * \brief  fixed-size circular packet log on flash. Records are staged in RAM and written a page at
+ *         a time, so logging costs one flash write per PACKET_LOG_PAGE_RECORDS packets.
+ */
+class PacketLog {
+  FILESYSTEM* _fs;
+  const char* _fname;
+  PacketLogRecord _page[PACKET_LOG_PAGE_RECORDS];
+  uint32_t _page_start;    // ring index of _page[0]
+  uint8_t _count, _flushed;
+  bool _lap;
+  unsigned long _dirty_since;
+
+  void reset();
+
+public:
+  PacketLog(const char* fname) : _fs(NULL), _fname(fname) { reset(); }
+
+  /**
+   * \brief  finds where the log left off, from the lap flags of stored records.
+   */
+  void begin(FILESYSTEM* fs);
+
+  void append(const PacketLogRecord& rec);
+
+  /**
+   * \brief  writes a partial page, if it has been held in RAM for too long.
+   */
+  void loop();
+  void flush();
+  void erase();
+
+  /**
+   * \brief  prints all records, oldest first, in the text log format.
+   * \param  formatTime  renders a record's timestamp as text
+   */
+  void dump(Print& out, const char* (*formatTime)(uint32_t timestamp));
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Packet.h>
+#include <stdio.h>
+
+#define PACKET_LOG_RX          0
+#define PACKET_LOG_TX          1
+#define PACKET_LOG_TX_FAIL     2
+
+#define PACKET_LOG_ACTION_MASK   0x0F
+#define PACKET_LOG_FLAG_HASHES   0x40   // src/dest hashes are valid
+#define PACKET_LOG_FLAG_LAP      0x80   // toggles each time the ring wraps (used to find the head on boot)
+
+/**
+ * \brief  one entry in the binary packet log. Fixed 16 bytes, stored as-is.
+ */
+struct PacketLogRecord {
+  uint32_t timestamp;    // RTC time
+  uint8_t  flags;        // action (low nibble) | PACKET_LOG_FLAG_*
+  uint8_t  header;       // Packet::header
+  uint16_t len;          // raw length, on air
+  uint8_t  payload_len;
+  int8_t   snr;
+  int16_t  rssi;
+  int16_t  score;        // x1000, RX only
+  uint8_t  src_hash, dest_hash;
+
+  uint8_t getAction() const { return flags & PACKET_LOG_ACTION_MASK; }
+
+  static PacketLogRecord fromPacket(uint32_t timestamp, uint8_t action, const mesh::Packet* pkt, int len,
+                                    float snr = 0, float rssi = 0, float score = 0) {
+    PacketLogRecord r;
+    r.timestamp = timestamp;
+    r.flags = action;
+    r.header = pkt->header;
+    r.len = len;
+    r.payload_len = pkt->payload_len;
+    r.snr = (int8_t) snr;
+    r.rssi = (int16_t) rssi;
+    r.score = (int16_t)(score * 1000);
+    uint8_t type = pkt->getPayloadType();
+    if (type == PAYLOAD_TYPE_PATH || type == PAYLOAD_TYPE_REQ || type == PAYLOAD_TYPE_RESPONSE || type == PAYLOAD_TYPE_TXT_MSG) {
+      r.flags |= PACKET_LOG_FLAG_HASHES;
+      r.dest_hash = pkt->payload[0];
+      r.src_hash = pkt->payload[1];
+    } else {
+      r.dest_hash = r.src_hash = 0;
+    }
+    return r;
+  }
+
+  /**
+   * \brief  renders this record in the original text log format (less the leading date/time), including newline.
+   * \returns  length of text in 'dest' (which should be at least 100 bytes)
+   */
+  int format(char* dest) const {
+    uint8_t type = (header >> PH_TYPE_SHIFT) & PH_TYPE_MASK;
+    uint8_t route = header & PH_ROUTE_MASK;
+    const char* route_str = (route == ROUTE_TYPE_DIRECT || route == ROUTE_TYPE_TRANSPORT_DIRECT) ? "D" : "F";
+
+    int n;
+    if (getAction() == PACKET_LOG_TX_FAIL) {
+      return sprintf(dest, "TX FAIL!, len=%d (type=%d, route=%s, payload_len=%d)\n", (int)len, (int)type, route_str, (int)payload_len);
+    } else if (getAction() == PACKET_LOG_RX) {
+      n = sprintf(dest, "RX, len=%d (type=%d, route=%s, payload_len=%d) SNR=%d RSSI=%d score=%d", (int)len, (int)type, route_str,
+                  (int)payload_len, (int)snr, (int)rssi, (int)score);
+    } else {
+      n = sprintf(dest, "TX, len=%d (type=%d, route=%s, payload_len=%d)", (int)len, (int)type, route_str, (int)payload_len);
+    }
+    if (flags & PACKET_LOG_FLAG_HASHES) {
+      n += sprintf(&dest[n], " [%02X -> %02X]\n", (uint32_t)src_hash, (uint32_t)dest_hash);
+    } else {
+      n += sprintf(&dest[n], "\n");
+    }
+    return n;
+  }
+};
+
+static_assert(sizeof(PacketLogRecord) == 16, "PacketLogRecord must be 16 bytes");
@@ -0,0 +1,180 @@
+#include "SeriesCodec.h"
+
+// payload widths for prefix '10', '110', '1110', '1111'
+static const uint8_t ts_widths[] = { 7, 9, 12, 32 };
+static const uint8_t val_widths[] = { 4, 8, 16, 32 };
+
+static bool fitsSigned(int32_t v, int bits) {
+  if (bits >= 32) return true;
+  int32_t lim = 1L << (bits - 1);
+  return v >= -lim && v < lim;
+}
+
+void SeriesEncoder::begin(uint8_t* buf, int max_len) {
+  _buf = buf;
+  _max_bits = max_len * 8;
+  _nbits = _count = 0;
+  _prev_ts = 0;
+  _prev_delta = _prev_val = 0;
+}
+
+bool SeriesEncoder::writeBits(uint32_t bits, int n) {
+  if (_nbits + n > _max_bits) return false;
+
+  while (n > 0) {
+    n--;
+    uint8_t mask = 0x80 >> (_nbits & 7);
+    if ((bits >> n) & 1) {
+      _buf[_nbits >> 3] |= mask;
+    } else {
+      _buf[_nbits >> 3] &= ~mask;
+    }
+    _nbits++;
+  }
+  return true;
+}
+
+bool SeriesEncoder::writeSigned(int32_t v, const uint8_t widths[]) {
+  if (v == 0) return writeBits(0, 1);
+
+  for (int i = 0; i < 4; i++) {
+    if (fitsSigned(v, widths[i])) {
+      int prefix_len = i < 3 ? i + 2 : 4;               // 10, 110, 1110, 1111
+      uint32_t prefix = ((1 << prefix_len) - 1) & ~(i < 3 ? 1 : 0);
+      uint32_t bits = widths[i] >= 32 ? (uint32_t) v : ((uint32_t) v & ((1UL << widths[i]) - 1));
+      return writeBits(prefix, prefix_len) && writeBits(bits, widths[i]);
+    }
+  }
+  return false;  // not reachable
+}
+
+bool SeriesEncoder::add(uint32_t timestamp, int32_t value) {
+  int save_bits = _nbits;
+  bool success;
+  int32_t delta = 0;
+  if (_count == 0) {
+    success = writeBits(timestamp, 32) && writeBits((uint32_t) value, 32);
+  } else {
+    delta = (int32_t)(timestamp - _prev_ts);
+    success = writeSigned(delta - _prev_delta, ts_widths) && writeSigned(value - _prev_val, val_widths);
+  }
+  if (!success) {
+    _nbits = save_bits;   // discard partial sample
+    return false;
+  }
+  _prev_delta = delta;
+  _prev_ts = timestamp;
+  _prev_val = value;
+  _count++;
+  return true;
+}
+
+void SeriesDecoder::begin(const uint8_t* buf, int len, int count) {
+  _buf = buf;
+  _max_bits = len * 8;
+  _pos = 0;
+  _remaining = count;
+  _prev_ts = 0;
+  _prev_delta = _prev_val = 0;
+  _first = true;
+}
+
+bool SeriesDecoder::readBits(uint32_t& bits, int n) {
+  if (_pos + n > _max_bits) return false;
+
+  bits = 0;
+  while (n > 0) {
+    n--;
+    bits = (bits << 1) | ((_buf[_pos >> 3] >> (7 - (_pos & 7))) & 1);
+    _pos++;
+  }
+  return true;
+}
+
+bool SeriesDecoder::readSigned(int32_t& v, const uint8_t widths[]) {
+  uint32_t bit;
+  int ones = 0;
+  while (ones < 4) {
+    if (!readBits(bit, 1)) return false;
+    if (bit == 0) break;
+    ones++;
+  }
+  if (ones == 0) {
+    v = 0;
+    return true;
+  }
+  int w = widths[ones - 1];
+  uint32_t bits;
+  if (!readBits(bits, w)) return false;
+  if (w < 32 && (bits & (1UL << (w - 1)))) bits |= ~((1UL << w) - 1);   // sign extend
+  v = (int32_t) bits;
+  return true;
+}
+
+bool SeriesDecoder::next(uint32_t& timestamp, int32_t& value) {
+  if (_remaining <= 0) return false;
+
+  if (_first) {
+    uint32_t ts, val;
+    if (!readBits(ts, 32) || !readBits(val, 32)) return false;
+    _prev_ts = ts;
+    _prev_val = (int32_t) val;
+    _first = false;
+  } else {
+    int32_t dod, dv;
+    if (!readSigned(dod, ts_widths) || !readSigned(dv, val_widths)) return false;
+    _prev_delta += dod;
+    _prev_ts += _prev_delta;
+    _prev_val += dv;
+  }
+  _remaining--;
+  timestamp = _prev_ts;
+  value = _prev_val;
+  return true;
+}
+
+CompressedSeries::CompressedSeries(int num_chunks) {
+  _num_chunks = num_chunks;
+  _chunks = new uint8_t[num_chunks * SERIES_CHUNK_SIZE];
+  memset(_chunks, 0, num_chunks * SERIES_CHUNK_SIZE);
+  clear();
+}
+
+uint32_t CompressedSeries::chunkStart(int i) const {
+  const uint8_t* c = chunkAt(i);
+  return ((uint32_t)c[2] << 24) | ((uint32_t)c[3] << 16) | ((uint32_t)c[4] << 8) | c[5];   // first timestamp, MSB first
+}
+
+void CompressedSeries::add(uint32_t timestamp, int32_t value) {
+  if (_used == 0 || !_enc.add(timestamp, value)) {   // start a new chunk
+    _head = (_head + 1) % _num_chunks;
+    if (_used < _num_chunks) _used++;    // otherwise, oldest is dropped
+
+    uint8_t* c = &_chunks[_head * SERIES_CHUNK_SIZE];
+    _enc.begin(&c[SERIES_CHUNK_HEADER], SERIES_CHUNK_SIZE - SERIES_CHUNK_HEADER);
+    _enc.add(timestamp, value);
+  }
+  uint8_t* c = &_chunks[_head * SERIES_CHUNK_SIZE];
+  c[0] = _enc.getCount();
+  c[1] = _enc.getLength();
+}
+
+int CompressedSeries::exportSince(uint32_t since, uint8_t* dest, int max_len) const {
+  // work back from newest chunk, to the one that 'since' is in
+  int first = _used, len = 0;
+  while (first > 0) {
+    int sz = SERIES_CHUNK_HEADER + chunkAt(first - 1)[1];
+    if (len + sz > max_len) break;
+    len += sz;
+    first--;
+    if (chunkStart(first) <= since) break;   // has all samples from 'since'
+  }
+
+  int ofs = 0;
+  for (int i = first; i < _used; i++) {
+    int sz = SERIES_CHUNK_HEADER + chunkAt(i)[1];
+    memcpy(&dest[ofs], chunkAt(i), sz);
+    ofs += sz;
+  }
+  return ofs;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef SERIES_CHUNK_SIZE
+  #define SERIES_CHUNK_SIZE      64    // bytes per chunk, including header
+#endif
+
+#define SERIES_CHUNK_HEADER       2    // [0] sample count, [1] length of encoded data
+
+/*
+  Encoded samples (bit stream, MSB first):
+    first sample:  timestamp (32 bits), value (32 bits)
+    next samples:  timestamp as delta-of-delta, then value as delta, both as a variable length signed int:
+                     timestamp:  '0' = 0,  '10' + 7 bits,  '110' + 9 bits,  '1110' + 12 bits,  '1111' + 32 bits
+                     value:      '0' = 0,  '10' + 4 bits,  '110' + 8 bits,  '1110' + 16 bits,  '1111' + 32 bits
+  Values are integers, ie. a reading quantised to the resolution of its LPP type (eg. voltage x 100).
+  So, samples at a fixed interval cost 1 bit for the timestamp, and a slowly changing reading a few bits.
+*/
+
+/**
+ * \brief  Appends (timestamp, value) samples to a fixed size buffer, as a compressed bit stream.
+ */
+class SeriesEncoder {
+  uint8_t* _buf;
+  int _max_bits, _nbits, _count;
+  uint32_t _prev_ts;
+  int32_t _prev_delta, _prev_val;
+
+  bool writeBits(uint32_t bits, int n);
+  bool writeSigned(int32_t v, const uint8_t widths[]);
+
+public:
+  SeriesEncoder() { begin(NULL, 0); }
+
+  void begin(uint8_t* buf, int max_len);
+
+  /**
+   * \returns  false if sample doesn't fit (buffer is unchanged)
+   */
+  bool add(uint32_t timestamp, int32_t value);
+
+  int getLength() const { return (_nbits + 7) / 8; }
+  int getCount() const { return _count; }
+};
+
+class SeriesDecoder {
+  const uint8_t* _buf;
+  int _max_bits, _pos, _remaining;
+  uint32_t _prev_ts;
+  int32_t _prev_delta, _prev_val;
+  bool _first;
+
+  bool readBits(uint32_t& bits, int n);
+  bool readSigned(int32_t& v, const uint8_t widths[]);
+
+public:
+  /**
+   * \param  count  number of samples encoded in buf
+   */
+  void begin(const uint8_t* buf, int len, int count);
+
+  /**
+   * \returns  false if no more samples (or data is truncated)
+   */
+  bool next(uint32_t& timestamp, int32_t& value);
+};
+
+/**
+ * \brief  Ring of fixed size chunks of encoded samples, for on-device history. Each chunk starts with a full
+ *     timestamp and value (so can be decoded on its own), and the oldest chunk is dropped when all are full.
+ *     Chunks are exported as-is, ie. [count][len][encoded data], so a bulk history reply needs no re-encoding.
+ */
+class CompressedSeries {
+  uint8_t* _chunks;
+  int _num_chunks, _head, _used;
+  SeriesEncoder _enc;     // appends to head chunk
+
+  uint8_t* chunkAt(int i) const { return &_chunks[((_head + 1 - _used + _num_chunks + i) % _num_chunks) * SERIES_CHUNK_SIZE]; }
+  uint32_t chunkStart(int i) const;
+
+public:
+  CompressedSeries(int num_chunks);
+
+  void add(uint32_t timestamp, int32_t value);
+  void clear() { _used = 0; _head = _num_chunks - 1; }
+
+  int getNumChunks() const { return _used; }    // ones with data
+
+  /**
+   * \param  i  0 is the oldest chunk
+   */
+  const uint8_t* getChunk(int i) const { return chunkAt(i); }
+
+  /**
+   * \brief  copies the chunks which have samples at or after 'since', or as many of the newest of them that fit
+   * \returns  number of bytes written to dest
+   */
+  int exportSince(uint32_t since, uint8_t* dest, int max_len) const;
+};
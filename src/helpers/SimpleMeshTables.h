@@ -69,6 +69,11 @@ public:
     }
   }
 
+  void registerMetrics(mesh::MetricsRegistry& metrics) override {
+    metrics.addCounter(METRIC_ID_DUPS_FLOOD, "dups_flood", &_flood_dups);
+    metrics.addCounter(METRIC_ID_DUPS_DIRECT, "dups_direct", &_direct_dups);
+  }
+
   uint32_t getNumDirectDups() const { return _direct_dups; }
   uint32_t getNumFloodDups() const { return _flood_dups; }
 
@@ -19,11 +19,12 @@ int PacketQueue::countBefore(uint32_t now) const {
   return n;
 }
 
-mesh::Packet* PacketQueue::get(uint32_t now) {
+mesh::Packet* PacketQueue::get(uint32_t now, int max_raw_len) {
   uint8_t min_pri = 0xFF;
   int best_idx = -1;
   for (int j = 0; j < _num; j++) {
     if ((int32_t)(_schedule_table[j] - now) > 0) continue;   // scheduled for future... ignore for now
+    if (max_raw_len < MAX_TRANS_UNIT && _table[j]->getRawLength() > max_raw_len) continue;   // too long for now
     if (_pri_table[j] < min_pri) {  // select most important priority amongst non-future entries
       min_pri = _pri_table[j];
       best_idx = j;
@@ -95,6 +96,10 @@ mesh::Packet* StaticPoolPacketManager::getNextOutbound(uint32_t now) {
   return send_queue.get(now);
 }
 
+mesh::Packet* StaticPoolPacketManager::getNextOutbound(uint32_t now, int max_raw_len) {
+  return send_queue.get(now, max_raw_len);
+}
+
 int  StaticPoolPacketManager::getOutboundCount(uint32_t now) const {
   return send_queue.countBefore(now);
 }
@@ -123,3 +128,11 @@ void StaticPoolPacketManager::queueInbound(mesh::Packet* packet, uint32_t schedu
 mesh::Packet* StaticPoolPacketManager::getNextInbound(uint32_t now) {
   return rx_queue.get(now);
 }
+
+int StaticPoolPacketManager::getInboundTotal() const {
+  return rx_queue.count();
+}
+
+mesh::Packet* StaticPoolPacketManager::getInboundByIdx(int i) {
+  return rx_queue.itemAt(i);
+}
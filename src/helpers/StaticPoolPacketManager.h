@@ -10,7 +10,7 @@ class PacketQueue {
 
 public:
   PacketQueue(int max_entries);
-  mesh::Packet* get(uint32_t now);
+  mesh::Packet* get(uint32_t now, int max_raw_len=MAX_TRANS_UNIT);
   bool add(mesh::Packet* packet, uint8_t priority, uint32_t scheduled_for);
   int count() const { return _num; }
   int countBefore(uint32_t now) const;
@@ -28,6 +28,7 @@ public:
   void free(mesh::Packet* packet) override;
   void queueOutbound(mesh::Packet* packet, uint8_t priority, uint32_t scheduled_for) override;
   mesh::Packet* getNextOutbound(uint32_t now) override;
+  mesh::Packet* getNextOutbound(uint32_t now, int max_raw_len) override;
   int getOutboundCount(uint32_t now) const override;
   int getOutboundTotal() const override;
   int getFreeCount() const override;
@@ -35,4 +36,6 @@ public:
   mesh::Packet* removeOutboundByIdx(int i) override;
   void queueInbound(mesh::Packet* packet, uint32_t scheduled_for) override;
   mesh::Packet* getNextInbound(uint32_t now) override;
+  int getInboundTotal() const override;
+  mesh::Packet* getInboundByIdx(int i) override;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Mesh.h"
+#include <helpers/ChannelMonitor.h>
 
 class StatsFormatHelper {
 public:
@@ -9,6 +10,17 @@ public:
                              mesh::MillisecondClock& ms, 
                              uint16_t err_flags,
                              mesh::PacketManager* mgr) {
+#ifdef USE_PUBKEY_POINT_CACHE
+    sprintf(reply, 
+      "{\"battery_mv\":%u,\"uptime_secs\":%u,\"errors\":%u,\"queue_len\":%u,\"key_cache_hits\":%u,\"key_cache_misses\":%u}",
+      board.getBattMilliVolts(),
+      ms.getMillis() / 1000,
+      err_flags,
+      mgr->getOutboundTotal(),
+      mesh::Identity::getPointCache().getHits(),
+      mesh::Identity::getPointCache().getMisses()
+    );
+#else
     sprintf(reply, 
       "{\"battery_mv\":%u,\"uptime_secs\":%u,\"errors\":%u,\"queue_len\":%u}",
       board.getBattMilliVolts(),
@@ -16,6 +28,7 @@ public:
       err_flags,
       mgr->getOutboundTotal()
     );
+#endif
   }
 
   template<typename RadioDriverType>
@@ -34,6 +47,39 @@ public:
     );
   }
 
+  /**
+   * \brief  channel utilisation over the last minute, hour and day. busy/rx/tx are per-mille of time,
+   *          noise is the median noise floor (dBm)
+   */
+  template<typename RadioDriverType>
+  static void formatChannelStats(char* reply, RadioDriverType& driver) {
+    const ChannelMonitor& ch = driver.getChannelMonitor();
+    sprintf(reply,
+      "{\"busy\":[%u,%u,%u],\"rx\":[%u,%u,%u],\"tx\":[%u,%u,%u],\"noise\":[%d,%d,%d]}",
+      ch.getBusyPermille(CHANNEL_WINDOW_MINUTE), ch.getBusyPermille(CHANNEL_WINDOW_HOUR), ch.getBusyPermille(CHANNEL_WINDOW_DAY),
+      ch.getRecvPermille(CHANNEL_WINDOW_MINUTE), ch.getRecvPermille(CHANNEL_WINDOW_HOUR), ch.getRecvPermille(CHANNEL_WINDOW_DAY),
+      ch.getSentPermille(CHANNEL_WINDOW_MINUTE), ch.getSentPermille(CHANNEL_WINDOW_HOUR), ch.getSentPermille(CHANNEL_WINDOW_DAY),
+      ch.getNoisePercentile(CHANNEL_WINDOW_MINUTE, 50), ch.getNoisePercentile(CHANNEL_WINDOW_HOUR, 50), ch.getNoisePercentile(CHANNEL_WINDOW_DAY, 50)
+    );
+  }
+
+  /**
+   * \brief  TX airtime used (millis) over the last duty-cycle window, per sub-band. 'band' is the one in use,
+   *          and 'bands' is [band, used, limit] for each sub-band airtime is held for
+   */
+  static void formatDutyCycleStats(char* reply, mesh::Dispatcher& dispatcher) {
+    mesh::DutyCycleTracker& duty = dispatcher.getDutyCycleTracker();
+    sprintf(reply, "{\"window_secs\":%u,\"band\":%u,\"bands\":[", duty.getWindowMillis() / 1000, (uint32_t) dispatcher.getCurrentDutyCycleBand());
+    bool first = true;
+    for (int i = 0; i < DUTY_CYCLE_MAX_BANDS; i++) {
+      if (!duty.isSlotInUse(i)) continue;
+      uint8_t band = duty.getSlotBand(i);
+      sprintf(&reply[strlen(reply)], "%s[%u,%u,%u]", first ? "" : ",", (uint32_t) band, duty.getSlotUsed(i), dispatcher.getDutyCycleLimit(band));
+      first = false;
+    }
+    strcat(reply, "]}");
+  }
+
   template<typename RadioDriverType>
   static void formatPacketStats(char* reply,
                                RadioDriverType& driver,
@@ -52,4 +98,35 @@ public:
       driver.getPacketsRecvErrors()
     );
   }
+
+  /**
+   * \brief  a page of the metrics registry, from index 'start'. Histograms are [count,p50,p90,max].
+   *          If not all fit, "next" is the index to ask for next.
+   */
+  static void formatMetrics(char* reply, const mesh::MetricsRegistry& metrics, int start) {
+    char* dp = reply;
+    *dp++ = '{';
+    int i;
+    for (i = start < 0 ? 0 : start; i < metrics.getCount(); i++) {
+      char item[64];
+      const mesh::MetricHistogram* h = metrics.getHistogram(i);
+      if (h) {
+        snprintf(item, sizeof(item), "\"%s\":[%u,%u,%u,%u]", metrics.getName(i),
+          h->getCount(), h->getPercentile(50), h->getPercentile(90), h->getMax());
+      } else if (metrics.getType(i) == METRIC_TYPE_GAUGE) {
+        snprintf(item, sizeof(item), "\"%s\":%d", metrics.getName(i), (int) metrics.getValue(i));
+      } else {
+        snprintf(item, sizeof(item), "\"%s\":%u", metrics.getName(i), (uint32_t) metrics.getValue(i));
+      }
+      if ((dp - reply) + strlen(item) + 12 > 150) break;   // leave room for "next"
+      if (dp > reply + 1) *dp++ = ',';
+      strcpy(dp, item);
+      dp += strlen(item);
+    }
+    if (i < metrics.getCount()) {
+      sprintf(dp, "%s\"next\":%d}", dp > reply + 1 ? "," : "", i);
+    } else {
+      strcpy(dp, "}");
+    }
+  }
 };
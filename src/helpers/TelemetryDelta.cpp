@@ -0,0 +1,168 @@
+#include "TelemetryDelta.h"
+
+static uint32_t getRaw(const uint8_t* raw, uint8_t size) {
+  uint32_t v = 0;
+  for (int i = 0; i < size; i++) v = (v << 8) | raw[i];
+  return v;
+}
+
+static void putRaw(uint8_t* raw, uint8_t size, uint32_t v) {
+  for (int i = size - 1; i >= 0; i--) {
+    raw[i] = v & 0xFF;
+    v >>= 8;
+  }
+}
+
+static uint32_t sizeMask(uint8_t size) {
+  return size >= 4 ? 0xFFFFFFFF : (1UL << (size * 8)) - 1;
+}
+
+// difference, modulo the value's size, as a signed int (so works for both signed and unsigned LPP types)
+static int32_t calcDelta(uint32_t from, uint32_t to, uint8_t size) {
+  uint32_t mask = sizeMask(size);
+  uint32_t d = (to - from) & mask;
+  if (d & ~(mask >> 1)) d |= ~mask;   // sign extend
+  return (int32_t) d;
+}
+
+static int putVarint(uint8_t* dest, uint32_t v) {
+  int n = 0;
+  while (v >= 0x80) {
+    dest[n++] = (v & 0x7F) | 0x80;
+    v >>= 7;
+  }
+  dest[n++] = v;
+  return n;
+}
+
+static int getVarint(const uint8_t* src, int len, uint32_t& v) {
+  v = 0;
+  for (int n = 0; n < len && n < 5; n++) {
+    v |= (uint32_t)(src[n] & 0x7F) << (7 * n);
+    if ((src[n] & 0x80) == 0) return n + 1;
+  }
+  return -1;  // truncated
+}
+
+int TelemetryDelta::find(uint8_t channel, uint8_t lpp_type) const {
+  for (int i = 0; i < _num; i++) {
+    if (_values[i].channel == channel && _values[i].lpp_type == lpp_type) return i;
+  }
+  return -1;
+}
+
+void TelemetryDelta::store(uint8_t channel, uint8_t lpp_type, const uint8_t* raw, uint8_t size) {
+  if (size > TELEM_DELTA_MAX_RAW) return;   // not tracked, always sent in full
+
+  int i = find(channel, lpp_type);
+  if (i < 0) {
+    if (_num >= TELEM_DELTA_MAX_VALUES) return;   // table full, value just sent in full each time
+    i = _num++;
+    _values[i].channel = channel;
+    _values[i].lpp_type = lpp_type;
+  }
+  _values[i].size = size;
+  memcpy(_values[i].raw, raw, size);
+}
+
+int TelemetryDelta::encode(const uint8_t* lpp, int lpp_len, uint8_t* dest, int max_len, uint32_t min_delta, bool full, SizeFunc size_of) {
+  if (max_len < 2) return 0;
+  if (full) _num = 0;
+
+  int ofs = 2, num_deltas = 0;
+
+  // first pass: deltas of the known scalar values
+  for (int i = 0; i + 2 <= lpp_len; ) {
+    uint8_t ch = lpp[i], type = lpp[i + 1];
+    uint8_t sz = size_of(type);
+    if (i + 2 + sz > lpp_len) break;
+    const uint8_t* raw = &lpp[i + 2];
+    i += 2 + sz;
+
+    int idx = find(ch, type);
+    if (idx < 0 || sz > TELEM_DELTA_MAX_SCALAR || _values[idx].size != sz) continue;
+
+    Entry& e = _values[idx];
+    int32_t d = calcDelta(getRaw(e.raw, sz), getRaw(raw, sz), sz);
+    uint32_t mag = d < 0 ? -(uint32_t)d : (uint32_t)d;
+    if (mag == 0 || mag < min_delta) continue;   // not changed enough
+
+    uint8_t tmp[5];
+    int n = putVarint(tmp, ((uint32_t)d << 1) ^ (uint32_t)(d >> 31));   // zig-zag
+    if (ofs + 1 + n > max_len || num_deltas >= 255) continue;   // no room, leave for next time
+
+    dest[ofs++] = idx;
+    memcpy(&dest[ofs], tmp, n); ofs += n;
+    num_deltas++;
+    memcpy(e.raw, raw, sz);
+  }
+
+  // second pass: new values, and changed non-scalar values, in full
+  int num_full = 0;
+  for (int i = 0; i + 2 <= lpp_len; ) {
+    uint8_t ch = lpp[i], type = lpp[i + 1];
+    uint8_t sz = size_of(type);
+    if (i + 2 + sz > lpp_len) break;
+    const uint8_t* rec = &lpp[i];
+    i += 2 + sz;
+
+    int idx = find(ch, type);
+    if (idx >= 0 && _values[idx].size == sz) {
+      if (sz <= TELEM_DELTA_MAX_SCALAR) continue;   // done in first pass
+      if (memcmp(_values[idx].raw, &rec[2], sz) == 0) continue;   // unchanged
+    }
+    if (ofs + 2 + sz > max_len) continue;   // no room, leave for next time
+
+    memcpy(&dest[ofs], rec, 2 + sz); ofs += 2 + sz;
+    num_full++;
+    store(ch, type, &rec[2], sz);
+  }
+
+  if (num_deltas == 0 && num_full == 0 && !full) return 0;   // nothing to send
+
+  dest[0] = full ? TELEM_DELTA_FLAG_FULL : 0;
+  dest[1] = num_deltas;
+  return ofs;
+}
+
+int TelemetryDelta::decode(const uint8_t* src, int len, uint8_t* lpp_dest, int max_len, SizeFunc size_of) {
+  if (len < 2) return -1;
+  if (src[0] & TELEM_DELTA_FLAG_FULL) {
+    _num = 0;
+    _need_full = false;
+  } else if (_need_full) {
+    return -1;   // deltas are against values we never got
+  }
+
+  int num_deltas = src[1];
+  int i = 2, ofs = 0;
+  while (num_deltas-- > 0) {
+    if (i >= len) return -1;
+    int idx = src[i++];
+    if (idx >= _num || _values[idx].size > TELEM_DELTA_MAX_SCALAR) return -1;
+
+    uint32_t zz;
+    int n = getVarint(&src[i], len - i, zz);
+    if (n < 0) return -1;
+    i += n;
+
+    Entry& e = _values[idx];
+    int32_t d = (int32_t)(zz >> 1) ^ -(int32_t)(zz & 1);
+    putRaw(e.raw, e.size, (getRaw(e.raw, e.size) + d) & sizeMask(e.size));
+
+    if (ofs + 2 + e.size > max_len) return -1;
+    lpp_dest[ofs++] = e.channel;
+    lpp_dest[ofs++] = e.lpp_type;
+    memcpy(&lpp_dest[ofs], e.raw, e.size); ofs += e.size;
+  }
+
+  while (i + 2 <= len) {
+    uint8_t sz = size_of(src[i + 1]);
+    if (i + 2 + sz > len || ofs + 2 + sz > max_len) return -1;
+
+    store(src[i], src[i + 1], &src[i + 2], sz);
+    memcpy(&lpp_dest[ofs], &src[i], 2 + sz); ofs += 2 + sz;
+    i += 2 + sz;
+  }
+  return i == len ? ofs : -1;
+}
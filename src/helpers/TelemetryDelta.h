@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef TELEM_DELTA_MAX_VALUES
+  #define TELEM_DELTA_MAX_VALUES   16    // (channel, type) values tracked per subscriber
+#endif
+
+#define TELEM_DELTA_MAX_RAW         9    // largest LPP value (GPS)
+#define TELEM_DELTA_MAX_SCALAR      4    // values up to this size are sent as deltas, larger ones in full when changed
+
+#define TELEM_DELTA_FLAG_FULL    0x01    // all values in full, receiver should reset its state
+
+/**
+ * \brief  Encodes a CayenneLPP buffer as just the values which have changed since the last one sent, with
+ *      (scalar) values as a delta from the last sent. Both ends keep the same table of last values, in the order
+ *      first sent, so a delta is just the table index and a (zig-zag varint) delta of the raw LPP integer.
+ *
+ *   Encoded:  [flags][num deltas][deltas: (index, varint)...][full LPP records...]
+ */
+class TelemetryDelta {
+public:
+  typedef uint8_t (*SizeFunc)(uint8_t lpp_type);   // size of LPP value
+
+private:
+  struct Entry {
+    uint8_t channel;
+    uint8_t lpp_type;
+    uint8_t size;
+    uint8_t raw[TELEM_DELTA_MAX_RAW];
+  };
+  Entry _values[TELEM_DELTA_MAX_VALUES];
+  int _num;
+  bool _need_full;   // receiver missed a push, so its values are stale
+
+  int find(uint8_t channel, uint8_t lpp_type) const;
+  void store(uint8_t channel, uint8_t lpp_type, const uint8_t* raw, uint8_t size);
+
+public:
+  TelemetryDelta() : _num(0), _need_full(false) { }
+
+  void reset() { _num = 0; _need_full = false; }
+  int getCount() const { return _num; }
+
+  /**
+   * \brief  encodes values from 'lpp' which have changed (scalars by at least 'min_delta' raw steps) since last encode()
+   * \param  full  send all values in full (eg. periodically, in case receiver has missed some)
+   * \returns  encoded length, or zero if nothing has changed
+   */
+  int encode(const uint8_t* lpp, int lpp_len, uint8_t* dest, int max_len, uint32_t min_delta, bool full, SizeFunc size_of);
+
+  /**
+   * \brief  receiver end, call when a push was missed (gap in seq). The encoder has already moved on, so deltas
+   *      can't be applied to the values here, and decode() rejects everything until the next full push.
+   */
+  void markGap() { _need_full = true; }
+  bool isWaitingForFull() const { return _need_full; }
+
+  /**
+   * \brief  receiver end, reconstructs the changed values as a CayenneLPP buffer
+   * \returns  length of LPP output, or -1 if malformed (eg. deltas without the full values before them), or
+   *      waiting for a full push (after markGap())
+   */
+  int decode(const uint8_t* src, int len, uint8_t* lpp_dest, int max_len, SizeFunc size_of);
+};
@@ -0,0 +1,196 @@
+#include "BridgeCipher.h"
+
+#include <SHA256.h>
+#include <Utils.h>
+#include <string.h>
+
+static void putU32(uint8_t *dest, uint32_t v) {
+  dest[0] = v >> 24;  dest[1] = v >> 16;  dest[2] = v >> 8;  dest[3] = v;
+}
+
+static uint32_t getU32(const uint8_t *src) {
+  return ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | src[3];
+}
+
+BridgeCipher::BridgeCipher() : _sender_id(0), _counter(0), _challenge(0), _challenge_gen(0), _use_clock(0),
+                               n_auth_fail(0), n_replays(0), n_unsynced(0) {
+  resetPeers();
+  _secret[0] = 1;   // force key derivation on first setSecret()
+  _secret[1] = 0;
+}
+
+void BridgeCipher::resetPeers() {
+  memset(_windows, 0, sizeof(_windows));
+  _echo_pref = -1;
+  _echo_next = 0;
+  _hello_due = false;
+}
+
+void BridgeCipher::setSecret(const char *secret) {
+  if (strncmp(_secret, secret, sizeof(_secret) - 1) == 0) return;   // unchanged
+
+  strncpy(_secret, secret, sizeof(_secret) - 1);
+  _secret[sizeof(_secret) - 1] = 0;
+
+  // separate keys for encryption and MAC, derived from the shared secret
+  uint8_t hash[32];
+  mesh::Utils::sha256(hash, sizeof(hash), (const uint8_t *)"bridge-enc", 10, (const uint8_t *)_secret, strlen(_secret));
+  _aes.setKey(hash, 16);
+  mesh::Utils::sha256(_mac_key, sizeof(_mac_key), (const uint8_t *)"bridge-mac", 10, (const uint8_t *)_secret, strlen(_secret));
+
+  resetPeers();   // counters from old key are meaningless
+}
+
+void BridgeCipher::setSenderId(uint32_t id) {
+  _sender_id = id;
+  _counter = 0;
+  _challenge_gen = 0;
+  _challenge = id;
+}
+
+void BridgeCipher::newChallenge() {
+  // only needs to differ from any challenge we've used before (this boot, or earlier ones with other sender IDs)
+  _challenge = _sender_id ^ (++_challenge_gen * 0x9E3779B9);
+}
+
+void BridgeCipher::crypt(uint8_t *frame, size_t aad_len, size_t payload_len, bool encrypting, uint8_t *tag) {
+  SHA256 sha;
+  sha.resetHMAC(_mac_key, sizeof(_mac_key));
+  sha.update(frame, aad_len + HEADER_SIZE);
+
+  uint8_t ctr[16], ks[16];
+  memcpy(ctr, &frame[aad_len], NONCE_SIZE);   // nonce = sender ID + counter
+  memset(&ctr[NONCE_SIZE], 0, sizeof(ctr) - NONCE_SIZE);
+
+  uint8_t *p = &frame[aad_len + HEADER_SIZE];
+  size_t remaining = payload_len;
+  while (remaining > 0) {
+    size_t n = remaining < 16 ? remaining : 16;
+    _aes.encryptBlock(ks, ctr);
+    if (!encrypting) sha.update(p, n);   // MAC is always over ciphertext
+    for (size_t i = 0; i < n; i++) p[i] ^= ks[i];
+    if (encrypting) sha.update(p, n);
+
+    p += n;
+    remaining -= n;
+    ctr[15]++;   // max 16 blocks per packet, so low byte never wraps
+  }
+  sha.finalizeHMAC(_mac_key, sizeof(_mac_key), tag, TAG_SIZE);
+}
+
+uint32_t BridgeCipher::nextEcho() {
+  if (_echo_pref >= 0 && _windows[_echo_pref].last_use != 0) {   // peer which is waiting on us
+    uint32_t c = _windows[_echo_pref].challenge;
+    _echo_pref = -1;
+    return c;
+  }
+  _echo_pref = -1;
+  for (int i = 0; i < BRIDGE_CIPHER_MAX_SENDERS; i++) {   // else take turns
+    ReplayWindow *w = &_windows[_echo_next];
+    _echo_next = (_echo_next + 1) % BRIDGE_CIPHER_MAX_SENDERS;
+    if (w->last_use != 0) return w->challenge;
+  }
+  return 0;
+}
+
+size_t BridgeCipher::seal(uint8_t *frame, size_t aad_len, size_t payload_len) {
+  putU32(&frame[aad_len], _sender_id);
+  putU32(&frame[aad_len + 4], ++_counter);
+  putU32(&frame[aad_len + 8], _challenge);
+  putU32(&frame[aad_len + 12], nextEcho());
+  crypt(frame, aad_len, payload_len, true, &frame[aad_len + HEADER_SIZE + payload_len]);
+  return aad_len + OVERHEAD + payload_len;
+}
+
+int BridgeCipher::open(uint8_t *frame, size_t aad_len, size_t len) {
+  if (len < aad_len + OVERHEAD) return -1;
+  size_t payload_len = len - aad_len - OVERHEAD;
+
+  uint32_t sender_id = getU32(&frame[aad_len]);
+  uint32_t counter = getU32(&frame[aad_len + 4]);
+  if (sender_id == _sender_id) return -1;   // our own broadcast, echoed back
+
+  ReplayWindow *w = findWindow(sender_id);
+  if (w && w->synced && isReplay(w, counter)) {   // cheap reject, before doing any crypto
+    n_replays++;
+    return -1;
+  }
+
+  uint8_t tag[TAG_SIZE];
+  crypt(frame, aad_len, payload_len, false, tag);
+
+  uint8_t diff = 0;   // constant time compare
+  const uint8_t *rcv_tag = &frame[aad_len + HEADER_SIZE + payload_len];
+  for (size_t i = 0; i < TAG_SIZE; i++) diff |= tag[i] ^ rcv_tag[i];
+  if (diff != 0) {
+    n_auth_fail++;
+    return -1;
+  }
+
+  // only once authenticated
+  bool fresh = getU32(&frame[aad_len + 12]) == _challenge;   // made since our current challenge
+  if (w == NULL && (w = addWindow(sender_id, fresh)) == NULL) {
+    n_unsynced++;   // table is full of synced peers, so don't track stale sender
+    _hello_due = true;   // but if it is genuine, it can learn our challenge
+    return -1;
+  }
+  w->challenge = getU32(&frame[aad_len + 8]);
+  w->last_use = ++_use_clock;
+  if (payload_len == 0) _echo_pref = w - _windows;   // a hello, so echo them next
+
+  if (!w->synced) {
+    if (!fresh) {   // could be replayed from an earlier session, so start no window from it
+      n_unsynced++;
+      _echo_pref = w - _windows;
+      _hello_due = true;   // tell them our challenge
+      return -1;
+    }
+    w->synced = true;
+    w->top = counter;
+    w->mask = 0xFFFFFFFF;   // treat earlier counters as seen, they may be from before an eviction
+    if (payload_len == 0) _hello_due = true;   // answer, so they can sync us too
+    return payload_len;
+  }
+  markSeen(w, counter);
+  return payload_len;
+}
+
+BridgeCipher::ReplayWindow *BridgeCipher::findWindow(uint32_t sender_id) {
+  for (int i = 0; i < BRIDGE_CIPHER_MAX_SENDERS; i++) {
+    if (_windows[i].last_use != 0 && _windows[i].sender_id == sender_id) return &_windows[i];
+  }
+  return NULL;
+}
+
+BridgeCipher::ReplayWindow *BridgeCipher::addWindow(uint32_t sender_id, bool fresh) {
+  // use a free slot, else the least recently used unsynced one. Only a fresh sender may evict a synced one
+  ReplayWindow *w = NULL;
+  for (int i = 0; i < BRIDGE_CIPHER_MAX_SENDERS; i++) {
+    ReplayWindow *c = &_windows[i];
+    if (c->last_use == 0) { w = c; break; }
+    if (c->synced && !fresh) continue;
+    if (w == NULL || (w->synced && !c->synced) || (w->synced == c->synced && c->last_use < w->last_use)) w = c;
+  }
+  if (w == NULL) return NULL;
+
+  if (w->synced) newChallenge();   // else its old frames could start a new window
+  memset(w, 0, sizeof(*w));
+  w->sender_id = sender_id;
+  return w;
+}
+
+bool BridgeCipher::isReplay(const ReplayWindow *w, uint32_t counter) const {
+  if (counter > w->top) return false;
+  uint32_t age = w->top - counter;
+  return age >= 32 || (w->mask & (1UL << age)) != 0;
+}
+
+void BridgeCipher::markSeen(ReplayWindow *w, uint32_t counter) {
+  if (counter > w->top) {
+    uint32_t shift = counter - w->top;
+    w->mask = shift >= 32 ? 1 : (w->mask << shift) | 1;
+    w->top = counter;
+  } else {
+    w->mask |= 1UL << (w->top - counter);
+  }
+}
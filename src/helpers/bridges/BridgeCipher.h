@@ -0,0 +1,105 @@
+#pragma once
+
+#include <AES.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef BRIDGE_CIPHER_MAX_SENDERS
+  #define BRIDGE_CIPHER_MAX_SENDERS  8     // number of peers tracked for replay protection
+#endif
+
+/**
+ * @brief Authenticated encryption for bridge packets sent over a shared medium (eg. ESP-NOW)
+ *
+ * AES-128 in CTR mode, plus HMAC-SHA256 (truncated to TAG_SIZE) over the associated data,
+ * header and ciphertext. Encryption/decryption and the MAC are done in a single pass over
+ * the buffer, 16 bytes at a time. Keys are derived from the bridge secret (only when it changes).
+ *
+ * Envelope (appended after 'aad_len' bytes of associated data, eg. the magic header):
+ * [4 bytes] Sender ID - random per boot
+ * [4 bytes] Counter - per sender, incremented for every packet
+ * [4 bytes] Challenge - the sender's current session epoch
+ * [4 bytes] Echo - the challenge of one of the sender's peers
+ * [n bytes] Ciphertext
+ * [8 bytes] Tag
+ *
+ * The (Sender ID, Counter) pair is the CTR nonce, and a sliding window of the last 32 counters
+ * per sender rejects replayed packets.
+ *
+ * A window is only started for a sender once it sends a frame echoing our current challenge, which
+ * proves the frame was made after we booted (or last evicted a window). Until then, its frames are
+ * rejected and a hello (empty payload) is due, to tell it our challenge. So frames captured earlier
+ * can't be replayed after a reboot, nor after flushing the sender's window from the table.
+ */
+class BridgeCipher {
+public:
+  static constexpr size_t NONCE_SIZE = 8;
+  static constexpr size_t HEADER_SIZE = 16;
+  static constexpr size_t TAG_SIZE = 8;
+  static constexpr size_t OVERHEAD = HEADER_SIZE + TAG_SIZE;
+
+  BridgeCipher();
+
+  /**
+   * @brief Derives the encryption and MAC keys from 'secret' (a C string, max 16 chars).
+   *        Does nothing if secret is unchanged since last call.
+   */
+  void setSecret(const char *secret);
+
+  /**
+   * @brief Sets our sender ID (should be random each boot), resets our counter and session challenge.
+   */
+  void setSenderId(uint32_t id);
+
+  /**
+   * @brief Encrypts and authenticates in place. Plaintext must be at: frame + aad_len + HEADER_SIZE
+   * @return total length of frame (aad_len + OVERHEAD + payload_len)
+   */
+  size_t seal(uint8_t *frame, size_t aad_len, size_t payload_len);
+
+  /**
+   * @brief Verifies and decrypts in place. Plaintext is left at: frame + aad_len + HEADER_SIZE
+   * @return length of plaintext (zero for a hello), or -1 if frame is too short, tag is invalid, is a
+   *         replay, or is from a sender which hasn't yet echoed our challenge
+   */
+  int open(uint8_t *frame, size_t aad_len, size_t len);
+
+  /**
+   * @return true (once) if a hello should be sent, ie. seal() with an empty payload. Caller should rate limit these.
+   */
+  bool isHelloDue() { bool d = _hello_due; _hello_due = false; return d; }
+
+  uint32_t getAuthFailures() const { return n_auth_fail; }
+  uint32_t getReplays() const { return n_replays; }
+  uint32_t getUnsynced() const { return n_unsynced; }
+
+private:
+  struct ReplayWindow {
+    uint32_t sender_id;
+    uint32_t challenge; // theirs, for us to echo
+    bool synced;        // they have echoed our challenge, so window is valid
+    uint32_t top;       // highest counter seen
+    uint32_t mask;      // bit i => (top - i) seen
+    uint32_t last_use;
+  };
+
+  AES128 _aes;
+  uint8_t _mac_key[32];
+  char _secret[17];
+  uint32_t _sender_id, _counter;
+  uint32_t _challenge, _challenge_gen;
+  ReplayWindow _windows[BRIDGE_CIPHER_MAX_SENDERS];
+  uint32_t _use_clock;
+  int _echo_pref, _echo_next;
+  bool _hello_due;
+  uint32_t n_auth_fail, n_replays, n_unsynced;
+
+  void crypt(uint8_t *frame, size_t aad_len, size_t payload_len, bool encrypting, uint8_t *tag);
+  void resetPeers();
+  void newChallenge();
+  uint32_t nextEcho();
+  ReplayWindow *findWindow(uint32_t sender_id);
+  ReplayWindow *addWindow(uint32_t sender_id, bool fresh);
+  bool isReplay(const ReplayWindow *w, uint32_t counter) const;
+  void markSeen(ReplayWindow *w, uint32_t counter);
+};
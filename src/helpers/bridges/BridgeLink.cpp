@@ -0,0 +1,293 @@
+#include "BridgeLink.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define FLAG_DATA  0x01
+
+#define OFS_FLAGS        2
+#define OFS_SESSION      3
+#define OFS_ACK_SESSION  4
+#define OFS_SEQ          5
+#define OFS_BASE         6
+#define OFS_ACK          7
+#define OFS_SACK         8
+#define OFS_LEN          9
+
+// CRC-32 (IEEE 802.3, reflected), nibble-wise table to keep flash usage small
+static const uint32_t crc_table[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t BridgeLink::crc32(const uint8_t *data, size_t len, uint32_t crc) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc = crc_table[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+    crc = crc_table[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+  }
+  return ~crc;
+}
+
+BridgeLink::BridgeLink(Stream &serial, BridgeLinkCallbacks *callbacks) : _serial(&serial), _callbacks(callbacks) {
+  begin(115200, 1);
+}
+
+void BridgeLink::begin(uint32_t baud, uint8_t session) {
+  // allow for a full window of max-size frames each way, plus some turnaround slack
+  _rto_ms = ((uint32_t)MAX_FRAME_SIZE * 10000 / baud) * (BRIDGE_LINK_WINDOW + 1) + 50;
+
+  tx_session = session ? session : 1;
+  tx_base = tx_next = 0;
+  memset(tx_slots, 0, sizeof(tx_slots));
+  batch_len = 0;
+  batch_count = 0;
+  rx_session = 0;
+  rx_next = 0;
+  rx_mask = 0;
+  ack_pending = false;
+  rx_pos = 0;
+  resetStats();
+}
+
+void BridgeLink::resetStats() {
+  n_tx_frames = n_rx_frames = n_tx_packets = n_rx_packets = 0;
+  n_retransmits = n_dropped = n_crc_errors = n_tx_bytes = n_rx_bytes = 0;
+  avg_ack_ms = max_ack_ms = 0;
+}
+
+bool BridgeLink::queuePacket(const uint8_t *raw, uint16_t len) {
+  if (len == 0 || len > MAX_TRANS_UNIT + 1) return false;
+
+  if (batch_len + 2 + len > BRIDGE_LINK_MAX_PAYLOAD) {
+    flushBatch();
+    if (batch_len + 2 + len > BRIDGE_LINK_MAX_PAYLOAD) {   // window is still full
+      n_dropped++;
+      return false;
+    }
+  }
+  batch[batch_len++] = (len >> 8) & 0xFF;
+  batch[batch_len++] = len & 0xFF;
+  memcpy(&batch[batch_len], raw, len);
+  batch_len += len;
+  batch_count++;
+
+  flushBatch();   // send now, if window has room, otherwise keep batching
+  return true;
+}
+
+void BridgeLink::flushBatch() {
+  if (batch_len == 0 || isWindowFull()) return;
+
+  TxSlot &slot = tx_slots[tx_next % BRIDGE_LINK_WINDOW];
+  slot.frame[OFS_FLAGS] = FLAG_DATA;
+  slot.frame[OFS_SEQ] = tx_next;
+  memcpy(&slot.frame[HEADER_SIZE], batch, batch_len);
+  slot.num_packets = batch_count;
+  slot.retries = 0;
+  slot.in_use = true;
+  tx_next++;
+
+  writeFrame(slot.frame, batch_len);
+  slot.len = batch_len;
+  slot.first_sent = slot.last_sent = millis();
+
+  n_tx_frames++;
+  n_tx_packets += batch_count;
+  n_tx_bytes += batch_len;
+  batch_len = 0;
+  batch_count = 0;
+}
+
+void BridgeLink::writeFrame(uint8_t *frame, uint16_t payload_len) {
+  frame[0] = (LINK_MAGIC >> 8) & 0xFF;
+  frame[1] = LINK_MAGIC & 0xFF;
+  frame[OFS_SESSION] = tx_session;
+  frame[OFS_ACK_SESSION] = rx_session;
+  frame[OFS_BASE] = tx_base;
+  frame[OFS_ACK] = rx_next;   // always piggyback latest receive state
+  frame[OFS_SACK] = rx_mask;
+  frame[OFS_LEN] = (payload_len >> 8) & 0xFF;
+  frame[OFS_LEN + 1] = payload_len & 0xFF;
+
+  uint32_t crc = crc32(&frame[2], HEADER_SIZE - 2 + payload_len);
+  uint8_t *dest = &frame[HEADER_SIZE + payload_len];
+  dest[0] = (crc >> 24) & 0xFF;
+  dest[1] = (crc >> 16) & 0xFF;
+  dest[2] = (crc >> 8) & 0xFF;
+  dest[3] = crc & 0xFF;
+
+  _serial->write(frame, HEADER_SIZE + payload_len + CRC_SIZE);
+  ack_pending = false;
+}
+
+void BridgeLink::sendAck() {
+  uint8_t frame[HEADER_SIZE + CRC_SIZE];
+  frame[OFS_FLAGS] = 0;
+  frame[OFS_SEQ] = 0;
+  writeFrame(frame, 0);
+}
+
+void BridgeLink::loop() {
+  while (_serial->available() > 0) {
+    if (rx_pos < 2) {   // hunting for magic word
+      int c = _serial->read();
+      if (c < 0) break;
+      if ((rx_pos == 0 && c == ((LINK_MAGIC >> 8) & 0xFF)) || (rx_pos == 1 && c == (LINK_MAGIC & 0xFF))) {
+        rx_buf[rx_pos++] = c;
+      } else {
+        rx_pos = (c == ((LINK_MAGIC >> 8) & 0xFF)) ? 1 : 0;   // could be start of next magic
+        rx_buf[0] = c;
+      }
+      continue;
+    }
+
+    uint16_t payload_len = (rx_buf[OFS_LEN] << 8) | rx_buf[OFS_LEN + 1];
+    uint16_t want = rx_pos < HEADER_SIZE ? HEADER_SIZE : HEADER_SIZE + payload_len + CRC_SIZE;
+    int avail = _serial->available();
+    uint16_t n = want - rx_pos;
+    if (avail < n) n = avail;
+    rx_pos += _serial->readBytes(&rx_buf[rx_pos], n);
+
+    if (rx_pos == HEADER_SIZE) {
+      payload_len = (rx_buf[OFS_LEN] << 8) | rx_buf[OFS_LEN + 1];
+      if (payload_len > BRIDGE_LINK_MAX_PAYLOAD) {
+        MESH_DEBUG_PRINTLN("BridgeLink: RX invalid length %d, resetting", payload_len);
+        n_crc_errors++;
+        rx_pos = 0;
+      }
+    } else if (rx_pos == HEADER_SIZE + payload_len + CRC_SIZE) {   // full frame received
+      const uint8_t *p = &rx_buf[HEADER_SIZE + payload_len];
+      uint32_t received_crc = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+      if (received_crc == crc32(&rx_buf[2], HEADER_SIZE - 2 + payload_len)) {
+        onFrameRecv(rx_buf, payload_len);
+      } else {
+        MESH_DEBUG_PRINTLN("BridgeLink: RX crc mismatch, rcv=0x%08x", received_crc);
+        n_crc_errors++;
+      }
+      rx_pos = 0;
+    }
+  }
+
+  checkRetransmits();
+  flushBatch();
+  if (ack_pending) sendAck();
+}
+
+void BridgeLink::onFrameRecv(const uint8_t *frame, uint16_t payload_len) {
+  n_rx_frames++;
+  if (frame[OFS_SESSION] != rx_session) {   // first frame from peer, or peer has restarted
+    if (rx_session != 0) MESH_DEBUG_PRINTLN("BridgeLink: peer restarted, resyncing at seq=%d", (uint32_t)frame[OFS_BASE]);
+    rx_session = frame[OFS_SESSION];
+    rx_next = frame[OFS_BASE];
+    rx_mask = 0;
+  }
+  if (frame[OFS_ACK_SESSION] == tx_session) {   // otherwise acks are for our previous session
+    onAckRecv(frame[OFS_ACK], frame[OFS_SACK]);
+  }
+  skipRxTo(frame[OFS_BASE]);
+
+  if ((frame[OFS_FLAGS] & FLAG_DATA) == 0) return;   // ACK only
+
+  ack_pending = true;   // even for duplicates, as our previous ACK may have been lost
+
+  uint8_t seq = frame[OFS_SEQ];
+  uint8_t d = seq - rx_next;
+  if (d == 0) {
+    rx_next++;
+    while (rx_mask & 1) {   // also advance past frames already received out of order
+      rx_mask >>= 1;
+      rx_next++;
+    }
+    rx_mask >>= 1;
+  } else if (d <= 8 && (rx_mask & (1 << (d - 1))) == 0) {
+    rx_mask |= (1 << (d - 1));   // out of order, deliver now (mesh packets don't need ordering)
+  } else {
+    return;   // duplicate
+  }
+
+  const uint8_t *payload = &frame[HEADER_SIZE];
+  uint16_t i = 0;
+  while (i + 2 <= payload_len) {
+    uint16_t len = (payload[i] << 8) | payload[i + 1];
+    i += 2;
+    if (i + len > payload_len) break;
+    _callbacks->onLinkPacketRecv(&payload[i], len);
+    i += len;
+    n_rx_packets++;
+  }
+  n_rx_bytes += payload_len;
+}
+
+void BridgeLink::skipRxTo(uint8_t base) {
+  uint8_t d = base - rx_next;
+  if (d == 0 || (uint8_t)(rx_next - base) <= BRIDGE_LINK_WINDOW) return;  // base is not ahead of us
+
+  // sender has given up on frames before 'base'
+  bool base_recv = d <= 8 && (rx_mask & (1 << (d - 1)));
+  rx_mask = d >= 8 ? 0 : (rx_mask >> d);
+  rx_next = base;
+  if (base_recv) {
+    rx_next++;
+    while (rx_mask & 1) {
+      rx_mask >>= 1;
+      rx_next++;
+    }
+    rx_mask >>= 1;
+  }
+}
+
+void BridgeLink::onAckRecv(uint8_t ack, uint8_t sack) {
+  uint8_t in_flight = tx_next - tx_base;
+  uint8_t a = ack - tx_base;
+  if (a > in_flight) return;   // stale
+
+  unsigned long now = millis();
+  for (uint8_t d = 0; d < in_flight; d++) {
+    TxSlot &slot = tx_slots[(uint8_t)(tx_base + d) % BRIDGE_LINK_WINDOW];
+    if (!slot.in_use) continue;
+
+    if (d < a || (d > a && (sack & (1 << (d - a - 1))))) {
+      uint32_t elapsed = now - slot.first_sent;
+      avg_ack_ms = avg_ack_ms == 0 ? elapsed : (avg_ack_ms * 7 + elapsed) / 8;
+      if (elapsed > max_ack_ms) max_ack_ms = elapsed;
+      slot.in_use = false;
+    }
+  }
+  advanceTxBase();
+}
+
+void BridgeLink::advanceTxBase() {
+  while (tx_base != tx_next && !tx_slots[tx_base % BRIDGE_LINK_WINDOW].in_use) {
+    tx_base++;
+  }
+}
+
+void BridgeLink::checkRetransmits() {
+  unsigned long now = millis();
+  for (uint8_t s = tx_base; s != tx_next; s++) {
+    TxSlot &slot = tx_slots[s % BRIDGE_LINK_WINDOW];
+    if (!slot.in_use || now - slot.last_sent < _rto_ms) continue;
+
+    if (slot.retries >= BRIDGE_LINK_MAX_RETRIES) {
+      MESH_DEBUG_PRINTLN("BridgeLink: TX giving up on seq=%d", (uint32_t)s);
+      n_dropped += slot.num_packets;
+      slot.in_use = false;
+    } else {
+      slot.retries++;
+      slot.last_sent = now;
+      writeFrame(slot.frame, slot.len);   // selective: only this frame
+      n_retransmits++;
+    }
+  }
+  advanceTxBase();
+}
+
+void BridgeLink::formatStats(char *reply) const {
+  sprintf(reply,
+    "{\"tx_frames\":%u,\"rx_frames\":%u,\"tx_pkts\":%u,\"rx_pkts\":%u,\"tx_bytes\":%u,\"rx_bytes\":%u,"
+    "\"retransmits\":%u,\"dropped\":%u,\"crc_errors\":%u,\"ack_avg_ms\":%u,\"ack_max_ms\":%u}",
+    n_tx_frames, n_rx_frames, n_tx_packets, n_rx_packets, n_tx_bytes, n_rx_bytes,
+    n_retransmits, n_dropped, n_crc_errors, avg_ack_ms, max_ack_ms
+  );
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <Arduino.h>
+#include <MeshCore.h>
+#include <Stream.h>
+
+#ifndef BRIDGE_LINK_WINDOW
+  #define BRIDGE_LINK_WINDOW       4     // max unacknowledged frames in flight (power of 2, <= 8)
+#endif
+#ifndef BRIDGE_LINK_MAX_RETRIES
+  #define BRIDGE_LINK_MAX_RETRIES  5
+#endif
+
+#define BRIDGE_LINK_MAX_PAYLOAD   (2 * (2 + MAX_TRANS_UNIT + 1))   // room for at least two max-size packets
+
+class BridgeLinkCallbacks {
+public:
+  /**
+   * @brief A mesh packet (in Packet::writeTo() format) has arrived from the peer.
+   *        NOTE: packets can arrive out of order, but never duplicated (by the link layer)
+   */
+  virtual void onLinkPacketRecv(const uint8_t *raw, uint16_t len) = 0;
+};
+
+/**
+ * @brief Framed, CRC-protected, windowed point-to-point link over a Stream (eg. UART, or a pty on Linux)
+ *
+ * Frame Structure:
+ * [2 bytes] Magic (0xC03F)
+ * [1 byte]  Flags - bit0: DATA frame (otherwise ACK only)
+ * [1 byte]  Session - sender's session, random each begin() (never 0)
+ * [1 byte]  AckSession - peer's session that Ack/SAck refer to (0 until a frame has been received)
+ * [1 byte]  Seq - sequence number of this DATA frame
+ * [1 byte]  Base - oldest Seq the sender is still retrying (receiver skips anything earlier)
+ * [1 byte]  Ack - next Seq expected from peer (all earlier frames received)
+ * [1 byte]  SAck - selective ack bitmap, bit i => frame (Ack + 1 + i) received
+ * [2 bytes] Payload length
+ * [n bytes] Payload - batch of packets, each as: [2 bytes length][packet bytes]
+ * [4 bytes] CRC-32, over everything after magic
+ *
+ * Every frame piggybacks the receiver state (Ack/SAck), so only frames actually lost get
+ * re-sent. Packets queued while the window is full are batched together into the next frame.
+ * A frame is given up on after BRIDGE_LINK_MAX_RETRIES, and Base tells the peer to move past it.
+ * A new Session means the peer has restarted, so the receiver starts again from its Base (sequence
+ * numbers alone can't tell a restart from a retransmit).
+ * All multi-byte fields are big-endian.
+ */
+class BridgeLink {
+public:
+  static constexpr uint16_t LINK_MAGIC = 0xC03F;
+  static constexpr uint16_t HEADER_SIZE = 11;
+  static constexpr uint16_t CRC_SIZE = 4;
+  static constexpr uint16_t MAX_FRAME_SIZE = HEADER_SIZE + BRIDGE_LINK_MAX_PAYLOAD + CRC_SIZE;
+
+  BridgeLink(Stream &serial, BridgeLinkCallbacks *callbacks);
+
+  /**
+   * @brief Resets link state, and sizes the retransmit timeout for the given line speed.
+   * @param session should be random each boot, so the peer can tell we have restarted
+   */
+  void begin(uint32_t baud, uint8_t session);
+
+  /**
+   * @brief Queues a packet for transmission, sending immediately if the window has room.
+   * @return false if the packet had to be dropped (window AND batch buffer full)
+   */
+  bool queuePacket(const uint8_t *raw, uint16_t len);
+
+  /**
+   * @brief Reads and processes incoming frames, handles retransmits and pending ACKs.
+   */
+  void loop();
+
+  uint32_t getFramesSent() const { return n_tx_frames; }
+  uint32_t getFramesRecv() const { return n_rx_frames; }
+  uint32_t getPacketsSent() const { return n_tx_packets; }
+  uint32_t getPacketsRecv() const { return n_rx_packets; }
+  uint32_t getRetransmits() const { return n_retransmits; }
+  uint32_t getDropped() const { return n_dropped; }
+  uint32_t getCRCErrors() const { return n_crc_errors; }
+  uint32_t getBytesSent() const { return n_tx_bytes; }
+  uint32_t getBytesRecv() const { return n_rx_bytes; }
+  uint32_t getAvgAckMillis() const { return avg_ack_ms; }
+  uint32_t getMaxAckMillis() const { return max_ack_ms; }
+  void resetStats();
+
+  /**
+   * @brief Formats link counters as JSON, in the style of StatsFormatHelper
+   */
+  void formatStats(char *reply) const;
+
+  static uint32_t crc32(const uint8_t *data, size_t len, uint32_t crc = 0);
+
+private:
+  struct TxSlot {
+    bool in_use;
+    uint8_t retries;
+    uint8_t num_packets;
+    unsigned long first_sent, last_sent;
+    uint16_t len;
+    uint8_t frame[MAX_FRAME_SIZE];
+  };
+
+  Stream *_serial;
+  BridgeLinkCallbacks *_callbacks;
+  uint32_t _rto_ms;
+
+  // sender state
+  uint8_t tx_session;
+  uint8_t tx_base, tx_next;
+  TxSlot tx_slots[BRIDGE_LINK_WINDOW];
+  uint8_t batch[BRIDGE_LINK_MAX_PAYLOAD];
+  uint16_t batch_len;
+  uint8_t batch_count;
+
+  // receiver state
+  uint8_t rx_session;   // peer's, 0 = none yet
+  uint8_t rx_next, rx_mask;
+  bool ack_pending;
+  uint8_t rx_buf[MAX_FRAME_SIZE];
+  uint16_t rx_pos;
+
+  uint32_t n_tx_frames, n_rx_frames, n_tx_packets, n_rx_packets;
+  uint32_t n_retransmits, n_dropped, n_crc_errors, n_tx_bytes, n_rx_bytes;
+  uint32_t avg_ack_ms, max_ack_ms;
+
+  bool isWindowFull() const { return (uint8_t)(tx_next - tx_base) >= BRIDGE_LINK_WINDOW; }
+  void flushBatch();
+  void writeFrame(uint8_t *frame, uint16_t payload_len);
+  void sendAck();
+  void onFrameRecv(const uint8_t *frame, uint16_t payload_len);
+  void onAckRecv(uint8_t ack, uint8_t sack);
+  void skipRxTo(uint8_t base);
+  void advanceTxBase();
+  void checkRetransmits();
+};
@@ -22,13 +22,18 @@ void ESPNowBridge::send_cb(const uint8_t *mac, esp_now_send_status_t status) {
 }
 
 ESPNowBridge::ESPNowBridge(NodePrefs *prefs, mesh::PacketManager *mgr, mesh::RTCClock *rtc)
-    : BridgeBase(prefs, mgr, rtc), _rx_buffer_pos(0) {
+    : BridgeBase(prefs, mgr, rtc), _rx_buffer_pos(0), _last_hello(0) {
   _instance = this;
+  _cipher_lock = xSemaphoreCreateMutex();
 }
 
 void ESPNowBridge::begin() {
   BRIDGE_DEBUG_PRINTLN("Initializing...\n");
 
+  // Derive keys, and pick a new sender ID so our counter can restart from zero
+  _cipher.setSecret(_prefs->bridge_secret);
+  _cipher.setSenderId(esp_random());
+
   // Initialize WiFi in station mode
   WiFi.mode(WIFI_STA);
   
@@ -62,6 +67,8 @@ void ESPNowBridge::begin() {
 
   // Update bridge state
   _initialized = true;
+
+  sendHello();   // so peers can start accepting our packets straight away
 }
 
 void ESPNowBridge::end() {
@@ -90,19 +97,35 @@ void ESPNowBridge::end() {
 }
 
 void ESPNowBridge::loop() {
-  // Nothing to do here - ESP-NOW is callback based
+  // ESP-NOW is callback based, the only thing to do here is answer peers which don't know our challenge yet
+  if (!_initialized || millis() - _last_hello < 1000) return;   // at most one a second, as stale (eg. replayed) packets trigger these
+
+  xSemaphoreTake(_cipher_lock, portMAX_DELAY);
+  bool due = _cipher.isHelloDue();
+  xSemaphoreGive(_cipher_lock);
+  if (due) sendHello();
 }
 
-void ESPNowBridge::xorCrypt(uint8_t *data, size_t len) {
-  size_t keyLen = strlen(_prefs->bridge_secret);
-  for (size_t i = 0; i < len; i++) {
-    data[i] ^= _prefs->bridge_secret[i % keyLen];
+void ESPNowBridge::sendHello() {
+  uint8_t buffer[BRIDGE_MAGIC_SIZE + BridgeCipher::OVERHEAD];
+  buffer[0] = (BRIDGE_PACKET_MAGIC >> 8) & 0xFF;
+  buffer[1] = BRIDGE_PACKET_MAGIC & 0xFF;
+
+  xSemaphoreTake(_cipher_lock, portMAX_DELAY);
+  _cipher.setSecret(_prefs->bridge_secret);
+  const size_t len = _cipher.seal(buffer, BRIDGE_MAGIC_SIZE, 0);
+  xSemaphoreGive(_cipher_lock);
+
+  uint8_t broadcastAddress[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+  if (esp_now_send(broadcastAddress, buffer, len) != ESP_OK) {
+    BRIDGE_DEBUG_PRINTLN("TX hello FAILED!\n");
   }
+  _last_hello = millis();
 }
 
 void ESPNowBridge::onDataRecv(const uint8_t *mac, const uint8_t *data, int32_t len) {
-  // Ignore packets that are too small to contain header + checksum
-  if (len < (BRIDGE_MAGIC_SIZE + BRIDGE_CHECKSUM_SIZE)) {
+  // Ignore packets that are too small to contain header + nonce + tag
+  if (len < (int32_t)(BRIDGE_MAGIC_SIZE + BridgeCipher::OVERHEAD)) {
     BRIDGE_DEBUG_PRINTLN("RX packet too small, len=%d\n", len);
     return;
   }
@@ -120,23 +143,22 @@ void ESPNowBridge::onDataRecv(const uint8_t *mac, const uint8_t *data, int32_t l
     return;
   }
 
-  // Make a copy we can decrypt
+  // Make a copy we can decrypt in place
   uint8_t decrypted[MAX_ESPNOW_PACKET_SIZE];
-  const size_t encryptedDataLen = len - BRIDGE_MAGIC_SIZE;
-  memcpy(decrypted, data + BRIDGE_MAGIC_SIZE, encryptedDataLen);
-
-  // Try to decrypt (checksum + payload)
-  xorCrypt(decrypted, encryptedDataLen);
-
-  // Validate checksum
-  uint16_t received_checksum = (decrypted[0] << 8) | decrypted[1];
-  const size_t payloadLen = encryptedDataLen - BRIDGE_CHECKSUM_SIZE;
-
-  if (!validateChecksum(decrypted + BRIDGE_CHECKSUM_SIZE, payloadLen, received_checksum)) {
-    // Failed to decrypt - likely from a different network
-    BRIDGE_DEBUG_PRINTLN("RX checksum mismatch, rcv=0x%04X\n", received_checksum);
+  memcpy(decrypted, data, len);
+
+  // Verify tag (magic + nonce + ciphertext), check for replay, and decrypt.
+  // Re-key here too, so a changed bridge.secret applies to RX straight away, not just after the next TX
+  xSemaphoreTake(_cipher_lock, portMAX_DELAY);
+  _cipher.setSecret(_prefs->bridge_secret);
+  int payloadLen = _cipher.open(decrypted, BRIDGE_MAGIC_SIZE, len);
+  xSemaphoreGive(_cipher_lock);
+  if (payloadLen < 0) {
+    // Failed to authenticate - likely from a different network, a replay, or a peer which hasn't echoed our challenge yet
+    BRIDGE_DEBUG_PRINTLN("RX auth failed, len=%d\n", len);
     return;
   }
+  if (payloadLen == 0) return;   // a hello, just for the cipher
 
   BRIDGE_DEBUG_PRINTLN("RX, payload_len=%d\n", payloadLen);
 
@@ -144,7 +166,7 @@ void ESPNowBridge::onDataRecv(const uint8_t *mac, const uint8_t *data, int32_t l
   mesh::Packet *pkt = _instance->_mgr->allocNew();
   if (!pkt) return;
 
-  if (pkt->readFrom(decrypted + BRIDGE_CHECKSUM_SIZE, payloadLen)) {
+  if (pkt->readFrom(decrypted + BRIDGE_MAGIC_SIZE + BridgeCipher::HEADER_SIZE, payloadLen)) {
     _instance->onPacketReceived(pkt);
   } else {
     _instance->_mgr->free(pkt);
@@ -169,9 +191,11 @@ void ESPNowBridge::sendPacket(mesh::Packet *packet) {
 
   if (!_seen_packets.wasSeen(packet)) {
     _seen_packets.markSeen(packet);
-    // Create a temporary buffer just for size calculation and reuse for actual writing
-    uint8_t sizingBuffer[MAX_PAYLOAD_SIZE];
-    uint16_t meshPacketLen = packet->writeTo(sizingBuffer);
+    uint8_t buffer[BRIDGE_MAGIC_SIZE + BridgeCipher::OVERHEAD + MAX_TRANS_UNIT + 1];
+
+    // Write packet payload directly where it will be encrypted in place
+    const size_t packetOffset = BRIDGE_MAGIC_SIZE + BridgeCipher::HEADER_SIZE;
+    uint16_t meshPacketLen = packet->writeTo(buffer + packetOffset);
 
     // Check if packet fits within our maximum payload size
     if (meshPacketLen > MAX_PAYLOAD_SIZE) {
@@ -180,26 +204,15 @@ void ESPNowBridge::sendPacket(mesh::Packet *packet) {
       return;
     }
 
-    uint8_t buffer[MAX_ESPNOW_PACKET_SIZE];
-
     // Write magic header (2 bytes)
     buffer[0] = (BRIDGE_PACKET_MAGIC >> 8) & 0xFF;
     buffer[1] = BRIDGE_PACKET_MAGIC & 0xFF;
 
-    // Write packet payload starting after magic header and checksum
-    const size_t packetOffset = BRIDGE_MAGIC_SIZE + BRIDGE_CHECKSUM_SIZE;
-    memcpy(buffer + packetOffset, sizingBuffer, meshPacketLen);
-
-    // Calculate and add checksum (only of the payload)
-    uint16_t checksum = fletcher16(buffer + packetOffset, meshPacketLen);
-    buffer[2] = (checksum >> 8) & 0xFF; // High byte
-    buffer[3] = checksum & 0xFF;        // Low byte
-
-    // Encrypt payload and checksum (not including magic header)
-    xorCrypt(buffer + BRIDGE_MAGIC_SIZE, meshPacketLen + BRIDGE_CHECKSUM_SIZE);
-
-    // Total packet size: magic header + checksum + payload
-    const size_t totalPacketSize = BRIDGE_MAGIC_SIZE + BRIDGE_CHECKSUM_SIZE + meshPacketLen;
+    // Encrypt and append tag, in one pass (keys are re-derived only if secret was changed)
+    xSemaphoreTake(_cipher_lock, portMAX_DELAY);
+    _cipher.setSecret(_prefs->bridge_secret);
+    const size_t totalPacketSize = _cipher.seal(buffer, BRIDGE_MAGIC_SIZE, meshPacketLen);
+    xSemaphoreGive(_cipher_lock);
 
     // Broadcast using ESP-NOW
     uint8_t broadcastAddress[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
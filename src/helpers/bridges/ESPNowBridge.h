@@ -2,7 +2,10 @@
 
 #include "MeshCore.h"
 #include "esp_now.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "helpers/bridges/BridgeBase.h"
+#include "helpers/bridges/BridgeCipher.h"
 
 #ifdef WITH_ESPNOW_BRIDGE
 
@@ -15,20 +18,23 @@
  *
  * Features:
  * - Broadcast-based communication (all bridges receive all packets)
- * - Network isolation using XOR encryption with shared secret
+ * - Authenticated encryption (AES-128-CTR + truncated HMAC-SHA256) with shared secret
+ * - Replay protection, using a per-sender counter window, started only once the sender
+ *   has echoed our per-boot challenge (exchanged in hello packets, with no payload)
  * - Duplicate packet detection using SimpleMeshTables tracking
  * - Maximum packet size of 250 bytes (ESP-NOW limitation)
  *
  * Packet Structure:
  * [2 bytes] Magic Header - Used to identify ESPNowBridge packets
- * [2 bytes] Fletcher-16 checksum of encrypted payload (calculated over payload only)
- * [246 bytes max] Encrypted payload containing the mesh packet
+ * [4 bytes] Sender ID - random per boot
+ * [4 bytes] Counter - per sender, used as CTR nonce and for replay detection
+ * [4 bytes] Challenge - sender's session epoch
+ * [4 bytes] Echo - challenge of one of the sender's peers
+ * [224 bytes max] Encrypted payload containing the mesh packet (empty for a hello)
+ * [8 bytes] Tag - HMAC-SHA256 (truncated) over all the preceding bytes
  *
- * The Fletcher-16 checksum is used to validate packet integrity and detect
- * corrupted or tampered packets. It's calculated over the encrypted payload
- * and provides a simple but effective way to verify packets are both
- * uncorrupted and from the same network (since the checksum is calculated
- * after encryption).
+ * The tag authenticates the magic header, nonce and ciphertext, so corrupted,
+ * tampered or replayed packets are discarded before being parsed (see BridgeCipher).
  *
  * Configuration:
  * - Define WITH_ESPNOW_BRIDGE to enable this bridge
@@ -37,7 +43,7 @@
  * Network Isolation:
  * Multiple independent mesh networks can coexist by using different
  * _prefs->bridge_secret values. Packets encrypted with a different key will
- * fail the checksum validation and be discarded.
+ * fail the tag validation and be discarded.
  */
 class ESPNowBridge : public BridgeBase {
 private:
@@ -53,15 +59,16 @@ private:
    *
    * Our Bridge Packet Structure (must fit in ESP-NOW payload):
    * - Magic header: 2 bytes
-   * - Checksum: 2 bytes
-   * - Available payload: 246 bytes
+   * - Sender ID, Counter, Challenge, Echo: 16 bytes
+   * - Available payload: 224 bytes
+   * - Tag: 8 bytes
    */
   static const size_t MAX_ESPNOW_PACKET_SIZE = 250;
 
   /**
    * Size constants for packet parsing
    */
-  static const size_t MAX_PAYLOAD_SIZE = MAX_ESPNOW_PACKET_SIZE - (BRIDGE_MAGIC_SIZE + BRIDGE_CHECKSUM_SIZE);
+  static const size_t MAX_PAYLOAD_SIZE = MAX_ESPNOW_PACKET_SIZE - (BRIDGE_MAGIC_SIZE + BridgeCipher::OVERHEAD);
 
   /** Buffer for receiving ESP-NOW packets */
   uint8_t _rx_buffer[MAX_ESPNOW_PACKET_SIZE];
@@ -70,17 +77,23 @@ private:
   size_t _rx_buffer_pos;
 
   /**
-   * Performs XOR encryption/decryption of data
-   * Used to isolate different mesh networks
-   *
-   * Uses _prefs->bridge_secret as the key in a simple XOR operation.
-   * The same operation is used for both encryption and decryption.
-   * While not cryptographically secure, it provides basic network isolation.
-   *
-   * @param data Pointer to data to encrypt/decrypt
-   * @param len Length of data in bytes
+   * Authenticated encryption of packets, keyed from _prefs->bridge_secret
+   * Used to isolate different mesh networks, and to reject forged or replayed packets
+   */
+  BridgeCipher _cipher;
+
+  /**
+   * @brief Guards _cipher, as RX (WiFi task) and TX (loop task) both use it, and either may re-key it
+   */
+  SemaphoreHandle_t _cipher_lock;
+
+  /** When (millis) we last sent a hello */
+  unsigned long _last_hello;
+
+  /**
+   * @brief Broadcasts a hello (no payload), so peers learn our challenge
    */
-  void xorCrypt(uint8_t *data, size_t len);
+  void sendHello();
 
   /**
    * ESP-NOW receive callback
@@ -133,7 +146,7 @@ public:
 
   /**
    * Main loop handler
-   * ESP-NOW is callback-based, so this is currently empty
+   * ESP-NOW is callback-based, so this just sends a hello when the cipher asks for one
    */
   void loop() override;
 
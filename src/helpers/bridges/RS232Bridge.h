@@ -1,6 +1,7 @@
 #pragma once
 
 #include "helpers/bridges/BridgeBase.h"
+#include "helpers/bridges/BridgeLink.h"
 
 #include <Stream.h>
 
@@ -10,27 +11,20 @@
  * @brief Bridge implementation using RS232/UART protocol for packet transport
  *
  * This bridge enables mesh packet transport over serial/UART connections,
- * allowing nodes to communicate over wired serial links. It implements a simple
- * packet framing protocol with checksums for reliable transfer.
+ * allowing nodes to communicate over wired serial links. Framing, integrity and
+ * retransmission are handled by BridgeLink (see BridgeLink.h for the frame structure).
  *
  * Features:
  * - Point-to-point communication over hardware UART
- * - Fletcher-16 checksum for data integrity verification
- * - Magic header for packet synchronization and frame alignment
+ * - CRC-32 per frame for data integrity verification
+ * - Sliding window with selective acknowledgements, so lost frames are re-sent
+ * - Packets queued while the window is full are batched into a single frame
  * - Duplicate packet detection using SimpleMeshTables tracking
  * - Configurable RX/TX pins via build defines
- * - Fixed baud rate at 115200 for consistent timing
+ * - Link counters (retransmits, drops, CRC errors, ACK latency) via 'stats-bridge'
  *
- * Packet Structure:
- * [2 bytes] Magic Header (0xC03E) - Used to identify start of RS232Bridge packets
- * [2 bytes] Payload Length - Length of the mesh packet payload
- * [n bytes] Mesh Packet Payload - The actual mesh packet data
- * [2 bytes] Fletcher-16 Checksum - Calculated over the payload for integrity verification
- *
- * The Fletcher-16 checksum is calculated over the mesh packet payload and provides
- * error detection capabilities suitable for serial communication where electrical
- * noise, timing issues, or hardware problems could corrupt data. The checksum
- * validation ensures only valid packets are forwarded to the mesh.
+ * NOTE: the link framing (magic 0xC03F) is not compatible with the older single-packet
+ *       framing (magic 0xC03E), so both ends of the link need the same firmware version.
  *
  * Configuration:
  * - Define WITH_RS232_BRIDGE to enable this bridge
@@ -44,7 +38,7 @@
  * - RP2040: Uses SerialUART::setRX(rx) and SerialUART::setTX(tx)
  * - STM32: Uses HardwareSerial::setRx(rx) and HardwareSerial::setTx(tx)
  */
-class RS232Bridge : public BridgeBase {
+class RS232Bridge : public BridgeBase, public BridgeLinkCallbacks {
 public:
   /**
    * @brief Constructs an RS232Bridge instance
@@ -53,8 +47,9 @@ public:
    * @param serial The hardware serial port to use
    * @param mgr PacketManager for allocating and queuing packets
    * @param rtc RTCClock for timestamping debug messages
+   * @param rng for the link's per-boot session ID
    */
-  RS232Bridge(NodePrefs *prefs, Stream &serial, mesh::PacketManager *mgr, mesh::RTCClock *rtc);
+  RS232Bridge(NodePrefs *prefs, Stream &serial, mesh::PacketManager *mgr, mesh::RTCClock *rtc, mesh::RNG *rng);
 
   /**
    * Initializes the RS232 bridge
@@ -73,27 +68,15 @@ public:
   void end() override;
 
   /**
-   * @brief Main loop handler for processing incoming serial data
-   *
-   * Implements a state machine for packet reception:
-   * 1. Searches for magic header bytes for packet synchronization
-   * 2. Reads length field to determine expected packet size
-   * 3. Validates packet length against maximum allowed size
-   * 4. Receives complete packet payload and checksum
-   * 5. Validates Fletcher-16 checksum for data integrity
-   * 6. Creates mesh packet and forwards if valid
+   * @brief Main loop handler, lets the link process incoming frames, ACKs and retransmits
    */
   void loop() override;
 
   /**
    * @brief Called when a packet needs to be transmitted over serial
    *
-   * Formats the mesh packet with RS232 framing protocol:
-   * - Adds magic header for synchronization
-   * - Includes payload length field
-   * - Calculates Fletcher-16 checksum over payload
-   * - Transmits complete framed packet
-   * - Uses duplicate detection to prevent retransmission
+   * Uses duplicate detection to prevent retransmission, then queues the packet
+   * on the link (which may batch it with others, if the window is full).
    *
    * @param packet The mesh packet to transmit
    */
@@ -110,39 +93,23 @@ public:
    */
   void onPacketReceived(mesh::Packet *packet) override;
 
-private:
   /**
-   * RS232 Protocol Structure:
-   * - Magic header: 2 bytes (packet identification)
-   * - Length field: 2 bytes (payload length)
-   * - Payload: variable bytes (mesh packet data)
-   * - Checksum: 2 bytes (Fletcher-16 over payload)
-   * Total overhead: 6 bytes
+   * @brief Called by the link for each packet received (and CRC validated) from the peer
    */
+  void onLinkPacketRecv(const uint8_t *raw, uint16_t len) override;
 
   /**
-   * @brief The total overhead of the serial protocol in bytes.
-   * Includes: MAGIC_WORD (2) + LENGTH (2) + CHECKSUM (2) = 6 bytes
+   * @brief Formats the link counters as JSON, for the 'stats-bridge' CLI command
    */
-  static constexpr uint16_t SERIAL_OVERHEAD = BRIDGE_MAGIC_SIZE + BRIDGE_LENGTH_SIZE + BRIDGE_CHECKSUM_SIZE;
-
-  /**
-   * @brief The maximum size of a complete packet on the serial line.
-   *
-   * This is calculated as the sum of:
-   * - MAX_TRANS_UNIT + 1 for the maximum mesh packet size
-   * - SERIAL_OVERHEAD for the framing (magic + length + checksum)
-   */
-  static constexpr uint16_t MAX_SERIAL_PACKET_SIZE = (MAX_TRANS_UNIT + 1) + SERIAL_OVERHEAD;
+  void formatStats(char *reply) const { _link.formatStats(reply); }
 
+private:
   /** Hardware serial port interface */
   Stream *_serial;
 
-  /** Buffer for building received packets */
-  uint8_t _rx_buffer[MAX_SERIAL_PACKET_SIZE];
-
-  /** Current position in the receive buffer */
-  uint16_t _rx_buffer_pos = 0;
+  /** Reliable framed link running over _serial */
+  BridgeLink _link;
+  mesh::RNG *_rng;
 };
 
 #endif
@@ -1,5 +1,6 @@
 #include "SerialBLEInterface.h"
 #include "esp_mac.h"
+#include "esp_gap_ble_api.h"
 
 // See the following for generating UUIDs:
 // https://www.uuidgenerator.net/
@@ -10,6 +11,9 @@
 
 #define ADVERT_RESTART_DELAY  1000   // millis
 
+#define BLE_BURST_MTU         517    // max ATT MTU we will accept (burst mode packs multiple frames per notify)
+#define BLE_MAX_DATA_LEN      251    // LE Data Length Extension (max link-layer PDU payload)
+
 void SerialBLEInterface::begin(const char* prefix, char* name, uint32_t pin_code) {
   _pin_code = pin_code;
 
@@ -26,7 +30,7 @@ void SerialBLEInterface::begin(const char* prefix, char* name, uint32_t pin_code
   // Create the BLE Device
   BLEDevice::init(dev_name);
   BLEDevice::setSecurityCallbacks(this);
-  BLEDevice::setMTU(MAX_FRAME_SIZE);
+  BLEDevice::setMTU(BLE_BURST_MTU);
 
   BLESecurity  sec;
   sec.setStaticPIN(pin_code);
@@ -95,15 +99,20 @@ void SerialBLEInterface::onConnect(BLEServer* pServer) {
 void SerialBLEInterface::onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t *param) {
   BLE_DEBUG_PRINTLN("onConnect(), conn_id=%d, mtu=%d", param->connect.conn_id, pServer->getPeerMTU(param->connect.conn_id));
   last_conn_id = param->connect.conn_id;
+  _peer_mtu = 23;
+  _burst = false;
+  esp_ble_gap_set_pkt_data_len(param->connect.remote_bda, BLE_MAX_DATA_LEN);
 }
 
 void SerialBLEInterface::onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
   BLE_DEBUG_PRINTLN("onMtuChanged(), mtu=%d", pServer->getPeerMTU(param->mtu.conn_id));
+  _peer_mtu = param->mtu.mtu > BLE_BURST_MTU ? BLE_BURST_MTU : param->mtu.mtu;
 }
 
 void SerialBLEInterface::onDisconnect(BLEServer* pServer) {
   BLE_DEBUG_PRINTLN("onDisconnect()");
   deviceConnected = false;
+  _burst = false;
   if (_isEnabled) {
     adv_restart_time = millis() + ADVERT_RESTART_DELAY;
   }
@@ -115,7 +124,28 @@ void SerialBLEInterface::onWrite(BLECharacteristic* pCharacteristic, esp_ble_gat
   uint8_t* rxValue = pCharacteristic->getData();
   int len = pCharacteristic->getLength();
 
-  if (len > MAX_FRAME_SIZE) {
+  if (_burst) {   // envelope of one or more frames
+    size_t pos = 0;
+    const uint8_t* src;
+    int n;
+    while ((n = FrameBatch::next(rxValue, len, pos, src)) > 0) {
+      if (n > MAX_FRAME_SIZE) {
+        BLE_DEBUG_PRINTLN("ERROR: onWrite(), burst frame too big, len=%d", n);
+        continue;
+      }
+      Frame frame = {};
+      frame.len = n;
+      memcpy(frame.buf, src, n);
+
+      if (xQueueSend(recv_queue, &frame, 0) != pdTRUE) {
+        BLE_DEBUG_PRINTLN("ERROR: onWrite(), recv_queue is full!");
+        break;
+      }
+    }
+    if (n < 0) {
+      BLE_DEBUG_PRINTLN("ERROR: onWrite(), malformed burst envelope, len=%d", len);
+    }
+  } else if (len > MAX_FRAME_SIZE) {
     BLE_DEBUG_PRINTLN("ERROR: onWrite(), frame too big, len=%d", len);
   } else {
     Frame frame = {};
@@ -135,6 +165,43 @@ void SerialBLEInterface::clearBuffers() {
   send_queue_len = 0;
 }
 
+void SerialBLEInterface::shiftSendQueueLeft(int n) {
+  send_queue_len -= n;
+  for (int i = 0; i < send_queue_len; i++) {   // delete top 'n' items from queue
+    send_queue[i] = send_queue[i + n];
+  }
+}
+
+void SerialBLEInterface::sendBurst() {
+  // only push as many notifications as the stack has buffers (credits) for, so none get dropped
+  int credits = esp_ble_get_cur_sendable_packets_num(last_conn_id);
+  size_t max_len = _peer_mtu - 3;   // ATT notify header
+
+  while (credits > 0 && send_queue_len > 0) {
+    uint8_t buf[BLE_BURST_MTU - 3];
+    size_t len = 0;
+    int n = 0;
+    while (n < send_queue_len) {
+      size_t new_len = FrameBatch::append(buf, len, max_len, send_queue[n].buf, send_queue[n].len);
+      if (new_len == 0) break;   // no more room in this notify
+      len = new_len;
+      n++;
+    }
+    if (n == 0) {   // can't happen, burst mode is only enabled if MTU fits a MAX_FRAME_SIZE frame
+      BLE_DEBUG_PRINTLN("ERROR: sendBurst: frame too big for MTU=%d, dropping", (uint32_t)_peer_mtu);
+      shiftSendQueueLeft(1);
+      continue;
+    }
+    pTxCharacteristic->setValue(buf, len);
+    pTxCharacteristic->notify();
+    _last_write = millis();
+
+    BLE_DEBUG_PRINTLN("writeBurst: frames=%d, sz=%d", n, (uint32_t)len);
+    shiftSendQueueLeft(n);
+    credits--;
+  }
+}
+
 void SerialBLEInterface::enable() { 
   if (_isEnabled) return;
 
@@ -189,11 +256,14 @@ size_t SerialBLEInterface::writeFrame(const uint8_t src[], size_t len) {
 #define  BLE_WRITE_MIN_INTERVAL   60
 
 bool SerialBLEInterface::isWriteBusy() const {
+  if (_burst) return send_queue_len >= (FRAME_QUEUE_SIZE * 2 / 3);   // sendBurst() drains in batches
   return millis() < _last_write + BLE_WRITE_MIN_INTERVAL;   // still too soon to start another write?
 }
 
 size_t SerialBLEInterface::checkRecvFrame(uint8_t dest[]) {
-  if (send_queue_len > 0   // first, check send queue
+  if (_burst) {
+    if (send_queue_len > 0) sendBurst();
+  } else if (send_queue_len > 0   // first, check send queue
     && millis() >= _last_write + BLE_WRITE_MIN_INTERVAL    // space the writes apart
   ) {
     _last_write = millis();
@@ -202,14 +272,23 @@ size_t SerialBLEInterface::checkRecvFrame(uint8_t dest[]) {
 
     BLE_DEBUG_PRINTLN("writeBytes: sz=%d, hdr=%d", (uint32_t)send_queue[0].len, (uint32_t) send_queue[0].buf[0]);
 
-    send_queue_len--;
-    for (int i = 0; i < send_queue_len; i++) {   // delete top item from queue
-      send_queue[i] = send_queue[i + 1];
-    }
+    shiftSendQueueLeft(1);
   }
 
   Frame frame;
   if (xQueueReceive(recv_queue, &frame, 0) == pdTRUE) {
+    if (!_burst && FrameBatch::isHello(frame.buf, frame.len)) {   // app is requesting burst-mode
+      uint16_t max_payload = _peer_mtu - 3;   // ATT notify header
+      bool ok = FrameBatch::canBurst(max_payload, MAX_FRAME_SIZE);   // else declined, until a larger MTU is negotiated
+      uint8_t reply[4];
+      size_t reply_len = FrameBatch::writeHelloReply(reply, ok ? max_payload : 0);
+      pTxCharacteristic->setValue(reply, reply_len);   // NOTE: reply is sent as a legacy (single) frame
+      pTxCharacteristic->notify();
+      _last_write = millis();
+      _burst = ok;
+      BLE_DEBUG_PRINTLN("burst mode %s, mtu=%d", ok ? "enabled" : "declined", (uint32_t)_peer_mtu);
+      return 0;
+    }
     memcpy(dest, frame.buf, frame.len);
     BLE_DEBUG_PRINTLN("readBytes: sz=%d, hdr=%d", (uint32_t) frame.len, (uint32_t) dest[0]);
     return frame.len;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../BaseSerialInterface.h"
+#include "../FrameBatch.h"
 #include <BLEDevice.h>
 #include <BLEServer.h>
 #include <BLEUtils.h>
@@ -19,13 +20,15 @@ class SerialBLEInterface : public BaseSerialInterface, BLESecurityCallbacks, BLE
   uint32_t _pin_code;
   unsigned long _last_write;
   unsigned long adv_restart_time;
+  uint16_t _peer_mtu;
+  volatile bool _burst;   // burst-mode (FrameBatch envelopes) negotiated with app
 
   struct Frame {
     uint8_t len;
     uint8_t buf[MAX_FRAME_SIZE];
   };
 
-  #define FRAME_QUEUE_SIZE  4
+  #define FRAME_QUEUE_SIZE  8
   StaticQueue_t recv_queue_state;
   uint8_t recv_queue_storage[FRAME_QUEUE_SIZE * sizeof(Frame)];
   QueueHandle_t recv_queue;
@@ -33,6 +36,8 @@ class SerialBLEInterface : public BaseSerialInterface, BLESecurityCallbacks, BLE
   Frame send_queue[FRAME_QUEUE_SIZE];
 
   void clearBuffers();
+  void shiftSendQueueLeft(int n);
+  void sendBurst();
 
 protected:
   // BLESecurityCallbacks methods
@@ -61,6 +66,8 @@ public:
     _isEnabled = false;
     _last_write = 0;
     last_conn_id = 0;
+    _peer_mtu = 23;
+    _burst = false;
     recv_queue = xQueueCreateStatic(
       FRAME_QUEUE_SIZE, sizeof(Frame), recv_queue_storage, &recv_queue_state
     );
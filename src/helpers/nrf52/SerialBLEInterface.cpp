@@ -29,6 +29,7 @@ void SerialBLEInterface::onConnect(uint16_t connection_handle) {
   if (instance) {
     instance->_conn_handle = connection_handle;
     instance->_isDeviceConnected = false;
+    instance->_burst = false;
     instance->clearBuffers();
   }
 }
@@ -39,6 +40,7 @@ void SerialBLEInterface::onDisconnect(uint16_t connection_handle, uint8_t reason
     if (instance->_conn_handle == connection_handle) {
       instance->_conn_handle = BLE_CONN_HANDLE_INVALID;
       instance->_isDeviceConnected = false;
+      instance->_burst = false;
       instance->clearBuffers();
     }
   }
@@ -69,6 +71,13 @@ void SerialBLEInterface::onSecured(uint16_t connection_handle) {
       } else {
         BLE_DEBUG_PRINTLN("Failed to request connection parameter update: %lu", err_code);
       }
+
+      // larger MTU + LE data length, so burst-mode can pack several frames per notify, per connection event
+      BLEConnection* conn = Bluefruit.Connection(connection_handle);
+      if (conn) {
+        conn->requestDataLengthUpdate();
+        conn->requestMtuExchange(BLE_BURST_MTU);
+      }
     } else {
       BLE_DEBUG_PRINTLN("onSecured: ignoring stale/duplicate callback");
     }
@@ -204,6 +213,7 @@ void SerialBLEInterface::begin(const char* prefix, char* name, uint32_t pin_code
 void SerialBLEInterface::clearBuffers() {
   send_queue_len = 0;
   recv_queue_len = 0;
+  _burst_rx.reset();
   _last_retry_attempt = 0;
   bleuart.flush();
 }
@@ -226,6 +236,45 @@ void SerialBLEInterface::shiftRecvQueueLeft() {
   }
 }
 
+uint16_t SerialBLEInterface::getMaxNotifyLen() const {
+  BLEConnection* conn = Bluefruit.Connection(_conn_handle);
+  uint16_t mtu = conn ? conn->getMtu() : BLE_GATT_ATT_MTU_DEFAULT;
+  if (mtu > BLE_BURST_MTU) mtu = BLE_BURST_MTU;
+  return mtu - 3;   // ATT notify header
+}
+
+void SerialBLEInterface::sendBurst() {
+  uint8_t buf[BLE_BURST_MAX_PAYLOAD];
+  size_t max_len = getMaxNotifyLen();
+  size_t len = 0;
+  uint8_t n = 0;
+  while (n < send_queue_len) {
+    size_t new_len = FrameBatch::append(buf, len, max_len, send_queue[n].buf, send_queue[n].len);
+    if (new_len == 0) break;   // no more room in this notify
+    len = new_len;
+    n++;
+  }
+  if (n == 0) {   // can't happen, burst mode is only enabled if MTU fits a MAX_FRAME_SIZE frame
+    BLE_DEBUG_PRINTLN("ERROR: writeBurst: frame too big for notify (max=%u), dropping", (unsigned)max_len);
+    shiftSendQueueLeft();
+    return;
+  }
+
+  size_t written = bleuart.write(buf, len);
+  if (written == len) {
+    BLE_DEBUG_PRINTLN("writeBurst: frames=%u, sz=%u", (unsigned)n, (unsigned)len);
+    _last_retry_attempt = 0;
+    while (n-- > 0) shiftSendQueueLeft();
+  } else if (written > 0 || !isConnected()) {
+    BLE_DEBUG_PRINTLN("writeBurst: failed, sent=%u of %u, dropping frames", (unsigned)written, (unsigned)len);
+    _last_retry_attempt = 0;
+    while (n-- > 0) shiftSendQueueLeft();
+  } else {
+    BLE_DEBUG_PRINTLN("writeBurst failed (no tx credits), keeping frames for retry");
+    _last_retry_attempt = millis();
+  }
+}
+
 bool SerialBLEInterface::isValidConnection(uint16_t handle, bool requireWaitingForSecurity) const {
   if (_conn_handle != handle) {
     return false;
@@ -304,7 +353,11 @@ size_t SerialBLEInterface::checkRecvFrame(uint8_t dest[]) {
       unsigned long now = millis();
       bool throttle_active = (_last_retry_attempt > 0 && (now - _last_retry_attempt) < BLE_RETRY_THROTTLE_MS);
 
-      if (!throttle_active) {
+      if (throttle_active) {
+        // wait for tx credits to free up
+      } else if (_burst) {
+        sendBurst();
+      } else {
         Frame frame_to_send = send_queue[0];
 
         size_t written = bleuart.write(frame_to_send.buf, frame_to_send.len);
@@ -337,6 +390,20 @@ size_t SerialBLEInterface::checkRecvFrame(uint8_t dest[]) {
     BLE_DEBUG_PRINTLN("readBytes: sz=%u, hdr=%u", (unsigned)len, (unsigned)dest[0]);
     
     shiftRecvQueueLeft();
+
+    if (!_burst && FrameBatch::isHello(dest, len)) {   // app is requesting burst-mode
+      uint16_t max_payload = getMaxNotifyLen();
+      bool ok = FrameBatch::canBurst(max_payload, MAX_FRAME_SIZE);   // else declined, until a larger MTU is negotiated
+      uint8_t reply[4];
+      size_t reply_len = FrameBatch::writeHelloReply(reply, ok ? max_payload : 0);
+      bleuart.write(reply, reply_len);   // NOTE: reply is sent as a legacy (single) frame
+      if (ok) {
+        _burst_rx.reset();
+        _burst = true;
+      }
+      BLE_DEBUG_PRINTLN("burst mode %s, max notify=%u", ok ? "enabled" : "declined", (unsigned)max_payload);
+      return 0;
+    }
     return len;
   }
   
@@ -369,6 +436,28 @@ void SerialBLEInterface::onBleUartRX(uint16_t conn_handle) {
     return;
   }
   
+  if (instance->_burst) {   // envelope(s) of one or more frames. NOTE: consecutive writes may be coalesced in FIFO
+    auto& rx = instance->_burst_rx;   // NOTE: a partial frame is kept here until the next callback
+    while (instance->bleuart.available() > 0) {
+      int avail = instance->bleuart.available();
+      int room = rx.getRoom();
+      rx.added(instance->bleuart.readBytes(rx.getTail(), avail > room ? room : avail));
+
+      const uint8_t* src;
+      int n;
+      while ((n = rx.next(src)) > 0) {
+        if (n > MAX_FRAME_SIZE || instance->recv_queue_len >= FRAME_QUEUE_SIZE) {
+          BLE_DEBUG_PRINTLN("onBleUartRX: burst frame too big, or recv queue full, dropping");
+          continue;
+        }
+        instance->recv_queue[instance->recv_queue_len].len = n;
+        memcpy(instance->recv_queue[instance->recv_queue_len].buf, src, n);
+        instance->recv_queue_len++;
+      }
+    }
+    return;
+  }
+
   while (instance->bleuart.available() > 0) {
     if (instance->recv_queue_len >= FRAME_QUEUE_SIZE) {
       while (instance->bleuart.available() > 0) {
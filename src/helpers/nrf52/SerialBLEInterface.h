@@ -1,12 +1,17 @@
 #pragma once
 
 #include "../BaseSerialInterface.h"
+#include "../FrameBatch.h"
 #include <bluefruit.h>
 
 #ifndef BLE_TX_POWER
 #define BLE_TX_POWER 4
 #endif
 
+// Burst mode: max ATT MTU with BANDWIDTH_MAX config, and notify payload limit
+#define BLE_BURST_MTU              247
+#define BLE_BURST_MAX_PAYLOAD      (BLE_BURST_MTU - 3)
+
 class SerialBLEInterface : public BaseSerialInterface {
   BLEDfu bledfu;
   BLEUart bleuart;
@@ -15,6 +20,8 @@ class SerialBLEInterface : public BaseSerialInterface {
   uint16_t _conn_handle;
   unsigned long _last_health_check;
   unsigned long _last_retry_attempt;
+  volatile bool _burst;   // burst-mode (FrameBatch envelopes) negotiated with app
+  FrameBatchReader<BLE_BURST_MAX_PAYLOAD + 1 + MAX_FRAME_SIZE> _burst_rx;
 
   struct Frame {
     uint8_t len;
@@ -32,6 +39,8 @@ class SerialBLEInterface : public BaseSerialInterface {
   void clearBuffers();
   void shiftSendQueueLeft();
   void shiftRecvQueueLeft();
+  uint16_t getMaxNotifyLen() const;
+  void sendBurst();
   bool isValidConnection(uint16_t handle, bool requireWaitingForSecurity = false) const;
   bool isAdvertising() const;
   static void onConnect(uint16_t connection_handle);
@@ -49,6 +58,7 @@ public:
     _conn_handle = BLE_CONN_HANDLE_INVALID;
     _last_health_check = 0;
     _last_retry_attempt = 0;
+    _burst = false;
     send_queue_len = 0;
     recv_queue_len = 0;
   }
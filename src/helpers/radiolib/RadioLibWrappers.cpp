@@ -11,6 +11,9 @@
 #define NUM_NOISE_FLOOR_SAMPLES  64
 #define SAMPLING_THRESHOLD  14
 
+#define CHANNEL_SAMPLE_MILLIS   250   // how often to sample channel busy state
+#define CHANNEL_BUSY_MARGIN      10   // dB above noise floor, for channel to count as busy
+
 static volatile uint8_t state = STATE_IDLE;
 
 // this function is called when a complete packet
@@ -28,6 +31,7 @@ void RadioLibWrapper::begin() {
   _radio->setPacketReceivedAction(setFlag);  // this is also SentComplete interrupt
   _preamble_sf = getSpreadingFactor();
   _radio->setPreambleLength(preambleLengthForSF(_preamble_sf)); // longer preamble for lower SF improves reliability
+  invalidateAirtime();
   state = STATE_IDLE;
 
   if (_board->getStartupReason() == BD_STARTUP_RX_PACKET) {  // received a LoRa packet (while in deep sleep)
@@ -41,6 +45,11 @@ void RadioLibWrapper::begin() {
   // start average out some samples
   _num_floor_samples = 0;
   _floor_sample_sum = 0;
+
+  _channel.reset();
+  _last_channel_sample = millis();
+  _channel.update(_last_channel_sample);
+  _tx_len = 0;
 }
 
 uint32_t RadioLibWrapper::getRngSeed() {
@@ -85,6 +94,15 @@ void RadioLibWrapper::resetAGC() {
 }
 
 void RadioLibWrapper::loop() {
+  unsigned long now = millis();
+  if (now - _last_channel_sample >= CHANNEL_SAMPLE_MILLIS) {
+    _channel.update(now);
+    if (state == STATE_RX && (isReceivingPacket() || (_noise_floor != 0 && getCurrentRSSI() > _noise_floor + CHANNEL_BUSY_MARGIN))) {
+      _channel.addBusy(now - _last_channel_sample);   // count whole interval since last sample as busy
+    }
+    _last_channel_sample = now;
+  }
+
   if (state == STATE_RX && _num_floor_samples < NUM_NOISE_FLOOR_SAMPLES) {
     if (!isReceivingPacket()) {
       int rssi = getCurrentRSSI();
@@ -99,6 +117,7 @@ void RadioLibWrapper::loop() {
       _noise_floor = -120;    // clamp to lower bound of -120dBi
     }
     _floor_sample_sum = 0;
+    _channel.addNoiseFloor(_noise_floor);
 
     #ifdef MESH_DEBUG_NOISE_FLOOR
     MESH_DEBUG_PRINTLN("RadioLibWrapper: noise_floor = %d", (int)_noise_floor);
@@ -136,6 +155,7 @@ int RadioLibWrapper::recvRaw(uint8_t* bytes, int sz) {
       } else {
       //  Serial.print("  readData() -> "); Serial.println(len);
         n_recv++;
+        _channel.addRecv(getEstAirtimeFor(len));
       }
     }
     #if defined(USE_LR2021)
@@ -157,7 +177,15 @@ int RadioLibWrapper::recvRaw(uint8_t* bytes, int sz) {
 }
 
 uint32_t RadioLibWrapper::getEstAirtimeFor(int len_bytes) {
-  return _radio->getTimeOnAir(len_bytes) / 1000;
+  if (len_bytes < 0 || len_bytes > MAX_TRANS_UNIT) return _radio->getTimeOnAir(len_bytes) / 1000;
+
+  // called several times per packet (rx delay, tx budget, retransmit delays), so only do the float symbol math
+  // once per length, per radio config
+  uint32_t ms = _airtime_ms[len_bytes];
+  if (ms == 0xFFFFFFFF) {
+    ms = _airtime_ms[len_bytes] = _radio->getTimeOnAir(len_bytes) / 1000;
+  }
+  return ms;
 }
 
 bool RadioLibWrapper::startSendRaw(const uint8_t* bytes, int len) {
@@ -165,6 +193,7 @@ bool RadioLibWrapper::startSendRaw(const uint8_t* bytes, int len) {
   int err = _radio->startTransmit((uint8_t *) bytes, len);
   if (err == RADIOLIB_ERR_NONE) {
     state = STATE_TX_WAIT;
+    _tx_len = len;
     return true;
   }
   MESH_DEBUG_PRINTLN("RadioLibWrapper: error: startTransmit(%d)", err);
@@ -177,6 +206,7 @@ bool RadioLibWrapper::isSendComplete() {
   if (state & STATE_INT_READY) {
     state = STATE_IDLE;
     n_sent++;
+    _channel.addSent(getEstAirtimeFor(_tx_len));
     return true;
   }
   return false;
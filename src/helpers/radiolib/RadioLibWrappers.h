@@ -2,6 +2,7 @@
 
 #include <Mesh.h>
 #include <RadioLib.h>
+#include <helpers/ChannelMonitor.h>
 
 #ifdef USE_CC310_HW_CRYPTO
 #include <Adafruit_nRFCrypto.h>
@@ -21,7 +22,12 @@ protected:
   uint16_t _num_floor_samples;
   int32_t _floor_sample_sum;
   uint8_t _preamble_sf;
+  uint32_t _airtime_ms[MAX_TRANS_UNIT + 1];   // getTimeOnAir() by packet length, for current params (0xFFFFFFFF = not known yet)
+  ChannelMonitor _channel;
+  unsigned long _last_channel_sample;
+  int _tx_len;
 
+  void invalidateAirtime() { memset(_airtime_ms, 0xFF, sizeof(_airtime_ms)); }
   void idle();
   void startRecv();
   float packetScoreInt(float snr, int sf, int packet_len);
@@ -29,7 +35,7 @@ protected:
   virtual void doResetAGC();
 
 public:
-  RadioLibWrapper(PhysicalLayer& radio, mesh::MainBoard& board) : _radio(&radio), _board(&board), _preamble_sf(0) { n_recv = n_sent = 0; }
+  RadioLibWrapper(PhysicalLayer& radio, mesh::MainBoard& board) : _radio(&radio), _board(&board), _preamble_sf(0) { n_recv = n_sent = 0; invalidateAirtime(); }
 
   void begin() override;
   virtual void powerOff() { _radio->sleep(); }
@@ -54,7 +60,11 @@ public:
   virtual float getCurrentRSSI() =0;
   virtual uint8_t getSpreadingFactor() const { return LORA_SF; }
   static uint16_t preambleLengthForSF(uint8_t sf) { return sf <= 8 ? 32 : 16; }
-  void updatePreamble(uint8_t sf) { _preamble_sf = sf; _radio->setPreambleLength(preambleLengthForSF(sf)); }
+  void updatePreamble(uint8_t sf) {   // NOTE: all setParams() impls call this last, after SF/BW/CR are changed
+    _preamble_sf = sf;
+    _radio->setPreambleLength(preambleLengthForSF(sf));
+    invalidateAirtime();
+  }
   PacketMillis calcMaxPacketMillis(uint8_t sf, float bw, uint8_t cr, uint8_t preambleSymbols);
   virtual int16_t performChannelScan();
 
@@ -68,7 +78,14 @@ public:
   uint32_t getPacketsRecv() const { return n_recv; }
   uint32_t getPacketsRecvErrors() const { return n_recv_errors; }
   uint32_t getPacketsSent() const { return n_sent; }
-  void resetStats() { n_recv = n_sent = n_recv_errors = 0; }
+  void resetStats() { n_recv = n_sent = n_recv_errors = 0; _channel.reset(); }
+  void registerMetrics(mesh::MetricsRegistry& metrics) override {
+    metrics.addCounter(METRIC_ID_RADIO_RECV, "radio_recv", &n_recv);
+    metrics.addCounter(METRIC_ID_RADIO_SENT, "radio_sent", &n_sent);
+    metrics.addCounter(METRIC_ID_RADIO_RECV_ERRORS, "radio_recv_err", &n_recv_errors);
+  }
+
+  const ChannelMonitor& getChannelMonitor() const { return _channel; }
 
   virtual float getLastRSSI() const override;
   virtual float getLastSNR() const override;
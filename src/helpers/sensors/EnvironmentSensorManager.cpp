@@ -225,7 +225,7 @@ static void scanI2CBus(TwoWire* wire, bool found[128]) {
 }
 
 // ============================================================
-// Per-sensor init and query functions
+// Per-sensor init and read functions
 //
 // init(wire, address) — called only when the address was seen
 //   on the bus. Returns 0 on failure, or the number of
@@ -234,20 +234,30 @@ static void scanI2CBus(TwoWire* wire, bool found[128]) {
 //   hardware channel; MLX90614 and RAK12035+calibration
 //   return 2).
 //
-// query(channel, sub_channel, lpp) — called once per active
-//   sensor entry during querySensors(). sub_channel is always
-//   0 for single-output sensors.
+// read(sub_channel, reading) — called by the scheduler, every
+//   period of the sensor's driver, and the values are cached
+//   for querySensors(). sub_channel is always 0 for
+//   single-output sensors. Returns false if no new values.
+//
+// start(sub_channel) — optional, kicks off a conversion so
+//   read() is called (latency) millis later, instead of
+//   blocking while the sensor converts.
 // ============================================================
 
+#ifndef ENV_SENSOR_PERIOD_MILLIS
+#define ENV_SENSOR_PERIOD_MILLIS  30000   // how often sensors are read, in the background
+#endif
+
 #if ENV_INCLUDE_AHTX0
 static uint8_t init_ahtx0(TwoWire* wire, uint8_t addr) {
   return AHTX0.begin(wire, 0, addr) ? 1 : 0;
 }
-static void query_ahtx0(uint8_t ch, uint8_t, CayenneLPP& lpp) {
+static bool read_ahtx0(uint8_t, SensorReading& r) {
   sensors_event_t humidity, temp;
-  AHTX0.getEvent(&humidity, &temp);
-  lpp.addTemperature(ch, temp.temperature);
-  lpp.addRelativeHumidity(ch, humidity.relative_humidity);
+  if (!AHTX0.getEvent(&humidity, &temp)) return false;
+  r.add(LPP_TEMPERATURE, temp.temperature);
+  r.add(LPP_RELATIVE_HUMIDITY, humidity.relative_humidity);
+  return true;
 }
 #endif
 
@@ -256,36 +266,43 @@ static uint8_t init_bme680(TwoWire*, uint8_t addr) {
   // Wire was set in the static constructor; begin() takes address only.
   return BME680.begin(addr) ? 1 : 0;
 }
-static void query_bme680(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  if (BME680.performReading()) {
-    lpp.addTemperature(ch, BME680.temperature);
-    lpp.addRelativeHumidity(ch, BME680.humidity);
-    const float pressure_hpa = BME680.pressure / 100.0f;
-    lpp.addBarometricPressure(ch, pressure_hpa);
-    lpp.addAltitude(ch, 44330.0f * (1.0f - powf(pressure_hpa / (float)TELEM_BME680_SEALEVELPRESSURE_HPA, 0.1903f)));
-    lpp.addGenericSensor(ch, BME680.gas_resistance);
-  }
+static bool start_bme680(uint8_t) {
+  return BME680.beginReading() != 0;   // gas heater takes ~150ms, so don't wait for it here
+}
+static bool read_bme680(uint8_t, SensorReading& r) {
+  if (!BME680.endReading()) return false;
+  r.add(LPP_TEMPERATURE, BME680.temperature);
+  r.add(LPP_RELATIVE_HUMIDITY, BME680.humidity);
+  const float pressure_hpa = BME680.pressure / 100.0f;
+  r.add(LPP_BAROMETRIC_PRESSURE, pressure_hpa);
+  r.add(LPP_ALTITUDE, 44330.0f * (1.0f - powf(pressure_hpa / (float)TELEM_BME680_SEALEVELPRESSURE_HPA, 0.1903f)));
+  r.add(LPP_GENERIC_SENSOR, BME680.gas_resistance);
+  return true;
 }
 #endif
 
 #if ENV_INCLUDE_BME280
-static uint8_t init_bme280(TwoWire* wire, uint8_t addr) {
-  if (!BME280.begin(addr, wire)) return 0;
+static bool start_bme280(uint8_t) {
+  // writing MODE_FORCED starts one conversion, without waiting for it (as takeForcedMeasurement() does)
   BME280.setSampling(Adafruit_BME280::MODE_FORCED,
                      Adafruit_BME280::SAMPLING_X1,
                      Adafruit_BME280::SAMPLING_X1,
                      Adafruit_BME280::SAMPLING_X1,
                      Adafruit_BME280::FILTER_OFF,
                      Adafruit_BME280::STANDBY_MS_1000);
+  return true;
+}
+static uint8_t init_bme280(TwoWire* wire, uint8_t addr) {
+  if (!BME280.begin(addr, wire)) return 0;
+  start_bme280(0);
   return 1;
 }
-static void query_bme280(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  if (BME280.takeForcedMeasurement()) {
-    lpp.addTemperature(ch, BME280.readTemperature());
-    lpp.addRelativeHumidity(ch, BME280.readHumidity());
-    lpp.addBarometricPressure(ch, BME280.readPressure() / 100);
-    lpp.addAltitude(ch, BME280.readAltitude(TELEM_BME280_SEALEVELPRESSURE_HPA));
-  }
+static bool read_bme280(uint8_t, SensorReading& r) {
+  r.add(LPP_TEMPERATURE, BME280.readTemperature());
+  r.add(LPP_RELATIVE_HUMIDITY, BME280.readHumidity());
+  r.add(LPP_BAROMETRIC_PRESSURE, BME280.readPressure() / 100);
+  r.add(LPP_ALTITUDE, BME280.readAltitude(TELEM_BME280_SEALEVELPRESSURE_HPA));
+  return true;
 }
 #endif
 
@@ -294,10 +311,11 @@ static uint8_t init_bmp280(TwoWire*, uint8_t addr) {
   // BMP280 static instance was constructed with TELEM_WIRE; begin() uses it.
   return BMP280.begin(addr) ? 1 : 0;
 }
-static void query_bmp280(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  lpp.addTemperature(ch, BMP280.readTemperature());
-  lpp.addBarometricPressure(ch, BMP280.readPressure() / 100);
-  lpp.addAltitude(ch, BMP280.readAltitude(TELEM_BMP280_SEALEVELPRESSURE_HPA));
+static bool read_bmp280(uint8_t, SensorReading& r) {
+  r.add(LPP_TEMPERATURE, BMP280.readTemperature());
+  r.add(LPP_BAROMETRIC_PRESSURE, BMP280.readPressure() / 100);
+  r.add(LPP_ALTITUDE, BMP280.readAltitude(TELEM_BMP280_SEALEVELPRESSURE_HPA));
+  return true;
 }
 #endif
 
@@ -306,28 +324,53 @@ static uint8_t init_shtc3(TwoWire* wire, uint8_t) {
   // Adafruit_SHTC3::begin() does not accept an address (fixed at 0x70).
   return SHTC3.begin(wire) ? 1 : 0;
 }
-static void query_shtc3(uint8_t ch, uint8_t, CayenneLPP& lpp) {
+static bool read_shtc3(uint8_t, SensorReading& r) {
   sensors_event_t humidity, temp;
-  SHTC3.getEvent(&humidity, &temp);
-  lpp.addTemperature(ch, temp.temperature);
-  lpp.addRelativeHumidity(ch, humidity.relative_humidity);
+  if (!SHTC3.getEvent(&humidity, &temp)) return false;
+  r.add(LPP_TEMPERATURE, temp.temperature);
+  r.add(LPP_RELATIVE_HUMIDITY, humidity.relative_humidity);
+  return true;
 }
 #endif
 
 #if ENV_INCLUDE_SHT4X
+static TwoWire* sht4x_wire;
+static uint8_t sht4x_addr;
+
 static uint8_t init_sht4x(TwoWire* wire, uint8_t addr) {
   // SensirionI2cSht4x::begin() does not probe the hardware; use serialNumber()
   // as the actual presence check since it performs a real I2C transaction.
   SHT4X.begin(*wire, addr);
+  sht4x_wire = wire;
+  sht4x_addr = addr;
   uint32_t serial = 0;
   return (SHT4X.serialNumber(serial) == 0) ? 1 : 0;
 }
-static void query_sht4x(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  float temperature, humidity;
-  if (SHT4X.measureLowestPrecision(temperature, humidity) == 0) {
-    lpp.addTemperature(ch, temperature);
-    lpp.addRelativeHumidity(ch, humidity);
+// NOTE: the Sensirion driver only has blocking measure*() calls, so the command and result are done here directly
+static bool start_sht4x(uint8_t) {
+  sht4x_wire->beginTransmission(sht4x_addr);
+  sht4x_wire->write(0xE0);   // measure T & RH, lowest precision (same as measureLowestPrecision())
+  return sht4x_wire->endTransmission() == 0;
+}
+static uint8_t sht4x_crc(const uint8_t* data) {
+  uint8_t crc = 0xFF;
+  for (int i = 0; i < 2; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
   }
+  return crc;
+}
+static bool read_sht4x(uint8_t, SensorReading& r) {
+  uint8_t buf[6];   // T msb, lsb, crc, RH msb, lsb, crc
+  if (sht4x_wire->requestFrom(sht4x_addr, (uint8_t) sizeof(buf)) != sizeof(buf)) return false;
+  for (int i = 0; i < 6; i++) buf[i] = sht4x_wire->read();
+  if (sht4x_crc(&buf[0]) != buf[2] || sht4x_crc(&buf[3]) != buf[5]) return false;
+
+  uint16_t t_ticks = (buf[0] << 8) | buf[1];
+  uint16_t rh_ticks = (buf[3] << 8) | buf[4];
+  r.add(LPP_TEMPERATURE, -45.0f + 175.0f * t_ticks / 65535.0f);
+  r.add(LPP_RELATIVE_HUMIDITY, -6.0f + 125.0f * rh_ticks / 65535.0f);
+  return true;
 }
 #endif
 
@@ -336,9 +379,10 @@ static uint8_t init_lps22hb(TwoWire*, uint8_t) {
   // LPS22HBClass is constructed with the wire reference; begin() uses it.
   return LPS22HB.begin() ? 1 : 0;
 }
-static void query_lps22hb(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  lpp.addTemperature(ch, LPS22HB.readTemperature());
-  lpp.addBarometricPressure(ch, LPS22HB.readPressure() * 10); // convert kPa to hPa
+static bool read_lps22hb(uint8_t, SensorReading& r) {
+  r.add(LPP_TEMPERATURE, LPS22HB.readTemperature());
+  r.add(LPP_BAROMETRIC_PRESSURE, LPS22HB.readPressure() * 10); // convert kPa to hPa
+  return true;
 }
 #endif
 
@@ -355,7 +399,7 @@ static uint8_t init_ina3221(TwoWire* wire, uint8_t addr) {
   }
   return enabled > 0 ? enabled : 1;
 }
-static void query_ina3221(uint8_t ch, uint8_t sub_ch, CayenneLPP& lpp) {
+static bool read_ina3221(uint8_t sub_ch, SensorReading& r) {
   // sub_ch is the index of the nth enabled hardware channel.
   uint8_t seen = 0;
   for (int i = 0; i < TELEM_INA3221_NUM_CHANNELS; i++) {
@@ -363,14 +407,15 @@ static void query_ina3221(uint8_t ch, uint8_t sub_ch, CayenneLPP& lpp) {
       if (seen == sub_ch) {
         float v = INA3221.getBusVoltage(i);
         float c = INA3221.getCurrentAmps(i);
-        lpp.addVoltage(ch, v);
-        lpp.addCurrent(ch, c);
-        lpp.addPower(ch, v * c);
-        return;
+        r.add(LPP_VOLTAGE, v);
+        r.add(LPP_CURRENT, c);
+        r.add(LPP_POWER, v * c);
+        return true;
       }
       seen++;
     }
   }
+  return false;
 }
 #endif
 
@@ -379,10 +424,11 @@ static uint8_t init_ina219(TwoWire* wire, uint8_t) {
   // INA219 static instance was constructed with the address; begin() uses it.
   return INA219.begin(wire) ? 1 : 0;
 }
-static void query_ina219(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  lpp.addVoltage(ch, INA219.getBusVoltage_V());
-  lpp.addCurrent(ch, INA219.getCurrent_mA() / 1000.0f);
-  lpp.addPower(ch, INA219.getPower_mW() / 1000.0f);
+static bool read_ina219(uint8_t, SensorReading& r) {
+  r.add(LPP_VOLTAGE, INA219.getBusVoltage_V());
+  r.add(LPP_CURRENT, INA219.getCurrent_mA() / 1000.0f);
+  r.add(LPP_POWER, INA219.getPower_mW() / 1000.0f);
+  return true;
 }
 #endif
 
@@ -390,10 +436,11 @@ static void query_ina219(uint8_t ch, uint8_t, CayenneLPP& lpp) {
 static uint8_t init_ina260(TwoWire* wire, uint8_t addr) {
   return INA260.begin(addr, wire) ? 1 : 0;
 }
-static void query_ina260(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  lpp.addVoltage(ch, INA260.readBusVoltage() / 1000.0f);
-  lpp.addCurrent(ch, INA260.readCurrent() / 1000.0f);
-  lpp.addPower(ch, INA260.readPower() / 1000.0f);
+static bool read_ina260(uint8_t, SensorReading& r) {
+  r.add(LPP_VOLTAGE, INA260.readBusVoltage() / 1000.0f);
+  r.add(LPP_CURRENT, INA260.readCurrent() / 1000.0f);
+  r.add(LPP_POWER, INA260.readPower() / 1000.0f);
+  return true;
 }
 #endif
 
@@ -404,10 +451,11 @@ static uint8_t init_ina226(TwoWire*, uint8_t) {
   INA226.setMaxCurrentShunt(TELEM_INA226_MAX_AMP, TELEM_INA226_SHUNT_VALUE);
   return 1;
 }
-static void query_ina226(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  lpp.addVoltage(ch, INA226.getBusVoltage());
-  lpp.addCurrent(ch, INA226.getCurrent_mA() / 1000.0f);
-  lpp.addPower(ch, INA226.getPower_mW() / 1000.0f);
+static bool read_ina226(uint8_t, SensorReading& r) {
+  r.add(LPP_VOLTAGE, INA226.getBusVoltage());
+  r.add(LPP_CURRENT, INA226.getCurrent_mA() / 1000.0f);
+  r.add(LPP_POWER, INA226.getPower_mW() / 1000.0f);
+  return true;
 }
 #endif
 
@@ -415,11 +463,12 @@ static void query_ina226(uint8_t ch, uint8_t, CayenneLPP& lpp) {
 static uint8_t init_mlx90614(TwoWire* wire, uint8_t addr) {
   return MLX90614.begin(addr, wire) ? 2 : 0;  // 2 channels: object temp, ambient temp
 }
-static void query_mlx90614(uint8_t ch, uint8_t sub_ch, CayenneLPP& lpp) {
+static bool read_mlx90614(uint8_t sub_ch, SensorReading& r) {
   if (sub_ch == 0)
-    lpp.addTemperature(ch, MLX90614.readObjectTempC());
+    r.add(LPP_TEMPERATURE, MLX90614.readObjectTempC());
   else
-    lpp.addTemperature(ch, MLX90614.readAmbientTempC());
+    r.add(LPP_TEMPERATURE, MLX90614.readAmbientTempC());
+  return true;
 }
 #endif
 
@@ -427,10 +476,14 @@ static void query_mlx90614(uint8_t ch, uint8_t sub_ch, CayenneLPP& lpp) {
 static uint8_t init_vl53l0x(TwoWire* wire, uint8_t addr) {
   return VL53L0X.begin(addr, false, wire) ? 1 : 0;
 }
-static void query_vl53l0x(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  VL53L0X_RangingMeasurementData_t measure;
-  VL53L0X.rangingTest(&measure, false);
-  lpp.addDistance(ch, measure.RangeStatus != 4 ? measure.RangeMilliMeter / 1000.0f : 0.0f);
+static bool start_vl53l0x(uint8_t) {
+  return VL53L0X.startRange();   // single ranging, without waiting (as rangingTest() does)
+}
+static bool read_vl53l0x(uint8_t, SensorReading& r) {
+  if (!VL53L0X.isRangeComplete()) return false;
+  uint16_t mm = VL53L0X.readRangeResult();   // 0xFFFF if out of range
+  r.add(LPP_DISTANCE, mm != 0xFFFF ? mm / 1000.0f : 0.0f);
+  return true;
 }
 #endif
 
@@ -438,10 +491,11 @@ static void query_vl53l0x(uint8_t ch, uint8_t, CayenneLPP& lpp) {
 static uint8_t init_bmp085(TwoWire* wire, uint8_t) {
   return BMP085.begin(0, wire) ? 1 : 0;  // mode 0 = ULTRALOWPOWER
 }
-static void query_bmp085(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  lpp.addTemperature(ch, BMP085.readTemperature());
-  lpp.addBarometricPressure(ch, BMP085.readPressure() / 100);
-  lpp.addAltitude(ch, BMP085.readAltitude(TELEM_BMP085_SEALEVELPRESSURE_HPA * 100));
+static bool read_bmp085(uint8_t, SensorReading& r) {
+  r.add(LPP_TEMPERATURE, BMP085.readTemperature());
+  r.add(LPP_BAROMETRIC_PRESSURE, BMP085.readPressure() / 100);
+  r.add(LPP_ALTITUDE, BMP085.readAltitude(TELEM_BMP085_SEALEVELPRESSURE_HPA * 100));
+  return true;
 }
 #endif
 
@@ -456,22 +510,25 @@ static uint8_t init_rak12035(TwoWire* wire, uint8_t addr) {
   return 1;
 #endif
 }
-static void query_rak12035(uint8_t ch, uint8_t sub_ch, CayenneLPP& lpp) {
+static bool read_rak12035(uint8_t sub_ch, SensorReading& r) {
   if (sub_ch == 0) {
-    lpp.addTemperature(ch, RAK12035.get_sensor_temperature());
-    lpp.addPercentage(ch, RAK12035.get_sensor_moisture());
-  } else {
+    r.add(LPP_TEMPERATURE, RAK12035.get_sensor_temperature());
+    r.add(LPP_PERCENTAGE, RAK12035.get_sensor_moisture());
+    return true;
+  }
 #ifdef ENABLE_RAK12035_CALIBRATION
-    float cap = RAK12035.get_sensor_capacitance();
-    float wet = RAK12035.get_humidity_full();
-    float dry = RAK12035.get_humidity_zero();
-    lpp.addFrequency(ch, cap);
-    lpp.addTemperature(ch, wet);
-    lpp.addPower(ch, dry);
-    if (cap > dry) RAK12035.set_humidity_zero(cap);
-    if (cap < wet) RAK12035.set_humidity_full(cap);
+  float cap = RAK12035.get_sensor_capacitance();
+  float wet = RAK12035.get_humidity_full();
+  float dry = RAK12035.get_humidity_zero();
+  r.add(LPP_FREQUENCY, cap);
+  r.add(LPP_TEMPERATURE, wet);
+  r.add(LPP_POWER, dry);
+  if (cap > dry) RAK12035.set_humidity_zero(cap);
+  if (cap < wet) RAK12035.set_humidity_full(cap);
+  return true;
+#else
+  return false;
 #endif
-  }
 }
 #endif
 
@@ -520,24 +577,27 @@ static uint8_t init_bme680_bsec(TwoWire* wire, uint8_t addr) {
   return 1;
 }
 
-static void query_bme680_bsec(uint8_t ch, uint8_t, CayenneLPP& lpp) {
-  if (!bsec_data_ready) return;
-  lpp.addTemperature(ch, bsec_temperature);
-  lpp.addRelativeHumidity(ch, bsec_humidity);
-  lpp.addBarometricPressure(ch, bsec_pressure_hpa);
-  lpp.addAltitude(ch, 44330.0f * (1.0f - powf(bsec_pressure_hpa / (float)TELEM_BME680_SEALEVELPRESSURE_HPA, 0.1903f)));
-  lpp.addGenericSensor(ch, (uint16_t)bsec_iaq_val);
-  lpp.addAnalogInput(ch, (float)bsec_accuracy);
+// BSEC does its own sampling (in loop()), so this just takes its latest outputs
+static bool read_bme680_bsec(uint8_t, SensorReading& r) {
+  if (!bsec_data_ready) return false;
+  r.add(LPP_TEMPERATURE, bsec_temperature);
+  r.add(LPP_RELATIVE_HUMIDITY, bsec_humidity);
+  r.add(LPP_BAROMETRIC_PRESSURE, bsec_pressure_hpa);
+  r.add(LPP_ALTITUDE, 44330.0f * (1.0f - powf(bsec_pressure_hpa / (float)TELEM_BME680_SEALEVELPRESSURE_HPA, 0.1903f)));
+  r.add(LPP_GENERIC_SENSOR, (uint16_t)bsec_iaq_val);
+  r.add(LPP_ANALOG_INPUT, (float)bsec_accuracy);
+  return true;
 }
 #endif
 
 // ============================================================
 // Sensor descriptor table
 //
-// Each entry maps an I2C address to a sensor's init and query
-// functions. Only entries whose ENV_INCLUDE_* guard is defined
-// are compiled in. The sentinel at the end keeps the array
-// non-empty regardless of which sensors are enabled.
+// Each entry maps an I2C address to a sensor's init function,
+// and its driver (sample period, conversion latency, start and
+// read functions). Only entries whose ENV_INCLUDE_* guard is
+// defined are compiled in. The sentinel at the end keeps the
+// array non-empty regardless of which sensors are enabled.
 //
 // Ordering here determines channel assignment at runtime:
 // the first detected+initialized sensor gets channel 2, the
@@ -545,62 +605,62 @@ static void query_bme680_bsec(uint8_t ch, uint8_t, CayenneLPP& lpp) {
 // ============================================================
 
 struct SensorDef {
-  uint8_t     address;
-  const char* name;
-  uint8_t   (*init)(TwoWire* wire, uint8_t address);
-  void      (*query)(uint8_t channel, uint8_t sub_channel, CayenneLPP& telemetry);
+  uint8_t      address;
+  const char*  name;
+  uint8_t    (*init)(TwoWire* wire, uint8_t address);
+  SensorDriver driver;
 };
 
 static const SensorDef SENSOR_TABLE[] = {
 #if ENV_INCLUDE_AHTX0
-  { TELEM_AHTX_ADDRESS,    "AHT10/AHT20", init_ahtx0,    query_ahtx0    },
+  { TELEM_AHTX_ADDRESS,    "AHT10/AHT20", init_ahtx0,    { ENV_SENSOR_PERIOD_MILLIS, 0, NULL, read_ahtx0 } },
 #endif
 #ifdef ENV_INCLUDE_BME680
-  { TELEM_BME680_ADDRESS,  "BME680",       init_bme680,   query_bme680   },
+  { TELEM_BME680_ADDRESS,  "BME680",       init_bme680,   { ENV_SENSOR_PERIOD_MILLIS, 200, start_bme680, read_bme680 } },
 #endif
 #if ENV_INCLUDE_BME680_BSEC
-  { TELEM_BME680_ADDRESS,  "BME680+BSEC",   init_bme680_bsec, query_bme680_bsec },
+  { TELEM_BME680_ADDRESS,  "BME680+BSEC",   init_bme680_bsec, { 3000, 0, NULL, read_bme680_bsec } },   // BSEC LP rate
 #endif
 #if ENV_INCLUDE_BME280
-  { TELEM_BME280_ADDRESS,  "BME280",       init_bme280,   query_bme280   },
+  { TELEM_BME280_ADDRESS,  "BME280",       init_bme280,   { ENV_SENSOR_PERIOD_MILLIS, 12, start_bme280, read_bme280 } },   // x1 oversampling: max 9.3ms
 #endif
 #if ENV_INCLUDE_BMP280
-  { TELEM_BMP280_ADDRESS,  "BMP280",       init_bmp280,   query_bmp280   },
+  { TELEM_BMP280_ADDRESS,  "BMP280",       init_bmp280,   { ENV_SENSOR_PERIOD_MILLIS, 0, NULL, read_bmp280 } },
 #endif
 #if ENV_INCLUDE_SHTC3
-  { 0x70,                  "SHTC3",        init_shtc3,    query_shtc3    },
+  { 0x70,                  "SHTC3",        init_shtc3,    { ENV_SENSOR_PERIOD_MILLIS, 0, NULL, read_shtc3 } },
 #endif
 #if ENV_INCLUDE_SHT4X
-  { TELEM_SHT4X_ADDRESS,   "SHT4X",        init_sht4x,    query_sht4x    },
+  { TELEM_SHT4X_ADDRESS,   "SHT4X",        init_sht4x,    { ENV_SENSOR_PERIOD_MILLIS, 2, start_sht4x, read_sht4x } },
 #endif
 #if ENV_INCLUDE_LPS22HB
-  { 0x5C,                  "LPS22HB",      init_lps22hb,  query_lps22hb  },
+  { 0x5C,                  "LPS22HB",      init_lps22hb,  { ENV_SENSOR_PERIOD_MILLIS, 0, NULL, read_lps22hb } },
 #endif
 #if ENV_INCLUDE_INA3221
-  { TELEM_INA3221_ADDRESS, "INA3221",      init_ina3221,  query_ina3221  },
+  { TELEM_INA3221_ADDRESS, "INA3221",      init_ina3221,  { ENV_SENSOR_PERIOD_MILLIS / 3, 0, NULL, read_ina3221 } },
 #endif
 #if ENV_INCLUDE_INA219
-  { TELEM_INA219_ADDRESS,  "INA219",       init_ina219,   query_ina219   },
+  { TELEM_INA219_ADDRESS,  "INA219",       init_ina219,   { ENV_SENSOR_PERIOD_MILLIS / 3, 0, NULL, read_ina219 } },
 #endif
 #if ENV_INCLUDE_INA260
-  { TELEM_INA260_ADDRESS,  "INA260",       init_ina260,   query_ina260   },
+  { TELEM_INA260_ADDRESS,  "INA260",       init_ina260,   { ENV_SENSOR_PERIOD_MILLIS / 3, 0, NULL, read_ina260 } },
 #endif
 #if ENV_INCLUDE_INA226
-  { TELEM_INA226_ADDRESS,  "INA226",       init_ina226,   query_ina226   },
+  { TELEM_INA226_ADDRESS,  "INA226",       init_ina226,   { ENV_SENSOR_PERIOD_MILLIS / 3, 0, NULL, read_ina226 } },
 #endif
 #if ENV_INCLUDE_MLX90614
-  { TELEM_MLX90614_ADDRESS,"MLX90614",     init_mlx90614, query_mlx90614 },
+  { TELEM_MLX90614_ADDRESS,"MLX90614",     init_mlx90614, { ENV_SENSOR_PERIOD_MILLIS, 0, NULL, read_mlx90614 } },
 #endif
 #if ENV_INCLUDE_VL53L0X
-  { TELEM_VL53L0X_ADDRESS, "VL53L0X",      init_vl53l0x,  query_vl53l0x  },
+  { TELEM_VL53L0X_ADDRESS, "VL53L0X",      init_vl53l0x,  { ENV_SENSOR_PERIOD_MILLIS, 40, start_vl53l0x, read_vl53l0x } },   // default timing budget: 33ms
 #endif
 #ifdef ENV_INCLUDE_BMP085
-  { 0x77,                  "BMP085",       init_bmp085,   query_bmp085   },
+  { 0x77,                  "BMP085",       init_bmp085,   { ENV_SENSOR_PERIOD_MILLIS, 0, NULL, read_bmp085 } },
 #endif
 #if ENV_INCLUDE_RAK12035
-  { TELEM_RAK12035_ADDRESS,"RAK12035",     init_rak12035, query_rak12035 },
+  { TELEM_RAK12035_ADDRESS,"RAK12035",     init_rak12035, { ENV_SENSOR_PERIOD_MILLIS, 0, NULL, read_rak12035 } },
 #endif
-  { 0, nullptr, nullptr, nullptr }  // sentinel — keeps the array non-empty
+  { 0, nullptr, nullptr, { 0, 0, nullptr, nullptr } }  // sentinel — keeps the array non-empty
 };
 
 static const size_t SENSOR_TABLE_SIZE = (sizeof(SENSOR_TABLE) / sizeof(SENSOR_TABLE[0])) - 1;
@@ -637,8 +697,8 @@ bool EnvironmentSensorManager::begin() {
   scanI2CBus(TELEM_WIRE, detected);
 
   // Walk the sensor table and initialize only detected devices.
-  _active_sensor_count = 0;
-  for (size_t i = 0; i < SENSOR_TABLE_SIZE && _active_sensor_count < MAX_ACTIVE_SENSORS; i++) {
+  _scheduler.clear();
+  for (size_t i = 0; i < SENSOR_TABLE_SIZE && _scheduler.getCount() < SENSOR_SCHEDULER_MAX_TASKS; i++) {
     const SensorDef& def = SENSOR_TABLE[i];
     if (!detected[def.address]) {
       MESH_DEBUG_PRINTLN("%s not detected at I2C address %02X", def.name, def.address);
@@ -650,8 +710,8 @@ bool EnvironmentSensorManager::begin() {
       continue;
     }
     MESH_DEBUG_PRINTLN("Found %s at address: %02X", def.name, def.address);
-    for (uint8_t sub = 0; sub < n && _active_sensor_count < MAX_ACTIVE_SENSORS; sub++) {
-      _active_sensors[_active_sensor_count++] = { def.query, sub };
+    for (uint8_t sub = 0; sub < n; sub++) {
+      if (_scheduler.add(&def.driver, sub, millis()) < 0) break;   // first reading is taken in loop()
     }
   }
 
@@ -661,9 +721,31 @@ bool EnvironmentSensorManager::begin() {
 // ============================================================
 // querySensors() — GPS stays on channel 1; each active sensor
 // gets the next available channel in the order it was
-// initialized.
+// initialized. Values come from the latest cached reading, so
+// there is no I2C traffic here (a sensor not yet read, or that
+// failed its last read, is left out).
 // ============================================================
 
+static void addReading(CayenneLPP& lpp, uint8_t ch, const SensorReading& r) {
+  for (int i = 0; i < r.num; i++) {
+    float v = r.values[i];
+    switch (r.types[i]) {
+      case LPP_TEMPERATURE:         lpp.addTemperature(ch, v); break;
+      case LPP_RELATIVE_HUMIDITY:   lpp.addRelativeHumidity(ch, v); break;
+      case LPP_BAROMETRIC_PRESSURE: lpp.addBarometricPressure(ch, v); break;
+      case LPP_ALTITUDE:            lpp.addAltitude(ch, v); break;
+      case LPP_GENERIC_SENSOR:      lpp.addGenericSensor(ch, (uint32_t) v); break;
+      case LPP_VOLTAGE:             lpp.addVoltage(ch, v); break;
+      case LPP_CURRENT:             lpp.addCurrent(ch, v); break;
+      case LPP_POWER:               lpp.addPower(ch, v); break;
+      case LPP_DISTANCE:            lpp.addDistance(ch, v); break;
+      case LPP_PERCENTAGE:          lpp.addPercentage(ch, v); break;
+      case LPP_FREQUENCY:           lpp.addFrequency(ch, v); break;
+      case LPP_ANALOG_INPUT:        lpp.addAnalogInput(ch, v); break;
+    }
+  }
+}
+
 bool EnvironmentSensorManager::querySensors(uint8_t requester_permissions, CayenneLPP& telemetry) {
   next_available_channel = TELEM_CHANNEL_SELF + 1;
 
@@ -672,8 +754,9 @@ bool EnvironmentSensorManager::querySensors(uint8_t requester_permissions, Cayen
   }
 
   if (requester_permissions & TELEM_PERM_ENVIRONMENT) {
-    for (int i = 0; i < _active_sensor_count; i++) {
-      _active_sensors[i].query(next_available_channel, _active_sensors[i].sub_channel, telemetry);
+    for (int i = 0; i < _scheduler.getCount(); i++) {
+      const SensorReading* r = _scheduler.getReading(i);
+      if (r) addReading(telemetry, next_available_channel, *r);
       next_available_channel++;
     }
   }
@@ -892,8 +975,8 @@ void EnvironmentSensorManager::stop_gps() {
 }
 #endif // ENV_INCLUDE_GPS
 
-#if ENV_INCLUDE_GPS || defined(ENV_INCLUDE_BME680_BSEC)
 void EnvironmentSensorManager::loop() {
+  _scheduler.loop(millis());   // at most one sensor read per loop
 
   #if ENV_INCLUDE_GPS
   static unsigned long next_gps_update = 0;
@@ -947,4 +1030,3 @@ void EnvironmentSensorManager::loop() {
   }
   #endif  // ENV_INCLUDE_BME680_BSEC
 }
-#endif // ENV_INCLUDE_GPS || ENV_INCLUDE_BME680_BSEC
@@ -3,20 +3,12 @@
 #include <Mesh.h>
 #include <helpers/SensorManager.h>
 #include <helpers/sensors/LocationProvider.h>
+#include <helpers/sensors/SensorScheduler.h>
 
 class EnvironmentSensorManager : public SensorManager {
 protected:
-  static const int MAX_ACTIVE_SENSORS = 16;
-
-  // Query function pointer + sub-channel index (for multi-channel sensors like INA3221).
-  // Sub-channel is 0 for all single-output sensors.
-  struct ActiveSensor {
-    void    (*query)(uint8_t channel, uint8_t sub_channel, CayenneLPP& telemetry);
-    uint8_t   sub_channel;
-  };
-
-  ActiveSensor _active_sensors[MAX_ACTIVE_SENSORS];
-  int          _active_sensor_count = 0;
+  // one task per active sensor (sub-channel), with its latest reading
+  SensorScheduler _scheduler;
   uint8_t      next_available_channel = TELEM_CHANNEL_SELF + 1;
 
   bool     gps_detected = false;
@@ -43,9 +35,7 @@ public:
   #endif
   bool begin() override;
   bool querySensors(uint8_t requester_permissions, CayenneLPP& telemetry) override;
-  #if ENV_INCLUDE_GPS || defined(ENV_INCLUDE_BME680_BSEC)
   void loop() override;
-  #endif
   int getNumSettings() const override;
   const char* getSettingName(int i) const override;
   const char* getSettingValue(int i) const override;
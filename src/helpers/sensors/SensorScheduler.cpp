@@ -0,0 +1,68 @@
+#include "SensorScheduler.h"
+
+int SensorScheduler::add(const SensorDriver* driver, uint8_t sub_channel, unsigned long now) {
+  if (_num_tasks >= SENSOR_SCHEDULER_MAX_TASKS || driver == 0 || driver->read == 0) return -1;
+
+  Task& t = _tasks[_num_tasks];
+  t.driver = driver;
+  t.sub_channel = sub_channel;
+  t.state = IDLE;
+  t.valid = false;
+  t.due = t.started = t.read_at = now;
+  t.reading.reset();
+  return _num_tasks++;
+}
+
+bool SensorScheduler::loop(unsigned long now) {
+  // find the task which has been due the longest
+  Task* next = 0;
+  for (int i = 0; i < _num_tasks; i++) {
+    Task* t = &_tasks[i];
+    if ((long)(now - t->due) < 0) continue;   // not due yet
+    if (next == 0 || (long)(t->due - next->due) < 0) next = t;
+  }
+  if (next == 0) return false;
+
+  const SensorDriver* d = next->driver;
+  if (next->state == IDLE) {
+    next->started = now;
+    if (d->start) {
+      if (d->start(next->sub_channel)) {
+        next->state = CONVERTING;
+        next->due = now + d->latency_millis;
+      } else {
+        next->due = now + d->period_millis;   // try again next period
+      }
+      return true;
+    }
+    // no conversion to wait for, so read now
+  }
+
+  SensorReading r;
+  r.reset();
+  if (d->read(next->sub_channel, r)) {
+    next->reading = r;
+    next->valid = true;
+    next->read_at = now;
+  }
+  next->state = IDLE;
+  next->due = next->started + d->period_millis;    // keep to period, regardless of latency
+  if ((long)(now - next->due) >= 0) next->due = now + d->period_millis;   // fallen behind
+  return true;
+}
+
+void SensorScheduler::requestAll(unsigned long now) {
+  for (int i = 0; i < _num_tasks; i++) {
+    if (_tasks[i].state == IDLE) _tasks[i].due = now;
+  }
+}
+
+unsigned long SensorScheduler::millisUntilNext(unsigned long now) const {
+  unsigned long best = 0xFFFFFFFF;
+  for (int i = 0; i < _num_tasks; i++) {
+    long diff = (long)(_tasks[i].due - now);
+    unsigned long wait = diff > 0 ? (unsigned long) diff : 0;
+    if (wait < best) best = wait;
+  }
+  return best;
+}
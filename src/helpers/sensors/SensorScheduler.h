@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifndef SENSOR_SCHEDULER_MAX_TASKS
+  #define SENSOR_SCHEDULER_MAX_TASKS   16
+#endif
+#ifndef SENSOR_MAX_VALUES
+  #define SENSOR_MAX_VALUES             6    // values per reading, eg. temperature, humidity, pressure, ...
+#endif
+
+/**
+ * \brief  latest values read from a sensor, each tagged with its LPP_* type
+ */
+struct SensorReading {
+  uint8_t num;
+  uint8_t types[SENSOR_MAX_VALUES];
+  float values[SENSOR_MAX_VALUES];
+
+  void reset() { num = 0; }
+  bool add(uint8_t lpp_type, float value) {
+    if (num >= SENSOR_MAX_VALUES) return false;
+    types[num] = lpp_type;
+    values[num++] = value;
+    return true;
+  }
+};
+
+/**
+ * \brief  Declares how a sensor is sampled. If start() is given, it kicks off a conversion, and read() is called
+ *      (at least) 'latency_millis' later, without waiting in between.
+ */
+struct SensorDriver {
+  uint32_t period_millis;     // how often to sample
+  uint32_t latency_millis;    // conversion time, between start() and read()
+  bool (*start)(uint8_t sub_channel);                          // optional, return false if sensor failed
+  bool (*read)(uint8_t sub_channel, SensorReading& dest);     // return false if no new reading
+};
+
+/**
+ * \brief  Runs sensor conversions in the background of the main loop, and caches the latest reading of each,
+ *      so telemetry requests are answered from the cache (with no I2C traffic).
+ *
+ *   Each loop() does at most one sensor step (a start(), or a read()), the one which has been due the longest,
+ *   so a number of slow sensors are spread over many loop()s rather than stalling one.
+ */
+class SensorScheduler {
+  enum State { IDLE = 0, CONVERTING };
+
+  struct Task {
+    const SensorDriver* driver;
+    uint8_t sub_channel;
+    uint8_t state;
+    bool valid;
+    unsigned long due;          // when next step is due
+    unsigned long started;      // when current sample was started
+    unsigned long read_at;
+    SensorReading reading;
+  };
+
+  Task _tasks[SENSOR_SCHEDULER_MAX_TASKS];
+  int _num_tasks;
+
+public:
+  SensorScheduler() : _num_tasks(0) { }
+
+  /**
+   * \returns  task index, or -1 if full. First sample is due straight away.
+   */
+  int add(const SensorDriver* driver, uint8_t sub_channel, unsigned long now);
+  void clear() { _num_tasks = 0; }
+  int getCount() const { return _num_tasks; }
+
+  /**
+   * \returns  true if a sensor step was done
+   */
+  bool loop(unsigned long now);
+
+  /**
+   * \brief  makes all sensors due now (eg. for an up-to-date reading on demand)
+   */
+  void requestAll(unsigned long now);
+
+  /**
+   * \returns  latest reading of task 'i', or NULL if none yet
+   */
+  const SensorReading* getReading(int i) const { return _tasks[i].valid ? &_tasks[i].reading : 0; }
+  unsigned long getReadingAge(int i, unsigned long now) const { return now - _tasks[i].read_at; }
+  uint8_t getSubChannel(int i) const { return _tasks[i].sub_channel; }
+
+  /**
+   * \returns  millis until the next sensor step is due (zero if overdue), or 0xFFFFFFFF if no sensors
+   */
+  unsigned long millisUntilNext(unsigned long now) const;
+};
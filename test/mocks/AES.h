@@ -2,12 +2,23 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
-// Mock AES128 class for testing
-// Provides minimal interface to allow Utils.cpp to compile
+// Mock AES128 class for testing — deterministic, keyed, invertible, but not cryptographic.
+// Provides minimal interface to allow Utils.cpp (and bridge ciphers) to compile and round-trip.
 class AES128 {
+  uint8_t _key[16];
 public:
-  void setKey(const uint8_t* key, size_t keySize) {}
-  void encryptBlock(uint8_t* output, const uint8_t* input) {}
-  void decryptBlock(uint8_t* output, const uint8_t* input) {}
+  AES128() { memset(_key, 0, sizeof(_key)); }
+  bool setKey(const uint8_t* key, size_t keySize) {
+    memset(_key, 0, sizeof(_key));
+    memcpy(_key, key, keySize < 16 ? keySize : 16);
+    return true;
+  }
+  void encryptBlock(uint8_t* output, const uint8_t* input) {
+    for (int i = 0; i < 16; i++) output[i] = (input[i] ^ _key[i]) + (uint8_t)(i * 0x3B);
+  }
+  void decryptBlock(uint8_t* output, const uint8_t* input) {
+    for (int i = 0; i < 16; i++) output[i] = (uint8_t)(input[i] - (uint8_t)(i * 0x3B)) ^ _key[i];
+  }
 };
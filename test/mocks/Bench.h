@@ -0,0 +1,28 @@
+#pragma once
+
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+
+// Timing helpers for the benchmark tests. Results are printed for
+// information only, as timings are too noisy to assert on.
+
+typedef std::chrono::steady_clock::time_point BenchTime;
+
+inline BenchTime benchNow() {
+    return std::chrono::steady_clock::now();
+}
+
+inline double elapsedMicros(BenchTime since) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since).count();
+}
+
+// prints one result line, in the style of the gtest output
+inline void benchPrint(const char* fmt, ...) {
+    printf("[ BENCH    ] ");
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+    printf("\n");
+}
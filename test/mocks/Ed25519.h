@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <ed_25519.h>
+
+// Mock of the Crypto library's Ed25519 class for native testing,
+// verifying with lib/ed25519 instead.
+
+class Ed25519 {
+public:
+    static bool verify(const uint8_t* signature, const uint8_t* publicKey, const void* message, size_t len) {
+        return ed25519_verify(signature, (const unsigned char*) message, len, publicKey) == 1;
+    }
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Mock in-memory filesystem for native testing
+// Provides the subset of the ESP32 fs::FS / fs::File API used by helpers
+
+namespace fs {
+
+class File {
+    std::shared_ptr<std::vector<uint8_t>> _data;
+    size_t _pos;
+public:
+    File() : _pos(0) { }
+    File(std::shared_ptr<std::vector<uint8_t>> data, size_t pos) : _data(data), _pos(pos) { }
+
+    operator bool() const { return _data != nullptr; }
+    size_t size() const { return _data ? _data->size() : 0; }
+    size_t position() const { return _pos; }
+
+    bool seek(uint32_t pos) {
+        if (!_data || pos > _data->size()) return false;
+        _pos = pos;
+        return true;
+    }
+    size_t read(uint8_t* buf, size_t len) {
+        if (!_data || _pos >= _data->size()) return 0;
+        if (len > _data->size() - _pos) len = _data->size() - _pos;
+        memcpy(buf, &(*_data)[_pos], len);
+        _pos += len;
+        return len;
+    }
+    size_t write(const uint8_t* buf, size_t len) {
+        if (!_data) return 0;
+        if (_pos + len > _data->size()) _data->resize(_pos + len);
+        memcpy(&(*_data)[_pos], buf, len);
+        _pos += len;
+        return len;
+    }
+    void close() { _data.reset(); }
+};
+
+class FS {
+    std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> _files;
+public:
+    File open(const char* path, const char* mode = "r", bool create = false) {
+        auto it = _files.find(path);
+        if (mode[0] == 'w' || (it == _files.end() && create)) {
+            auto data = std::make_shared<std::vector<uint8_t>>();
+            _files[path] = data;
+            return File(data, 0);
+        }
+        if (it == _files.end()) return File();
+        return File(it->second, mode[0] == 'a' ? it->second->size() : 0);
+    }
+    bool exists(const char* path) const { return _files.count(path) > 0; }
+    bool remove(const char* path) { return _files.erase(path) > 0; }
+    bool mkdir(const char* path) { return true; }
+};
+
+}
+
+using fs::FS;
+using fs::File;
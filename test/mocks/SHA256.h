@@ -25,11 +25,23 @@ public:
   }
 
   void finalize(uint8_t* hash, size_t hashLen) {
+    // FNV-1a fold, so every output byte depends on every input byte
+    uint32_t h = 2166136261u ^ (uint32_t)_len;
     for (size_t i = 0; i < hashLen; i++) {
-      hash[i] = _state[i % 32];
+      for (size_t j = 0; j < 32; j++) h = (h ^ _state[j]) * 16777619u;
+      hash[i] = (uint8_t)(h >> 24);
+      h ^= i;
     }
   }
 
-  void resetHMAC(const uint8_t* key, size_t keyLen) {}
-  void finalizeHMAC(const uint8_t* key, size_t keyLen, uint8_t* hash, size_t hashLen) {}
+  // keyed variant, so a MAC computed with the wrong key won't match
+  void resetHMAC(const uint8_t* key, size_t keyLen) {
+    memset(_state, 0, sizeof(_state));
+    _len = 0;
+    update(key, keyLen);
+  }
+  void finalizeHMAC(const uint8_t* key, size_t keyLen, uint8_t* hash, size_t hashLen) {
+    update(key, keyLen);
+    finalize(hash, hashLen);
+  }
 };
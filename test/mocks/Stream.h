@@ -45,7 +45,7 @@ public:
     size_t print(char c) { return write(c); }
     size_t print(const char* str) { return write(str); }
 
-    //size_t println(void)  { return 0; }
+    size_t println(void)  { return write("\r\n"); }
     
     virtual void flush() { /* Empty implementation for backward compatibility */ }    
 };
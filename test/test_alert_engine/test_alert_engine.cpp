@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "helpers/AlertEngine.h"
+
+#define MASK_ALL    ((1 << ALERT_PRI_LOW) | (1 << ALERT_PRI_HIGH))
+#define MASK_HI     (1 << ALERT_PRI_HIGH)
+
+TEST(AlertEngine, FiresOnceOnRisingEdge) {
+    AlertEngine e;
+    AlertTrigger t;
+    e.check(t, false, ALERT_PRI_HIGH, "Door open", 1000);
+    EXPECT_EQ(0, e.getNumPending());
+
+    e.check(t, true, ALERT_PRI_HIGH, "Door open", 1010);
+    e.check(t, true, ALERT_PRI_HIGH, "Door open", 1020);
+    EXPECT_TRUE(t.isTriggered());
+    EXPECT_EQ(1, e.getNumPending());
+
+    e.check(t, false, ALERT_PRI_HIGH, "Door open", 1030);   // cleared before sent
+    EXPECT_FALSE(t.isTriggered());
+    EXPECT_EQ(0, e.getNumPending());
+}
+
+TEST(AlertEngine, Hysteresis) {
+    AlertEngine e;
+    e.setMinRepeatSecs(0);
+    AlertTrigger t;
+    uint32_t now = 1000;
+
+    e.checkBelow(t, 3.39f, 3.4f, 0.1f, ALERT_PRI_HIGH, "Batt low", now++);
+    EXPECT_TRUE(t.isTriggered());
+    e.beginBatch(now);
+    e.endBatch();
+
+    // noise around the threshold doesn't re-alert
+    e.checkBelow(t, 3.41f, 3.4f, 0.1f, ALERT_PRI_HIGH, "Batt low", now++);
+    e.checkBelow(t, 3.39f, 3.4f, 0.1f, ALERT_PRI_HIGH, "Batt low", now++);
+    e.checkBelow(t, 3.45f, 3.4f, 0.1f, ALERT_PRI_HIGH, "Batt low", now++);
+    EXPECT_TRUE(t.isTriggered());
+    EXPECT_EQ(0, e.getNumPending());
+
+    e.checkBelow(t, 3.55f, 3.4f, 0.1f, ALERT_PRI_HIGH, "Batt low", now++);   // past hysteresis band
+    EXPECT_FALSE(t.isTriggered());
+    e.checkBelow(t, 3.35f, 3.4f, 0.1f, ALERT_PRI_HIGH, "Batt low", now++);
+    EXPECT_EQ(1, e.getNumPending());
+
+    AlertTrigger hot;
+    e.checkAbove(hot, 40.5f, 40.0f, 2.0f, ALERT_PRI_LOW, "Hot", now++);
+    e.checkAbove(hot, 38.5f, 40.0f, 2.0f, ALERT_PRI_LOW, "Hot", now++);
+    EXPECT_TRUE(hot.isTriggered());
+    e.checkAbove(hot, 37.5f, 40.0f, 2.0f, ALERT_PRI_LOW, "Hot", now++);
+    EXPECT_FALSE(hot.isTriggered());
+}
+
+TEST(AlertEngine, RateLimit) {
+    AlertEngine e;
+    e.setMinRepeatSecs(600);
+    AlertTrigger t;
+
+    e.check(t, true, ALERT_PRI_LOW, "Flap", 1000);
+    EXPECT_EQ(1, e.beginBatch(1000));
+    e.endBatch();
+
+    // flapping sensor, inside rate limit
+    e.check(t, false, ALERT_PRI_LOW, "Flap", 1100);
+    e.check(t, true, ALERT_PRI_LOW, "Flap", 1200);
+    EXPECT_EQ(0, e.getNumPending());
+
+    // still active once rate limit has passed, so now alerts
+    e.check(t, true, ALERT_PRI_LOW, "Flap", 1600);
+    EXPECT_EQ(1, e.getNumPending());
+
+    // per-trigger override
+    AlertTrigger fast;
+    e.check(fast, true, ALERT_PRI_LOW, "Fast", 2000, 10);
+    e.beginBatch(2000);
+    e.endBatch();
+    e.check(fast, false, ALERT_PRI_LOW, "Fast", 2005);
+    e.check(fast, true, ALERT_PRI_LOW, "Fast", 2010, 10);
+    EXPECT_TRUE(fast.pending);
+}
+
+TEST(AlertEngine, CoalescesPerRecipient) {
+    AlertEngine e;
+    AlertTrigger a, b, c;
+    e.check(a, true, ALERT_PRI_LOW, "Batt low", 100);
+    e.check(b, true, ALERT_PRI_HIGH, "Temp high", 100);
+    e.check(c, true, ALERT_PRI_LOW, "Door open", 100);
+
+    EXPECT_EQ(3, e.beginBatch(100));
+    EXPECT_EQ(0, e.getNumPending());
+
+    char text[ALERT_BATCH_TEXT + 1];
+    EXPECT_EQ(ALERT_PRI_HIGH, e.formatBatch(text, sizeof(text), MASK_ALL));
+    EXPECT_STREQ("Temp high\nBatt low\nDoor open", text);    // high priority first
+
+    EXPECT_EQ(ALERT_PRI_HIGH, e.formatBatch(text, sizeof(text), MASK_HI));
+    EXPECT_STREQ("Temp high", text);
+
+    EXPECT_EQ(ALERT_PRI_LOW, e.formatBatch(text, sizeof(text), 1 << ALERT_PRI_LOW));
+    EXPECT_STREQ("Batt low\nDoor open", text);
+
+    EXPECT_EQ(-1, e.formatBatch(text, sizeof(text), 0));
+    EXPECT_STREQ("", text);
+}
+
+TEST(AlertEngine, BatchLimitedToOneMessage) {
+    AlertEngine e;
+    AlertTrigger t[ALERT_MAX_PENDING + 1];
+    char name[ALERT_MAX_TEXT];
+    for (int i = 0; i <= ALERT_MAX_PENDING; i++) {
+        memset(name, 'a' + i, sizeof(name) - 1);
+        name[sizeof(name) - 1] = 0;
+        e.check(t[i], true, ALERT_PRI_LOW, name, 100);
+    }
+    EXPECT_EQ(ALERT_MAX_PENDING, e.getNumPending());   // queue full, last one dropped
+
+    int n = e.beginBatch(100);
+    EXPECT_EQ(ALERT_BATCH_TEXT / ALERT_MAX_TEXT, n);
+    EXPECT_EQ(ALERT_MAX_PENDING - n, e.getNumPending());   // rest wait for next batch
+
+    char text[ALERT_BATCH_TEXT + 1];
+    e.formatBatch(text, sizeof(text), MASK_ALL);
+    EXPECT_LE(strlen(text), (size_t)ALERT_BATCH_TEXT);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#define ED25519_NO_SEED  1
+#include <ed_25519.h>
+extern "C" {
+#include <ge.h>
+#include <sc.h>
+#include <sha512.h>
+#include "Bench.h"
+}
+
+#define MAX_SIGS  64
+
+struct SignedMsg {
+    uint8_t pub[32], prv[64], sig[64], msg[100];
+    size_t msg_len;
+};
+
+static SignedMsg sigs[MAX_SIGS];
+static const unsigned char* sig_ptrs[MAX_SIGS];
+static const unsigned char* msg_ptrs[MAX_SIGS];
+static const unsigned char* key_ptrs[MAX_SIGS];
+static size_t msg_lens[MAX_SIGS];
+static uint8_t rand_bytes[MAX_SIGS * 16];
+
+static void makeSigs(int n) {
+    for (int i = 0; i < n; i++) {
+        SignedMsg& s = sigs[i];
+        uint8_t seed[32];
+        for (int j = 0; j < 32; j++) seed[j] = i * 37 + j;
+        ed25519_create_keypair(s.pub, s.prv, seed);
+        s.msg_len = 36 + (i % 64);   // like an advert: pub_key + timestamp + app_data
+        for (size_t j = 0; j < s.msg_len; j++) s.msg[j] = i ^ (j * 13);
+        ed25519_sign(s.sig, s.msg, s.msg_len, s.pub, s.prv);
+
+        sig_ptrs[i] = s.sig; msg_ptrs[i] = s.msg; key_ptrs[i] = s.pub; msg_lens[i] = s.msg_len;
+    }
+    for (int i = 0; i < n * 16; i++) rand_bytes[i] = (uint8_t)(i * 151 + 7);
+}
+
+TEST(BatchVerify, AllValid) {
+    makeSigs(10);
+    int valid[10];
+    EXPECT_EQ(1, ed25519_verify_batch(sig_ptrs, msg_ptrs, msg_lens, key_ptrs, 10, rand_bytes, valid));
+    for (int i = 0; i < 10; i++) EXPECT_EQ(1, valid[i]) << i;
+
+    EXPECT_EQ(1, ed25519_verify_batch(sig_ptrs, msg_ptrs, msg_lens, key_ptrs, 1, rand_bytes, NULL));
+}
+
+TEST(BatchVerify, FindsForgedSignature) {
+    makeSigs(10);
+    sigs[6].sig[40] ^= 0x01;    // S tampered
+    sigs[2].msg[5] ^= 0x80;     // message tampered
+
+    int valid[10];
+    EXPECT_EQ(0, ed25519_verify_batch(sig_ptrs, msg_ptrs, msg_lens, key_ptrs, 10, rand_bytes, valid));
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ((i == 6 || i == 2) ? 0 : 1, valid[i]) << i;
+    }
+    EXPECT_EQ(0, ed25519_verify_batch(sig_ptrs, msg_ptrs, msg_lens, key_ptrs, 10, rand_bytes, NULL));
+}
+
+TEST(BatchVerify, WrongKey) {
+    makeSigs(3);
+    key_ptrs[1] = sigs[0].pub;
+    int valid[3];
+    EXPECT_EQ(0, ed25519_verify_batch(sig_ptrs, msg_ptrs, msg_lens, key_ptrs, 3, rand_bytes, valid));
+    EXPECT_EQ(1, valid[0]);
+    EXPECT_EQ(0, valid[1]);
+    EXPECT_EQ(1, valid[2]);
+}
+
+// signs with R' = R + T, where T = (0, -1) is the point of order 2. Only the key's owner can do this
+static void signWithTorsion(SignedMsg& s) {
+    uint8_t nonce[64], r[32], R[32], h[64];
+    for (int i = 0; i < 64; i++) nonce[i] = (uint8_t)(s.msg[i % s.msg_len] + i);
+    sc_reduce(nonce);
+    memcpy(r, nonce, 32);
+    ge_p3 P;
+    ge_scalarmult_base(&P, r);
+    ge_p3_tobytes(R, &P);
+
+    // (x, y) + (0, -1) = (-x, -y): y' = p - y, and the sign of x flips
+    static const uint8_t p[32] = { 0xed, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                   0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f };
+    uint8_t sign = R[31] & 0x80;
+    R[31] &= 0x7f;
+    int borrow = 0;
+    for (int i = 0; i < 32; i++) {
+        int d = p[i] - R[i] - borrow;
+        borrow = d < 0;
+        s.sig[i] = (uint8_t) d;
+    }
+    s.sig[31] |= sign ^ 0x80;
+
+    sha512_context hash;
+    sha512_init(&hash);
+    sha512_update(&hash, s.sig, 32);
+    sha512_update(&hash, s.pub, 32);
+    sha512_update(&hash, s.msg, s.msg_len);
+    sha512_final(&hash, h);
+    sc_reduce(h);
+    sc_muladd(&s.sig[32], h, s.prv, r);   // S = r + h*a
+}
+
+TEST(BatchVerify, TorsionInR_SameAsIndividual) {
+    makeSigs(3);
+    signWithTorsion(sigs[0]);
+    signWithTorsion(sigs[1]);
+
+    // a cofactorless batch would pass this pair (z0*T + z1*T == 0, as both z are odd), while each alone fails.
+    // Cofactored, the batch agrees with the individual (cofactored) checks, whatever else is in it
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(0, ed25519_verify(sigs[i].sig, sigs[i].msg, sigs[i].msg_len, sigs[i].pub)) << i;
+        EXPECT_EQ(1, ed25519_verify_cofactored(sigs[i].sig, sigs[i].msg, sigs[i].msg_len, sigs[i].pub)) << i;
+        EXPECT_EQ(1, ed25519_verify_batch(&sig_ptrs[i], &msg_ptrs[i], &msg_lens[i], &key_ptrs[i], 1, rand_bytes, NULL)) << i;
+    }
+    EXPECT_EQ(1, ed25519_verify_batch(sig_ptrs, msg_ptrs, msg_lens, key_ptrs, 2, rand_bytes, NULL));
+    EXPECT_EQ(1, ed25519_verify_batch(&sig_ptrs[1], &msg_ptrs[1], &msg_lens[1], &key_ptrs[1], 2, rand_bytes, NULL));
+
+    sigs[1].sig[40] ^= 0x01;   // now one bad
+    int valid[3];
+    EXPECT_EQ(0, ed25519_verify_batch(sig_ptrs, msg_ptrs, msg_lens, key_ptrs, 3, rand_bytes, valid));
+    EXPECT_EQ(1, valid[0]);
+    EXPECT_EQ(0, valid[1]);
+    EXPECT_EQ(1, valid[2]);
+}
+
+TEST(BatchVerify, Benchmark_BatchSizes) {
+    makeSigs(MAX_SIGS);
+    const int ROUNDS = 4;
+    int ok = 0;
+
+    auto t0 = benchNow();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < MAX_SIGS; i++) ok += ed25519_verify(sig_ptrs[i], msg_ptrs[i], msg_lens[i], key_ptrs[i]);
+    }
+    double single_us = elapsedMicros(t0) / (ROUNDS * MAX_SIGS);
+    EXPECT_EQ(ROUNDS * MAX_SIGS, ok);
+    benchPrint("individual: %.1f us/sig", single_us);
+
+    const int sizes[] = { 1, 4, 16, 64 };
+    for (int n : sizes) {
+        t0 = benchNow();
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i + n <= MAX_SIGS; i += n) {
+                EXPECT_EQ(1, ed25519_verify_batch(&sig_ptrs[i], &msg_ptrs[i], &msg_lens[i], &key_ptrs[i], n, &rand_bytes[i * 16], NULL));
+            }
+        }
+        double us = elapsedMicros(t0) / (ROUNDS * MAX_SIGS);
+        benchPrint("batch of %2d: %.1f us/sig (%.2fx)", n, us, single_us / us);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
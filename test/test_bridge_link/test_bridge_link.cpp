@@ -0,0 +1,360 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "helpers/bridges/BridgeLink.h"
+
+#ifdef __linux__
+  #include <pty.h>      // openpty(), in libc since glibc 2.34 (-lutil before that)
+  #include <sys/ioctl.h>
+  #include <termios.h>
+  #include <unistd.h>
+#endif
+
+// One direction of a wire: written frames land in the peer's fifo, unless dropped/corrupted
+class WireStream : public Stream {
+    std::deque<uint8_t> _fifo;
+public:
+    WireStream* peer = nullptr;
+    int drop_next = 0;       // drop this many upcoming writes (whole frames)
+    bool corrupt_next = false;
+    int writes = 0;
+
+    size_t write(const uint8_t* buf, size_t len) override {
+        writes++;
+        if (drop_next > 0) { drop_next--; return len; }
+        for (size_t i = 0; i < len; i++) {
+            uint8_t b = buf[i];
+            if (corrupt_next && i == len / 2) { b ^= 0x55; corrupt_next = false; }
+            peer->_fifo.push_back(b);
+        }
+        return len;
+    }
+    int available() override { return _fifo.size(); }
+    int read() override {
+        if (_fifo.empty()) return -1;
+        int c = _fifo.front(); _fifo.pop_front();
+        return c;
+    }
+};
+
+class Collector : public BridgeLinkCallbacks {
+public:
+    std::vector<std::vector<uint8_t>> packets;
+    void onLinkPacketRecv(const uint8_t* raw, uint16_t len) override {
+        packets.emplace_back(raw, raw + len);
+    }
+};
+
+struct LinkPair {
+    WireStream sa, sb;
+    Collector ca, cb;
+    BridgeLink a, b;
+
+    LinkPair() : a(sa, &ca), b(sb, &cb) {
+        sa.peer = &sb;  sb.peer = &sa;
+        g_mock_millis = 1000;
+        a.begin(115200, 1);
+        b.begin(115200, 2);
+    }
+    void pump(int rounds = 4) {
+        for (int i = 0; i < rounds; i++) { a.loop(); b.loop(); }
+    }
+};
+
+static std::vector<uint8_t> makePacket(uint8_t tag, size_t len) {
+    std::vector<uint8_t> p(len, tag);
+    p[0] = tag;
+    return p;
+}
+
+TEST(BridgeLink, CRC32_KnownVector) {
+    EXPECT_EQ(0xCBF43926u, BridgeLink::crc32((const uint8_t*)"123456789", 9));
+}
+
+TEST(BridgeLink, RoundTrip_AckedBothWays) {
+    LinkPair lp;
+    auto p1 = makePacket(1, 40), p2 = makePacket(2, 200);
+    ASSERT_TRUE(lp.a.queuePacket(p1.data(), p1.size()));
+    ASSERT_TRUE(lp.b.queuePacket(p2.data(), p2.size()));
+    lp.pump();
+
+    ASSERT_EQ(1u, lp.cb.packets.size());
+    EXPECT_EQ(p1, lp.cb.packets[0]);
+    ASSERT_EQ(1u, lp.ca.packets.size());
+    EXPECT_EQ(p2, lp.ca.packets[0]);
+
+    // nothing left to retransmit, even after timeout
+    g_mock_millis += 10000;
+    lp.pump();
+    EXPECT_EQ(0u, lp.a.getRetransmits());
+    EXPECT_EQ(0u, lp.b.getRetransmits());
+    EXPECT_EQ(1u, lp.cb.packets.size());
+}
+
+TEST(BridgeLink, WindowFull_BatchesPackets) {
+    LinkPair lp;
+    for (int i = 0; i < BRIDGE_LINK_WINDOW + 3; i++) {
+        auto p = makePacket(i + 1, 30);
+        ASSERT_TRUE(lp.a.queuePacket(p.data(), p.size()));
+    }
+    // window worth of frames sent, remainder waits in one batch
+    EXPECT_EQ((uint32_t)BRIDGE_LINK_WINDOW, lp.a.getFramesSent());
+    lp.pump();
+
+    EXPECT_EQ((uint32_t)BRIDGE_LINK_WINDOW + 1, lp.a.getFramesSent());
+    ASSERT_EQ((size_t)BRIDGE_LINK_WINDOW + 3, lp.cb.packets.size());
+    for (int i = 0; i < BRIDGE_LINK_WINDOW + 3; i++) {
+        EXPECT_EQ(i + 1, lp.cb.packets[i][0]);
+    }
+}
+
+TEST(BridgeLink, LostFrame_SelectivelyRetransmitted) {
+    LinkPair lp;
+    auto p1 = makePacket(1, 20), p2 = makePacket(2, 20), p3 = makePacket(3, 20);
+    lp.a.queuePacket(p1.data(), p1.size());
+    lp.sa.drop_next = 1;
+    lp.a.queuePacket(p2.data(), p2.size());
+    lp.a.queuePacket(p3.data(), p3.size());
+    lp.pump();
+
+    ASSERT_EQ(2u, lp.cb.packets.size());   // 1 and 3, delivered out of order
+    EXPECT_EQ(0u, lp.a.getRetransmits());
+
+    g_mock_millis += 5000;
+    lp.pump();
+    ASSERT_EQ(3u, lp.cb.packets.size());
+    EXPECT_EQ(p2, lp.cb.packets[2]);
+    EXPECT_EQ(1u, lp.a.getRetransmits());   // only the lost frame was re-sent
+
+    g_mock_millis += 5000;
+    lp.pump();
+    EXPECT_EQ(1u, lp.a.getRetransmits());
+    EXPECT_EQ(3u, lp.cb.packets.size());
+}
+
+TEST(BridgeLink, CorruptFrame_CountedAndRecovered) {
+    LinkPair lp;
+    auto p1 = makePacket(7, 100);
+    lp.sa.corrupt_next = true;
+    lp.a.queuePacket(p1.data(), p1.size());
+    lp.pump();
+    EXPECT_EQ(0u, lp.cb.packets.size());
+    EXPECT_EQ(1u, lp.b.getCRCErrors());
+
+    g_mock_millis += 5000;
+    lp.pump();
+    ASSERT_EQ(1u, lp.cb.packets.size());
+    EXPECT_EQ(p1, lp.cb.packets[0]);
+}
+
+TEST(BridgeLink, GivesUp_AndPeerSkipsAhead) {
+    LinkPair lp;
+    auto p1 = makePacket(1, 20), p2 = makePacket(2, 20);
+    lp.sa.drop_next = 1 + BRIDGE_LINK_MAX_RETRIES;
+    lp.a.queuePacket(p1.data(), p1.size());
+    for (int i = 0; i <= BRIDGE_LINK_MAX_RETRIES; i++) {
+        g_mock_millis += 5000;
+        lp.pump();
+    }
+    EXPECT_EQ(1u, lp.a.getDropped());
+
+    lp.a.queuePacket(p2.data(), p2.size());
+    lp.pump();
+    ASSERT_EQ(1u, lp.cb.packets.size());
+    EXPECT_EQ(p2, lp.cb.packets[0]);
+
+    // receiver moved past the lost frame, so link keeps flowing normally
+    for (int i = 0; i < 20; i++) {
+        auto p = makePacket(10 + i, 20);
+        lp.a.queuePacket(p.data(), p.size());
+        lp.pump();
+    }
+    EXPECT_EQ(21u, lp.cb.packets.size());
+    EXPECT_EQ((uint32_t)BRIDGE_LINK_MAX_RETRIES, lp.a.getRetransmits());
+}
+
+TEST(BridgeLink, PeerRestart_Resyncs) {
+    LinkPair lp;
+    for (int i = 0; i < 50; i++) {
+        auto p = makePacket(i, 20);
+        lp.a.queuePacket(p.data(), p.size());
+        lp.pump();
+    }
+    ASSERT_EQ(50u, lp.cb.packets.size());
+
+    lp.a.begin(115200, 3);   // 'a' reboots, starts sequence from zero again
+    auto p = makePacket(99, 20);
+    lp.a.queuePacket(p.data(), p.size());
+    lp.pump();
+    ASSERT_EQ(51u, lp.cb.packets.size());
+    EXPECT_EQ(p, lp.cb.packets[50]);
+}
+
+TEST(BridgeLink, PeerRestart_AtLowSeq) {
+    LinkPair lp;
+    for (int i = 0; i < 2; i++) {   // receiver's rx_next is now 2, within a window of the restarted sender's 0
+        auto p = makePacket(i, 20);
+        lp.a.queuePacket(p.data(), p.size());
+        lp.pump();
+    }
+    ASSERT_EQ(2u, lp.cb.packets.size());
+
+    lp.a.begin(115200, 3);
+    for (int i = 0; i < 4; i++) {
+        auto p = makePacket(50 + i, 20);
+        lp.a.queuePacket(p.data(), p.size());
+    }
+    lp.pump();
+    ASSERT_EQ(6u, lp.cb.packets.size());
+    for (int i = 0; i < 4; i++) EXPECT_EQ(50 + i, lp.cb.packets[2 + i][0]);
+
+    g_mock_millis += 5000;   // and all acked, nothing re-sent
+    lp.pump();
+    EXPECT_EQ(0u, lp.a.getRetransmits());
+    EXPECT_EQ(6u, lp.cb.packets.size());
+}
+
+TEST(BridgeLink, PeerRestart_StaleAcksIgnored) {
+    LinkPair lp;
+    auto p0 = makePacket(1, 20);   // 'b' has acked a's seq 0
+    lp.a.queuePacket(p0.data(), p0.size());
+    lp.pump();
+
+    lp.a.begin(115200, 3);   // 'a' restarts, its first frame is lost
+    lp.sa.drop_next = 1;
+    auto p = makePacket(77, 20);
+    lp.a.queuePacket(p.data(), p.size());
+    auto q = makePacket(88, 20);
+    lp.b.queuePacket(q.data(), q.size());   // carries b's Ack=1 for a's old session, must not ack the new frame
+    lp.pump();
+    EXPECT_EQ(1u, lp.cb.packets.size());
+
+    g_mock_millis += 5000;
+    lp.pump();
+    ASSERT_EQ(2u, lp.cb.packets.size());
+    EXPECT_EQ(p, lp.cb.packets[1]);
+    EXPECT_EQ(1u, lp.a.getRetransmits());
+}
+
+#ifdef __linux__
+// A serial port as the bridge sees it on Linux: a tty fd in raw mode at a set baud rate.
+// Each end of a pty pair is one side of the "cable".
+class TtyStream : public Stream {
+    int _fd;
+public:
+    explicit TtyStream(int fd) : _fd(fd) { }
+
+    static bool setRaw(int fd, speed_t baud) {
+        struct termios t;
+        if (tcgetattr(fd, &t) != 0) return false;
+        cfmakeraw(&t);       // no echo, no CR/LF translation, no XON/XOFF
+        cfsetspeed(&t, baud);
+        return tcsetattr(fd, TCSANOW, &t) == 0;
+    }
+
+    size_t write(const uint8_t* buf, size_t len) override {
+        size_t done = 0;
+        while (done < len) {
+            ssize_t n = ::write(_fd, &buf[done], len - done);
+            if (n <= 0) break;
+            done += n;
+        }
+        return done;
+    }
+    int available() override {
+        int n = 0;
+        return ioctl(_fd, FIONREAD, &n) == 0 ? n : 0;
+    }
+    int read() override {
+        uint8_t c;
+        return available() > 0 && ::read(_fd, &c, 1) == 1 ? c : -1;
+    }
+};
+
+struct PtyLinkPair {
+    int master = -1, slave = -1;
+    std::unique_ptr<TtyStream> sa, sb;
+    std::unique_ptr<BridgeLink> a, b;
+    Collector ca, cb;
+
+    bool open() {
+        if (openpty(&master, &slave, NULL, NULL, NULL) != 0) return false;
+        if (!TtyStream::setRaw(slave, B115200) || !TtyStream::setRaw(master, B115200)) return false;
+        sa.reset(new TtyStream(master));
+        sb.reset(new TtyStream(slave));
+        a.reset(new BridgeLink(*sa, &ca));
+        b.reset(new BridgeLink(*sb, &cb));
+        g_mock_millis = 1000;
+        a->begin(115200, 1);
+        b->begin(115200, 2);
+        return true;
+    }
+    ~PtyLinkPair() {
+        if (master >= 0) close(master);
+        if (slave >= 0) close(slave);
+    }
+    // bytes cross the pty asynchronously, so poll until both sides have nothing left in flight
+    void pumpUntil(size_t a_expect, size_t b_expect) {
+        for (int i = 0; i < 2000 && (ca.packets.size() < a_expect || cb.packets.size() < b_expect); i++) {
+            a->loop(); b->loop();
+            usleep(200);
+        }
+        for (int i = 0; i < 20; i++) { a->loop(); b->loop(); usleep(200); }   // let final acks land
+    }
+};
+
+TEST(BridgeLinkPty, RoundTrip_AllByteValues) {
+    PtyLinkPair lp;
+    ASSERT_TRUE(lp.open());
+
+    // every byte value, incl. ones a cooked tty would eat or translate (CR, LF, XON/XOFF, ^C, ^D)
+    std::vector<uint8_t> p1(256), p2(200);
+    for (int i = 0; i < 256; i++) p1[i] = i;
+    for (int i = 0; i < 200; i++) p2[i] = 255 - i;
+
+    ASSERT_TRUE(lp.a->queuePacket(p1.data(), p1.size()));
+    ASSERT_TRUE(lp.b->queuePacket(p2.data(), p2.size()));
+    lp.pumpUntil(1, 1);
+
+    ASSERT_EQ(1u, lp.cb.packets.size());
+    EXPECT_EQ(p1, lp.cb.packets[0]);
+    ASSERT_EQ(1u, lp.ca.packets.size());
+    EXPECT_EQ(p2, lp.ca.packets[0]);
+    EXPECT_EQ(0u, lp.a->getCRCErrors());
+    EXPECT_EQ(0u, lp.b->getCRCErrors());
+    EXPECT_EQ(0u, lp.a->getRetransmits());
+}
+
+TEST(BridgeLinkPty, Burst_WindowAndBatching) {
+    PtyLinkPair lp;
+    ASSERT_TRUE(lp.open());
+
+    const int N = 40;
+    std::vector<std::vector<uint8_t>> sent;
+    for (int i = 0; i < N; i++) {
+        sent.push_back(makePacket(i + 1, 20 + (i * 37) % (MAX_TRANS_UNIT - 20)));
+        int tries = 0;
+        while (!lp.a->queuePacket(sent.back().data(), sent.back().size())) {   // window and batch full, wait for acks
+            ASSERT_LT(++tries, 1000) << i;
+            lp.a->loop(); lp.b->loop();
+            usleep(200);
+        }
+    }
+    lp.pumpUntil(0, N);
+
+    ASSERT_EQ((size_t) N, lp.cb.packets.size());
+    std::vector<std::vector<uint8_t>> got = lp.cb.packets;
+    std::sort(got.begin(), got.end());
+    std::sort(sent.begin(), sent.end());
+    EXPECT_EQ(sent, got);
+    EXPECT_EQ(0u, lp.b->getCRCErrors());
+    EXPECT_LT(lp.a->getFramesSent(), (uint32_t) N);   // some were batched
+}
+#endif
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
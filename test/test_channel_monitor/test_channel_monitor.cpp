@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "helpers/ChannelMonitor.h"
+
+// advance the monitor in 250ms ticks, with channel busy for 'busy_pct' of each second
+static uint32_t run(ChannelMonitor& m, uint32_t now, uint32_t secs, int busy_pct) {
+    for (uint32_t t = 0; t < secs * 4; t++) {
+        now += 250;
+        m.update(now);
+        if ((int)(t % 4) * 25 < busy_pct) m.addBusy(250);
+    }
+    return now;
+}
+
+TEST(ChannelMonitor, EmptyIsZero) {
+    ChannelMonitor m;
+    m.update(1000);
+    for (int w = 0; w < CHANNEL_NUM_WINDOWS; w++) {
+        EXPECT_EQ(0, m.getBusyPermille(w));
+        EXPECT_EQ(0, m.getSentPermille(w));
+        EXPECT_EQ(0, m.getNoisePercentile(w, 50));
+    }
+}
+
+TEST(ChannelMonitor, BusyFraction) {
+    ChannelMonitor m;
+    uint32_t now = m.getWindowMillis(0);
+    m.update(now);
+    now = run(m, now, 120, 50);
+    EXPECT_NEAR(500, m.getBusyPermille(CHANNEL_WINDOW_MINUTE), 10);
+    EXPECT_NEAR(500, m.getBusyPermille(CHANNEL_WINDOW_HOUR), 10);
+
+    // a quiet minute drops the minute window right down, but the hour hardly moves
+    run(m, now, 60, 0);
+    EXPECT_LT(m.getBusyPermille(CHANNEL_WINDOW_MINUTE), 250);
+    EXPECT_GT(m.getBusyPermille(CHANNEL_WINDOW_HOUR), 300);
+    EXPECT_GT(m.getBusyPermille(CHANNEL_WINDOW_DAY), 300);
+}
+
+TEST(ChannelMonitor, AirtimeAndWrap) {
+    ChannelMonitor m;
+    uint32_t now = 0xFFFFFFFF - 5000;    // millis() about to wrap
+    m.update(now);
+    for (int i = 0; i < 60; i++) {
+        now += 1000;
+        m.update(now);
+        m.addSent(100);
+        m.addRecv(200);
+    }
+    EXPECT_NEAR(100, m.getSentPermille(CHANNEL_WINDOW_MINUTE), 5);
+    EXPECT_NEAR(200, m.getRecvPermille(CHANNEL_WINDOW_MINUTE), 5);
+}
+
+TEST(ChannelMonitor, NoiseHistogram) {
+    ChannelMonitor m;
+    m.update(0);
+    for (int i = 0; i < 30; i++) m.addNoiseFloor(-118);   // bin 1
+    for (int i = 0; i < 10; i++) m.addNoiseFloor(-95);    // bin 6
+    m.addNoiseFloor(-140);   // clamps to first bin
+    m.addNoiseFloor(-20);    // clamps to last bin
+
+    EXPECT_EQ(-115, m.getNoisePercentile(CHANNEL_WINDOW_HOUR, 50));
+    EXPECT_EQ(-90, m.getNoisePercentile(CHANNEL_WINDOW_HOUR, 90));
+    EXPECT_EQ(2, m.getNoiseBinPercent(CHANNEL_WINDOW_HOUR, 0));
+    EXPECT_EQ(71, m.getNoiseBinPercent(CHANNEL_WINDOW_HOUR, 1));
+    EXPECT_EQ(2, m.getNoiseBinPercent(CHANNEL_WINDOW_HOUR, CHANNEL_NOISE_BINS - 1));
+}
+
+TEST(ChannelMonitor, LongGap) {
+    ChannelMonitor m;
+    m.update(0);
+    uint32_t now = run(m, 0, 60, 100);
+    now += 2 * 60 * 60 * 1000;   // eg. deep sleep for two hours
+    m.update(now);
+    EXPECT_EQ(0, m.getBusyPermille(CHANNEL_WINDOW_MINUTE));
+    EXPECT_LT(m.getBusyPermille(CHANNEL_WINDOW_HOUR), 20);
+    EXPECT_GT(m.getBusyPermille(CHANNEL_WINDOW_DAY), 0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
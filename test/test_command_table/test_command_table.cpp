@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "helpers/CommonCLICommands.h"
+#include "Bench.h"
+
+// what the old chain of memcmp()'s did: first match, in table (source) order
+static const CommandDef* chainLookup(const CommandDef* defs, int num, const char* text, bool from_serial) {
+    for (int i = 0; i < num; i++) {
+        const CommandDef* d = &defs[i];
+        int len = strlen(d->name);
+        if (memcmp(text, d->name, len) != 0) continue;
+        if ((d->flags & CMD_FLAG_SERIAL_ONLY) && !from_serial) continue;
+        if ((d->flags & CMD_FLAG_EXACT) && text[len] != 0) continue;
+        if ((d->flags & CMD_FLAG_WHOLE_WORD) && text[len] != 0 && text[len] != ' ') continue;
+        return d;
+    }
+    return NULL;
+}
+
+static std::vector<std::string> sampleTexts(const CommandDef* defs, int num) {
+    std::vector<std::string> texts = { "", " ", "x", "zzz", "unknown command", "~" };
+    for (int i = 0; i < num; i++) {
+        std::string n = defs[i].name;
+        texts.push_back(n);
+        texts.push_back(n + "1");
+        texts.push_back(n + " 1 2");
+        texts.push_back(n + ".x");
+        texts.push_back(n.substr(0, n.length() - 1));
+        texts.push_back(n.substr(0, 1));
+    }
+    return texts;
+}
+
+static void expectSameAsChain(const CommandDef* defs, int num) {
+    CommandTable table(defs, num);
+    EXPECT_EQ(num, table.getCount());
+    for (auto& t : sampleTexts(defs, num)) {
+        for (int serial = 0; serial < 2; serial++) {
+            EXPECT_EQ(chainLookup(defs, num, t.c_str(), serial), table.lookup(t.c_str(), serial))
+                << "'" << t << "' serial=" << serial;
+        }
+    }
+}
+
+TEST(CommandTable, LongestPrefixAndFlags) {
+    static const CommandDef defs[] = {
+        { "gps", 1, 0 },
+        { "gps on", 2, 0 },
+        { "gps advert", 3, 0 },
+        { "log", 4, CMD_FLAG_SERIAL_ONLY },
+        { "log start", 5, 0 },
+        { "stats-core", 6, CMD_FLAG_WHOLE_WORD },
+        { "erase", 7, CMD_FLAG_EXACT },
+    };
+    CommandTable t(defs, 7);
+
+    const char* args;
+    ASSERT_NE(nullptr, t.lookup("gps advert  share", true, &args));
+    EXPECT_EQ(3, t.lookup("gps advert share", true)->id);
+    EXPECT_STREQ("share", args);
+    EXPECT_EQ(2, t.lookup("gps on", false)->id);
+    EXPECT_EQ(1, t.lookup("gps", false)->id);
+    EXPECT_EQ(1, t.lookup("gps o", false)->id);
+    EXPECT_EQ(1, t.lookup("gpsx", false)->id);
+    EXPECT_EQ(NULL, t.lookup("gp", true));
+
+    EXPECT_EQ(4, t.lookup("log", true)->id);
+    EXPECT_EQ(NULL, t.lookup("log", false));      // serial only
+    EXPECT_EQ(5, t.lookup("log start", false)->id);
+
+    EXPECT_EQ(6, t.lookup("stats-core", false)->id);
+    EXPECT_EQ(6, t.lookup("stats-core 1", false)->id);
+    EXPECT_EQ(NULL, t.lookup("stats-corex", false));
+    EXPECT_EQ(7, t.lookup("erase", false)->id);
+    EXPECT_EQ(NULL, t.lookup("erase ", false));
+}
+
+TEST(CommandTable, Complete) {
+    CommandTable t(cli_commands, num_cli_commands);
+    const CommandDef* found[8];
+    int n = t.complete("powersaving", true, found, 8);
+    ASSERT_EQ(3, n);
+    EXPECT_STREQ("powersaving", found[0]->name);
+    EXPECT_STREQ("powersaving off", found[1]->name);
+    EXPECT_STREQ("powersaving on", found[2]->name);
+
+    EXPECT_EQ(7, t.complete("stats-", true, found, 2));   // total, even if more than 'max_num'
+    EXPECT_EQ(0, t.complete("stats-", false, found, 8));  // serial only
+    EXPECT_EQ(0, t.complete("xyz", true, found, 8));
+    EXPECT_EQ(num_cli_commands, t.complete("", true, found, 0));
+
+    for (int i = 1; i < t.getCount(); i++) {
+        EXPECT_LT(strcmp(t.getSorted(i - 1)->name, t.getSorted(i)->name), 0);   // sorted, no duplicates
+    }
+}
+
+TEST(CommonCLICommands, AllResolveSameAsChain) {
+    expectSameAsChain(cli_commands, num_cli_commands);
+    expectSameAsChain(cli_get_keys, num_cli_get_keys);
+    expectSameAsChain(cli_set_keys, num_cli_set_keys);
+}
+
+TEST(CommonCLICommands, KnownCases) {
+    CommandTable cmds(cli_commands, num_cli_commands);
+    EXPECT_EQ(CLI_CMD_ADVERT_ZEROHOP, cmds.lookup("advert.zerohop", false)->id);
+    EXPECT_EQ(CLI_CMD_ADVERT, cmds.lookup("advert.zerohopx", false)->id);
+    EXPECT_EQ(CLI_CMD_POWEROFF, cmds.lookup("shutdown", false)->id);
+    EXPECT_EQ(CLI_CMD_CLOCK_SYNC, cmds.lookup("clock sync", false)->id);
+    EXPECT_EQ(CLI_CMD_CLOCK, cmds.lookup("clock", false)->id);
+    EXPECT_EQ(CLI_CMD_ERASE, cmds.lookup("erase", true)->id);
+    EXPECT_EQ(NULL, cmds.lookup("erase", false));
+    EXPECT_EQ(CLI_CMD_GET, cmds.lookup("get radio", false)->id);
+
+    CommandTable get(cli_get_keys, num_cli_get_keys);
+    EXPECT_EQ(CLI_GET_TXDELAY, get.lookup("txdelay", false)->id);
+    EXPECT_EQ(CLI_GET_TX, get.lookup("tx", false)->id);
+    EXPECT_EQ(NULL, get.lookup("txx", false));
+    EXPECT_EQ(CLI_GET_RADIO_FEM_RXGAIN, get.lookup("radio.fem.rxgain", false)->id);
+    EXPECT_EQ(CLI_GET_RADIO, get.lookup("radio", false)->id);
+    EXPECT_EQ(CLI_GET_FLOOD_MAX_ADVERT, get.lookup("flood.max.advert", false)->id);
+    EXPECT_EQ(CLI_GET_FLOOD_MAX, get.lookup("flood.max", false)->id);
+    EXPECT_EQ(NULL, get.lookup("prv.key", false));
+
+    CommandTable set(cli_set_keys, num_cli_set_keys);
+    EXPECT_EQ(CLI_SET_FLOOD_MAX, set.lookup("flood.max 3", false)->id);
+    EXPECT_EQ(CLI_SET_RADIO, set.lookup("radio 869.5,250,11,5", false)->id);
+    EXPECT_EQ(NULL, set.lookup("freq 869.5", false));
+    EXPECT_EQ(CLI_SET_FREQ, set.lookup("freq 869.5", true)->id);
+}
+
+TEST(CommonCLICommands, LookupBenchmark) {
+    std::vector<std::string> texts;
+    for (int i = 0; i < num_cli_get_keys; i++) texts.push_back(cli_get_keys[i].name);
+    for (int i = 0; i < num_cli_set_keys; i++) texts.push_back(std::string(cli_set_keys[i].name) + "1");
+    CommandTable get(cli_get_keys, num_cli_get_keys);
+    CommandTable set(cli_set_keys, num_cli_set_keys);
+
+    const int N = 2000;
+    int found = 0;
+    auto t0 = benchNow();
+    for (int n = 0; n < N; n++) {
+        for (auto& t : texts) {
+            found += chainLookup(cli_get_keys, num_cli_get_keys, t.c_str(), true) != NULL;
+            found += chainLookup(cli_set_keys, num_cli_set_keys, t.c_str(), true) != NULL;
+        }
+    }
+    double chain_us = elapsedMicros(t0);
+
+    t0 = benchNow();
+    for (int n = 0; n < N; n++) {
+        for (auto& t : texts) {
+            found -= get.lookup(t.c_str(), true) != NULL;
+            found -= set.lookup(t.c_str(), true) != NULL;
+        }
+    }
+    double table_us = elapsedMicros(t0);
+    EXPECT_EQ(0, found);
+
+    int lookups = N * texts.size() * 2;
+    double chain_ns = chain_us * 1000 / lookups;
+    double table_ns = table_us * 1000 / lookups;
+    benchPrint("get/set key lookup: memcmp chain %.1f ns, table %.1f ns", chain_ns, table_ns);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
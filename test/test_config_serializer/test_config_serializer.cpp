@@ -1,13 +1,12 @@
 #include <gtest/gtest.h>
+#include <set>
 #include "helpers/ConfigSerializer.h"
-
-class NativeFileSystem {
-public:
-    void mkdir(const char*) { }
-};
-#define FILESYSTEM NativeFileSystem
 #include "helpers/CommonCLI.h"
-#undef FILESYSTEM
+#include "Bench.h"
+
+namespace companion {   // companion radio has its own NodePrefs
+#include "../../examples/companion_radio/NodePrefs.h"
+}
 
 #define TEST_INT_S  "56"
 #define TEST_INT     56
@@ -214,6 +213,214 @@ TEST(NodePrefs, FemGainSettingsRoundTrip) {
     EXPECT_EQ(1, loaded.radio_fem_txgain);
 }
 
+// ── binary ──────────────────────────────────────────────────────────────────
+
+class TestStructV2 : public ConfigSerializer {   // 'flags' removed, 'level' added, 'age' narrower
+  protected:
+    void structure() override {
+        def("level", level);
+        def("name", name, sizeof(name));
+        def("age", age);
+    }
+  public:
+    int8_t  age;
+    char    name[8];
+    float   level;
+};
+
+TEST(ConfigSerializer, Binary_RoundTrip) {
+    TestStruct saved;
+    saved.age = -TEST_INT;
+    saved.flags = 0xA5;
+    strcpy(saved.name, "Scott");
+
+    uint8_t buf[64];
+    int len = saved.saveBinary(buf, sizeof(buf));
+    ASSERT_GT(len, CONFIG_BINARY_HDR_SIZE);
+    EXPECT_EQ(len, saved.saveBinary(NULL, 0));
+    EXPECT_EQ(-1, saved.saveBinary(buf, len - 1));   // too small
+
+    TestStruct loaded;
+    loaded.age = 0; loaded.flags = 0; loaded.name[0] = 0;
+    ASSERT_TRUE(loaded.loadBinary(buf, len));
+    EXPECT_EQ(-TEST_INT, loaded.age);
+    EXPECT_EQ(0xA5, loaded.flags);
+    EXPECT_STREQ("Scott", loaded.name);
+}
+
+TEST(ConfigSerializer, Binary_FieldsAddedRemoved) {
+    TestStruct saved;
+    saved.age = -100;
+    saved.flags = 3;
+    strcpy(saved.name, "A long name");
+
+    uint8_t buf[64];
+    int len = saved.saveBinary(buf, sizeof(buf));
+    ASSERT_GT(len, 0);
+
+    TestStructV2 v2;
+    v2.level = 1.5f;
+    ASSERT_TRUE(v2.loadBinary(buf, len));
+    EXPECT_EQ(-100, v2.age);      // narrowed
+    EXPECT_STREQ("A long ", v2.name);   // truncated
+    EXPECT_EQ(1.5f, v2.level);    // not in file, so unmodified
+
+    len = v2.saveBinary(buf, sizeof(buf));
+    ASSERT_GT(len, 0);
+    TestStruct loaded;
+    loaded.flags = 7;
+    ASSERT_TRUE(loaded.loadBinary(buf, len));
+    EXPECT_EQ(-100, loaded.age);  // sign extended
+    EXPECT_EQ(7, loaded.flags);
+    EXPECT_STREQ("A long ", loaded.name);
+}
+
+TEST(ConfigSerializer, Binary_RejectsCorrupt) {
+    TestStruct saved;
+    saved.age = TEST_INT;
+    saved.flags = 1;
+    strcpy(saved.name, "Scott");
+
+    uint8_t buf[64];
+    int len = saved.saveBinary(buf, sizeof(buf));
+    ASSERT_GT(len, 0);
+
+    TestStruct loaded;
+    loaded.age = 1;
+    strcpy(loaded.name, "x");
+
+    uint8_t bad[64];
+    memcpy(bad, buf, len);
+    bad[len - 2] ^= 0x40;    // payload corrupted
+    EXPECT_FALSE(loaded.loadBinary(bad, len));
+    EXPECT_FALSE(loaded.loadBinary(buf, len - 1));   // truncated
+
+    memcpy(bad, buf, len);
+    bad[2] = CONFIG_BINARY_VERSION + 1;   // from newer firmware
+    EXPECT_FALSE(loaded.loadBinary(bad, len));
+
+    EXPECT_FALSE(loaded.loadBinary((const uint8_t*) "{age:12}", 8));   // not binary
+    EXPECT_EQ(1, loaded.age);    // nothing modified
+    EXPECT_STREQ("x", loaded.name);
+}
+
+TEST(NodePrefs, BinaryRoundTrip) {
+    NodePrefs saved;
+    strcpy(saved.node_name, "Repeater 1");
+    strcpy(saved.password, "secret");
+    saved.freq = 869.525f;
+    saved.sf = 11;
+    saved.node_lat = -37.8136;
+    saved.node_lon = 144.9631;
+    saved.radio_fem_txgain = 1;
+    saved.bridge_enabled = true;
+    saved.bridge_baud = 115200;
+    strcpy(saved.bridge_secret, "0123456789abcde");
+
+    uint8_t buf[CONFIG_BINARY_HDR_SIZE + CONFIG_BINARY_MAX_SIZE];
+    int len = saved.saveBinary(buf, sizeof(buf));
+    ASSERT_GT(len, 0);
+
+    NodePrefs loaded;
+    ASSERT_TRUE(loaded.loadBinary(buf, len));
+    EXPECT_STREQ("Repeater 1", loaded.node_name);
+    EXPECT_STREQ("secret", loaded.password);
+    EXPECT_EQ(869.525f, loaded.freq);
+    EXPECT_EQ(11, loaded.sf);
+    EXPECT_EQ(-37.8136, loaded.node_lat);
+    EXPECT_EQ(144.9631, loaded.node_lon);
+    EXPECT_EQ(1, loaded.radio_fem_txgain);
+    EXPECT_TRUE(loaded.bridge_enabled);
+    EXPECT_EQ(115200u, loaded.bridge_baud);
+    EXPECT_STREQ("0123456789abcde", loaded.bridge_secret);
+
+    // re-saving what was loaded should be identical
+    uint8_t again[sizeof(buf)];
+    EXPECT_EQ(len, loaded.saveBinary(again, sizeof(again)));
+    EXPECT_EQ(0, memcmp(buf, again, len));
+}
+
+// savePrefs() writes both files, so a corrupt /prefs.bin (or a downgrade) still has the JSON copy
+TEST(NodePrefs, JsonCopy_RestoresWhenBinaryCorrupt) {
+    NodePrefs saved;
+    strcpy(saved.node_name, "Repeater 1");
+    strcpy(saved.password, "secret");
+    saved.freq = 869.525f;
+
+    static MockPrintStream json;   // NOTE: large buffer
+    ASSERT_TRUE(saved.saveSerial(json));
+    std::string text(reinterpret_cast<const char*>(json.getBytes()), json.getLength());
+
+    uint8_t buf[CONFIG_BINARY_HDR_SIZE + CONFIG_BINARY_MAX_SIZE];
+    int len = saved.saveBinary(buf, sizeof(buf));
+    ASSERT_GT(len, 0);
+    buf[len - 1] ^= 0x01;
+
+    NodePrefs loaded;
+    EXPECT_FALSE(loaded.loadBinary(buf, len));
+    MockInputStream in(text.c_str());
+    ASSERT_TRUE(loaded.loadSerial(in));
+    EXPECT_STREQ("Repeater 1", loaded.node_name);
+    EXPECT_STREQ("secret", loaded.password);
+    EXPECT_EQ(869.525f, loaded.freq);
+}
+
+// every field (including ones in sub objects) is written, so a tag collision shows up as a repeat
+static void expectTagsUnique(ConfigSerializer& prefs) {
+    uint8_t buf[CONFIG_BINARY_HDR_SIZE + CONFIG_BINARY_MAX_SIZE];
+    int len = prefs.saveBinary(buf, sizeof(buf));
+    ASSERT_GT(len, CONFIG_BINARY_HDR_SIZE);
+
+    std::set<uint16_t> tags;
+    int n = 0;
+    for (int i = CONFIG_BINARY_HDR_SIZE; i < len; i += 3 + buf[i + 2], n++) {
+        uint16_t tag = buf[i] | (buf[i + 1] << 8);
+        EXPECT_TRUE(tags.insert(tag).second) << "tag collision: " << tag;
+    }
+    EXPECT_GT(n, 20);
+}
+
+TEST(NodePrefs, BinaryTagsUnique) {
+    NodePrefs prefs;
+    expectTagsUnique(prefs);
+
+    companion::NodePrefs companion_prefs;
+    expectTagsUnique(companion_prefs);
+}
+
+TEST(NodePrefs, BinaryVsJsonBenchmark) {
+    NodePrefs prefs;
+    strcpy(prefs.node_name, "Benchmark node");
+    prefs.freq = 915.0f;
+
+    static MockPrintStream json;   // NOTE: large buffer
+    ASSERT_TRUE(prefs.saveSerial(json));
+    std::string text(reinterpret_cast<const char*>(json.getBytes()), json.getLength());
+
+    uint8_t buf[CONFIG_BINARY_HDR_SIZE + CONFIG_BINARY_MAX_SIZE];
+    int len = prefs.saveBinary(buf, sizeof(buf));
+    ASSERT_GT(len, 0);
+    EXPECT_LT(len, (int) text.length());
+
+    const int N = 2000;
+    NodePrefs loaded;
+    auto t0 = benchNow();
+    for (int i = 0; i < N; i++) {
+        MockInputStream in(text.c_str());
+        ASSERT_TRUE(loaded.loadSerial(in));
+    }
+    double json_us = elapsedMicros(t0) / N;
+
+    t0 = benchNow();
+    for (int i = 0; i < N; i++) {
+        ASSERT_TRUE(loaded.loadBinary(buf, len));
+    }
+    double bin_us = elapsedMicros(t0) / N;
+
+    printf("[ SIZE     ] json %d bytes, binary %d bytes\n", (int) text.length(), len);
+    benchPrint("load json %.2f us, binary %.2f us", json_us, bin_us);
+}
+
 
 // ── main ───────────────────────────────────────────────────────
 
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "DutyCycle.h"
+
+using mesh::DutyCycleTracker;
+
+#define HOUR      (60UL*60*1000)
+#define BUCKET    (HOUR / (DUTY_CYCLE_BUCKETS - 1))
+
+TEST(DutyCycle, AirtimeExpiresAfterWindow) {
+    DutyCycleTracker d;
+    d.begin(HOUR, 0);
+    EXPECT_EQ(BUCKET, d.getBucketMillis());
+
+    d.recordTx(0, 1000, 0);
+    d.recordTx(0, 500, BUCKET + 10);
+    EXPECT_EQ(1500, d.getUsed(0, BUCKET * 2));
+    EXPECT_EQ(1500, d.getUsed(0, HOUR));                 // never under-counted...
+    EXPECT_EQ(500, d.getUsed(0, HOUR + BUCKET));         // ...and over-counted by at most one bucket
+    EXPECT_EQ(0, d.getUsed(0, HOUR + BUCKET * 2));
+}
+
+TEST(DutyCycle, MillisUntilAllowed) {
+    DutyCycleTracker d;
+    d.begin(HOUR, 0);
+    uint32_t limit = HOUR / 100;   // 1%, 36 secs
+
+    d.recordTx(0, 30000, 0);
+    d.recordTx(0, 5000, BUCKET * 2);
+    uint32_t now = BUCKET * 10;
+    EXPECT_EQ(1000, d.getAvailable(0, limit, now));
+    EXPECT_EQ(0, d.millisUntilAllowed(0, limit, 500, now));
+    EXPECT_EQ(HOUR + BUCKET - now, d.millisUntilAllowed(0, limit, 2000, now));                // first bucket has to go
+    EXPECT_EQ(HOUR + BUCKET * 3 - now, d.millisUntilAllowed(0, limit, 31500, now));           // ...and the third
+    EXPECT_EQ(DUTY_CYCLE_NEVER, d.millisUntilAllowed(0, limit, limit + 1, now));
+
+    uint32_t wait = d.millisUntilAllowed(0, limit, 31500, now);
+    EXPECT_LT(d.getAvailable(0, limit, now + wait - 1), 31500);
+    EXPECT_GE(d.getAvailable(0, limit, now + wait), 31500);
+}
+
+TEST(DutyCycle, BandsAreSeparate) {
+    DutyCycleTracker d;
+    d.begin(HOUR, 0);
+    d.recordTx(7, 3000, 100);
+    d.recordTx(3, 200, 200);
+    EXPECT_EQ(3000, d.getUsed(7, 300));
+    EXPECT_EQ(200, d.getUsed(3, 300));
+    EXPECT_EQ(0, d.getUsed(5, 300));
+
+    d.recordTx(5, 100, 400);       // no free slot, so least used band is dropped
+    EXPECT_EQ(3000, d.getUsed(7, 500));
+    EXPECT_EQ(100, d.getUsed(5, 500));
+    EXPECT_EQ(0, d.getUsed(3, 500));
+}
+
+TEST(DutyCycle, IdleAndWrapAround) {
+    DutyCycleTracker d;
+    uint32_t start = 0xFFFFFFFF - BUCKET * 3;   // millis() about to wrap
+    d.begin(HOUR, start);
+    d.recordTx(0, 800, start + 5);
+    EXPECT_EQ(800, d.getUsed(0, start + BUCKET * 10));   // past the wrap
+    EXPECT_EQ(0, d.getUsed(0, start + HOUR * 3));       // idle for longer than a window
+
+    d.recordTx(0, 200, start + HOUR * 3);
+    EXPECT_EQ(200, d.getUsed(0, start + HOUR * 3 + 1));
+}
+
+TEST(DutyCycle, EU868SubBands) {
+    uint8_t band = DutyCycleTracker::findEU868Band(869.525f);
+    EXPECT_NE(DUTY_CYCLE_BAND_NONE, band);
+    EXPECT_FLOAT_EQ(0.1f, DutyCycleTracker::getEU868DutyCycle(band));
+    EXPECT_FLOAT_EQ(0.01f, DutyCycleTracker::getEU868DutyCycle(DutyCycleTracker::findEU868Band(868.1f)));
+    EXPECT_FLOAT_EQ(0.001f, DutyCycleTracker::getEU868DutyCycle(DutyCycleTracker::findEU868Band(869.3f)));
+    EXPECT_NE(band, DutyCycleTracker::findEU868Band(868.1f));
+
+    EXPECT_EQ(DUTY_CYCLE_BAND_NONE, DutyCycleTracker::findEU868Band(915.0f));
+    EXPECT_FLOAT_EQ(1.0f, DutyCycleTracker::getEU868DutyCycle(DUTY_CYCLE_BAND_NONE));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
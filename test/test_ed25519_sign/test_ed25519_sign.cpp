@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#define ED25519_NO_SEED  1
+#include <ed_25519.h>
+#include "Bench.h"
+
+#ifndef ED25519_BASE_STRIDE
+  #define ED25519_BASE_STRIDE 1
+#endif
+
+static void fromHex(uint8_t* dest, const char* hex) {
+    for (int i = 0; hex[i * 2]; i++) sscanf(&hex[i * 2], "%2hhx", &dest[i]);
+}
+
+// RFC 8032, section 7.1, TEST 1 and TEST 2
+TEST(Ed25519Sign, RFC8032_Vectors) {
+    struct { const char *seed, *pub, *msg, *sig; } vectors[] = {
+        { "9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+          "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a", "",
+          "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e065224901555fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b" },
+        { "4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+          "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c", "72",
+          "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00" },
+    };
+    for (auto& v : vectors) {
+        uint8_t seed[32], pub[32], prv[64], msg[1], sig[64], exp_pub[32], exp_sig[64];
+        fromHex(seed, v.seed); fromHex(exp_pub, v.pub); fromHex(exp_sig, v.sig);
+        size_t msg_len = strlen(v.msg) / 2;
+        fromHex(msg, v.msg);
+
+        ed25519_create_keypair(pub, prv, seed);
+        EXPECT_EQ(0, memcmp(pub, exp_pub, 32));
+        ed25519_sign(sig, msg, msg_len, pub, prv);
+        EXPECT_EQ(0, memcmp(sig, exp_sig, 64));
+        EXPECT_EQ(1, ed25519_verify(sig, msg, msg_len, pub));
+    }
+}
+
+TEST(Ed25519Sign, DerivePubMatchesKeypair) {
+    for (int i = 0; i < 16; i++) {
+        uint8_t seed[32], pub[32], prv[64], pub2[32];
+        for (int j = 0; j < 32; j++) seed[j] = i * 11 + j * 3;
+        ed25519_create_keypair(pub, prv, seed);
+        ed25519_derive_pub(pub2, prv);
+        EXPECT_EQ(0, memcmp(pub, pub2, 32)) << i;
+    }
+}
+
+TEST(Ed25519Sign, Benchmark_SignAndKeygen) {
+    const int N = 200;
+    uint8_t seed[32], pub[32], prv[64], msg[100], sig[64];
+    memset(seed, 7, sizeof(seed));
+    memset(msg, 0x5A, sizeof(msg));
+    uint32_t sink = 0;
+
+    auto t0 = benchNow();
+    for (int i = 0; i < N; i++) { seed[0] = i; ed25519_create_keypair(pub, prv, seed); sink += pub[0]; }
+    double keygen = elapsedMicros(t0) / N;
+
+    t0 = benchNow();
+    for (int i = 0; i < N; i++) { msg[0] = i; ed25519_sign(sig, msg, sizeof(msg), pub, prv); sink += sig[0]; }
+    double sign = elapsedMicros(t0) / N;
+
+    benchPrint("ED25519_BASE_STRIDE=%d (%d table rows): keygen %.1f us, sign %.1f us",
+               ED25519_BASE_STRIDE, 32 / ED25519_BASE_STRIDE, keygen, sign);
+    EXPECT_GT(sink, 0u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "helpers/FloodContention.h"
+
+using namespace mesh;
+
+static Packet makeFlood(uint8_t tag, uint8_t hops) {
+    Packet p;
+    p.header = ROUTE_TYPE_FLOOD | (PAYLOAD_TYPE_TXT_MSG << PH_TYPE_SHIFT);
+    p.setPathHashSizeAndCount(1, hops);
+    p.payload_len = 4;
+    memset(p.payload, tag, p.payload_len);
+    return p;
+}
+
+TEST(FloodContention, WindowGrowsWithNeighbours) {
+    FloodContention fc;
+    EXPECT_EQ(FLOOD_MIN_WINDOW_SLOTS, fc.getWindowSlots());   // no neighbours, same as legacy 5*t
+
+    fc.setNeighbourCount(2);
+    EXPECT_EQ(FLOOD_MIN_WINDOW_SLOTS, fc.getWindowSlots());
+    fc.setNeighbourCount(10);
+    EXPECT_EQ(20, fc.getWindowSlots());
+    fc.setNeighbourCount(200);
+    EXPECT_EQ(FLOOD_MAX_WINDOW_SLOTS, fc.getWindowSlots());
+}
+
+TEST(FloodContention, WindowWidensWithDupRate) {
+    FloodContention fc;
+    fc.setNeighbourCount(8);
+    fc.updateDupRate(0, 0);
+    EXPECT_EQ(16, fc.getWindowSlots());
+
+    for (int i = 1; i <= 10; i++) fc.updateDupRate(i * 100, i * 100);   // everything heard is a dup
+    EXPECT_GT(fc.getDupRate(), 200);
+    EXPECT_GE(fc.getWindowSlots(), 30);
+
+    fc.updateDupRate(5, 0);   // stats were cleared, just re-baselines
+    EXPECT_GT(fc.getDupRate(), 200);
+    fc.updateDupRate(10, 0);   // sample too small
+    EXPECT_GT(fc.getDupRate(), 200);
+}
+
+TEST(FloodContention, SNRBiasesWithinWindow) {
+    FloodContention fc;
+    fc.setNeighbourCount(10);   // 20 slots, of 10ms => 200ms window
+    for (uint32_t r = 0; r < 1000; r += 37) {
+        uint32_t weak = fc.calcDelay(10, -15.0f, r);
+        uint32_t strong = fc.calcDelay(10, 12.0f, r);
+        EXPECT_LE(weak, 100u);
+        EXPECT_GE(strong, 100u);
+        EXPECT_LE(strong, 200u);
+    }
+    EXPECT_EQ(50u, fc.calcDelay(10, 0.0f, 0));   // mid SNR starts at quarter window
+    EXPECT_EQ(0u, fc.calcDelay(0, 0.0f, 1234));  // txdelay 0 => no delay
+}
+
+TEST(FloodContention, SuppressAfterThreshold) {
+    FloodContention fc;
+    fc.setSuppressThreshold(2);
+    Packet ours = makeFlood(0x11, 1);
+    Packet other = makeFlood(0x22, 1);
+    fc.onQueued(&ours);
+
+    Packet heard1 = makeFlood(0x11, 2);   // same packet, rebroadcast with a longer path
+    Packet heard2 = makeFlood(0x11, 3);
+    EXPECT_EQ(NULL, fc.onHeard(&other));
+    EXPECT_EQ(NULL, fc.onHeard(&ours));    // our own copy doesn't count
+    EXPECT_EQ(NULL, fc.onHeard(&heard1));
+    EXPECT_EQ(&ours, fc.onHeard(&heard2));
+    EXPECT_EQ(NULL, fc.onHeard(&heard2));  // only reported once
+}
+
+TEST(FloodContention, SuppressDisabled) {
+    FloodContention fc;
+    Packet ours = makeFlood(0x11, 1);
+    fc.onQueued(&ours);
+    Packet heard = makeFlood(0x11, 2);
+    for (int i = 0; i < 10; i++) EXPECT_EQ(NULL, fc.onHeard(&heard));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "helpers/FrameBatch.h"
+
+TEST(FrameBatch, AppendThenNext_RoundTrips) {
+    uint8_t env[64];
+    const uint8_t f1[] = { 0x05, 0x01, 0x02 };
+    const uint8_t f2[] = { 0x03 };
+    size_t len = 0;
+    len = FrameBatch::append(env, len, sizeof(env), f1, sizeof(f1));
+    ASSERT_EQ(4u, len);
+    len = FrameBatch::append(env, len, sizeof(env), f2, sizeof(f2));
+    ASSERT_EQ(6u, len);
+
+    size_t pos = 0;
+    const uint8_t* frame;
+    ASSERT_EQ(3, FrameBatch::next(env, len, pos, frame));
+    EXPECT_EQ(0, memcmp(f1, frame, sizeof(f1)));
+    ASSERT_EQ(1, FrameBatch::next(env, len, pos, frame));
+    EXPECT_EQ(0x03, frame[0]);
+    EXPECT_EQ(0, FrameBatch::next(env, len, pos, frame));
+}
+
+TEST(FrameBatch, Append_RejectsFrameThatDoesNotFit) {
+    uint8_t env[8];
+    const uint8_t f[7] = { 0 };
+    EXPECT_EQ(0u, FrameBatch::append(env, 0, sizeof(env) - 1, f, sizeof(f)));
+    EXPECT_EQ(8u, FrameBatch::append(env, 0, sizeof(env), f, sizeof(f)));
+}
+
+TEST(FrameBatch, Next_DetectsTruncatedEnvelope) {
+    const uint8_t env[] = { 0x04, 0x01, 0x02 };
+    size_t pos = 0;
+    const uint8_t* frame;
+    EXPECT_EQ(-1, FrameBatch::next(env, sizeof(env), pos, frame));
+}
+
+TEST(FrameBatch, Hello_IsRecognised) {
+    const uint8_t hello[] = { FRAME_BATCH_HELLO, FRAME_BATCH_VERSION };
+    const uint8_t cmd[] = { 0x16, 0x03 };   // CMD_DEVICE_QUERY
+    EXPECT_TRUE(FrameBatch::isHello(hello, sizeof(hello)));
+    EXPECT_FALSE(FrameBatch::isHello(cmd, sizeof(cmd)));
+
+    uint8_t reply[4];
+    ASSERT_EQ(4u, FrameBatch::writeHelloReply(reply, 244));
+    EXPECT_EQ(FRAME_BATCH_HELLO, reply[0]);
+    EXPECT_EQ(244, reply[2] | (reply[3] << 8));
+}
+
+TEST(FrameBatch, CanBurst_OnlyIfFullFrameFits) {
+    EXPECT_FALSE(FrameBatch::canBurst(23 - 3, 176));   // default ATT MTU
+    EXPECT_FALSE(FrameBatch::canBurst(176, 176));      // no room for length byte
+    EXPECT_TRUE(FrameBatch::canBurst(177, 176));
+    EXPECT_TRUE(FrameBatch::canBurst(244, 176));
+}
+
+TEST(FrameBatchReader, EnvelopeSplitAcrossReads) {
+    uint8_t env[64];
+    const uint8_t f1[] = { 0x05, 0x01, 0x02 };
+    const uint8_t f2[] = { 0x07, 0x08, 0x09, 0x0A, 0x0B };
+    size_t len = FrameBatch::append(env, 0, sizeof(env), f1, sizeof(f1));
+    len = FrameBatch::append(env, len, sizeof(env), f2, sizeof(f2));
+
+    FrameBatchReader<32> rx;
+    const uint8_t* frame;
+    size_t split = 1 + sizeof(f1) + 2;   // f1, then len byte and first byte of f2
+    memcpy(rx.getTail(), env, split);
+    rx.added(split);
+    ASSERT_EQ(3, rx.next(frame));
+    EXPECT_EQ(0, memcmp(f1, frame, sizeof(f1)));
+    EXPECT_EQ(0, rx.next(frame));           // rest of f2 not here yet
+    EXPECT_EQ(2u, rx.getPending());
+
+    memcpy(rx.getTail(), &env[split], len - split);   // next callback
+    rx.added(len - split);
+    ASSERT_EQ(5, rx.next(frame));
+    EXPECT_EQ(0, memcmp(f2, frame, sizeof(f2)));
+    EXPECT_EQ(0, rx.next(frame));
+    EXPECT_EQ(0u, rx.getPending());
+    EXPECT_EQ(32u, rx.getRoom());
+}
+
+TEST(FrameBatchReader, DiscardsMalformedAndReset) {
+    FrameBatchReader<8> rx;
+    const uint8_t* frame;
+    const uint8_t bad[] = { 0x00, 0x01 };   // zero length frame
+    memcpy(rx.getTail(), bad, sizeof(bad));
+    rx.added(sizeof(bad));
+    EXPECT_EQ(0, rx.next(frame));
+    EXPECT_EQ(0u, rx.getPending());
+
+    const uint8_t big[] = { 0x20, 1, 2, 3, 4, 5, 6, 7 };   // can never fit
+    memcpy(rx.getTail(), big, sizeof(big));
+    rx.added(sizeof(big));
+    EXPECT_EQ(0, rx.next(frame));
+    EXPECT_EQ(8u, rx.getRoom());
+
+    const uint8_t part[] = { 0x03, 0x01 };
+    memcpy(rx.getTail(), part, sizeof(part));
+    rx.added(sizeof(part));
+    EXPECT_EQ(0, rx.next(frame));
+    rx.reset();   // eg. disconnect, or mode change
+    EXPECT_EQ(0u, rx.getPending());
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#define ED25519_NO_SEED  1
+#include <ed_25519.h>
+#include "Identity.h"
+#include "Bench.h"
+
+struct KeyPair {
+    uint8_t pub[32], prv[64];
+    explicit KeyPair(uint8_t seed_byte) {
+        uint8_t seed[32];
+        for (int i = 0; i < 32; i++) seed[i] = seed_byte * 31 + i;
+        ed25519_create_keypair(pub, prv, seed);
+    }
+};
+
+TEST(KeyExchange, Montgomery_MatchesOriginal) {
+    for (int i = 1; i <= 8; i++) {
+        KeyPair self(i), peer(100 + i);
+        uint8_t expected[32], mont_u[32], actual[32];
+        ed25519_key_exchange(expected, peer.pub, self.prv);
+
+        ed25519_key_to_montgomery(mont_u, peer.pub);
+        ed25519_key_exchange_montgomery(actual, mont_u, self.prv);
+        EXPECT_EQ(0, memcmp(expected, actual, 32)) << "key " << i;
+    }
+}
+
+TEST(KeyExchange, Montgomery_BothSidesAgree) {
+    KeyPair a(7), b(9);
+    uint8_t a_u[32], b_u[32], ss1[32], ss2[32];
+    ed25519_key_to_montgomery(a_u, a.pub);
+    ed25519_key_to_montgomery(b_u, b.pub);
+    ed25519_key_exchange_montgomery(ss1, b_u, a.prv);
+    ed25519_key_exchange_montgomery(ss2, a_u, b.prv);
+    EXPECT_EQ(0, memcmp(ss1, ss2, 32));
+}
+
+static void expectMontgomery(const uint8_t* pub, const uint8_t* mont_u) {
+    uint8_t expected[32];
+    ed25519_key_to_montgomery(expected, pub);
+    EXPECT_EQ(0, memcmp(expected, mont_u, 32));
+}
+
+TEST(PeerKeyCache, HitAndMiss) {
+    mesh::PeerKeyCache cache;
+    KeyPair a(3), b(4);
+
+    const uint8_t* u = cache.get(a.pub);
+    expectMontgomery(a.pub, u);
+    EXPECT_EQ(1u, cache.getMisses());
+    EXPECT_EQ(0u, cache.getHits());
+
+    EXPECT_EQ(u, cache.get(a.pub));    // same entry, not converted again
+    EXPECT_EQ(1u, cache.getHits());
+
+    expectMontgomery(b.pub, cache.get(b.pub));
+    EXPECT_EQ(2u, cache.getMisses());
+    expectMontgomery(a.pub, cache.get(a.pub));
+    EXPECT_EQ(2u, cache.getHits());
+}
+
+TEST(PeerKeyCache, EvictsLeastRecentlyUsed) {
+    mesh::PeerKeyCache cache;
+    static KeyPair* peers[PEER_KEY_CACHE_SIZE + 1];
+    for (int i = 0; i <= PEER_KEY_CACHE_SIZE; i++) peers[i] = new KeyPair(50 + i);
+
+    for (int i = 0; i < PEER_KEY_CACHE_SIZE; i++) cache.get(peers[i]->pub);
+    cache.get(peers[0]->pub);    // peer 1 is now least recently used
+    EXPECT_EQ(1u, cache.getHits());
+
+    expectMontgomery(peers[PEER_KEY_CACHE_SIZE]->pub, cache.get(peers[PEER_KEY_CACHE_SIZE]->pub));
+    EXPECT_EQ((uint32_t)(PEER_KEY_CACHE_SIZE + 1), cache.getMisses());
+
+    cache.get(peers[0]->pub);
+    cache.get(peers[2]->pub);
+    EXPECT_EQ(3u, cache.getHits());    // both still cached
+
+    expectMontgomery(peers[1]->pub, cache.get(peers[1]->pub));    // was evicted
+    EXPECT_EQ((uint32_t)(PEER_KEY_CACHE_SIZE + 2), cache.getMisses());
+
+    for (int i = 0; i <= PEER_KEY_CACHE_SIZE; i++) delete peers[i];
+}
+
+TEST(PeerKeyCache, ReplacedKey_NotServedStale) {
+    mesh::PeerKeyCache cache;
+    KeyPair old_key(7), new_key(8);
+
+    // eg. a contact that re-keyed: the new key is a miss, never the old key's entry
+    cache.get(old_key.pub);
+    const uint8_t* u = cache.get(new_key.pub);
+    expectMontgomery(new_key.pub, u);
+    EXPECT_EQ(2u, cache.getMisses());
+
+    // an entry reused for another key gives that key's value
+    static KeyPair* others[PEER_KEY_CACHE_SIZE];
+    for (int i = 0; i < PEER_KEY_CACHE_SIZE; i++) {
+        others[i] = new KeyPair(80 + i);
+        expectMontgomery(others[i]->pub, cache.get(others[i]->pub));
+    }
+    expectMontgomery(old_key.pub, cache.get(old_key.pub));
+    expectMontgomery(new_key.pub, cache.get(new_key.pub));
+    for (int i = 0; i < PEER_KEY_CACHE_SIZE; i++) delete others[i];
+}
+
+TEST(KeyExchange, Benchmark_AclLoadAndAnonRequests) {
+    const int NUM_CLIENTS = 20, NUM_PEERS = 4, NUM_REQS = 200;
+    KeyPair self(1);
+    static KeyPair* clients[NUM_CLIENTS];
+    for (int i = 0; i < NUM_CLIENTS; i++) clients[i] = new KeyPair(10 + i);
+
+    uint8_t secret[32], mont_u[NUM_CLIENTS][32];
+    uint32_t sink = 0;
+
+    // boot-time ACL load: every entry is a distinct key, so each is converted exactly once either way
+    auto t0 = benchNow();
+    for (int i = 0; i < NUM_CLIENTS; i++) { ed25519_key_exchange(secret, clients[i]->pub, self.prv); sink += secret[0]; }
+    double acl_before = elapsedMicros(t0);
+
+    t0 = benchNow();
+    for (int i = 0; i < NUM_CLIENTS; i++) {
+        ed25519_key_to_montgomery(mont_u[i], clients[i]->pub);
+        ed25519_key_exchange_montgomery(secret, mont_u[i], self.prv);
+        sink += secret[0];
+    }
+    double acl_after = elapsedMicros(t0);
+
+    // ANON_REQ handling: repeated requests (logins, retries) from a few peers, conversion cached after first
+    t0 = benchNow();
+    for (int i = 0; i < NUM_REQS; i++) { ed25519_key_exchange(secret, clients[i % NUM_PEERS]->pub, self.prv); sink += secret[0]; }
+    double anon_before = elapsedMicros(t0);
+
+    t0 = benchNow();
+    for (int i = 0; i < NUM_REQS; i++) { ed25519_key_exchange_montgomery(secret, mont_u[i % NUM_PEERS], self.prv); sink += secret[0]; }
+    double anon_after = elapsedMicros(t0);
+
+    benchPrint("ACL load (%d clients): %.0f us -> %.0f us", NUM_CLIENTS, acl_before, acl_after);
+    benchPrint("ANON_REQ (%d reqs, %d peers): %.1f us/req -> %.1f us/req", NUM_REQS, NUM_PEERS,
+               anon_before / NUM_REQS, anon_after / NUM_REQS);
+    EXPECT_GT(sink, 0u);
+
+    for (int i = 0; i < NUM_CLIENTS; i++) delete clients[i];
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "helpers/LinkQuality.h"
+
+using namespace mesh;
+
+static const uint8_t SELF[32] = { 0x50, 0x51, 0x52 };
+static const uint8_t DEST[32] = { 0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5 };
+
+#define NOW  1000000
+
+static void link(LinkQualityTable& t, uint8_t a, uint8_t b, float snr) {
+    t.recordLink(&a, &b, 1, (int8_t)(snr * 4), NOW);
+}
+
+TEST(LinkQuality, LinksAreUndirectedAndSmoothed) {
+    LinkQualityTable t;
+    t.setSelf(SELF);
+    uint8_t a = 0x10, b = 0x20;
+    EXPECT_EQ(LINK_UNKNOWN_SNR, t.getLinkSNR(&a, &b, 1, NOW));
+
+    link(t, 0x10, 0x20, 8.0f);
+    EXPECT_EQ(32, t.getLinkSNR(&b, &a, 1, NOW));
+    link(t, 0x20, 0x10, 0.0f);
+    EXPECT_EQ(24, t.getLinkSNR(&a, &b, 1, NOW));
+    EXPECT_EQ(1, t.getNumLinks());
+
+    EXPECT_EQ(LINK_UNKNOWN_SNR, t.getLinkSNR(&a, &b, 1, NOW + LINK_QUALITY_MAX_AGE_SECS + 1));   // stale
+}
+
+TEST(LinkQuality, RecordsLastHopOfFlood) {
+    LinkQualityTable t;
+    t.setSelf(SELF);
+    Packet p;
+    p.header = ROUTE_TYPE_FLOOD | (PAYLOAD_TYPE_TXT_MSG << PH_TYPE_SHIFT);
+    p.setPathHashSizeAndCount(1, 2);
+    p.path[0] = 0x11; p.path[1] = 0x22;
+    p._snr = -20;
+    t.onPacketRecv(&p, NOW);
+
+    uint8_t hop = 0x22;
+    EXPECT_EQ(-20, t.getLinkSNR(&hop, SELF, 1, NOW));
+    EXPECT_EQ(1, t.getNumLinks());
+}
+
+TEST(LinkQuality, RecordsTraceLinks) {
+    LinkQualityTable t;
+    t.setSelf(SELF);
+    uint8_t hashes[] = { 0x11, 0x22 };
+    uint8_t snrs[] = { 40, (uint8_t)-8 };
+    t.onTraceRecv(0, snrs, hashes, 2, 12, NOW);
+
+    EXPECT_EQ(40, t.getLinkSNR(SELF, &hashes[0], 1, NOW));
+    EXPECT_EQ(-8, t.getLinkSNR(&hashes[0], &hashes[1], 1, NOW));
+    EXPECT_EQ(12, t.getLinkSNR(&hashes[1], SELF, 1, NOW));
+}
+
+TEST(LinkQuality, NewestPathWinsWithoutLinkData) {
+    LinkQualityTable t;
+    t.setSelf(SELF);
+    uint8_t p1[] = { 0x11, 0x22 }, p2[] = { 0x33, 0x44 };
+    uint8_t out[MAX_PATH_SIZE], out_len = LINK_PATH_NONE;
+
+    t.addPath(DEST, p1, 2, NOW);
+    EXPECT_TRUE(t.selectPath(DEST, out, out_len, NOW, false));
+    EXPECT_EQ(2, out_len);
+    EXPECT_EQ(0x11, out[0]);
+
+    t.addPath(DEST, p2, 2, NOW + 1);
+    EXPECT_TRUE(t.selectPath(DEST, out, out_len, NOW + 1, false));
+    EXPECT_EQ(0x33, out[0]);
+}
+
+TEST(LinkQuality, PicksStrongestPath) {
+    LinkQualityTable t;
+    t.setSelf(SELF);
+    uint8_t weak[] = { 0x11, 0x22 }, strong[] = { 0x33, 0x44 }, shorter[] = { 0x55 };
+    link(t, SELF[0], 0x11, 6); link(t, 0x11, 0x22, -12); link(t, 0x22, DEST[0], 6);
+    link(t, SELF[0], 0x33, 4); link(t, 0x33, 0x44, 3);   // last link unknown, doesn't count
+
+    t.addPath(DEST, weak, 2, NOW);
+    t.addPath(DEST, strong, 2, NOW);
+    EXPECT_EQ(3*4 - 2*LINK_HOP_PENALTY, t.scorePath(DEST, strong, 2, NOW));
+    EXPECT_GT(t.scorePath(DEST, strong, 2, NOW), t.scorePath(DEST, weak, 2, NOW));
+
+    uint8_t out[MAX_PATH_SIZE], out_len = LINK_PATH_NONE;
+    t.selectPath(DEST, out, out_len, NOW, false);
+    EXPECT_EQ(0x33, out[0]);
+
+    t.addPath(DEST, shorter, 1, NOW);   // one less hop, with a better first link
+    link(t, SELF[0], 0x55, 4);
+    t.selectPath(DEST, out, out_len, NOW, false);
+    EXPECT_EQ(1, out_len);
+    EXPECT_EQ(0x55, out[0]);
+}
+
+TEST(LinkQuality, DirtyOnlyForCandidateLinks) {
+    LinkQualityTable t;
+    t.setSelf(SELF);
+    link(t, 0x11, 0x22, 5);
+    EXPECT_FALSE(t.checkDirty());   // not on any path
+
+    uint8_t p1[] = { 0x11, 0x22 };
+    t.addPath(DEST, p1, 2, NOW);
+    link(t, 0x22, 0x11, 1);
+    EXPECT_TRUE(t.checkDirty());
+    EXPECT_FALSE(t.checkDirty());
+
+    link(t, 0x22, DEST[0], 3);   // last link, to the contact
+    EXPECT_TRUE(t.checkDirty());
+    link(t, 0x22, DEST[0], 3);   // no change
+    EXPECT_FALSE(t.checkDirty());
+    link(t, SELF[0], 0x33, 3);
+    EXPECT_FALSE(t.checkDirty());
+}
+
+TEST(LinkQuality, KeepsCurrentPathWithinMargin) {
+    LinkQualityTable t;
+    t.setSelf(SELF);
+    uint8_t p1[] = { 0x11 }, p2[] = { 0x22 };
+    link(t, SELF[0], 0x11, 2.0f); link(t, 0x11, DEST[0], 2.0f);
+    link(t, SELF[0], 0x22, 2.5f); link(t, 0x22, DEST[0], 2.5f);
+    t.addPath(DEST, p1, 1, NOW);
+    t.addPath(DEST, p2, 1, NOW);
+
+    uint8_t out[MAX_PATH_SIZE] = { 0x11 }, out_len = 1;
+    EXPECT_FALSE(t.selectPath(DEST, out, out_len, NOW, true));   // only 0.5 dB better
+    link(t, 0x11, DEST[0], -10.0f);
+    link(t, 0x11, DEST[0], -10.0f);
+    EXPECT_TRUE(t.selectPath(DEST, out, out_len, NOW, true));
+    EXPECT_EQ(0x22, out[0]);
+
+    uint8_t user[] = { 0x77 };   // a path not learned here, is left alone
+    memcpy(out, user, 1);
+    EXPECT_FALSE(t.selectPath(DEST, out, out_len, NOW, true));
+}
+
+TEST(LinkQuality, FailedPathFallsBackToNextCandidate) {
+    LinkQualityTable t;
+    t.setSelf(SELF);
+    uint8_t p1[] = { 0x11 }, p2[] = { 0x22 };
+    t.addPath(DEST, p1, 1, NOW);
+    t.addPath(DEST, p2, 1, NOW + 1);
+
+    uint8_t out[MAX_PATH_SIZE], out_len = LINK_PATH_NONE;
+    t.selectPath(DEST, out, out_len, NOW, false);
+    EXPECT_EQ(0x22, out[0]);
+
+    t.removePath(DEST, out, out_len);
+    out_len = LINK_PATH_NONE;
+    EXPECT_TRUE(t.selectPath(DEST, out, out_len, NOW, false));
+    EXPECT_EQ(0x11, out[0]);
+
+    t.removePath(DEST, out, out_len);
+    EXPECT_TRUE(t.selectPath(DEST, out, out_len, NOW, false));
+    EXPECT_EQ(LINK_PATH_NONE, out_len);   // back to flood
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
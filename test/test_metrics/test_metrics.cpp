@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "Metrics.h"
+#include "helpers/StatsFormatHelper.h"
+
+using mesh::MetricHistogram;
+using mesh::MetricsRegistry;
+
+static int readVarint(const uint8_t* src, int& pos) {
+    uint32_t v = 0;
+    int shift = 0;
+    while (src[pos] & 0x80) {
+        v |= (uint32_t)(src[pos++] & 0x7F) << shift;
+        shift += 7;
+    }
+    v |= (uint32_t)src[pos++] << shift;
+    return (int) v;
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+struct Decoded {
+    uint8_t id, type;
+    int64_t value;
+    uint32_t count, sum, max;
+    std::vector<uint32_t> buckets;
+};
+
+static std::vector<Decoded> decode(const uint8_t* buf, int len, int* total = NULL, int* start = NULL) {
+    std::vector<Decoded> out;
+    EXPECT_EQ(METRICS_EXPORT_VERSION, buf[0]);
+    if (total) *total = buf[1];
+    if (start) *start = buf[2];
+    int pos = 4;
+    for (int i = 0; i < buf[3]; i++) {
+        Decoded d = {};
+        d.id = buf[pos++];
+        d.type = buf[pos++];
+        if (d.type == METRIC_TYPE_HISTOGRAM) {
+            d.count = readVarint(buf, pos);
+            d.sum = readVarint(buf, pos);
+            d.max = readVarint(buf, pos);
+            int n = buf[pos++];
+            for (int b = 0; b < n; b++) d.buckets.push_back(readVarint(buf, pos));
+        } else if (d.type == METRIC_TYPE_GAUGE) {
+            d.value = unzigzag(readVarint(buf, pos));
+        } else {
+            d.value = (uint32_t) readVarint(buf, pos);
+        }
+        out.push_back(d);
+    }
+    EXPECT_EQ(len, pos);
+    return out;
+}
+
+static int32_t readNeg(const void* ctx) {
+    return -*(const int32_t *) ctx;
+}
+
+TEST(MetricHistogram, BucketsAndPercentiles) {
+    EXPECT_EQ(0, MetricHistogram::bucketFor(0));
+    EXPECT_EQ(1, MetricHistogram::bucketFor(1));
+    EXPECT_EQ(2, MetricHistogram::bucketFor(2));
+    EXPECT_EQ(2, MetricHistogram::bucketFor(3));
+    EXPECT_EQ(11, MetricHistogram::bucketFor(1500));
+    EXPECT_EQ(METRIC_HIST_BUCKETS - 1, MetricHistogram::bucketFor(0xFFFFFFFF));
+
+    MetricHistogram h;
+    EXPECT_EQ(0u, h.getPercentile(50));
+    for (int i = 0; i < 90; i++) h.add(10);     // bucket [8, 16)
+    for (int i = 0; i < 10; i++) h.add(1000);   // bucket [512, 1024)
+    EXPECT_EQ(100u, h.getCount());
+    EXPECT_EQ(90u * 10 + 10 * 1000, h.getSum());
+    EXPECT_EQ(1000u, h.getMax());
+    EXPECT_EQ(16u, h.getPercentile(50));
+    EXPECT_EQ(16u, h.getPercentile(90));
+    EXPECT_EQ(1000u, h.getPercentile(91));   // capped by max
+    EXPECT_EQ(1000u, h.getPercentile(100));
+
+    h.reset();
+    EXPECT_EQ(0u, h.getCount());
+    EXPECT_EQ(0u, h.getBucket(4));
+}
+
+TEST(MetricsRegistry, AddReplaceAndFull) {
+    MetricsRegistry m;
+    uint32_t a = 5, b = 7;
+    EXPECT_TRUE(m.addCounter(1, "a", &a));
+    EXPECT_TRUE(m.addCounter(2, "b", &b));
+    EXPECT_EQ(2, m.getCount());
+    EXPECT_EQ(5, m.getValue(m.findById(1)));
+
+    EXPECT_TRUE(m.addCounter(1, "a2", &b));   // same ID replaces
+    EXPECT_EQ(2, m.getCount());
+    EXPECT_STREQ("a2", m.getName(0));
+    EXPECT_EQ(7, m.getValue(0));
+    EXPECT_EQ(-1, m.findById(3));
+
+    for (int id = 3; id <= METRICS_MAX; id++) EXPECT_TRUE(m.addCounter(id, "x", &a));
+    EXPECT_EQ(METRICS_MAX, m.getCount());
+    EXPECT_FALSE(m.addCounter(200, "full", &a));
+    EXPECT_TRUE(m.addCounter(2, "b", &a));   // replacing still works when full
+}
+
+TEST(MetricsRegistry, ExportDecodes) {
+    MetricsRegistry m;
+    uint32_t big = 300000;
+    int32_t noise = 112;
+    MetricHistogram h;
+    h.add(0);
+    h.add(5);
+    h.add(5);
+    h.add(200);
+    m.addCounter(METRIC_ID_RADIO_RECV, "recv", &big);
+    m.addGauge(METRIC_ID_NOISE_FLOOR, "noise", readNeg, &noise);
+    m.addHistogram(METRIC_ID_FWD_DELAY_MS, "fwd", &h);
+
+    uint8_t buf[128];
+    int len = m.exportBinary(buf, sizeof(buf), 0);
+    EXPECT_EQ(4 + (2 + 3) + (2 + 2) + (2 + 1 + 2 + 2 + 1 + 9), len);
+
+    int total, start;
+    auto d = decode(buf, len, &total, &start);
+    EXPECT_EQ(3, total);
+    EXPECT_EQ(0, start);
+    ASSERT_EQ(3u, d.size());
+    EXPECT_EQ(METRIC_ID_RADIO_RECV, d[0].id);
+    EXPECT_EQ(300000, d[0].value);
+    EXPECT_EQ(METRIC_TYPE_GAUGE, d[1].type);
+    EXPECT_EQ(-112, d[1].value);
+    EXPECT_EQ(METRIC_TYPE_HISTOGRAM, d[2].type);
+    EXPECT_EQ(4u, d[2].count);
+    EXPECT_EQ(210u, d[2].sum);
+    EXPECT_EQ(200u, d[2].max);
+    ASSERT_EQ(9u, d[2].buckets.size());   // empty buckets above 200 trimmed
+    EXPECT_EQ(1u, d[2].buckets[0]);
+    EXPECT_EQ(2u, d[2].buckets[3]);
+    EXPECT_EQ(1u, d[2].buckets[8]);
+
+    noise = -3;   // read at export time
+    len = m.exportBinary(buf, sizeof(buf), 0);
+    EXPECT_EQ(3, decode(buf, len)[1].value);
+}
+
+TEST(MetricsRegistry, ExportPages) {
+    MetricsRegistry m;
+    uint32_t values[METRICS_MAX];
+    for (int i = 0; i < METRICS_MAX; i++) {
+        values[i] = 1000 * i;
+        m.addCounter(i + 1, "c", &values[i]);
+    }
+    uint8_t buf[20];
+    int start = 0, seen = 0, pages = 0;
+    while (start < METRICS_MAX) {
+        int len = m.exportBinary(buf, sizeof(buf), start);
+        ASSERT_LE(len, (int) sizeof(buf));
+        int total, s;
+        auto d = decode(buf, len, &total, &s);
+        EXPECT_EQ(METRICS_MAX, total);
+        EXPECT_EQ(start, s);
+        ASSERT_GT(d.size(), 0u);
+        for (auto& e : d) {
+            EXPECT_EQ(seen + 1, e.id);
+            EXPECT_EQ(1000 * seen, e.value);
+            seen++;
+        }
+        start += d.size();
+        pages++;
+    }
+    EXPECT_EQ(METRICS_MAX, seen);
+    EXPECT_GT(pages, 1);
+
+    EXPECT_EQ(4, m.exportBinary(buf, sizeof(buf), METRICS_MAX));   // past end, just the header
+    EXPECT_EQ(0, buf[3]);
+    EXPECT_EQ(0, m.exportBinary(buf, 3, 0));
+}
+
+TEST(StatsFormatHelper, FormatMetrics) {
+    MetricsRegistry m;
+    uint32_t sent = 42;
+    int32_t snr = -9;
+    MetricHistogram h;
+    h.add(100);
+    m.addCounter(METRIC_ID_RADIO_SENT, "radio_sent", &sent);
+    m.addGauge(METRIC_ID_LAST_SNR_X4, "last_snr_x4", readNeg, &snr);
+    m.addHistogram(METRIC_ID_QUEUE_WAIT_MS, "queue_wait_ms", &h);
+
+    char reply[160];
+    StatsFormatHelper::formatMetrics(reply, m, 0);
+    EXPECT_STREQ("{\"radio_sent\":42,\"last_snr_x4\":9,\"queue_wait_ms\":[1,100,100,100]}", reply);
+
+    uint32_t more[METRICS_MAX];
+    for (int i = 3; i < METRICS_MAX; i++) {
+        more[i] = 123456789;
+        m.addCounter(i + 100, "some_long_counter", &more[i]);
+    }
+    StatsFormatHelper::formatMetrics(reply, m, 0);
+    EXPECT_LE(strlen(reply), 150u);
+    const char* next = strstr(reply, "\"next\":");
+    ASSERT_NE(nullptr, next);
+    int n = atoi(next + 7);
+    EXPECT_GT(n, 3);
+    EXPECT_LT(n, METRICS_MAX);
+
+    StatsFormatHelper::formatMetrics(reply, m, METRICS_MAX);
+    EXPECT_STREQ("{}", reply);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include "Multipart.h"
+#include "Packet.h"
+
+using mesh::MultipartRecvBuffer;
+using mesh::MultipartSendBuffer;
+
+static void fillBlob(uint8_t* blob, int len, uint8_t seed) {
+    for (int i = 0; i < len; i++) blob[i] = (uint8_t)(seed + i * 7);
+}
+
+TEST(Multipart, ReassembleOutOfOrder) {
+    uint8_t blob[MULTIPART_MAX_BLOB];
+    int blob_len = MULTIPART_FRAG_DATA_SIZE * 2 + 40;
+    fillBlob(blob, blob_len, 3);
+
+    MultipartSendBuffer tx;
+    int s = tx.add(PAYLOAD_TYPE_RESPONSE, 0x22, 9, blob, blob_len, 0);
+    ASSERT_GE(s, 0);
+    EXPECT_EQ(3, tx.getCount(s));
+    EXPECT_TRUE(tx.isFlood(s));
+
+    uint8_t frags[3][MAX_PACKET_PAYLOAD];
+    int lens[3];
+    for (int i = 0; i < 3; i++) lens[i] = tx.writeFragment(s, i, 0x11, frags[i]);
+    EXPECT_EQ(MAX_PACKET_PAYLOAD, lens[0]);
+    EXPECT_EQ(MULTIPART_HEADER_SIZE + 40, lens[2]);
+    EXPECT_EQ((2 << 4) | PAYLOAD_TYPE_RESPONSE, frags[0][0]);
+
+    MultipartRecvBuffer rx;
+    bool completed;
+    int r = rx.addFragment(frags[2], lens[2], 100, completed);
+    ASSERT_GE(r, 0);
+    EXPECT_FALSE(completed);
+    EXPECT_EQ(r, rx.addFragment(frags[0], lens[0], 200, completed));
+    EXPECT_FALSE(completed);
+    EXPECT_EQ(0x05, rx.getReceived(r));     // fragment 1 missing
+    EXPECT_EQ(r, rx.addFragment(frags[0], lens[0], 250, completed));   // duplicate
+    EXPECT_FALSE(completed);
+
+    EXPECT_EQ(r, rx.addFragment(frags[1], lens[1], 300, completed));
+    EXPECT_TRUE(completed);
+    EXPECT_EQ(PAYLOAD_TYPE_RESPONSE, rx.getType(r));
+    EXPECT_EQ(0x11, rx.getSrcHash(r));
+    EXPECT_EQ(9, rx.getMsgId(r));
+    ASSERT_EQ(blob_len, rx.getBlobLength(r));
+    EXPECT_EQ(0, memcmp(blob, rx.getBlob(r), blob_len));
+}
+
+TEST(Multipart, EncryptedRoundTrip) {
+    uint8_t secret[PUB_KEY_SIZE], other[PUB_KEY_SIZE];
+    fillBlob(secret, sizeof(secret), 5);
+    fillBlob(other, sizeof(other), 6);
+    uint8_t data[MULTIPART_MAX_DATA];
+    fillBlob(data, sizeof(data), 9);
+
+    MultipartSendBuffer tx;
+    EXPECT_EQ(-1, tx.add(PAYLOAD_TYPE_REQ, 0x22, 1, secret, data, MULTIPART_MAX_DATA + 1, 0));
+    int s = tx.add(PAYLOAD_TYPE_REQ, 0x22, 1, secret, data, 500, 0);
+    ASSERT_GE(s, 0);
+    EXPECT_EQ(3, tx.getCount(s));
+
+    MultipartRecvBuffer rx;
+    bool completed = false;
+    int r = -1;
+    for (int i = 0; i < tx.getCount(s); i++) {
+        uint8_t frag[MAX_PACKET_PAYLOAD];
+        int len = tx.writeFragment(s, i, 0x11, frag);
+        r = rx.addFragment(frag, len, 0, completed);
+    }
+    ASSERT_TRUE(completed);
+    EXPECT_EQ(0, rx.decrypt(r, other));    // MAC doesn't match
+    int len = rx.decrypt(r, secret);
+    ASSERT_GE(len, 500);                   // padded to cipher block size
+    EXPECT_EQ(0, memcmp(data, rx.getData(), 500));
+}
+
+TEST(Multipart, RejectsInvalidFragments) {
+    MultipartRecvBuffer rx;
+    bool completed;
+    uint8_t payload[MAX_PACKET_PAYLOAD];
+    memset(payload, 0, sizeof(payload));
+
+    EXPECT_EQ(-1, rx.addFragment(payload, MULTIPART_HEADER_SIZE, 0, completed));     // no data
+
+    payload[4] = (1 << 3) | 2;   // index past count
+    EXPECT_EQ(-1, rx.addFragment(payload, 20, 0, completed));
+
+    payload[4] = (1 << 3) | 0;   // first of two, but short
+    EXPECT_EQ(-1, rx.addFragment(payload, 20, 0, completed));
+
+    payload[4] = ((MULTIPART_MAX_FRAGMENTS) << 3) | 0;   // too many fragments
+    EXPECT_EQ(-1, rx.addFragment(payload, MAX_PACKET_PAYLOAD, 0, completed));
+}
+
+TEST(Multipart, NewMessageReplacesOld) {
+    uint8_t blob[MULTIPART_MAX_BLOB];
+    fillBlob(blob, MULTIPART_FRAG_DATA_SIZE + 10, 1);
+
+    MultipartSendBuffer tx;
+    int a = tx.add(PAYLOAD_TYPE_REQ, 0x22, 1, blob, MULTIPART_FRAG_DATA_SIZE + 10, 0);
+    uint8_t frag[MAX_PACKET_PAYLOAD];
+    int len = tx.writeFragment(a, 0, 0x11, frag);
+
+    MultipartRecvBuffer rx;
+    bool completed;
+    int r = rx.addFragment(frag, len, 0, completed);
+    ASSERT_GE(r, 0);
+
+    int b = tx.add(PAYLOAD_TYPE_REQ, 0x22, 2, blob, MULTIPART_FRAG_DATA_SIZE + 10, 10);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(b, tx.find(0x22, 2));
+    len = tx.writeFragment(b, 1, 0x11, frag);
+    EXPECT_EQ(r, rx.addFragment(frag, len, 20, completed));   // same sender, so same slot
+    EXPECT_FALSE(completed);
+    EXPECT_EQ(2, rx.getMsgId(r));
+    EXPECT_EQ(0x02, rx.getReceived(r));   // fragment 0 of old message was dropped
+}
+
+TEST(Multipart, Timeouts) {
+    uint8_t blob[MULTIPART_MAX_BLOB];
+    fillBlob(blob, MULTIPART_FRAG_DATA_SIZE * 2, 5);
+
+    MultipartSendBuffer tx;
+    int s = tx.add(PAYLOAD_TYPE_TXT_MSG, 0x22, 7, blob, MULTIPART_FRAG_DATA_SIZE * 2, 0);
+    uint8_t frag[MAX_PACKET_PAYLOAD];
+    int len = tx.writeFragment(s, 0, 0x11, frag);
+
+    MultipartRecvBuffer rx;
+    bool completed;
+    int r = rx.addFragment(frag, len, 1000, completed);
+    EXPECT_EQ(-1, rx.checkTimeouts(1000 + MULTIPART_GAP_MILLIS - 1));
+
+    uint32_t now = 1000 + MULTIPART_GAP_MILLIS;
+    for (int i = 0; i < MULTIPART_MAX_ACKS; i++) {
+        EXPECT_EQ(r, rx.checkTimeouts(now));
+        rx.onAckSent(r, now);
+        EXPECT_EQ(-1, rx.checkTimeouts(now + 1));
+        now += MULTIPART_GAP_MILLIS;
+    }
+    EXPECT_EQ(-1, rx.checkTimeouts(now));     // gave up
+    EXPECT_EQ(MultipartRecvBuffer::FREE, rx.getState(r));
+
+    // a completed message is held, so resent fragments are re-ACKed, then freed
+    r = rx.addFragment(frag, len, now, completed);
+    len = tx.writeFragment(s, 1, 0x11, frag);
+    r = rx.addFragment(frag, len, now, completed);
+    EXPECT_TRUE(completed);
+    rx.markDone(r);
+    EXPECT_EQ(-1, rx.checkTimeouts(now + MULTIPART_GAP_MILLIS));
+    EXPECT_EQ(MultipartRecvBuffer::DONE, rx.getState(r));
+    rx.checkTimeouts(now + MULTIPART_HOLD_MILLIS);
+    EXPECT_EQ(MultipartRecvBuffer::FREE, rx.getState(r));
+
+    tx.expire(MULTIPART_HOLD_MILLIS - 1);
+    EXPECT_EQ(s, tx.find(0x22, 7));
+    tx.expire(MULTIPART_HOLD_MILLIS);
+    EXPECT_EQ(-1, tx.find(0x22, 7));
+}
+
+TEST(Multipart, AttemptLimit) {
+    uint8_t blob[64];
+    fillBlob(blob, sizeof(blob), 0);
+
+    MultipartSendBuffer tx;
+    EXPECT_EQ(-1, tx.add(PAYLOAD_TYPE_REQ, 0x22, 1, blob, MULTIPART_MAX_BLOB + 1, 0));
+    int s = tx.add(PAYLOAD_TYPE_REQ, 0x22, 1, blob, sizeof(blob), 0);
+    EXPECT_EQ(1, tx.getCount(s));
+
+    uint8_t frag[MAX_PACKET_PAYLOAD];
+    for (int i = 0; i < MULTIPART_MAX_ATTEMPTS; i++) {
+        EXPECT_EQ(MULTIPART_HEADER_SIZE + (int)sizeof(blob), tx.writeFragment(s, 0, 0x11, frag));
+        EXPECT_EQ(i, frag[4] >> 6);
+    }
+    EXPECT_EQ(0, tx.writeFragment(s, 0, 0x11, frag));
+    EXPECT_EQ(0, tx.writeFragment(s, 1, 0x11, frag));   // no such fragment
+
+    uint8_t path[] = { 0xA1, 0xB2, 0xC3, 0xD4 };
+    tx.setRoute(s, path, (1 << 6) | 2, 2);     // two 2-byte hashes
+    EXPECT_FALSE(tx.isFlood(s));
+    EXPECT_EQ((1 << 6) | 2, tx.getPathLen(s));
+    EXPECT_EQ(0, memcmp(path, tx.getPath(s), sizeof(path)));
+    EXPECT_EQ(2, tx.getPathHashSize(s));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "helpers/NeighbourTable.h"
+
+static const uint8_t* key(uint8_t a, uint8_t b = 0) {
+    static uint8_t k[PUB_KEY_SIZE];
+    memset(k, 0x55, sizeof(k));
+    k[0] = a;
+    k[1] = b;
+    return k;
+}
+
+static int orderedKeys(const NeighbourTable& t, uint8_t order, int offset, uint8_t dest[], int max) {
+    const NeighbourInfo* page[64];
+    int n = t.getOrdered(order, offset, page, max);
+    for (int i = 0; i < n; i++) dest[i] = page[i]->pub_key[0];
+    return n;
+}
+
+TEST(NeighbourTable, RecencyOrder) {
+    NeighbourTable t(8);
+    t.put(key(1), 0, 100, 0);
+    t.put(key(2), 0, 200, 0);
+    t.put(key(3), 0, 300, 0);
+    t.put(key(1), 0, 400, 0);    // heard again
+
+    uint8_t k[8];
+    ASSERT_EQ(3, orderedKeys(t, NEIGHBOUR_ORDER_NEWEST, 0, k, 8));
+    EXPECT_EQ(1, k[0]); EXPECT_EQ(3, k[1]); EXPECT_EQ(2, k[2]);
+    ASSERT_EQ(3, orderedKeys(t, NEIGHBOUR_ORDER_OLDEST, 0, k, 8));
+    EXPECT_EQ(2, k[0]); EXPECT_EQ(3, k[1]); EXPECT_EQ(1, k[2]);
+
+    // paged
+    ASSERT_EQ(1, orderedKeys(t, NEIGHBOUR_ORDER_NEWEST, 1, k, 1));
+    EXPECT_EQ(3, k[0]);
+    EXPECT_EQ(0, orderedKeys(t, NEIGHBOUR_ORDER_NEWEST, 3, k, 8));
+
+    EXPECT_EQ(2, t.countHeardSince(300));
+    EXPECT_EQ(3, t.getCount());
+}
+
+TEST(NeighbourTable, SnrOrder) {
+    NeighbourTable t(8);
+    int8_t snrs[] = { 10, -20, 40, 0, 25 };
+    for (int i = 0; i < 5; i++) t.put(key(i + 1), 0, 100, snrs[i]);
+
+    uint8_t k[8];
+    ASSERT_EQ(5, orderedKeys(t, NEIGHBOUR_ORDER_STRONGEST, 0, k, 8));
+    uint8_t expect[] = { 3, 5, 1, 4, 2 };
+    for (int i = 0; i < 5; i++) EXPECT_EQ(expect[i], k[i]);
+
+    ASSERT_EQ(2, orderedKeys(t, NEIGHBOUR_ORDER_WEAKEST, 1, k, 2));
+    EXPECT_EQ(4, k[0]); EXPECT_EQ(1, k[1]);
+
+    // neighbour 2 improves, averaged: (3*-20 + 60)/4 = 0
+    t.put(key(2), 0, 200, 60);
+    EXPECT_EQ(0, t.find(key(2), PUB_KEY_SIZE)->snr);
+    // ... and again, much later, so old SNR is dropped
+    t.put(key(2), 0, 200 + NEIGHBOUR_SNR_MAX_AGE_SECS, 60);
+    ASSERT_EQ(5, orderedKeys(t, NEIGHBOUR_ORDER_STRONGEST, 0, k, 8));
+    EXPECT_EQ(2, k[0]);
+    EXPECT_EQ(60, t.find(key(2), 1)->snr);
+}
+
+TEST(NeighbourTable, ReplacesLeastRecent) {
+    NeighbourTable t(4);
+    for (int i = 0; i < 4; i++) t.put(key(i + 1), 0, 100 + i, i);
+    t.put(key(1), 0, 200, 0);     // refresh 1, so 2 is now oldest
+    t.put(key(9), 0, 300, 50);
+
+    EXPECT_EQ(4, t.getCount());
+    EXPECT_EQ(NULL, t.find(key(2), PUB_KEY_SIZE));
+    EXPECT_NE(nullptr, t.find(key(1), PUB_KEY_SIZE));
+
+    uint8_t k[8];
+    ASSERT_EQ(4, orderedKeys(t, NEIGHBOUR_ORDER_STRONGEST, 0, k, 8));
+    EXPECT_EQ(9, k[0]);
+    ASSERT_EQ(4, orderedKeys(t, NEIGHBOUR_ORDER_OLDEST, 0, k, 8));
+    EXPECT_EQ(3, k[0]); EXPECT_EQ(4, k[1]); EXPECT_EQ(1, k[2]); EXPECT_EQ(9, k[3]);
+}
+
+TEST(NeighbourTable, FindAndRemoveByPrefix) {
+    NeighbourTable t(16);
+    // same first byte, so same hash bucket
+    t.put(key(0xAB, 1), 0, 100, 4);
+    t.put(key(0xAB, 2), 0, 110, 8);
+    t.put(key(0xCD, 1), 0, 120, 12);
+    t.put(key(0x2B, 1), 0, 130, 16);    // same bucket as 0xAB, in small table
+
+    uint8_t prefix[2] = { 0xAB, 2 };
+    ASSERT_NE(nullptr, t.find(prefix, 2));
+    EXPECT_EQ(8, t.find(prefix, 2)->snr);
+    EXPECT_EQ(110u, t.find(prefix, 2)->heard_timestamp);
+
+    EXPECT_EQ(2, t.remove(prefix, 1));   // both 0xAB entries
+    EXPECT_EQ(2, t.getCount());
+    EXPECT_EQ(NULL, t.find(prefix, 1));
+    EXPECT_NE(nullptr, t.find(key(0x2B, 1), PUB_KEY_SIZE));
+
+    // orderings still consistent after remove
+    uint8_t k[8];
+    ASSERT_EQ(2, orderedKeys(t, NEIGHBOUR_ORDER_NEWEST, 0, k, 8));
+    EXPECT_EQ(0x2B, k[0]); EXPECT_EQ(0xCD, k[1]);
+    ASSERT_EQ(2, orderedKeys(t, NEIGHBOUR_ORDER_WEAKEST, 0, k, 8));
+    EXPECT_EQ(0xCD, k[0]); EXPECT_EQ(0x2B, k[1]);
+
+    t.put(key(0xAB, 3), 0, 140, 0);
+    EXPECT_EQ(3, t.getCount());
+    t.clear();
+    EXPECT_EQ(0, t.getCount());
+    EXPECT_EQ(NULL, t.find(key(0xCD, 1), PUB_KEY_SIZE));
+}
+
+TEST(NeighbourTable, ManyUpdatesStaySorted) {
+    NeighbourTable t(64);
+    uint32_t seed = 1;
+    for (int i = 0; i < 5000; i++) {
+        seed = seed * 1103515245 + 12345;
+        uint8_t id = (seed >> 16) % 100;    // more ids than table can hold
+        int8_t snr = (int8_t)((seed >> 8) % 120) - 60;
+        t.put(key(id, id), 0, 1000 + i, snr);
+    }
+    EXPECT_EQ(64, t.getCount());
+
+    const NeighbourInfo* page[64];
+    ASSERT_EQ(64, t.getOrdered(NEIGHBOUR_ORDER_STRONGEST, 0, page, 64));
+    for (int i = 1; i < 64; i++) EXPECT_GE(page[i - 1]->snr, page[i]->snr);
+    ASSERT_EQ(64, t.getOrdered(NEIGHBOUR_ORDER_NEWEST, 0, page, 64));
+    for (int i = 1; i < 64; i++) EXPECT_GT(page[i - 1]->heard_timestamp, page[i]->heard_timestamp);
+    for (int i = 0; i < 64; i++) EXPECT_EQ(page[i], t.find(page[i]->pub_key, PUB_KEY_SIZE));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
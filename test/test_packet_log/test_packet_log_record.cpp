@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "helpers/PacketLog.h"
+#include "helpers/PacketLogRecord.h"
+
+static mesh::Packet makePacket(uint8_t type, uint8_t route, uint8_t payload_len) {
+    mesh::Packet pkt;
+    pkt.header = (type << PH_TYPE_SHIFT) | route;
+    pkt.payload_len = payload_len;
+    pkt.payload[0] = 0xAB;   // dest hash
+    pkt.payload[1] = 0x12;   // src hash
+    return pkt;
+}
+
+TEST(PacketLogRecord, Rx_MatchesTextFormat) {
+    mesh::Packet pkt = makePacket(PAYLOAD_TYPE_TXT_MSG, ROUTE_TYPE_FLOOD, 40);
+    PacketLogRecord r = PacketLogRecord::fromPacket(1700000000, PACKET_LOG_RX, &pkt, 52, -7.5f, -112.0f, 0.25f);
+
+    char line[100];
+    int n = r.format(line);
+    EXPECT_STREQ("RX, len=52 (type=2, route=F, payload_len=40) SNR=-7 RSSI=-112 score=250 [12 -> AB]\n", line);
+    EXPECT_EQ((int)strlen(line), n);
+    EXPECT_EQ(1700000000u, r.timestamp);
+}
+
+TEST(PacketLogRecord, Tx_NoHashesForAdvert) {
+    mesh::Packet pkt = makePacket(PAYLOAD_TYPE_ADVERT, ROUTE_TYPE_DIRECT, 100);
+    PacketLogRecord r = PacketLogRecord::fromPacket(0, PACKET_LOG_TX, &pkt, 110);
+
+    char line[100];
+    r.format(line);
+    EXPECT_STREQ("TX, len=110 (type=4, route=D, payload_len=100)\n", line);
+}
+
+TEST(PacketLogRecord, TxFail_Format) {
+    mesh::Packet pkt = makePacket(PAYLOAD_TYPE_REQ, ROUTE_TYPE_TRANSPORT_DIRECT, 20);
+    PacketLogRecord r = PacketLogRecord::fromPacket(0, PACKET_LOG_TX_FAIL, &pkt, 30);
+
+    char line[100];
+    r.format(line);
+    EXPECT_STREQ("TX FAIL!, len=30 (type=0, route=D, payload_len=20)\n", line);
+}
+
+TEST(PacketLogRecord, LapFlag_DoesNotAffectAction) {
+    mesh::Packet pkt = makePacket(PAYLOAD_TYPE_ACK, ROUTE_TYPE_FLOOD, 4);
+    PacketLogRecord r = PacketLogRecord::fromPacket(0, PACKET_LOG_TX, &pkt, 10);
+    r.flags |= PACKET_LOG_FLAG_LAP;
+    EXPECT_EQ(PACKET_LOG_TX, r.getAction());
+}
+
+#define LOG_FILE  "/packet_log"
+#define RECORD_SIZE  sizeof(PacketLogRecord)
+
+class CapturePrint : public Print {
+public:
+    std::string text;
+    size_t write(uint8_t b) override { text += (char) b; return 1; }
+};
+
+static const char* formatTimestamp(uint32_t timestamp) {
+    static char buf[16];
+    sprintf(buf, "%u", timestamp);
+    return buf;
+}
+
+static void appendRecords(PacketLog& log, uint32_t from, uint32_t to) {
+    mesh::Packet pkt = makePacket(PAYLOAD_TYPE_ACK, ROUTE_TYPE_FLOOD, 4);
+    for (uint32_t t = from; t < to; t++) log.append(PacketLogRecord::fromPacket(t, PACKET_LOG_RX, &pkt, 10));
+}
+
+// timestamps of dumped records, in the order printed
+static std::vector<uint32_t> dumpTimestamps(PacketLog& log) {
+    CapturePrint out;
+    log.dump(out, formatTimestamp);
+    std::vector<uint32_t> ts;
+    for (size_t pos = 0; pos < out.text.size(); pos = out.text.find('\n', pos) + 1) {
+        ts.push_back(strtoul(&out.text[pos], NULL, 10));
+    }
+    return ts;
+}
+
+static size_t fileSize(fs::FS& fs) {
+    fs::File f = fs.open(LOG_FILE, "r");
+    return f ? f.size() : 0;
+}
+
+static void expectSequence(const std::vector<uint32_t>& ts, uint32_t from, uint32_t to) {
+    ASSERT_EQ(to - from, ts.size());
+    for (uint32_t i = 0; i < ts.size(); i++) {
+        if (ts[i] != from + i) { ADD_FAILURE() << "at " << i << ": " << ts[i] << " != " << from + i; return; }
+    }
+}
+
+TEST(PacketLog, WritesWholePages) {
+    fs::FS fs;
+    PacketLog log(LOG_FILE);
+    log.begin(&fs);
+    appendRecords(log, 0, PACKET_LOG_PAGE_RECORDS - 1);
+    EXPECT_FALSE(fs.exists(LOG_FILE));   // still staged in RAM
+
+    appendRecords(log, PACKET_LOG_PAGE_RECORDS - 1, PACKET_LOG_PAGE_RECORDS + 3);
+    EXPECT_EQ(PACKET_LOG_PAGE_RECORDS * RECORD_SIZE, fileSize(fs));   // first page only
+}
+
+TEST(PacketLog, PartialFlushThenRestore) {
+    fs::FS fs;
+    {
+        PacketLog log(LOG_FILE);
+        log.begin(&fs);
+        g_mock_millis = 1000;
+        appendRecords(log, 0, PACKET_LOG_PAGE_RECORDS + 4);
+        log.loop();
+        EXPECT_EQ(PACKET_LOG_PAGE_RECORDS * RECORD_SIZE, fileSize(fs));
+
+        g_mock_millis += PACKET_LOG_FLUSH_MILLIS;
+        log.loop();   // partial page held too long
+        EXPECT_EQ((PACKET_LOG_PAGE_RECORDS + 4) * RECORD_SIZE, fileSize(fs));
+
+        appendRecords(log, PACKET_LOG_PAGE_RECORDS + 4, PACKET_LOG_PAGE_RECORDS + 6);
+        log.flush();   // only the two new records
+        EXPECT_EQ((PACKET_LOG_PAGE_RECORDS + 6) * RECORD_SIZE, fileSize(fs));
+    }
+
+    PacketLog log(LOG_FILE);   // eg. after reboot
+    log.begin(&fs);
+    appendRecords(log, PACKET_LOG_PAGE_RECORDS + 6, 2 * PACKET_LOG_PAGE_RECORDS);   // completes the partial page
+    EXPECT_EQ(2 * PACKET_LOG_PAGE_RECORDS * RECORD_SIZE, fileSize(fs));
+    expectSequence(dumpTimestamps(log), 0, 2 * PACKET_LOG_PAGE_RECORDS);
+}
+
+TEST(PacketLog, WrapsAroundOldestFirst) {
+    fs::FS fs;
+    PacketLog log(LOG_FILE);
+    log.begin(&fs);
+    appendRecords(log, 0, PACKET_LOG_MAX_RECORDS + 40);
+    EXPECT_EQ(PACKET_LOG_MAX_RECORDS * RECORD_SIZE, fileSize(fs));   // never grows past the ring
+    expectSequence(dumpTimestamps(log), 40, PACKET_LOG_MAX_RECORDS + 40);
+
+    PacketLog restored(LOG_FILE);
+    restored.begin(&fs);
+    expectSequence(dumpTimestamps(restored), 40, PACKET_LOG_MAX_RECORDS + 40);
+    appendRecords(restored, PACKET_LOG_MAX_RECORDS + 40, PACKET_LOG_MAX_RECORDS + 50);
+    expectSequence(dumpTimestamps(restored), 50, PACKET_LOG_MAX_RECORDS + 50);
+}
+
+TEST(PacketLog, RestoresWhenRingExactlyFull) {
+    fs::FS fs;
+    {
+        PacketLog log(LOG_FILE);
+        log.begin(&fs);
+        appendRecords(log, 0, PACKET_LOG_MAX_RECORDS);
+    }
+    PacketLog log(LOG_FILE);
+    log.begin(&fs);   // head is at the end, so continues from record zero
+    expectSequence(dumpTimestamps(log), 0, PACKET_LOG_MAX_RECORDS);
+    appendRecords(log, PACKET_LOG_MAX_RECORDS, PACKET_LOG_MAX_RECORDS + 1);
+    expectSequence(dumpTimestamps(log), 1, PACKET_LOG_MAX_RECORDS + 1);
+
+    log.erase();
+    EXPECT_TRUE(dumpTimestamps(log).empty());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "helpers/sensors/SensorScheduler.h"
+
+#define TYPE_TEMPERATURE  103    // LPP_TEMPERATURE
+
+static int num_starts, num_reads;
+static float next_value;
+static bool fail_read;
+
+static bool fakeStart(uint8_t) {
+    num_starts++;
+    return true;
+}
+
+static bool fakeRead(uint8_t sub_channel, SensorReading& r) {
+    num_reads++;
+    if (fail_read) return false;
+    r.add(TYPE_TEMPERATURE, next_value + sub_channel);
+    return true;
+}
+
+static void resetFakes() {
+    num_starts = num_reads = 0;
+    next_value = 20.0f;
+    fail_read = false;
+}
+
+TEST(SensorScheduler, ReadsEachPeriod) {
+    resetFakes();
+    SensorDriver drv = { 1000, 0, NULL, fakeRead };
+    SensorScheduler s;
+    ASSERT_EQ(0, s.add(&drv, 0, 0));
+    EXPECT_EQ(NULL, s.getReading(0));
+
+    EXPECT_TRUE(s.loop(0));
+    ASSERT_NE(nullptr, s.getReading(0));
+    EXPECT_EQ(1, s.getReading(0)->num);
+    EXPECT_FLOAT_EQ(20.0f, s.getReading(0)->values[0]);
+    EXPECT_EQ(TYPE_TEMPERATURE, s.getReading(0)->types[0]);
+
+    EXPECT_FALSE(s.loop(500));
+    EXPECT_EQ(500u, s.millisUntilNext(500));
+    next_value = 21.0f;
+    EXPECT_TRUE(s.loop(1000));
+    EXPECT_FLOAT_EQ(21.0f, s.getReading(0)->values[0]);
+    EXPECT_EQ(200u, s.getReadingAge(0, 1200));
+    EXPECT_EQ(2, num_reads);
+}
+
+TEST(SensorScheduler, ConversionDoesNotBlock) {
+    resetFakes();
+    SensorDriver drv = { 5000, 200, fakeStart, fakeRead };
+    SensorScheduler s;
+    s.add(&drv, 0, 0);
+
+    EXPECT_TRUE(s.loop(0));        // starts conversion only
+    EXPECT_EQ(1, num_starts);
+    EXPECT_EQ(0, num_reads);
+    EXPECT_EQ(NULL, s.getReading(0));
+
+    EXPECT_FALSE(s.loop(199));
+    EXPECT_TRUE(s.loop(200));      // conversion done
+    EXPECT_EQ(1, num_reads);
+    ASSERT_NE(nullptr, s.getReading(0));
+
+    EXPECT_FALSE(s.loop(4999));    // period is from start of conversion
+    EXPECT_TRUE(s.loop(5000));
+    EXPECT_EQ(2, num_starts);
+}
+
+TEST(SensorScheduler, OneStepPerLoop) {
+    resetFakes();
+    SensorDriver drv = { 1000, 0, NULL, fakeRead };
+    SensorScheduler s;
+    for (int i = 0; i < 4; i++) s.add(&drv, i, 0);
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(s.loop(10));
+        EXPECT_EQ(i + 1, num_reads);
+    }
+    EXPECT_FALSE(s.loop(10));
+    for (int i = 0; i < 4; i++) {
+        ASSERT_NE(nullptr, s.getReading(i));
+        EXPECT_FLOAT_EQ(20.0f + i, s.getReading(i)->values[0]);   // sub-channel passed through
+    }
+}
+
+TEST(SensorScheduler, FailedReadKeepsLastValue) {
+    resetFakes();
+    SensorDriver drv = { 1000, 0, NULL, fakeRead };
+    SensorScheduler s;
+    s.add(&drv, 0, 0);
+    s.loop(0);
+
+    fail_read = true;
+    next_value = 30.0f;
+    EXPECT_TRUE(s.loop(1000));
+    EXPECT_FLOAT_EQ(20.0f, s.getReading(0)->values[0]);
+    EXPECT_EQ(1000u, s.getReadingAge(0, 1000));
+
+    s.requestAll(1100);          // on demand, sooner than period
+    fail_read = false;
+    EXPECT_TRUE(s.loop(1100));
+    EXPECT_FLOAT_EQ(30.0f, s.getReading(0)->values[0]);
+}
+
+TEST(SensorScheduler, Limits) {
+    SensorDriver drv = { 1000, 0, NULL, fakeRead };
+    SensorScheduler s;
+    EXPECT_EQ(0xFFFFFFFFu, s.millisUntilNext(0));
+    for (int i = 0; i < SENSOR_SCHEDULER_MAX_TASKS; i++) EXPECT_EQ(i, s.add(&drv, 0, 0));
+    EXPECT_EQ(-1, s.add(&drv, 0, 0));
+
+    SensorReading r;
+    r.reset();
+    for (int i = 0; i < SENSOR_MAX_VALUES; i++) EXPECT_TRUE(r.add(TYPE_TEMPERATURE, i));
+    EXPECT_FALSE(r.add(TYPE_TEMPERATURE, 0));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
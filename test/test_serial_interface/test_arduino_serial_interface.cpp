@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include "helpers/ArduinoSerialInterface.h"
+
+// Loopback: bytes written are read back, with '>' (outbound) frames re-tagged as '<' (inbound)
+class LoopbackStream : public Stream {
+    std::deque<uint8_t> _fifo;
+public:
+    int writes = 0;
+
+    size_t write(uint8_t b) override { _fifo.push_back(b); return 1; }
+    size_t write(const uint8_t* buf, size_t len) override {
+        writes++;
+        for (size_t i = 0; i < len; i++) _fifo.push_back(i == 0 && buf[0] == '>' ? '<' : buf[i]);
+        return len;
+    }
+    int available() override { return _fifo.size(); }
+    int read() override {
+        if (_fifo.empty()) return -1;
+        int c = _fifo.front(); _fifo.pop_front();
+        return c;
+    }
+    void inject(const uint8_t* buf, size_t len) { _fifo.insert(_fifo.end(), buf, buf + len); }
+};
+
+TEST(ArduinoSerialInterface, WriteFrame_IsSingleWrite) {
+    LoopbackStream s;
+    ArduinoSerialInterface iface;
+    iface.begin(s);
+    iface.enable();
+
+    const uint8_t frame[] = { 0x01, 0x02, 0x03 };
+    EXPECT_EQ(sizeof(frame), iface.writeFrame(frame, sizeof(frame)));
+    EXPECT_EQ(1, s.writes);
+}
+
+TEST(ArduinoSerialInterface, RecvFrame_ParsesBackToBackFrames) {
+    LoopbackStream s;
+    ArduinoSerialInterface iface;
+    iface.begin(s);
+    iface.enable();
+
+    const uint8_t noise[] = { 'x', 'y' };
+    s.inject(noise, sizeof(noise));
+    for (int i = 1; i <= 3; i++) {
+        uint8_t frame[MAX_FRAME_SIZE];
+        memset(frame, i, sizeof(frame));
+        iface.writeFrame(frame, i * 50);
+    }
+
+    uint8_t dest[MAX_FRAME_SIZE];
+    for (int i = 1; i <= 3; i++) {
+        ASSERT_EQ((size_t)(i * 50), iface.checkRecvFrame(dest));
+        EXPECT_EQ(i, dest[0]);
+        EXPECT_EQ(i, dest[i * 50 - 1]);
+    }
+    EXPECT_EQ(0u, iface.checkRecvFrame(dest));
+}
+
+TEST(ArduinoSerialInterface, RecvFrame_TruncatesOversizeFrame) {
+    LoopbackStream s;
+    ArduinoSerialInterface iface;
+    iface.begin(s);
+    iface.enable();
+
+    uint8_t raw[3 + MAX_FRAME_SIZE + 10];
+    raw[0] = '<';
+    raw[1] = (MAX_FRAME_SIZE + 10) & 0xFF;
+    raw[2] = (MAX_FRAME_SIZE + 10) >> 8;
+    memset(&raw[3], 0x55, MAX_FRAME_SIZE + 10);
+    s.inject(raw, sizeof(raw));
+    const uint8_t next[] = { '<', 1, 0, 0x42 };
+    s.inject(next, sizeof(next));
+
+    uint8_t dest[MAX_FRAME_SIZE];
+    EXPECT_EQ((size_t)MAX_FRAME_SIZE, iface.checkRecvFrame(dest));
+    ASSERT_EQ(1u, iface.checkRecvFrame(dest));
+    EXPECT_EQ(0x42, dest[0]);
+}
+
+TEST(ArduinoSerialInterface, LoopbackBenchmark) {
+    LoopbackStream s;
+    ArduinoSerialInterface iface;
+    iface.begin(s);
+    iface.enable();
+
+    uint8_t frame[MAX_FRAME_SIZE], dest[MAX_FRAME_SIZE];
+    memset(frame, 0xA5, sizeof(frame));
+
+    const int N = 20000;
+    auto start = std::chrono::steady_clock::now();
+    int recv = 0;
+    for (int i = 0; i < N; i++) {
+        iface.writeFrame(frame, 32 + (i % (MAX_FRAME_SIZE - 32)));
+        if (iface.checkRecvFrame(dest) > 0) recv++;
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  loopback: %d frames in %.3f s (%.0f frames/sec)\n", recv, secs, recv / secs);
+    EXPECT_EQ(N, recv);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include "helpers/SeriesCodec.h"
+#include "Bench.h"
+
+struct Sample {
+    uint32_t ts;
+    int32_t val;
+};
+
+static int roundTrip(const Sample* samples, int n, uint8_t* buf, int buf_len) {
+    SeriesEncoder enc;
+    enc.begin(buf, buf_len);
+    for (int i = 0; i < n; i++) {
+        if (!enc.add(samples[i].ts, samples[i].val)) break;
+    }
+
+    SeriesDecoder dec;
+    dec.begin(buf, enc.getLength(), enc.getCount());
+    uint32_t ts;
+    int32_t val;
+    int i = 0;
+    while (dec.next(ts, val)) {
+        EXPECT_EQ(samples[i].ts, ts) << "sample " << i;
+        EXPECT_EQ(samples[i].val, val) << "sample " << i;
+        i++;
+    }
+    EXPECT_EQ(enc.getCount(), i);
+    return enc.getCount();
+}
+
+// a week of soil moisture-like readings, every 5 mins (with a little jitter), as LPP_ANALOG_INPUT (x 100)
+static void makeWeek(Sample* samples, int n) {
+    uint32_t ts = 1700000000;
+    for (int i = 0; i < n; i++) {
+        ts += 300 + ((i % 17) == 0 ? 1 : 0);
+        samples[i].ts = ts;
+        samples[i].val = (int32_t) lroundf((32.0f + 2.0f * sinf(i * 0.02f)) * 100);
+    }
+}
+
+TEST(SeriesCodec, RoundTripFixedInterval) {
+    Sample samples[200];
+    for (int i = 0; i < 200; i++) {
+        samples[i].ts = 1700000000 + i * 60;
+        samples[i].val = 370 + (i / 10);      // eg. battery volts x 100, slowly rising
+    }
+    uint8_t buf[256];
+    EXPECT_EQ(200, roundTrip(samples, 200, buf, sizeof(buf)));
+
+    SeriesEncoder enc;
+    enc.begin(buf, sizeof(buf));
+    for (int i = 0; i < 200; i++) enc.add(samples[i].ts, samples[i].val);
+    EXPECT_LT(enc.getLength(), 8 + 200 / 2);    // ~2-3 bits per sample after the first
+}
+
+TEST(SeriesCodec, RoundTripExtremes) {
+    Sample samples[] = {
+        { 0xFFFFFF00, INT32_MIN },
+        { 0xFFFFFF10, INT32_MAX },    // timestamp wraps next
+        { 0x00000020, -1 },
+        { 0x00000020, 0 },            // same timestamp
+        { 0x01000000, 7 },            // big jump
+        { 0x01000001, -8 },
+        { 0x01000002, 127 },
+        { 0x01000003, -32768 },
+    };
+    int n = sizeof(samples) / sizeof(samples[0]);
+    uint8_t buf[128];
+    EXPECT_EQ(n, roundTrip(samples, n, buf, sizeof(buf)));
+}
+
+TEST(SeriesCodec, FullBufferIsUnchanged) {
+    uint8_t buf[11];
+    SeriesEncoder enc;
+    enc.begin(buf, sizeof(buf));
+    EXPECT_TRUE(enc.add(1000, 5));          // 8 bytes
+    EXPECT_TRUE(enc.add(1060, 5));          // 10 bits
+    EXPECT_FALSE(enc.add(5000000, 100000)); // too big for what's left
+    EXPECT_EQ(2, enc.getCount());
+    EXPECT_TRUE(enc.add(1120, 6));
+
+    SeriesDecoder dec;
+    dec.begin(buf, enc.getLength(), enc.getCount());
+    uint32_t ts;
+    int32_t val;
+    ASSERT_TRUE(dec.next(ts, val));
+    ASSERT_TRUE(dec.next(ts, val));
+    ASSERT_TRUE(dec.next(ts, val));
+    EXPECT_EQ(1120, ts);
+    EXPECT_EQ(6, val);
+    EXPECT_FALSE(dec.next(ts, val));
+}
+
+TEST(SeriesCodec, ChunkRingAndExport) {
+    const int N = 2016;     // one week
+    static Sample samples[N];
+    makeWeek(samples, N);
+
+    CompressedSeries series(40);
+    for (int i = 0; i < N; i++) series.add(samples[i].ts, samples[i].val);
+    ASSERT_GT(series.getNumChunks(), 1);
+    ASSERT_LT(series.getNumChunks(), 40);     // a week fits in 2.5KB (vs 16KB raw)
+
+    static uint8_t out[40 * SERIES_CHUNK_SIZE];
+    int len = series.exportSince(0, out, sizeof(out));
+
+    // decode all exported chunks, should be the whole week
+    int ofs = 0, i = 0;
+    while (ofs < len) {
+        SeriesDecoder dec;
+        dec.begin(&out[ofs + SERIES_CHUNK_HEADER], out[ofs + 1], out[ofs]);
+        uint32_t ts;
+        int32_t val;
+        while (dec.next(ts, val)) {
+            ASSERT_LT(i, N);
+            EXPECT_EQ(samples[i].ts, ts);
+            EXPECT_EQ(samples[i].val, val);
+            i++;
+        }
+        ofs += SERIES_CHUNK_HEADER + out[ofs + 1];
+    }
+    EXPECT_EQ(N, i);
+    printf("[ SIZE     ] %d samples -> %d bytes (%.2f bits/sample)\n", N, len, len * 8.0f / N);
+
+    // just the last day, starts with chunk that has the day's first sample
+    len = series.exportSince(samples[N - 288].ts, out, sizeof(out));
+    SeriesDecoder dec;
+    dec.begin(&out[SERIES_CHUNK_HEADER], out[1], out[0]);
+    uint32_t ts;
+    int32_t val;
+    ASSERT_TRUE(dec.next(ts, val));
+    EXPECT_LE(ts, samples[N - 288].ts);
+    EXPECT_LT(len, (int) sizeof(out) / 5);
+
+    // limited space, so only newest chunks
+    len = series.exportSince(0, out, 2 * SERIES_CHUNK_SIZE);
+    EXPECT_LE(len, 2 * SERIES_CHUNK_SIZE);
+    EXPECT_GT(len, 0);
+
+    // ring wraps, so oldest chunks are dropped
+    CompressedSeries small(3);
+    for (int i = 0; i < N; i++) small.add(samples[i].ts, samples[i].val);
+    EXPECT_EQ(3, small.getNumChunks());
+    len = small.exportSince(0, out, sizeof(out));
+    ofs = 0;
+    uint32_t last_ts = 0;
+    while (ofs < len) {
+        dec.begin(&out[ofs + SERIES_CHUNK_HEADER], out[ofs + 1], out[ofs]);
+        while (dec.next(ts, val)) {
+            EXPECT_GT(ts, last_ts);
+            last_ts = ts;
+        }
+        ofs += SERIES_CHUNK_HEADER + out[ofs + 1];
+    }
+    EXPECT_EQ(samples[N - 1].ts, last_ts);
+}
+
+TEST(SeriesCodec, Benchmark_EncodeDecode) {
+    const int N = 2016, ROUNDS = 50;
+    static Sample samples[N];
+    makeWeek(samples, N);
+    static uint8_t buf[N * 8];
+
+    SeriesEncoder enc;
+    auto t0 = benchNow();
+    for (int r = 0; r < ROUNDS; r++) {
+        enc.begin(buf, sizeof(buf));
+        for (int i = 0; i < N; i++) enc.add(samples[i].ts, samples[i].val);
+    }
+    double enc_us = elapsedMicros(t0);
+
+    uint32_t ts, sum = 0;
+    int32_t val;
+    t0 = benchNow();
+    for (int r = 0; r < ROUNDS; r++) {
+        SeriesDecoder dec;
+        dec.begin(buf, enc.getLength(), enc.getCount());
+        while (dec.next(ts, val)) sum += ts + val;
+    }
+    double dec_us = elapsedMicros(t0);
+
+    benchPrint("%d samples: %d bytes (raw %d), encode %.3f us/sample, decode %.3f us/sample",
+               N, enc.getLength(), N * 8, enc_us / (N * ROUNDS), dec_us / (N * ROUNDS));
+    EXPECT_EQ(N, enc.getCount());
+    EXPECT_NE(0u, sum);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
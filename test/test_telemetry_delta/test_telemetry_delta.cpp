@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "helpers/TelemetryDelta.h"
+
+// CayenneLPP types used below
+#define TYPE_TEMPERATURE  103    // 2 bytes, signed, 0.1 C
+#define TYPE_VOLTAGE      116    // 2 bytes, 0.01 V
+#define TYPE_GPS          136    // 9 bytes
+
+static uint8_t sizeOf(uint8_t type) {
+    switch (type) {
+        case TYPE_GPS: return 9;
+        case TYPE_TEMPERATURE:
+        case TYPE_VOLTAGE: return 2;
+    }
+    return 1;
+}
+
+static int addRecord(uint8_t* buf, int ofs, uint8_t ch, uint8_t type, int32_t v) {
+    buf[ofs++] = ch;
+    buf[ofs++] = type;
+    buf[ofs++] = (v >> 8) & 0xFF;
+    buf[ofs++] = v & 0xFF;
+    return ofs;
+}
+
+static int makeLPP(uint8_t* buf, int16_t temp, uint16_t volts, uint8_t gps_byte) {
+    int n = addRecord(buf, 0, 1, TYPE_VOLTAGE, volts);
+    n = addRecord(buf, n, 2, TYPE_TEMPERATURE, temp);
+    buf[n++] = 3;
+    buf[n++] = TYPE_GPS;
+    memset(&buf[n], gps_byte, 9);
+    return n + 9;
+}
+
+TEST(TelemetryDelta, FirstIsFullThenOnlyChanges) {
+    TelemetryDelta tx, rx;
+    uint8_t lpp[64], enc[64], out[64];
+    int lpp_len = makeLPP(lpp, 215, 412, 0x11);
+
+    int n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, true, sizeOf);
+    EXPECT_EQ(2 + lpp_len, n);
+    EXPECT_EQ(TELEM_DELTA_FLAG_FULL, enc[0]);
+    EXPECT_EQ(lpp_len, rx.decode(enc, n, out, sizeof(out), sizeOf));
+    EXPECT_EQ(0, memcmp(lpp, out, lpp_len));
+
+    // nothing changed
+    EXPECT_EQ(0, tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, false, sizeOf));
+
+    // temperature changes by -0.3 C: index + one varint byte
+    lpp_len = makeLPP(lpp, 212, 412, 0x11);
+    n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, false, sizeOf);
+    EXPECT_EQ(2 + 2, n);
+    EXPECT_EQ(1, enc[1]);
+    ASSERT_EQ(4, rx.decode(enc, n, out, sizeof(out), sizeOf));
+    EXPECT_EQ(2, out[0]);
+    EXPECT_EQ(TYPE_TEMPERATURE, out[1]);
+    EXPECT_EQ(212, (int16_t)((out[2] << 8) | out[3]));
+
+    // GPS changes: sent in full
+    lpp_len = makeLPP(lpp, 212, 412, 0x22);
+    n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, false, sizeOf);
+    EXPECT_EQ(2 + 11, n);
+    EXPECT_EQ(0, enc[1]);
+    ASSERT_EQ(11, rx.decode(enc, n, out, sizeof(out), sizeOf));
+    EXPECT_EQ(0x22, out[2]);
+}
+
+TEST(TelemetryDelta, Threshold) {
+    TelemetryDelta tx, rx;
+    uint8_t lpp[64], enc[64], out[64];
+    int lpp_len = makeLPP(lpp, 200, 400, 0);
+    int n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 5, true, sizeOf);
+    rx.decode(enc, n, out, sizeof(out), sizeOf);
+
+    // small drift is held back, until it adds up to the threshold (vs last SENT value)
+    lpp_len = makeLPP(lpp, 203, 400, 0);
+    EXPECT_EQ(0, tx.encode(lpp, lpp_len, enc, sizeof(enc), 5, false, sizeOf));
+    lpp_len = makeLPP(lpp, 205, 400, 0);
+    n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 5, false, sizeOf);
+    ASSERT_GT(n, 0);
+    ASSERT_EQ(4, rx.decode(enc, n, out, sizeof(out), sizeOf));
+    EXPECT_EQ(205, (int16_t)((out[2] << 8) | out[3]));
+}
+
+TEST(TelemetryDelta, SignedAndWrapAround) {
+    TelemetryDelta tx, rx;
+    uint8_t lpp[8], enc[16], out[16];
+    int16_t temps[] = { 10, -10, -32768, 32767, 0 };
+    bool full = true;
+    for (int16_t t : temps) {
+        int lpp_len = addRecord(lpp, 0, 2, TYPE_TEMPERATURE, t);
+        int n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, full, sizeOf);
+        ASSERT_GT(n, 0);
+        ASSERT_EQ(4, rx.decode(enc, n, out, sizeof(out), sizeOf));
+        EXPECT_EQ(t, (int16_t)((out[2] << 8) | out[3]));
+        full = false;
+    }
+}
+
+TEST(TelemetryDelta, NewValueMidStream) {
+    TelemetryDelta tx, rx;
+    uint8_t lpp[64], enc[64], out[64];
+    int lpp_len = addRecord(lpp, 0, 1, TYPE_VOLTAGE, 400);
+    int n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, true, sizeOf);
+    rx.decode(enc, n, out, sizeof(out), sizeOf);
+
+    // voltage changes AND a new sensor appears
+    lpp_len = addRecord(lpp, 0, 1, TYPE_VOLTAGE, 390);
+    lpp_len = addRecord(lpp, lpp_len, 4, TYPE_TEMPERATURE, 150);
+    n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, false, sizeOf);
+    EXPECT_EQ(1, enc[1]);   // one delta, then full record
+    ASSERT_EQ(8, rx.decode(enc, n, out, sizeof(out), sizeOf));
+    EXPECT_EQ(0, memcmp(lpp, out, 8));
+    EXPECT_EQ(2, rx.getCount());
+
+    // now both as deltas
+    lpp_len = addRecord(lpp, 0, 1, TYPE_VOLTAGE, 380);
+    lpp_len = addRecord(lpp, lpp_len, 4, TYPE_TEMPERATURE, 151);
+    n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, false, sizeOf);
+    EXPECT_EQ(2, enc[1]);
+    EXPECT_EQ(6, n);
+    ASSERT_EQ(8, rx.decode(enc, n, out, sizeof(out), sizeOf));
+    EXPECT_EQ(0, memcmp(lpp, out, 8));
+}
+
+TEST(TelemetryDelta, GapWaitsForFull) {
+    TelemetryDelta tx, rx;
+    uint8_t lpp[64], enc[64], out[64];
+    int lpp_len = addRecord(lpp, 0, 1, TYPE_VOLTAGE, 400);
+    int n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, true, sizeOf);
+    ASSERT_GT(rx.decode(enc, n, out, sizeof(out), sizeOf), 0);
+
+    lpp_len = addRecord(lpp, 0, 1, TYPE_VOLTAGE, 390);
+    tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, false, sizeOf);   // this push is lost
+    rx.markGap();                                                   // receiver sees seq jump on the next
+
+    lpp_len = addRecord(lpp, 0, 1, TYPE_VOLTAGE, 385);
+    n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, false, sizeOf);
+    EXPECT_EQ(-1, rx.decode(enc, n, out, sizeof(out), sizeOf));     // would give 395, not 385
+    EXPECT_TRUE(rx.isWaitingForFull());
+
+    n = tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, true, sizeOf); // eg. response to re-subscribe
+    ASSERT_EQ(lpp_len, rx.decode(enc, n, out, sizeof(out), sizeOf));
+    EXPECT_EQ(0, memcmp(lpp, out, lpp_len));
+    EXPECT_FALSE(rx.isWaitingForFull());
+}
+
+TEST(TelemetryDelta, Malformed) {
+    TelemetryDelta rx;
+    uint8_t out[32];
+    uint8_t no_base[] = { 0, 1, 0, 0x02 };       // delta, with no full value before it
+    EXPECT_EQ(-1, rx.decode(no_base, sizeof(no_base), out, sizeof(out), sizeOf));
+    uint8_t truncated[] = { 0, 0, 2, TYPE_TEMPERATURE, 0x01 };
+    EXPECT_EQ(-1, rx.decode(truncated, sizeof(truncated), out, sizeof(out), sizeOf));
+    EXPECT_EQ(-1, rx.decode(out, 1, out, sizeof(out), sizeOf));
+}
+
+TEST(TelemetryDelta, SavesAirtime) {
+    // a node with 6 environment values, of which typically 2 change per push
+    TelemetryDelta tx;
+    uint8_t lpp[64], enc[64];
+    int16_t v[6] = { 215, 550, 10132, 412, 1200, 35 };
+    int lpp_full = 0, delta_total = 0;
+    for (int round = 0; round < 20; round++) {
+        int lpp_len = 0;
+        for (int i = 0; i < 6; i++) lpp_len = addRecord(lpp, lpp_len, i + 1, TYPE_TEMPERATURE, v[i]);
+        lpp_full += lpp_len;
+        delta_total += tx.encode(lpp, lpp_len, enc, sizeof(enc), 0, round == 0, sizeOf);
+        v[round % 6] += (round & 1) ? 1 : -2;
+        v[(round + 3) % 6] += 3;
+    }
+    printf("[ SIZE     ] LPP: %d bytes, delta: %d bytes\n", lpp_full, delta_total);
+    EXPECT_LT(delta_total * 3, lpp_full);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
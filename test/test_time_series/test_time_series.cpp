@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include "TimeSeriesData.h"
+
+class MockRTC : public mesh::RTCClock {
+public:
+    uint32_t now = 1700000000 - (1700000000 % (24*60*60));   // start of a day, so all tiers are aligned
+    uint32_t getCurrentTime() override { return now; }
+    void setCurrentTime(uint32_t time) override { now = time; }
+};
+
+// same layout as examples/simple_sensor battery series
+static void addBatteryTiers(TimeSeriesData& s) {
+    s.addRollupTier(15*60, 16);
+    s.addRollupTier(60*60, 24);
+    s.addRollupTier(24*60*60, 14);
+}
+
+// records 'value' once a minute for 'mins' minutes
+static void recordMinutes(TimeSeriesData& s, MockRTC& rtc, int mins, float value) {
+    for (int i = 0; i < mins; i++) {
+        s.recordData(&rtc, value);
+        rtc.now += 60;
+    }
+}
+
+TEST(TimeSeriesData, LegacyCtor_NumThenSecs) {
+    MockRTC rtc;
+    TimeSeriesData s(12, 5*60);   // 12 x 5 minute buckets
+    recordMinutes(s, rtc, 60, 3.7f);
+
+    MinMaxAvg r;
+    s.calcMinMaxAvg(&rtc, 60*60, 0, &r, 1, 2);
+    EXPECT_FLOAT_EQ(3.7f, r._avg);
+    EXPECT_EQ(1, r._channel);
+    EXPECT_EQ(2, r._lpp_type);
+
+    // an hour later the raw buckets have been recycled, only the new reading is left
+    rtc.now += 60*60;
+    s.recordData(&rtc, 3.0f);
+    s.calcMinMaxAvg(&rtc, 2*60*60, 0, &r, 1, 2);
+    EXPECT_FLOAT_EQ(3.0f, r._avg);
+}
+
+TEST(TimeSeriesData, RollupTier_LimitedToMaxTiers) {
+    TimeSeriesData s(12, 5*60);
+    addBatteryTiers(s);
+    EXPECT_FALSE(s.addRollupTier(7*24*60*60, 4));   // already at TIME_SERIES_MAX_TIERS
+    EXPECT_FALSE(TimeSeriesData(12, 5*60).addRollupTier(0, 4));
+}
+
+TEST(TimeSeriesData, Rollup_MinMaxAvgAcrossBuckets) {
+    MockRTC rtc;
+    TimeSeriesData s(12, 5*60);
+    addBatteryTiers(s);
+
+    recordMinutes(s, rtc, 30, 4.0f);
+    recordMinutes(s, rtc, 30, 3.0f);
+
+    MinMaxAvg r;
+    s.calcMinMaxAvg(&rtc, 60*60, 0, &r, 0, 0);
+    EXPECT_FLOAT_EQ(3.0f, r._min);
+    EXPECT_FLOAT_EQ(4.0f, r._max);
+    EXPECT_FLOAT_EQ(3.5f, r._avg);
+
+    // only the second half hour
+    s.calcMinMaxAvg(&rtc, 30*60, 0, &r, 0, 0);
+    EXPECT_FLOAT_EQ(3.0f, r._min);
+    EXPECT_FLOAT_EQ(3.0f, r._max);
+}
+
+TEST(TimeSeriesData, RangeQuery_UsesCoarserTierBeyondRaw) {
+    MockRTC rtc;
+    TimeSeriesData s(12, 5*60);
+    addBatteryTiers(s);
+
+    recordMinutes(s, rtc, 6*60, 4.0f);    // six hours at 4.0
+    recordMinutes(s, rtc, 2*60, 3.0f);    // then two at 3.0
+
+    // 8 hours back is beyond the raw (1h) and 15 min (4h) tiers, so comes from hourly buckets
+    MinMaxAvg r;
+    s.calcMinMaxAvg(&rtc, 8*60*60, 0, &r, 0, 0);
+    EXPECT_FLOAT_EQ(3.0f, r._min);
+    EXPECT_FLOAT_EQ(4.0f, r._max);
+    EXPECT_FLOAT_EQ(3.5f + 0.25f, r._avg);   // 6h of 4.0, 2h of 3.0
+
+    // a window wholly in the older part
+    s.calcMinMaxAvg(&rtc, 8*60*60, 3*60*60, &r, 0, 0);
+    EXPECT_FLOAT_EQ(4.0f, r._min);
+    EXPECT_FLOAT_EQ(4.0f, r._max);
+
+    // last hour comes from the raw tier
+    s.calcMinMaxAvg(&rtc, 60*60, 0, &r, 0, 0);
+    EXPECT_FLOAT_EQ(3.0f, r._max);
+}
+
+TEST(TimeSeriesData, RangeQuery_DailyTierCoversDays) {
+    MockRTC rtc;
+    TimeSeriesData s(12, 5*60);
+    addBatteryTiers(s);
+
+    for (int day = 0; day < 3; day++) {
+        recordMinutes(s, rtc, 24*60, 3.0f + day);
+    }
+    MinMaxAvg r;
+    s.calcMinMaxAvg(&rtc, 3*24*60*60, 0, &r, 0, 0);
+    EXPECT_FLOAT_EQ(3.0f, r._min);
+    EXPECT_FLOAT_EQ(5.0f, r._max);
+    EXPECT_FLOAT_EQ(4.0f, r._avg);
+}
+
+TEST(TimeSeriesData, EmptyRange_IsNan) {
+    MockRTC rtc;
+    TimeSeriesData s(12, 5*60);
+    MinMaxAvg r;
+    s.calcMinMaxAvg(&rtc, 60*60, 0, &r, 0, 0);
+    EXPECT_TRUE(isnan(r._min));
+    EXPECT_TRUE(isnan(r._max));
+    EXPECT_TRUE(isnan(r._avg));
+}
+
+TEST(TimeSeriesData, Persist_RestoresAllTiers) {
+    MockRTC rtc;
+    FS fs;
+    MinMaxAvg before, after;
+    {
+        TimeSeriesData s(12, 5*60);
+        addBatteryTiers(s);
+        s.begin(&fs, "/batt_series", 60*60);
+        recordMinutes(s, rtc, 6*60, 4.0f);
+        recordMinutes(s, rtc, 30, 3.0f);
+        s.save();
+        s.calcMinMaxAvg(&rtc, 6*60*60, 0, &before, 0, 0);
+    }
+    ASSERT_TRUE(fs.exists("/batt_series"));
+
+    TimeSeriesData s(12, 5*60);
+    addBatteryTiers(s);
+    s.begin(&fs, "/batt_series", 60*60);
+    s.calcMinMaxAvg(&rtc, 6*60*60, 0, &after, 0, 0);
+    EXPECT_FLOAT_EQ(before._min, after._min);
+    EXPECT_FLOAT_EQ(before._max, after._max);
+    EXPECT_FLOAT_EQ(before._avg, after._avg);
+    EXPECT_FLOAT_EQ(3.0f, after._min);
+}
+
+TEST(TimeSeriesData, Persist_SavedPeriodicallyWhileRecording) {
+    MockRTC rtc;
+    FS fs;
+    TimeSeriesData s(12, 5*60);
+    s.begin(&fs, "/batt_series", 60*60);
+    recordMinutes(s, rtc, 30, 4.0f);
+    EXPECT_FALSE(fs.exists("/batt_series"));
+    recordMinutes(s, rtc, 31, 4.0f);
+    EXPECT_TRUE(fs.exists("/batt_series"));
+}
+
+TEST(TimeSeriesData, Persist_DifferentTiersNotLoaded) {
+    MockRTC rtc;
+    FS fs;
+    {
+        TimeSeriesData s(12, 5*60);
+        addBatteryTiers(s);
+        s.begin(&fs, "/batt_series", 60*60);
+        recordMinutes(s, rtc, 60, 4.0f);
+        s.save();
+    }
+    TimeSeriesData s(24, 5*60);   // config changed
+    s.begin(&fs, "/batt_series", 60*60);
+    MinMaxAvg r;
+    s.calcMinMaxAvg(&rtc, 60*60, 0, &r, 0, 0);
+    EXPECT_TRUE(isnan(r._avg));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#define ED25519_NO_SEED  1
+#include <ed_25519.h>
+#include "Bench.h"
+
+struct Signer {
+    uint8_t pub[32], prv[64];
+    explicit Signer(uint8_t seed_byte) {
+        uint8_t seed[32];
+        for (int i = 0; i < 32; i++) seed[i] = seed_byte * 17 + i;
+        ed25519_create_keypair(pub, prv, seed);
+    }
+};
+
+TEST(VerifyCache, DecompressedMatchesVerify) {
+    uint8_t msg[64], sig[64], point[ED25519_POINT_SIZE];
+    for (int i = 0; i < 8; i++) {
+        Signer s(i + 1);
+        for (int j = 0; j < 64; j++) msg[j] = i * 3 + j;
+        ed25519_sign(sig, msg, sizeof(msg), s.pub, s.prv);
+
+        ASSERT_EQ(1, ed25519_decompress_key(point, s.pub));
+        EXPECT_EQ(1, ed25519_verify(sig, msg, sizeof(msg), s.pub));
+        EXPECT_EQ(1, ed25519_verify_decompressed(sig, msg, sizeof(msg), s.pub, point));
+
+        msg[10] ^= 1;
+        EXPECT_EQ(0, ed25519_verify(sig, msg, sizeof(msg), s.pub));
+        EXPECT_EQ(0, ed25519_verify_decompressed(sig, msg, sizeof(msg), s.pub, point));
+    }
+}
+
+TEST(VerifyCache, PointIsPerKey) {
+    Signer a(1), b(2);
+    uint8_t msg[40] = { 1, 2, 3 }, sig[64], point_b[ED25519_POINT_SIZE];
+    ed25519_sign(sig, msg, sizeof(msg), a.pub, a.prv);
+    ASSERT_EQ(1, ed25519_decompress_key(point_b, b.pub));
+    EXPECT_EQ(0, ed25519_verify_decompressed(sig, msg, sizeof(msg), a.pub, point_b));
+}
+
+TEST(VerifyCache, InvalidKeyRejected) {
+    uint8_t bad[32], point[ED25519_POINT_SIZE];
+    memset(bad, 0, sizeof(bad));
+    bad[0] = 2;    // y = 2 is not on the curve
+    EXPECT_EQ(0, ed25519_decompress_key(point, bad));
+}
+
+TEST(VerifyCache, Benchmark_RepeatedSigners) {
+    const int NUM_SIGNERS = 8, NUM_MSGS = 200;
+    static Signer* signers[NUM_SIGNERS];
+    static uint8_t points[NUM_SIGNERS][ED25519_POINT_SIZE];
+    uint8_t msg[NUM_MSGS][60], sig[NUM_MSGS][64];
+    for (int i = 0; i < NUM_SIGNERS; i++) {
+        signers[i] = new Signer(50 + i);
+        ed25519_decompress_key(points[i], signers[i]->pub);
+    }
+    for (int m = 0; m < NUM_MSGS; m++) {
+        Signer* s = signers[m % NUM_SIGNERS];
+        for (int j = 0; j < 60; j++) msg[m][j] = m + j;
+        ed25519_sign(sig[m], msg[m], 60, s->pub, s->prv);
+    }
+
+    int ok = 0;
+    auto t0 = benchNow();
+    for (int m = 0; m < NUM_MSGS; m++) ok += ed25519_verify(sig[m], msg[m], 60, signers[m % NUM_SIGNERS]->pub);
+    double before = elapsedMicros(t0);
+
+    t0 = benchNow();
+    for (int m = 0; m < NUM_MSGS; m++) {
+        int k = m % NUM_SIGNERS;
+        ok += ed25519_verify_decompressed(sig[m], msg[m], 60, signers[k]->pub, points[k]);
+    }
+    double after = elapsedMicros(t0);
+
+    benchPrint("verify (%d signers): %.1f us/sig -> %.1f us/sig cached", NUM_SIGNERS, before / NUM_MSGS, after / NUM_MSGS);
+    EXPECT_EQ(2 * NUM_MSGS, ok);
+
+    for (int i = 0; i < NUM_SIGNERS; i++) delete signers[i];
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}